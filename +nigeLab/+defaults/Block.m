@@ -22,6 +22,8 @@ pars.MatFileWorkflow.ConvertFcn = []; % Most cases, this will be blank (AA - IIT
 pars.MatFileWorkflow.ExtractFcn = @nigeLab.workflow.mat2BlockRC; % RC project (MM - KUMC)
 pars.DefaultRecLoc  = 'R:/Rat';
 pars.SaveFormat  = 'Hybrid'; % refers to save/load format
+pars.StreamCodec = 'deflate'; % 'deflate' (HDF5) or 'lpc' (native lossless codec for Raw/Filt/CAR/LFP; requires nigeLab.utils.compileNativeKernels)
+pars.WriteBehind = false; % Opt-in: if true, extraction/filtering stages queue DiskData writes (nigeLab.libs.DiskWriter) so computing the next channel overlaps writing the last; off by default because the background (parfeval) h5write is not thread-safe alongside foreground HDF5 calls
 pars.SaveLocDefault = 'P:/Rat';
 pars.FolderIdentifier = '.nigelBlock'; % for file "flag" in block folder
 
@@ -23,7 +23,13 @@ function pars = Filt(varargin)
 %                    -> 'STIM_SUPPRESS' [def: false] // do stim suppression
 %
 %                    -> 'STIM_BLANK' [def: [1,3] ms] // prior and post stim
-%                                                        blanking period
+%                                                        suppression window
+%
+%                    -> 'STIM_TEMPLATE' [def: 20] // neighbouring pulses
+%                                                  averaged per template
+%
+%                    -> 'STIM_DETREND' [def: 3] // local polynomial order
+%                                                (-1: no detrending)
 %
 %  --------
 %   OUTPUT
@@ -48,7 +54,9 @@ METHOD = 'ellip';    % filter type
 ORDER = 4;
 
 STIM_SUPPRESS = false;  % set true to do stimulus artifact suppression
-STIM_BLANK = [1 3];     % milliseconds prior and after to blank on stims
+STIM_BLANK = [1 3];     % milliseconds prior and after to suppress on stims
+STIM_TEMPLATE = 20;     % # neighbouring pulses in each artifact template
+STIM_DETREND = 3;       % order of local polynomial fit to residual (-1: none)
 STIM_P_CH = [nan, nan]; % [probe #, channel #] for channel delivering stims
 
 %% PARSE VARARGIN
@@ -76,6 +84,8 @@ pars.METHOD = METHOD;
 
 pars.STIM_SUPPRESS = STIM_SUPPRESS;
 pars.STIM_BLANK = STIM_BLANK;
+pars.STIM_TEMPLATE = STIM_TEMPLATE;
+pars.STIM_DETREND = STIM_DETREND;
 pars.STIM_P_CH = STIM_P_CH;
 
 pars.getFilterCoeff = @(f) getFilterCoeff(pars,f);
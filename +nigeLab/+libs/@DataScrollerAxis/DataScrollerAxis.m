@@ -136,22 +136,27 @@ classdef DataScrollerAxis < handle
             obj.fs = obj.ThisBlock.SampleRate;
             obj.sigLenght = obj.ThisBlock.Samples;
            
-            data = obj.ThisBlock.Channels(obj.Channels.Selected).(obj.Field)(:);
-            if obj.ThisBlock.getStatus('Time') && ~isempty(obj.ThisBlock.Time)
-                tt = obj.ThisBlock.Time(:);
+            % Min/max pyramid of the channel (cached on its DiskData):
+            % the stream is read once, in chunks, and plotting any zoom of
+            % it reads only a few values per pixel
+            data = obj.ThisBlock.Channels(obj.Channels.Selected).(obj.Field);
+            if isa(data,'nigeLab.libs.DiskData')
+                P = getMinMaxPyramid(data);
             else
-                tt = linspace(0,obj.sigLenght./obj.fs,obj.sigLenght);
+                P = nigeLab.utils.MinMaxPyramid(data(:));
             end
-            
-            if isempty(tt) || length(tt)~=obj.sigLenght
-                %failsafe
-                tt = linspace(0,obj.sigLenght./obj.fs,obj.sigLenght);
+            P.X0 = 0;
+            P.DX = 1./obj.fs;
+            if obj.ThisBlock.getStatus('Time') && ~isempty(obj.ThisBlock.Time)
+                P.X0 = double(obj.ThisBlock.Time(1));
             end
-            [x_reduced, y_reduced] = nigeLab.utils.reduce_to_width(tt, data, obj.MainAxPixelSize(4) ,[tt(1) tt(end)]);
+            tLim = P.X0 + [0, max(P.N-1,1)].*P.DX;
+            
+            [x_reduced, y_reduced] = reduce(P,obj.MainAxPixelSize(3),tLim);
             cla(obj.UI.MainAx);
             L = line(obj.UI.MainAx,x_reduced,y_reduced);
-            obj.ReducedPlot = nigeLab.utils.LinePlotReducer(L,tt,data);
-            xlim(obj.UI.MainAx,[tt(1) tt(end)]);
+            obj.ReducedPlot = nigeLab.utils.LinePlotReducer(L,P);
+            xlim(obj.UI.MainAx,tLim);
 %             obj.LinePlotExplorer = nigeLab.utils.LinePlotExplorer(obj.UI.Fig);
             
         end
@@ -32,6 +32,12 @@ classdef DiskData < handle & ...
    %                       -> 'class'
    %                       -> 'access' : 'r' (default, read-only) or 'w'
    %                                     'w' (for write access)
+   %                       -> 'codec' : 'deflate' (default, HDF5 Deflate)
+   %                                     or 'lpc' (native lossless
+   %                                     predictive codec; streams only)
+   %                       -> 'writebehind' : false (default) or true
+   %                                     (queue writes on
+   %                                     nigeLab.libs.DiskWriter)
    %
    %  DISKDATA Properties:
    %     ## Dependent (File Attributes) ##
@@ -53,6 +59,8 @@ classdef DiskData < handle & ...
    %     chunks_ - Size of "chunks" to read
    %     access_ - Whether access is read-only (default) or writable
    %     writable_ - Whether file is writable (parsed from access_)
+   %     codec_ - 'deflate' (HDF5 filter) or 'lpc' (native stream codec)
+   %     writebehind_ - Queue writes on nigeLab.libs.DiskWriter (async)
    %
    %  DISKDATA Methods:
    %     DiskData - Class constructor
@@ -92,6 +100,7 @@ classdef DiskData < handle & ...
    % PROTECTED
    properties (Access=protected)
       compress_   (1,1) double  = 1         % Value between 0 and 9, where 9 is the highest compression
+      codec_            char    = 'deflate' % 'deflate' (HDF5, uses compress_) or 'lpc' (native lossless codec; 'Hybrid' and 'MatFile' only)
       diskfile_         char    = ''        % Char array pointer to actual diskfile
       type_             char    = 'MatFile' % 'MatFile' (only MatFile) or 'Hybrid' (combo H5 stuff) or 'Event' (spikes etc)
       name_             char    = 'data'  % Name of variable pointed to by DiskData array (default: 'data')
@@ -103,6 +112,13 @@ classdef DiskData < handle & ...
       writable_         logical           % Whether file is writable
       overwrite_  (1,1) logical = false   % By default, constructor does not overwrite if data is already present
       verbose_    (1,1) logical = false   % Set false to suppress `getAttr` and `setAttr` print commands (maybe)
+      writebehind_(1,1) logical = false   % If true, writes are queued on nigeLab.libs.DiskWriter (see flush)
+   end
+   
+   % TRANSIENT,PROTECTED
+   properties (Transient,Access=protected)
+      index_                        = []      % In-memory 'Event' query index (see getEventIndex); cleared on write
+      pyramid_                      = []      % In-memory min/max pyramid of stream (see getMinMaxPyramid); cleared on write
    end
    % % % % % % % % % % END PROPERTIES %
    
@@ -137,7 +153,7 @@ classdef DiskData < handle & ...
          %PARSE INPUTS
          keyProps=...
             {'name','size','class','access','verbose',...
-             'overwrite','chunks','writable','compress',...
+             'overwrite','chunks','writable','compress','codec','writebehind',...
              'Tank','Animal','Block','Complete','Empty','Index','Locked','Data'};
          nargin=numel(varargin);
          
@@ -207,9 +223,12 @@ classdef DiskData < handle & ...
                obj.size_ = size(varargin{3});
                obj.class_ = class(varargin{3});
                
-               % Make sure if 'Event' it has a valid chunk size
+               % Make sure if 'Event' it has a valid chunk size: chunks
+               % are blocks of rows within one column, so that reading a
+               % single column (e.g. ts) or a subset of rows does not
+               % read every column of every event
                if strcmpi(obj.type_,'Event')
-                  obj.chunks_ = [1 obj.size_(2)];
+                  obj.chunks_ = [1024 1];
                end
                
                % Second arg is fName, third arg is data
@@ -259,8 +278,7 @@ classdef DiskData < handle & ...
          %  Out = abs(obj);
          %  --> Returns absolute value by directly reading entire file
          
-         varname=[ '/' obj.name_];
-         a = h5read(obj.getPath,varname,[1 1],[1 inf]);
+         a = readStream(obj);
          Out = abs(a);
       end
       
@@ -327,26 +345,45 @@ classdef DiskData < handle & ...
                ['[DISKDATA]: Append dimension (`dim`: %g) exceeds ' ...
                'data dimension (%g)\n'],dim,obj.rank_h5);
          end
+         clearCachedPages(obj);
+         
+         % 'lpc'-coded streams re-code only the (partial) tail block
+         if isCoded(obj)
+            setCodedStreamsFromIndexing(obj,obj.size_(2)+(1:numel(data)),data);
+            obj.bytes_ = obj.getFileSize();
+            if nargout > 0
+               out = readStream(obj);
+            else
+               out = [];
+               clear out;
+            end
+            return;
+         end
+         
          start_offset = zeros(1,obj.rank_h5);
          start_offset(dim) = 1;
+         obj.index_ = []; % Event query index is now out of date
          
          % Set arguments to h5write
          start = obj.size_ + start_offset;
          count = ones(1,obj.rank_h5);
-         stride = ones(1,obj.rank_h5);
          block = size(data);
          block(~logical(start_offset)) = 0;
          start(~logical(start_offset)) = 1;
          obj.size_= obj.size_ + block; 
          
          % Get file, data, and space identifiers
-         h5write(obj.diskfile_,varname_,data,start,size(data),stride);
+         writeHyperslab(obj,data,start,dim);
 
-         % Update file size
-         obj.bytes_ = obj.getFileSize();     
+         % Update file size from the new size (getFileSize would have to
+         % wait for the queued write)
+         val = zeros(1,1,obj.class_); %#ok<NASGU>
+         info = whos('val');
+         obj.bytes_ = prod(obj.size_) * info.bytes;
          
          % If requested, provide output
          if nargout > 0
+            nigeLab.libs.DiskWriter.barrier(obj.diskfile_);
             out = h5read(obj.diskfile_,varname_,...
                ones(1,obj.rank_h5),[inf,inf],ones(1,obj.rank_h5));
          else
@@ -373,8 +410,7 @@ classdef DiskData < handle & ...
          %  Out = double(obj);
          %  --> Returns value directly from file cast as `'double'` type
          
-         varname=[ '/' obj.name_];
-         a = h5read(obj.getPath,varname,[1 1],[1 inf]);
+         a = readStream(obj);
          Out= double(a);
       end
       
@@ -455,11 +491,9 @@ classdef DiskData < handle & ...
          %  to a disk file, but instead simply returns the result of the
          %  subtraction operation to the caller workspace.
          
-         varname=[ '/' obj.name_];
-         a = h5read(obj.getPath,varname,[1 1],[1 inf]);
+         a = readStream(obj);
          if isa(b,'nigeLab.libs.DiskData')
-            varname=[ '/' b.name_];
-            b = h5read(b.getPath,varname,[1 1],[1 inf]);
+            b = readStream(b);
             Out=a-b;
          elseif isnumeric(b)
             Out=a-b;
@@ -480,11 +514,9 @@ classdef DiskData < handle & ...
          %  to a disk file, but instead simply returns the result of the
          %  multiply operation to the caller workspace
          
-         varname=[ '/' obj.name_];
-         a = h5read(obj.getPath,varname,[1 1],[1 inf]);
+         a = readStream(obj);
          if isa(b,'nigeLab.libs.DiskData')
-            varname=[ '/' b.name_];
-            b = h5read(b.getPath,varname,[1 1],[1 inf]);
+            b = readStream(b);
             Out=a*b;
          elseif isnumeric(b)
             Out=a*b;
@@ -515,8 +547,7 @@ classdef DiskData < handle & ...
          %  Out = single(obj);
          %  --> Returns value directly from file cast as `'single'` type
          
-         varname=[ '/' obj.name_];
-         a = h5read(obj.getPath,varname,[1 1],[1 inf]);
+         a = readStream(obj);
          Out= single(a);
       end
       
@@ -577,11 +608,9 @@ classdef DiskData < handle & ...
          %  to a disk file, but instead simply returns the result of the
          %  multiply operation to the caller workspace
          
-         varname=[ '/' obj.name_];
-         a = h5read(obj.getPath,varname,[1 1],[1 inf]);
+         a = readStream(obj);
          if isa(b,'nigeLab.libs.DiskData')
-            varname=[ '/' b.name_];
-            b = h5read(b.getPath,varname,[1 1],[1 inf]);
+            b = readStream(b);
             Out=a*b;
          elseif isnumeric(b)
             Out=a.*b;
@@ -612,6 +641,9 @@ classdef DiskData < handle & ...
    
    % SEALED,PUBLIC
    methods (Sealed,Access=public)
+      rows = findEventRows(obj,propName,matchValue) % Rows of 'Event' data in a time range or set of values
+      P = getMinMaxPyramid(obj) % Returns (cached) min/max pyramid of 'Hybrid' or 'MatFile' stream, for plotting
+      
       % Mark that this file has completed processing
       function SetCompletedStatus(obj,tf)
          %SETCOMPLETEDSTATUS  Mark that this file has completed processing
@@ -646,6 +678,13 @@ classdef DiskData < handle & ...
             flag = false;
             return;
          end
+         nigeLab.libs.DiskWriter.barrier(obj.diskfile_);
+         if isCoded(obj)
+            obj.size_ = double(h5readatt(obj.diskfile_,['/' obj.name_],...
+               'CodecSize'));
+            flag = all(obj.size_ ~= 0);
+            return;
+         end
          info = h5info(obj.diskfile_);
          if isempty(info.Datasets)
             flag = false;
@@ -676,6 +715,19 @@ classdef DiskData < handle & ...
          
       end
       
+      % Wait for queued (write-behind) writes to this file
+      function flush(obj)
+         %FLUSH  Block until writes queued on nigeLab.libs.DiskWriter for
+         %       this file are on disk
+         %
+         %  flush(obj);
+         %  --> Barrier for obj.diskfile_ (reads already do this)
+         
+         for i = 1:numel(obj)
+            nigeLab.libs.DiskWriter.barrier(obj(i).diskfile_);
+         end
+      end
+      
       % Return an attribute of the H5 Diskfile
       function attvalue = getAttr(obj,attname,verbose)
          %GETATTR  Return an attribute of the H5 Diskfile
@@ -820,26 +872,22 @@ classdef DiskData < handle & ...
             return;            
          end
          
+         % Drop bytes left behind by re-coded blocks while still writable
+         if isCoded(obj) && obj.writable_
+            compactCodedStream(obj);
+         end
+         
          obj.writable_ = false;
          obj.access_ = 'r';
          obj.overwrite_ = false;
          
-         if setAttr(obj,'Locked',true)
-            col = 'Keywords*';
-            str = 'Successful';
+         % If writes to the file are still queued, lock it once they are
+         % done instead of waiting for them here
+         if nigeLab.libs.DiskWriter.pending(obj.diskfile_)
+            nigeLab.libs.DiskWriter.call(obj.diskfile_,...
+               @()lockDiskFile(obj,verbose));
          else
-            dbstack();
-            col = 'Errors*';
-            str = 'Unsuccessful';
-         end
-         % Set the actual file "write" flag AFTER modifying .Locked attr
-         fileattrib(obj.diskfile_,'-w'); 
-         
-         if verbose
-            nigeLab.utils.cprintf('Text*','\t\t\t->\t[DISKDATA/LOCKDATA]: ');
-            nigeLab.utils.cprintf('Keywords*','''Locked''');
-            nigeLab.utils.cprintf('Text',' property set--');
-            nigeLab.utils.cprintf(col,'%s\n',str); 
+            lockDiskFile(obj,verbose);
          end
       end
       
@@ -876,6 +924,7 @@ classdef DiskData < handle & ...
          end
 
          try 
+            nigeLab.libs.DiskWriter.barrier(obj.diskfile_); % Queued writes
             h5writeatt(obj.diskfile_,'/',attname,val);
          catch
             flag = false;
@@ -910,6 +959,9 @@ classdef DiskData < handle & ...
          end
          
          if exist(obj.diskfile_,'file')~=0
+            if ~obj.writable_ % Make sure a queued lock has happened first
+               nigeLab.libs.DiskWriter.barrier(obj.diskfile_);
+            end
             fileattrib(obj.diskfile_,'+w');
          elseif verbose
             [p,f,e] = fileparts(obj.diskfile_);
@@ -950,6 +1002,11 @@ classdef DiskData < handle & ...
    
    % SEALED,PROTECTED
    methods (Sealed,Access=protected)
+      data = getCachedStreamsFromIndexing(obj,idx) % Returns stream samples through the shared page cache
+      data = getCodedStreamsFromIndexing(obj,idx) % Returns decoded samples of 'lpc'-coded stream
+      index = getEventIndex(obj,propName)         % Returns (cached) 'Event' time index or posting lists
+      compactCodedStream(obj)                     % Drops dead bytes left by re-coded blocks of 'lpc'-coded stream
+      setCodedStreamsFromIndexing(obj,idx,data)   % Re-codes blocks of 'lpc'-coded stream touched by idx
       subsasgn_MatrixData(obj,S,data)  % For assigning 'Event' obj.type_ data using subscripting
       subsasgn_VectorData(obj,S,data)  % For assigning 'Hybrid' and 'MatFile' obj.type_ data using subscripting
       data = subsref_MatrixData(obj,S) % Returns 'Event' obj.type_ data using subscripting
@@ -1931,7 +1988,7 @@ classdef DiskData < handle & ...
          disp('   --    Data    --');
          switch obj.type_
             case 'Hybrid'
-               a = h5read(obj.getPath,varname_,[1 1],[1 inf]);
+               a = readStream(obj);
                if numel(a) > 5
                   fprintf(1,  '\tN:     %g (samples)',numel(a));
                   fprintf(1,'\n\tRange: [%g  %g]',min(a),max(a));
@@ -1941,7 +1998,7 @@ classdef DiskData < handle & ...
                   disp(a);
                end
             case 'MatFile'
-               a = h5read(obj.getPath,varname_,[1 1],[1 inf]);
+               a = readStream(obj);
                if numel(a) > 5
                   fprintf(1,  '\tN:     %g (samples)',numel(a));
                   fprintf(1,'\n\tRange: [%g  %g]',min(a),max(a));
@@ -1994,7 +2051,27 @@ classdef DiskData < handle & ...
          %  fsize = obj.getFileSize();
          %  [fsize,dname,dclass,sz] = getFileSize(obj);
          
+         nigeLab.libs.DiskWriter.barrier(obj.diskfile_); % Queued writes
          info = h5info(obj.diskfile_);
+         
+         % 'lpc'-coded streams keep the coded bytes in /data and the block
+         % offsets in /data_index: size and class are /data attributes
+         iCoded = find(strcmp({info.Datasets.Name},obj.name_),1);
+         if ~isempty(iCoded) && ~isempty(info.Datasets(iCoded).Attributes)
+            attr = info.Datasets(iCoded).Attributes;
+            attrname = {attr.Name};
+            if ismember('Codec',attrname)
+               getVal = @(name)attr(strcmp(attrname,name)).Value;
+               obj.codec_ = getVal('Codec');
+               obj.chunks_ = [1 double(getVal('CodecBlock'))];
+               fsize = prod(info.Datasets(iCoded).Dataspace.Size);
+               dname = obj.name_;
+               dclass = getVal('CodecClass');
+               sz = reshape(double(getVal('CodecSize')),1,[]);
+               return;
+            end
+         end
+         
          if numel(info.Datasets) > 1
             curSz = 0;
             idx = 1;
@@ -2249,7 +2326,9 @@ classdef DiskData < handle & ...
          varname_ = ['/' obj.name_]; 
          
          % Now, create h5 dataset with (correct) desired property list
-         if strcmp(obj.type_,'MatFile') % MatFile ~ not extendable
+         if isCoded(obj) % Native codec ~ coded bytes plus block index
+            initCodedFile(obj,fName);
+         elseif strcmp(obj.type_,'MatFile') % MatFile ~ not extendable
             h5create(fName, varname_, obj.maxdims_h5,...
                'DataType',obj.class_,'FillValue',zeros(1,1,obj.class_));
 
@@ -2264,6 +2343,125 @@ classdef DiskData < handle & ...
          addFileNameAttributes(obj,fName);
       end
       
+      % Drop pages of this stream from the shared page cache
+      function clearCachedPages(obj)
+         %CLEARCACHEDPAGES  Invalidate cached pages after a write
+         %
+         %  clearCachedPages(obj);
+         %  --> Also clears the min/max pyramid (see getMinMaxPyramid)
+         
+         obj.pyramid_ = [];
+         if exist('PageCache_core','file')==3
+            PageCache_core('invalidate',[obj.diskfile_ '/' obj.name_]);
+         end
+      end
+      
+      % Set .Locked attribute and make diskfile_ read-only
+      function lockDiskFile(obj,verbose)
+         %LOCKDISKFILE  File part of lockData (may run after queued writes)
+         %
+         %  lockDiskFile(obj,verbose);
+         
+         if setAttr(obj,'Locked',true)
+            col = 'Keywords*';
+            str = 'Successful';
+         else
+            dbstack();
+            col = 'Errors*';
+            str = 'Unsuccessful';
+         end
+         % Set the actual file "write" flag AFTER modifying .Locked attr
+         fileattrib(obj.diskfile_,'-w'); 
+         
+         if verbose
+            nigeLab.utils.cprintf('Text*','\t\t\t->\t[DISKDATA/LOCKDATA]: ');
+            nigeLab.utils.cprintf('Keywords*','''Locked''');
+            nigeLab.utils.cprintf('Text',' property set--');
+            nigeLab.utils.cprintf(col,'%s\n',str); 
+         end
+      end
+      
+      % Write data hyperslab now, or queue it if .writebehind_ is set
+      function writeHyperslab(obj,data,start,dim)
+         %WRITEHYPERSLAB  h5write of `data` to diskfile_ at `start`
+         %
+         %  writeHyperslab(obj,data,start,dim);
+         %
+         %  dim : Dimension along which consecutive writes extend (used
+         %        by nigeLab.libs.DiskWriter to merge queued writes)
+         
+         varname_ = ['/' obj.name_];
+         if ~obj.writebehind_
+            h5write(obj.diskfile_,varname_,data,start,size(data));
+            return;
+         end
+         c = obj.chunks_h5;
+         if numel(c) < dim
+            chunk = 1; % Not chunked; any write is "aligned"
+         else
+            chunk = c(dim);
+         end
+         nigeLab.libs.DiskWriter.write(obj.diskfile_,varname_,data,...
+            start,dim,chunk);
+      end
+      
+      % Initialize datasets for native 'lpc'-coded streams
+      function initCodedFile(obj,fName)
+         %INITCODEDFILE  Create empty datasets for an 'lpc'-coded stream
+         %
+         %  initCodedFile(obj,fName);
+         %
+         %  obj : nigeLab.libs.DiskData object (.codec_ == 'lpc')
+         %  fName : Full file character array to obj.diskfile_ source
+         %
+         %  Creates two extendable datasets:
+         %  * /<name_>        -- uint8 coded bytes (blocks are appended)
+         %  * /<name_>_index  -- 2 x nBlocks [byte offset; byte count]
+         %  The sample count, class, block size (.chunks_(end) samples)
+         %  and dead (re-coded) bytes are stored as attributes of /<name_>.
+         
+         if ~ismember(obj.class_,{'int16','int32','single','double'})
+            error(['nigeLab:' mfilename ':BadCodecClass'],...
+               ['[DISKDATA]: ''lpc'' codec supports int16, int32, ' ...
+               'single or double (not %s)\n'],obj.class_);
+         end
+         varname_ = ['/' obj.name_];
+         h5create(fName,varname_,[1 inf],...
+            'ChunkSize',[1 65536],'DataType','uint8');
+         h5create(fName,[varname_ '_index'],[2 inf],...
+            'ChunkSize',[2 256],'DataType','double');
+         h5writeatt(fName,varname_,'Codec','lpc');
+         h5writeatt(fName,varname_,'CodecClass',obj.class_);
+         h5writeatt(fName,varname_,'CodecBlock',obj.chunks_(end));
+         h5writeatt(fName,varname_,'CodecSize',[1 0]);
+         h5writeatt(fName,varname_,'CodecDead',0);
+         obj.size_ = [1 0];
+      end
+      
+      % Returns true if this is a stream stored with the native codec
+      function tf = isCoded(obj)
+         %ISCODED  Returns true for 'lpc'-coded 'Hybrid' or 'MatFile'
+         %
+         %  tf = isCoded(obj);
+         
+         tf = strcmp(obj.codec_,'lpc') && ~strcmp(obj.type_,'Event');
+      end
+      
+      % Returns the full stream (in its stored class)
+      function a = readStream(obj)
+         %READSTREAM  Returns full 'Hybrid' or 'MatFile' stream
+         %
+         %  a = readStream(obj);
+         %  --> Reads the whole vector, decoding it if needed
+         
+         if isCoded(obj)
+            a = getCodedStreamsFromIndexing(obj,1:obj.size_(2));
+         else
+            nigeLab.libs.DiskWriter.barrier(obj.diskfile_);
+            a = h5read(obj.getPath,['/' obj.name_],[1 1],[1 inf]);
+         end
+      end
+      
       % Initialize data in file specified by fName for .type_ = 'MatFile'
       function flag = initMatFile(obj,fName)
          %INITMATFILE  Init data to file specified by fName
@@ -2364,6 +2562,7 @@ classdef DiskData < handle & ...
                ['[DISKDATA]: Cannot write EMPTY array to file. '...
                '\t->\t(Check constructor)\n']);
          end         
+         nigeLab.libs.DiskWriter.barrier(fName);
          if exist(fName,'file')~=0 
             if obj.overwrite_
                delete(fName);
@@ -2410,6 +2609,17 @@ classdef DiskData < handle & ...
          H5L.delete(fid,'data','H5P_DEFAULT');
          H5F.close(fid);
          obj.diskfile_ = fName; % Associate name at this point
+         obj.index_ = [];
+         clearCachedPages(obj);
+         % Native codec handles its own layout and writing
+         if isCoded(obj)
+            initCodedFile(obj,fName);
+            setCodedStreamsFromIndexing(obj,1:numel(data),data);
+            obj.Empty = zeros(1,1,'int8');
+            addFileNameAttributes(obj,fName);
+            obj.bytes_ = obj.getFileSize();
+            return;
+         end
          % Now, create h5 dataset with (correct) desired property list
          if strcmp(obj.type_,'MatFile') % MatFile ~ not extendable
             h5create(fName, varname_, obj.maxdims_h5,...
@@ -2426,7 +2636,11 @@ classdef DiskData < handle & ...
          stride = ones(1,obj.rank_h5); % Stride for "hyperslab" spacing
          
          % % % Write the data provided to constructor to the Diskfile % % %
-         h5write(fName,varname_,data,start,sz,stride);
+         if strcmp(obj.type_,'MatFile')
+            h5write(fName,varname_,data,start,sz,stride);
+         else
+            writeHyperslab(obj,data,start,obj.var_dim_idx);
+         end
          % % % % % % % % % % % % % % % % % % % % % % % % % % % % % % % % %
          
          % Add attributes denoting that data file is non-empty
@@ -2570,6 +2784,46 @@ classdef DiskData < handle & ...
    
    % STATIC
    methods (Static)
+      % Query or configure the shared stream page cache
+      function out = pageCache(cmd,value)
+         %PAGECACHE  Query or configure the DiskData stream page cache
+         %
+         %  stats = nigeLab.libs.DiskData.pageCache('stats');
+         %  --> Struct with hits, misses, evictions, pages, bytes, budget
+         %
+         %  prev = nigeLab.libs.DiskData.pageCache('budget',bytes);
+         %  --> Sets the memory budget (default: 256 MB), returns previous
+         %
+         %  nigeLab.libs.DiskData.pageCache('clear');
+         %  --> Drops all cached pages and resets the counters
+         %
+         %  The cache holds pages of 'Hybrid' and 'MatFile' streams that
+         %  were read in windows (see getCachedStreamsFromIndexing); it is
+         %  shared by every DiskData object in this MATLAB session.
+         
+         out = [];
+         if exist('PageCache_core','file')~=3
+            error(['nigeLab:' mfilename ':MissingKernel'],...
+               ['[DISKDATA]: Page cache requires PageCache_core ' ...
+               '(run nigeLab.utils.compileNativeKernels)']);
+         end
+         switch lower(cmd)
+            case 'stats'
+               out = PageCache_core('stats');
+            case 'budget'
+               if nargin < 2
+                  out = PageCache_core('budget');
+               else
+                  out = PageCache_core('budget',value);
+               end
+            case 'clear'
+               PageCache_core('clear');
+            otherwise
+               error(['nigeLab:' mfilename ':BadCommand'],...
+                  '[DISKDATA]: Unknown page cache command: ''%s''',cmd);
+         end
+      end
+      
       % Enumeration to get Column index based on '.' indexing for 'Event'
       function iCol = getEnumeratedColumn(propName,numColumns)
          %GETENUMERATEDCOLUMN  Returns "enumerated" column index for Event
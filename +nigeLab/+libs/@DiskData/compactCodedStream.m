@@ -0,0 +1,70 @@
+function compactCodedStream(obj)
+%COMPACTCODEDSTREAM  Drop the dead bytes of an 'lpc'-coded stream
+%
+%  compactCodedStream(obj);
+%
+%  obj : nigeLab.libs.DiskData object with .codec_ == 'lpc'
+%
+%  Re-coded blocks leave bytes behind (see setCodedStreamsFromIndexing),
+%  counted in the 'CodecDead' attribute of /<name_>. If there are any,
+%  the live blocks are slid down in the order they are stored, so each
+%  only moves towards the start of /<name_> and never onto bytes that
+%  have not been read yet; /<name_> is then shrunk to the live bytes and
+%  the block index is rewritten.
+
+COPY_BYTES = 2^24; % Largest read (and write) while sliding blocks
+
+varname_ = ['/' obj.name_];
+try
+   nDead = double(h5readatt(obj.diskfile_,varname_,'CodecDead'));
+catch
+   nDead = 0;
+end
+if nDead == 0
+   return;
+end
+
+nBlk = ceil(obj.size_(2)/obj.chunks_(end));
+index = zeros(2,nBlk);
+if nBlk > 0
+   index = h5read(obj.diskfile_,[varname_ '_index'],[1 1],[2 nBlk]);
+end
+
+% Live blocks in stored order, and where each one ends up
+[off,order] = sort(index(1,:));
+cnt = index(2,order);
+dst = [0, cumsum(cnt(1:(end-1)))];
+dst = dst(1:nBlk);
+
+% Move runs of stored-adjacent blocks, up to COPY_BYTES at a time
+k0 = 1;
+while k0 <= nBlk
+   k1 = k0;
+   n = cnt(k0);
+   while (k1 < nBlk) && (off(k1+1) == (off(k1) + cnt(k1))) && ...
+         ((n + cnt(k1+1)) <= COPY_BYTES)
+      k1 = k1 + 1;
+      n = n + cnt(k1);
+   end
+   if (n > 0) && (dst(k0) ~= off(k0))
+      bytes = h5read(obj.diskfile_,varname_,[1 (off(k0)+1)],[1 n]);
+      h5write(obj.diskfile_,varname_,bytes,[1 (dst(k0)+1)],[1 n]);
+   end
+   k0 = k1 + 1;
+end
+
+if nBlk > 0
+   index(1,order) = dst;
+   h5write(obj.diskfile_,[varname_ '_index'],index,[1 1],size(index));
+end
+
+% Shrink the coded bytes to the live blocks (low-level dims are reversed)
+fid = H5F.open(obj.diskfile_,'H5F_ACC_RDWR','H5P_DEFAULT');
+did = H5D.open(fid,varname_);
+H5D.set_extent(did,fliplr([1 sum(cnt)]));
+H5D.close(did);
+H5F.close(fid);
+h5writeatt(obj.diskfile_,varname_,'CodecDead',0);
+obj.bytes_ = sum(cnt);
+
+end
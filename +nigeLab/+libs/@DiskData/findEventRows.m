@@ -0,0 +1,99 @@
+function rows = findEventRows(obj,propName,matchValue)
+%FINDEVENTROWS  Return rows of 'Event' data matching a time range or values
+%
+%  rows = findEventRows(obj,'ts',[t0 t1]);
+%  --> Rows of events with t0 <= ts < t1
+%
+%  rows = findEventRows(obj,'value',clusterIndex);
+%  --> Rows of events whose value (e.g. cluster label) is in clusterIndex
+%
+%  obj : nigeLab.libs.DiskData object with .type_ == 'Event'
+%  propName : 'ts' or 'value'
+%  matchValue : [t0 t1] (for 'ts') or vector of values (for 'value')
+%
+%  rows : Ascending column vector of matching rows, so that for example
+%         obj.snippet(rows,:) only reads the matching events.
+%
+%  Queries use an index that is kept in memory (see getEventIndex): a
+%  sparse time index brackets a time range so that only the ts of the
+%  events in the bracket are read, and per-value posting lists give the
+%  rows of a set of clusters directly. The index is rebuilt after any
+%  write to the file.
+
+rows = zeros(0,1);
+if ~strcmp(obj.type_,'Event')
+   error(['nigeLab:' mfilename ':BadType'],...
+      '[DISKDATA]: findEventRows requires ''Event'' type_ (not ''%s'')',...
+      obj.type_);
+end
+if ~checkSize(obj)
+   return;
+end
+useNative = exist('EventIndex_core','file')==3;
+
+switch lower(propName)
+   case 'ts'
+      if numel(matchValue) ~= 2
+         error(['nigeLab:' mfilename ':BadMatchValue'],...
+            '[DISKDATA]: ''ts'' queries require matchValue as [t0 t1]');
+      end
+      tLim = reshape(double(matchValue),1,2);
+      index = getEventIndex(obj,'ts');
+      if ~index.sorted % Cannot bracket; compare every timestamp
+         ts = getEventsFromIndexing(obj,1:index.N,4);
+         rows = find((ts >= tLim(1)) & (ts < tLim(2)));
+         return;
+      end
+      if useNative
+         [r0,r1] = EventIndex_core('range',index,tLim);
+      else
+         [r0,r1] = bracketTimeRange(index,tLim);
+      end
+      if r1 < r0
+         return;
+      end
+      ts = getEventsFromIndexing(obj,r0:r1,4);
+      if useNative
+         rows = EventIndex_core('refine',ts,r0,tLim);
+      else
+         rows = r0 - 1 + find((ts >= tLim(1)) & (ts < tLim(2)));
+      end
+
+   case 'value'
+      index = getEventIndex(obj,'value');
+      if useNative
+         rows = EventIndex_core('cluster',index,double(matchValue(:)));
+      else
+         [~,k] = ismember(unique(matchValue(:)),index.labels);
+         k(k==0) = [];
+         rows = cell(numel(k),1);
+         for i = 1:numel(k)
+            rows{i} = index.rows((index.offsets(k(i))+1):index.offsets(k(i)+1));
+         end
+         rows = sort(vertcat(zeros(0,1),rows{:}));
+      end
+
+   otherwise
+      error(['nigeLab:' mfilename ':BadProp'],...
+         '[DISKDATA]: Unsupported query property: ''%s'' (use ''ts'' or ''value'')',...
+         propName);
+end
+
+end
+
+% Return 1-based row window [r0, r1] holding every event in [t0, t1)
+function [r0,r1] = bracketTimeRange(index,tLim)
+%BRACKETTIMERANGE  MATLAB version of EventIndex_core('range',...)
+%
+%  [r0,r1] = bracketTimeRange(index,tLim);
+
+a = sum(index.tSparse < tLim(1)); % Sparse entries before t0
+b = sum(index.tSparse < tLim(2)); % Sparse entries before t1
+if (b == 0) || ~(tLim(1) < tLim(2))
+   r0 = 1;
+   r1 = 0;
+   return;
+end
+r0 = max(a-1,0) * index.stride + 1;
+r1 = min(b * index.stride, index.N);
+end
@@ -0,0 +1,64 @@
+function data = getCachedStreamsFromIndexing(obj,idx)
+%GETCACHEDSTREAMSFROMINDEXING  Return stream data through the page cache
+%
+%  data = getCachedStreamsFromIndexing(obj,idx);
+%
+%  obj : nigeLab.libs.DiskData object ('Hybrid' or 'MatFile')
+%  idx : Indexing vector (numeric, within 1:obj.size_(2))
+%
+%  data : Requested samples (double)
+%
+%  Streams are split into pages of PAGE samples. Pages are kept in a
+%  process-wide least-recently-used cache (PageCache_core), so windows
+%  that overlap earlier reads (e.g. scrolling in DataScrollerAxis or
+%  nigelStream) do not go back to the diskfile_. Missing pages are read
+%  in runs, together with up to AHEAD pages in the direction that the
+%  stream is being scrolled. See nigeLab.libs.DiskData.pageCache for the
+%  memory budget and hit/miss counters.
+
+PAGE = 32768; % Samples per cached page
+AHEAD = 2;    % Pages to read ahead in the scroll direction
+
+idx = reshape(idx,1,[]);
+N = obj.size_(2);
+key = [obj.diskfile_ '/' obj.name_];
+
+p = floor((idx-1)/PAGE); % 0-based page of each sample
+[u,~,k] = unique(p);
+[pages,ahead] = PageCache_core('lookup',key,u,ceil(N/PAGE),AHEAD);
+
+% Read missing pages (and read-ahead pages) in runs of adjacent pages
+iMiss = find(cellfun(@isempty,pages));
+toRead = sort([u(iMiss), ahead]);
+if ~isempty(toRead)
+   runStart = toRead([true, diff(toRead) > 1]);
+   runStop = toRead([diff(toRead) > 1, true]);
+   for i = 1:numel(runStart)
+      s0 = runStart(i)*PAGE; % Samples preceding this run
+      s1 = min((runStop(i)+1)*PAGE,N);
+      if isCoded(obj)
+         x = getCodedStreamsFromIndexing(obj,(s0+1):s1);
+      else
+         x = h5read(obj.diskfile_,['/' obj.name_],[1 (s0+1)],[1 (s1-s0)]);
+      end
+      x = reshape(x,1,[]);
+      for pg = runStart(i):runStop(i)
+         y = x(((pg*PAGE)-s0+1):(min((pg+1)*PAGE,N)-s0));
+         PageCache_core('put',key,pg,y);
+         iPg = find(u == pg,1);
+         if ~isempty(iPg)
+            pages{iPg} = y;
+         end
+      end
+   end
+end
+
+% Assemble requested samples from the (concatenated) pages
+len = cellfun(@numel,pages);
+offset = [0, cumsum(len(1:(end-1)))];
+buf = [pages{:}];
+k = reshape(k,1,[]);
+data = double(buf(offset(k) + idx - u(k)*PAGE));
+
+end
+
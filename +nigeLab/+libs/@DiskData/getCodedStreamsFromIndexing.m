@@ -0,0 +1,51 @@
+function data = getCodedStreamsFromIndexing(obj,idx)
+%GETCODEDSTREAMSFROMINDEXING  Return 'lpc'-coded stream data by indexing
+%
+%  data = getCodedStreamsFromIndexing(obj,idx);
+%
+%  obj : nigeLab.libs.DiskData object with .codec_ == 'lpc'
+%  idx : Indexing vector (numeric)
+%
+%  data : Decoded samples, in the class stored on disk (obj.class_)
+%
+%  Only the coded blocks (obj.chunks_(end) samples each) that contain
+%  `idx` are read from diskfile_ and decoded, so short windows of long
+%  recordings stay cheap to read.
+
+idx = reshape(idx,1,[]);
+data = zeros(1,numel(idx),obj.class_);
+if isempty(idx)
+   return;
+end
+if exist('StreamCodec_core','file')~=3
+   error(['nigeLab:' mfilename ':MissingKernel'],...
+      ['[DISKDATA]: ''lpc''-coded file requires StreamCodec_core ' ...
+      '(run nigeLab.utils.compileNativeKernels)']);
+end
+
+B = obj.chunks_(end);
+blk = unique(ceil(idx/B));
+starts = blk([true, diff(blk) > 1]); % Runs of consecutive blocks
+stops = blk([diff(blk) > 1, true]);
+varname_ = ['/' obj.name_];
+for i = 1:numel(starts)
+   index = h5read(obj.diskfile_,[varname_ '_index'],...
+      [1 starts(i)],[2 (stops(i)-starts(i)+1)]);
+   % Blocks re-coded by later writes are appended to the end of the file,
+   % so only read byte-contiguous groups of blocks in one go
+   brk = [true, index(1,2:end) ~= (index(1,1:(end-1)) + index(2,1:(end-1)))];
+   grp = cumsum(brk);
+   for g = 1:grp(end)
+      iBlk = find(grp == g);
+      offset = index(1,iBlk(1));
+      payload = h5read(obj.diskfile_,varname_,...
+         [1 (offset+1)],[1 sum(index(2,iBlk))]);
+      x = StreamCodec_core('decode',payload,...
+         [index(1,iBlk) - offset; index(2,iBlk)]);
+      s0 = (starts(i) + iBlk(1) - 2) * B; % Samples preceding this group
+      inGroup = (idx > s0) & (idx <= (s0 + numel(x)));
+      data(inGroup) = x(idx(inGroup) - s0);
+   end
+end
+
+end
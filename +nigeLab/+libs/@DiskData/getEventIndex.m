@@ -0,0 +1,72 @@
+function index = getEventIndex(obj,propName)
+%GETEVENTINDEX  Return (building if needed) in-memory index of 'Event' file
+%
+%  index = getEventIndex(obj,'ts');
+%  --> Sparse time index: ts of every index.stride-th event
+%
+%  index = getEventIndex(obj,'value');
+%  --> Posting lists: rows of each unique value (e.g. cluster label)
+%
+%  obj : nigeLab.libs.DiskData object with .type_ == 'Event'
+%  propName : 'ts' or 'value'
+%
+%  index : Struct with fields
+%           .N       - Number of events indexed
+%           .stride  - Rows between entries of .tSparse
+%           .sorted  - True if ts is non-decreasing
+%           .tSparse - ts(1:stride:N) (and ts(N))
+%           .labels  - Unique values (ascending)
+%           .offsets - Rows of .labels(k) are .rows(offsets(k)+1:offsets(k+1))
+%           .rows    - Posting lists, concatenated
+%
+%  The index is cached on obj (.index_) and only rebuilt when it is
+%  missing or the number of events changed; any write through DiskData
+%  clears it.
+
+STRIDE = 256; % Events per entry of the sparse time index
+
+propName = lower(propName);
+N = obj.size_(1);
+if isstruct(obj.index_) && isfield(obj.index_,propName)
+   index = obj.index_.(propName);
+   if index.N == N
+      return;
+   end
+end
+
+switch propName
+   case 'ts'
+      ts = getEventsFromIndexing(obj,1:N,4);
+      lab = [];
+   case 'value'
+      ts = [];
+      lab = getEventsFromIndexing(obj,1:N,2);
+   otherwise
+      error(['nigeLab:' mfilename ':BadProp'],...
+         '[DISKDATA]: No index for property: ''%s''',propName);
+end
+
+if exist('EventIndex_core','file')==3
+   index = EventIndex_core('build',double(ts),double(lab),STRIDE);
+else % MATLAB version: same fields as EventIndex_core('build',...)
+   index = struct('N',N,'stride',STRIDE,'sorted',true,...
+      'tSparse',zeros(0,1),'labels',zeros(0,1),'offsets',0,...
+      'rows',zeros(0,1));
+   if ~isempty(ts)
+      index.sorted = all(diff(ts) >= 0);
+      iSparse = unique([1:STRIDE:N, N]);
+      index.tSparse = reshape(ts(iSparse),[],1);
+   end
+   if ~isempty(lab)
+      [index.labels,~,k] = unique(lab(:));
+      [~,index.rows] = sort(k); % Stable, so each list stays ascending
+      index.offsets = [0; cumsum(accumarray(k,1))];
+   end
+end
+
+if ~isstruct(obj.index_)
+   obj.index_ = struct;
+end
+obj.index_.(propName) = index;
+
+end
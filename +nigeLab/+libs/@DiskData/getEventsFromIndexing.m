@@ -9,6 +9,12 @@ function data = getEventsFromIndexing(obj,iRow,iCol)
 %
 %  data : Requested data from indexing arguments iRow and iCol
 %  --> Typically called from subsref
+%
+%  Only the runs of requested rows are read from diskfile_, so that
+%  queries for a time window or a cluster subset (see findEventRows) do
+%  not load every event on the channel.
+
+MAX_SLABS = 64; % Max. number of separate hyperslab reads before bounding
 
 data = [];
 if isempty(iRow) % If no rows requested, then return empty double
@@ -52,16 +58,37 @@ end
     stride = diff(clustIdx(:));
     ColBlocks = [iCol(clustIdx(:)) [stride;numel(iCol)-sum(stride)]];
     
-    % First step: return full dataset using iCol
-    varname_ = ['/' obj.name_];
-    data = nan(obj.size_(1),sum(ColBlocks(:,2)));
-    st = 0;
-    for i = 1:size(ColBlocks,1)
-        data(:,st+1:st+ColBlocks(i,2))=h5read(obj.diskfile_,varname_,[1 ColBlocks(i,1)],[N ColBlocks(i,2)]);
-        st = st + ColBlocks(i,2);
+    % same for (unique, sorted) iRow, so that only requested rows are read
+    [uRow,~,iOut] = unique(iRow(:));
+    clustIdx = find([1;diff(uRow)-1]);
+    stride = diff(clustIdx(:));
+    RowBlocks = [uRow(clustIdx(:)) [stride;numel(uRow)-sum(stride)]];
+    
+    % If the rows are scattered, one hyperslab spanning all of them is
+    % cheaper than many small reads
+    if (size(RowBlocks,1) * size(ColBlocks,1)) > MAX_SLABS
+       RowBlocks = [uRow(1), uRow(end)-uRow(1)+1];
+       iOut = uRow(iOut) - uRow(1) + 1;
     end
 
-% Second step: return reduced subset using iRow
-data = data(iRow,:);
+% First step: return dataset using iCol and iRow blocks (after any queued
+% writes to the file)
+varname_ = ['/' obj.name_];
+nigeLab.libs.DiskWriter.barrier(obj.diskfile_);
+data = nan(sum(RowBlocks(:,2)),sum(ColBlocks(:,2)));
+stCol = 0;
+for ii = 1:size(ColBlocks,1)
+    stRow = 0;
+    for jj = 1:size(RowBlocks,1)
+        data(stRow+1:stRow+RowBlocks(jj,2),stCol+1:stCol+ColBlocks(ii,2)) = ...
+            h5read(obj.diskfile_,varname_,...
+            [RowBlocks(jj,1) ColBlocks(ii,1)],[RowBlocks(jj,2) ColBlocks(ii,2)]);
+        stRow = stRow + RowBlocks(jj,2);
+    end
+    stCol = stCol + ColBlocks(ii,2);
+end
+
+% Second step: return rows in the requested order (and with repeats)
+data = data(iOut,:);
 
 end
@@ -0,0 +1,31 @@
+function P = getMinMaxPyramid(obj)
+%GETMINMAXPYRAMID  Return (building if needed) min/max pyramid of stream
+%
+%  P = getMinMaxPyramid(obj);
+%
+%  obj : nigeLab.libs.DiskData object with .type_ 'Hybrid' or 'MatFile'
+%
+%  P : nigeLab.utils.MinMaxPyramid of the stream (.Source is obj; x is the
+%      sample index until .X0 and .DX are set). reduce(P,width,lims)
+%      returns the plot of any span of the stream on width pixels from
+%      a few times width values, instead of reading every sample.
+%
+%  The pyramid is built in one chunked pass over the stream, cached on
+%  obj (.pyramid_) and only rebuilt when it is missing or the length
+%  changed; any write through DiskData clears it.
+
+if strcmp(obj.type_,'Event')
+   error(['nigeLab:' mfilename ':BadType'],...
+      '[DISKDATA]: No min/max pyramid for ''Event'' type DiskData');
+end
+
+N = obj.size_(2);
+if isa(obj.pyramid_,'nigeLab.utils.MinMaxPyramid') && (obj.pyramid_.N == N)
+   P = obj.pyramid_;
+   return;
+end
+
+P = nigeLab.utils.MinMaxPyramid(obj);
+obj.pyramid_ = P;
+
+end
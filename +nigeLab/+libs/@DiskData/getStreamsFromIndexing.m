@@ -8,6 +8,8 @@ function data = getStreamsFromIndexing(obj,idx)
 %
 %  data : Data read from diskfile
 
+CACHE_MAX_SAMPLES = 2^21; % Larger reads (whole channels) bypass the cache
+
 data = [];
 if nargin < 2
    idx = inf;
@@ -23,6 +25,21 @@ if isinf(idx)
    idx = 1:N;
 end
 
+% Make sure any queued (write-behind) writes are on disk first
+nigeLab.libs.DiskWriter.barrier(obj.diskfile_);
+
+% Windowed reads (e.g. scrolling) go through the shared page cache
+if (numel(idx) <= CACHE_MAX_SAMPLES) && (exist('PageCache_core','file')==3)
+   data = getCachedStreamsFromIndexing(obj,idx);
+   return;
+end
+
+% Native codec: only the coded blocks containing idx are read and decoded
+if isCoded(obj)
+   data = double(getCodedStreamsFromIndexing(obj,idx));
+   return;
+end
+
 % First step: make a list of "chunks" to read
 starts = idx([true, diff(idx) > 1]); % All "starts" of included indices
 stops = idx([diff(idx) > 1, true]);  % All "stops" of runs of consecutive
@@ -0,0 +1,278 @@
+/*=================================================================
+ *
+ * EventIndex_core.CPP	.MEX file for 'Event' DiskData row queries
+ *
+ * The calling syntax is:
+ *
+ *		index = EventIndex_core('build', ts, labels, stride)
+ *		[r0, r1] = EventIndex_core('range', index, tLim)
+ *		rows = EventIndex_core('refine', tsWindow, r0, tLim)
+ *		rows = EventIndex_core('cluster', index, values)
+ *
+ *      ts:         N x 1 double event times (column 4 of 'Event' files)
+ *                  or [] if no time index is needed
+ *      labels:     N x 1 double cluster labels (column 2, 'value') or []
+ *      stride:     rows between entries of the sparse time index
+ *      index:      struct returned by 'build':
+ *                    .N        - number of events indexed
+ *                    .stride   - sparse time index stride
+ *                    .sorted   - true if ts is non-decreasing
+ *                    .tSparse  - ts(1:stride:N) (plus ts(N) last)
+ *                    .labels   - unique cluster labels (ascending)
+ *                    .offsets  - posting-list offsets (numel(labels)+1)
+ *                    .rows     - rows of each label, concatenated
+ *      tLim:       [t0 t1]; events with t0 <= ts < t1 match
+ *      r0, r1:     1-based row window guaranteed to hold every match
+ *      tsWindow:   ts(r0:r1), read from disk by the caller
+ *      values:     cluster labels to select
+ *      rows:       1-based ascending rows of matching events
+ *
+ * The sparse time index brackets a time range with two binary searches
+ * so that only the ts rows inside the bracket need to be read to refine
+ * it. Posting lists are built with one counting pass; selecting several
+ * clusters merges their (already sorted) lists.
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+#include "mex.h"
+
+/* Input Arguments */
+
+#define	MODE	prhs[0]
+
+/* Index fields */
+
+static const char *INDEX_FIELDS[] = {"N", "stride", "sorted", "tSparse",
+                                     "labels", "offsets", "rows"};
+static const int N_INDEX_FIELDS = 7;
+
+static const double *fieldPr(const mxArray *s, const char *name, size_t *n)
+{
+    const mxArray *f = mxGetField(s, 0, name);
+    if (f == NULL || !mxIsDouble(f))
+        mexErrMsgIdAndTxt("nigeLab:EventIndex:BadIndex",
+            "Index is missing field '%s'.", name);
+    if (n != NULL) *n = mxGetNumberOfElements(f);
+    return mxGetPr(f);
+}
+
+static mxArray *columnFrom(const std::vector<double> &v)
+{
+    mxArray *a = mxCreateDoubleMatrix(v.size(), 1, mxREAL);
+    if (!v.empty()) memcpy(mxGetPr(a), v.data(), v.size() * sizeof(double));
+    return a;
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* Build */
+///////////////////////////////////////////////////////////////////////////
+
+static void doBuild(mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    if (nrhs != 4)
+        mexErrMsgIdAndTxt("nigeLab:EventIndex:BadInput",
+            "Build requires ('build', ts, labels, stride).");
+    const mxArray *TS = prhs[1], *LAB = prhs[2];
+    if ((!mxIsEmpty(TS) && !mxIsDouble(TS)) || (!mxIsEmpty(LAB) && !mxIsDouble(LAB)))
+        mexErrMsgIdAndTxt("nigeLab:EventIndex:BadClass",
+            "ts and labels must be double.");
+
+    size_t nTs  = mxGetNumberOfElements(TS);
+    size_t nLab = mxGetNumberOfElements(LAB);
+    size_t N    = nTs > nLab ? nTs : nLab;
+    size_t stride = (size_t)mxGetScalar(prhs[3]);
+    if (stride < 1) stride = 1;
+
+    /* Sparse time index */
+    std::vector<double> tSparse;
+    bool sorted = true;
+    if (nTs > 0)
+    {
+        const double *ts = mxGetPr(TS);
+        for (size_t i = 1; i < nTs && sorted; i++)
+            sorted = !(ts[i] < ts[i-1]);
+        tSparse.reserve(nTs / stride + 2);
+        for (size_t i = 0; i < nTs; i += stride) tSparse.push_back(ts[i]);
+        if ((nTs - 1) % stride != 0) tSparse.push_back(ts[nTs-1]);
+    }
+
+    /* Posting lists (counting sort on the label rank) */
+    std::vector<double> labels, offsets(1, 0.0), rows;
+    if (nLab > 0)
+    {
+        const double *lab = mxGetPr(LAB);
+        labels.assign(lab, lab + nLab);
+        std::sort(labels.begin(), labels.end());
+        labels.erase(std::unique(labels.begin(), labels.end()), labels.end());
+
+        std::vector<size_t> rank(nLab), count(labels.size() + 1, 0);
+        for (size_t i = 0; i < nLab; i++)
+        {
+            rank[i] = std::lower_bound(labels.begin(), labels.end(), lab[i]) - labels.begin();
+            count[rank[i] + 1]++;
+        }
+        for (size_t k = 1; k < count.size(); k++) count[k] += count[k-1];
+        offsets.assign(count.begin(), count.end());
+        rows.resize(nLab);
+        std::vector<size_t> next(count.begin(), count.end() - 1);
+        for (size_t i = 0; i < nLab; i++) rows[next[rank[i]]++] = (double)(i + 1);
+    }
+
+    plhs[0] = mxCreateStructMatrix(1, 1, N_INDEX_FIELDS, INDEX_FIELDS);
+    mxSetField(plhs[0], 0, "N", mxCreateDoubleScalar((double)N));
+    mxSetField(plhs[0], 0, "stride", mxCreateDoubleScalar((double)stride));
+    mxSetField(plhs[0], 0, "sorted", mxCreateLogicalScalar(sorted));
+    mxSetField(plhs[0], 0, "tSparse", columnFrom(tSparse));
+    mxSetField(plhs[0], 0, "labels", columnFrom(labels));
+    mxSetField(plhs[0], 0, "offsets", columnFrom(offsets));
+    mxSetField(plhs[0], 0, "rows", columnFrom(rows));
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* Time-range queries */
+///////////////////////////////////////////////////////////////////////////
+
+static void doRange(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    if (nrhs != 3 || !mxIsStruct(prhs[1]) || mxGetNumberOfElements(prhs[2]) != 2)
+        mexErrMsgIdAndTxt("nigeLab:EventIndex:BadInput",
+            "Range requires ('range', index, [t0 t1]).");
+    const mxArray *mSorted = mxGetField(prhs[1], 0, "sorted");
+    if (mSorted == NULL || !mxGetScalar(mSorted))
+        mexErrMsgIdAndTxt("nigeLab:EventIndex:Unsorted",
+            "Time index requires non-decreasing ts.");
+
+    size_t nS;
+    const double *tS = fieldPr(prhs[1], "tSparse", &nS);
+    size_t N      = (size_t)*fieldPr(prhs[1], "N", NULL);
+    size_t stride = (size_t)*fieldPr(prhs[1], "stride", NULL);
+    const double *tLim = mxGetPr(prhs[2]);
+
+    /* First sparse entry >= t0; the block before it may hold matches */
+    size_t a = std::lower_bound(tS, tS + nS, tLim[0]) - tS;
+    /* First sparse entry >= t1; nothing at or after it can match */
+    size_t b = std::lower_bound(tS, tS + nS, tLim[1]) - tS;
+
+    double r0, r1;
+    if (nS == 0 || b == 0 || !(tLim[0] < tLim[1]))
+    {
+        r0 = 1; r1 = 0;  /* Empty window */
+    }
+    else
+    {
+        size_t lo = (a == 0) ? 0 : (a - 1) * stride;
+        size_t hi = b * stride;        /* Exclusive (0-based) */
+        if (hi > N) hi = N;
+        r0 = (double)(lo + 1);
+        r1 = (double)hi;
+    }
+    plhs[0] = mxCreateDoubleScalar(r0);
+    if (nlhs > 1) plhs[1] = mxCreateDoubleScalar(r1);
+}
+
+static void doRefine(mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    if (nrhs != 4 || !mxIsDouble(prhs[1]) || mxGetNumberOfElements(prhs[3]) != 2)
+        mexErrMsgIdAndTxt("nigeLab:EventIndex:BadInput",
+            "Refine requires ('refine', tsWindow, r0, [t0 t1]).");
+    size_t n = mxGetNumberOfElements(prhs[1]);
+    const double *ts = mxGetPr(prhs[1]);
+    double r0 = mxGetScalar(prhs[2]);
+    const double *tLim = mxGetPr(prhs[3]);
+
+    size_t a = std::lower_bound(ts, ts + n, tLim[0]) - ts;
+    size_t b = std::lower_bound(ts, ts + n, tLim[1]) - ts;
+    if (b < a) b = a;
+
+    plhs[0] = mxCreateDoubleMatrix(b - a, 1, mxREAL);
+    double *rows = mxGetPr(plhs[0]);
+    for (size_t i = a; i < b; i++) rows[i - a] = r0 + (double)i;
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* Cluster queries */
+///////////////////////////////////////////////////////////////////////////
+
+static void doCluster(mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    if (nrhs != 3 || !mxIsStruct(prhs[1]) || !mxIsDouble(prhs[2]))
+        mexErrMsgIdAndTxt("nigeLab:EventIndex:BadInput",
+            "Cluster requires ('cluster', index, values).");
+    size_t nL, nV = mxGetNumberOfElements(prhs[2]);
+    const double *labels  = fieldPr(prhs[1], "labels", &nL);
+    const double *offsets = fieldPr(prhs[1], "offsets", NULL);
+    const double *rows    = fieldPr(prhs[1], "rows", NULL);
+    const double *values  = mxGetPr(prhs[2]);
+
+    /* Gather the selected posting lists (each is ascending) */
+    std::vector<size_t> sel;
+    for (size_t v = 0; v < nV; v++)
+    {
+        const double *p = std::lower_bound(labels, labels + nL, values[v]);
+        if (p != labels + nL && *p == values[v]) sel.push_back(p - labels);
+    }
+    std::sort(sel.begin(), sel.end());
+    sel.erase(std::unique(sel.begin(), sel.end()), sel.end());
+
+    size_t nOut = 0;
+    for (size_t k = 0; k < sel.size(); k++)
+        nOut += (size_t)(offsets[sel[k]+1] - offsets[sel[k]]);
+
+    plhs[0] = mxCreateDoubleMatrix(nOut, 1, mxREAL);
+    double *out = mxGetPr(plhs[0]);
+    if (sel.size() == 1)
+    {
+        memcpy(out, rows + (size_t)offsets[sel[0]], nOut * sizeof(double));
+        return;
+    }
+
+    /* Merge the sorted lists pairwise into one ascending list */
+    std::vector<double> buf;
+    buf.reserve(nOut);
+    size_t nCur = 0;
+    for (size_t k = 0; k < sel.size(); k++)
+    {
+        const double *b0 = rows + (size_t)offsets[sel[k]];
+        const double *b1 = rows + (size_t)offsets[sel[k]+1];
+        buf.resize(nCur + (b1 - b0));
+        std::merge(out, out + nCur, b0, b1, buf.begin());
+        nCur = buf.size();
+        std::copy(buf.begin(), buf.end(), out);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+void mexFunction( int nlhs, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    if (nrhs < 1 || !mxIsChar(MODE))
+        mexErrMsgIdAndTxt("nigeLab:EventIndex:BadInput",
+            "First input must be 'build', 'range', 'refine' or 'cluster'.");
+
+    char *mode = mxArrayToString(MODE);
+    int m = !strcmp(mode, "build")  ? 1 :
+            !strcmp(mode, "range")  ? 2 :
+            !strcmp(mode, "refine") ? 3 :
+            !strcmp(mode, "cluster") ? 4 : 0;
+    mxFree(mode);
+
+    switch (m)
+    {
+        case 1:  doBuild(plhs, nrhs, prhs);       break;
+        case 2:  doRange(nlhs, plhs, nrhs, prhs); break;
+        case 3:  doRefine(plhs, nrhs, prhs);      break;
+        case 4:  doCluster(plhs, nrhs, prhs);     break;
+        default:
+            mexErrMsgIdAndTxt("nigeLab:EventIndex:BadMode",
+                "Unknown mode (must be 'build', 'range', 'refine' or 'cluster').");
+    }
+}
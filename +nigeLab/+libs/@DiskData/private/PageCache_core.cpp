@@ -0,0 +1,270 @@
+/*=================================================================
+ *
+ * PAGECACHE_CORE.CPP	.MEX file for process-wide DiskData page cache
+ *
+ * The calling syntax is:
+ *
+ *		[pages, ahead] = PageCache_core('lookup', key, pageList, nPages, nAhead)
+ *		PageCache_core('put', key, page, data)
+ *		PageCache_core('invalidate', key)
+ *		prev = PageCache_core('budget', bytes)
+ *		stats = PageCache_core('stats')
+ *		PageCache_core('clear')
+ *
+ *      key:        char, identifies one stream (diskfile_ and dataset)
+ *      pageList:   0-based page numbers needed by the current read
+ *      nPages:     number of pages in the stream (limits read-ahead)
+ *      nAhead:     max. number of pages to suggest for read-ahead
+ *      pages:      1 x numel(pageList) cell; cached page data, or [] on
+ *                  a miss
+ *      ahead:      0-based page numbers (not cached) that follow the
+ *                  request in the direction the stream is being scrolled
+ *      page, data: 0-based page number and its samples (any numeric
+ *                  class; returned as stored)
+ *      bytes:      memory budget of the cache (default: 256 MB)
+ *      stats:      struct with fields hits, misses, evictions, pages,
+ *                  bytes, budget
+ *
+ * Pages of every stream share one least-recently-used list, so the
+ * budget covers all channels that are open. Evicted pages are simply
+ * dropped (the cache never holds unwritten data).
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "mex.h"
+
+/* Input Arguments */
+
+#define	MODE	prhs[0]
+#define	KEY	prhs[1]
+
+/* Cache state (persists between calls while the MEX file is loaded) */
+
+struct Page {
+    std::string key;
+    int64_t page;
+    mxClassID cls;
+    size_t n;
+    std::vector<char> bytes;
+};
+typedef std::list<Page>::iterator PageIter;
+
+static std::list<Page> g_lru;                            /* Front = most recent */
+static std::unordered_map<std::string, PageIter> g_index; /* key#page -> page */
+static std::map<std::string, int64_t> g_last;            /* key -> first page of last lookup */
+static size_t   g_budget = (size_t)256 << 20;
+static size_t   g_used = 0;
+static uint64_t g_hits = 0, g_misses = 0, g_evictions = 0;
+
+static std::string pageId(const std::string &key, int64_t page)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "#%lld", (long long)page);
+    return key + buf;
+}
+
+static std::string getKey(int nrhs, const mxArray *prhs[])
+{
+    if (nrhs < 2 || !mxIsChar(KEY))
+        mexErrMsgIdAndTxt("nigeLab:PageCache:BadKey", "Key must be char.");
+    char *c = mxArrayToString(KEY);
+    std::string key(c);
+    mxFree(c);
+    return key;
+}
+
+static void erasePage(PageIter it)
+{
+    g_used -= it->bytes.size();
+    g_index.erase(pageId(it->key, it->page));
+    g_lru.erase(it);
+}
+
+static void evictToBudget()
+{
+    while (g_used > g_budget && !g_lru.empty())
+    {
+        erasePage(--g_lru.end());
+        g_evictions++;
+    }
+}
+
+static void clearAll(void)
+{
+    g_lru.clear();
+    g_index.clear();
+    g_last.clear();
+    g_used = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* Commands */
+///////////////////////////////////////////////////////////////////////////
+
+static void doLookup(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    if (nrhs != 5 || !mxIsDouble(prhs[2]))
+        mexErrMsgIdAndTxt("nigeLab:PageCache:BadInput",
+            "Lookup requires ('lookup', key, pageList, nPages, nAhead).");
+    std::string key = getKey(nrhs, prhs);
+    size_t nReq = mxGetNumberOfElements(prhs[2]);
+    const double *req = mxGetPr(prhs[2]);
+    int64_t nPages = (int64_t)mxGetScalar(prhs[3]);
+    int64_t nAhead = (int64_t)mxGetScalar(prhs[4]);
+
+    plhs[0] = mxCreateCellMatrix(1, nReq);
+    int64_t lo = nReq ? (int64_t)req[0] : 0, hi = lo;
+    for (size_t i = 0; i < nReq; i++)
+    {
+        int64_t p = (int64_t)req[i];
+        if (p < lo) lo = p;
+        if (p > hi) hi = p;
+        std::unordered_map<std::string, PageIter>::iterator f = g_index.find(pageId(key, p));
+        if (f == g_index.end())
+        {
+            g_misses++;
+            continue;
+        }
+        g_hits++;
+        PageIter it = f->second;
+        g_lru.splice(g_lru.begin(), g_lru, it); /* Mark most recent */
+        mxArray *a = mxCreateNumericMatrix(1, it->n, it->cls, mxREAL);
+        if (!it->bytes.empty()) memcpy(mxGetData(a), it->bytes.data(), it->bytes.size());
+        mxSetCell(plhs[0], i, a);
+    }
+
+    /* Read-ahead in the direction of travel since the last lookup */
+    std::vector<double> ahead;
+    if (nReq > 0)
+    {
+        std::map<std::string, int64_t>::iterator last = g_last.find(key);
+        int dir = 0;
+        if (last != g_last.end())
+            dir = (lo > last->second) ? 1 : ((lo < last->second) ? -1 : 0);
+        g_last[key] = lo;
+        for (int64_t k = 1; dir != 0 && k <= nAhead; k++)
+        {
+            int64_t p = (dir > 0) ? hi + k : lo - k;
+            if (p < 0 || p >= nPages) break;
+            if (g_index.find(pageId(key, p)) == g_index.end())
+                ahead.push_back((double)p);
+        }
+    }
+    if (nlhs > 1)
+    {
+        plhs[1] = mxCreateDoubleMatrix(1, ahead.size(), mxREAL);
+        if (!ahead.empty())
+            memcpy(mxGetPr(plhs[1]), ahead.data(), ahead.size() * sizeof(double));
+    }
+}
+
+static void doPut(int nrhs, const mxArray *prhs[])
+{
+    if (nrhs != 4 || !mxIsNumeric(prhs[3]) || mxIsComplex(prhs[3]))
+        mexErrMsgIdAndTxt("nigeLab:PageCache:BadInput",
+            "Put requires ('put', key, page, data) with real numeric data.");
+    std::string key = getKey(nrhs, prhs);
+    int64_t page = (int64_t)mxGetScalar(prhs[2]);
+    const mxArray *D = prhs[3];
+    size_t n = mxGetNumberOfElements(D);
+    size_t nBytes = n * mxGetElementSize(D);
+    if (nBytes > g_budget) return; /* Would evict everything; do not cache */
+
+    std::string id = pageId(key, page);
+    std::unordered_map<std::string, PageIter>::iterator f = g_index.find(id);
+    if (f != g_index.end()) erasePage(f->second);
+
+    Page pg;
+    pg.key = key;
+    pg.page = page;
+    pg.cls = mxGetClassID(D);
+    pg.n = n;
+    pg.bytes.resize(nBytes);
+    if (nBytes > 0) memcpy(pg.bytes.data(), mxGetData(D), nBytes);
+    g_lru.push_front(pg);
+    g_index[id] = g_lru.begin();
+    g_used += nBytes;
+    evictToBudget();
+}
+
+static void doInvalidate(int nrhs, const mxArray *prhs[])
+{
+    std::string key = getKey(nrhs, prhs);
+    for (PageIter it = g_lru.begin(); it != g_lru.end(); )
+    {
+        PageIter cur = it++;
+        if (cur->key == key) erasePage(cur);
+    }
+    g_last.erase(key);
+}
+
+static void doStats(mxArray *plhs[])
+{
+    static const char *fields[] = {"hits", "misses", "evictions",
+                                   "pages", "bytes", "budget"};
+    plhs[0] = mxCreateStructMatrix(1, 1, 6, fields);
+    mxSetField(plhs[0], 0, "hits", mxCreateDoubleScalar((double)g_hits));
+    mxSetField(plhs[0], 0, "misses", mxCreateDoubleScalar((double)g_misses));
+    mxSetField(plhs[0], 0, "evictions", mxCreateDoubleScalar((double)g_evictions));
+    mxSetField(plhs[0], 0, "pages", mxCreateDoubleScalar((double)g_lru.size()));
+    mxSetField(plhs[0], 0, "bytes", mxCreateDoubleScalar((double)g_used));
+    mxSetField(plhs[0], 0, "budget", mxCreateDoubleScalar((double)g_budget));
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+void mexFunction( int nlhs, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    static bool registered = false;
+    if (!registered)
+    {
+        mexAtExit(clearAll);
+        registered = true;
+    }
+
+    if (nrhs < 1 || !mxIsChar(MODE))
+        mexErrMsgIdAndTxt("nigeLab:PageCache:BadInput",
+            "First input must be a command (char).");
+    char *c = mxArrayToString(MODE);
+    std::string mode(c);
+    mxFree(c);
+
+    if (mode == "lookup")
+        doLookup(nlhs, plhs, nrhs, prhs);
+    else if (mode == "put")
+        doPut(nrhs, prhs);
+    else if (mode == "invalidate")
+        doInvalidate(nrhs, prhs);
+    else if (mode == "budget")
+    {
+        plhs[0] = mxCreateDoubleScalar((double)g_budget);
+        if (nrhs > 1)
+        {
+            double b = mxGetScalar(prhs[1]);
+            g_budget = (b > 0) ? (size_t)b : 0;
+            evictToBudget();
+        }
+    }
+    else if (mode == "stats")
+        doStats(plhs);
+    else if (mode == "clear")
+    {
+        clearAll();
+        g_hits = g_misses = g_evictions = 0;
+    }
+    else
+        mexErrMsgIdAndTxt("nigeLab:PageCache:BadMode",
+            "Unknown command: '%s'.", mode.c_str());
+}
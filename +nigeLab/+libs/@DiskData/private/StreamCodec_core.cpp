@@ -0,0 +1,594 @@
+/*=================================================================
+ *
+ * StreamCodec_core.CPP	.MEX file for lossless 'lpc' stream coding
+ *
+ * The calling syntax is:
+ *
+ *		[payload, index] = StreamCodec_core('encode', x, blockSize)
+ *		x                = StreamCodec_core('decode', payload, index)
+ *
+ *      x:          1 x N stream samples (int16, int32, single or double)
+ *      blockSize:  number of samples per independently-coded block
+ *      payload:    1 x nBytes uint8 coded byte stream
+ *      index:      2 x nBlocks double; row 1 is the (0-based) byte
+ *                  offset of each block within payload, row 2 is the
+ *                  number of bytes used by that block
+ *
+ * Each block is coded on its own, which gives random access at block
+ * granularity: to read samples k..m only the blocks that contain them
+ * need to be read from disk and decoded.
+ *
+ * Block layout:
+ *      byte  0     :  class code (1: int16, 2: int32, 3: single, 4: double)
+ *      byte  1     :  fixed polynomial predictor order (0 - 3)
+ *      byte  2     :  Rice parameter k
+ *      byte  3     :  escape width (bits of largest residual in block)
+ *      bytes 4 - 7 :  number of samples in block (uint32, little endian)
+ *      order x raw samples (warm-up, native width, little endian)
+ *      Rice-coded zig-zag residuals (MSB-first bit stream)
+ *
+ * Floating-point samples are mapped onto order-preserving integers
+ * before prediction, so the coding stays exactly lossless; all
+ * prediction arithmetic wraps modulo 2^64 and is therefore exactly
+ * invertible for every class. Blocks are encoded and decoded on a
+ * pool of worker threads.
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <math.h>
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+#include "mex.h"
+#include "nigel_threads.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+static inline int countLeadingZeros(uint64_t v)
+{
+    unsigned long i;
+    _BitScanReverse64(&i, v);
+    return 63 - (int)i;
+}
+#else
+static inline int countLeadingZeros(uint64_t v)
+{
+    return __builtin_clzll(v);
+}
+#endif
+
+/* Input Arguments */
+
+#define	MODE	prhs[0]
+#define	DATA	prhs[1]
+#define	BLOCK	prhs[2]
+#define	INDEX	prhs[2]
+
+/* Output Arguments */
+
+#define	PAYLOAD	plhs[0]
+#define	IDX_OUT	plhs[1]
+#define	X_OUT	plhs[0]
+
+/* Constants */
+
+static const int HEADER_BYTES = 8;
+static const int ESCAPE_Q = 24;     /* Unary quotients >= this are escaped */
+static const int MAX_ORDER = 3;
+
+enum CodecClass { C_INT16 = 1, C_INT32 = 2, C_SINGLE = 3, C_DOUBLE = 4 };
+
+static int classBytes(int cls)
+{
+    switch (cls)
+    {
+        case C_INT16:  return 2;
+        case C_INT32:  return 4;
+        case C_SINGLE: return 4;
+        default:       return 8;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* Sample <-> lane mapping (lanes are int64 held in uint64) */
+///////////////////////////////////////////////////////////////////////////
+
+static inline uint64_t toLane(const void *x, size_t i, int cls)
+{
+    switch (cls)
+    {
+        case C_INT16:
+            return (uint64_t)(int64_t)((const int16_t *)x)[i];
+        case C_INT32:
+            return (uint64_t)(int64_t)((const int32_t *)x)[i];
+        case C_SINGLE:
+        {
+            uint32_t b;
+            memcpy(&b, (const float *)x + i, 4);
+            b = (b & 0x80000000u) ? ~b : (b | 0x80000000u);
+            return (uint64_t)(int64_t)(int32_t)(b ^ 0x80000000u);
+        }
+        default:
+        {
+            uint64_t b;
+            memcpy(&b, (const double *)x + i, 8);
+            b = (b & 0x8000000000000000ull) ? ~b : (b | 0x8000000000000000ull);
+            return b ^ 0x8000000000000000ull;
+        }
+    }
+}
+
+static inline void fromLane(uint64_t v, void *x, size_t i, int cls)
+{
+    switch (cls)
+    {
+        case C_INT16:
+            ((int16_t *)x)[i] = (int16_t)(int64_t)v;
+            break;
+        case C_INT32:
+            ((int32_t *)x)[i] = (int32_t)(int64_t)v;
+            break;
+        case C_SINGLE:
+        {
+            uint32_t b = ((uint32_t)v) ^ 0x80000000u;
+            b = (b & 0x80000000u) ? (b & 0x7FFFFFFFu) : ~b;
+            memcpy((float *)x + i, &b, 4);
+            break;
+        }
+        default:
+        {
+            uint64_t b = v ^ 0x8000000000000000ull;
+            b = (b & 0x8000000000000000ull) ? (b & 0x7FFFFFFFFFFFFFFFull) : ~b;
+            memcpy((double *)x + i, &b, 8);
+            break;
+        }
+    }
+}
+
+/* Fixed polynomial prediction (wrapping arithmetic) */
+static inline uint64_t predict(const uint64_t *v, size_t n, int order)
+{
+    switch (order)
+    {
+        case 0:  return 0;
+        case 1:  return v[n-1];
+        case 2:  return 2*v[n-1] - v[n-2];
+        default: return 3*v[n-1] - 3*v[n-2] + v[n-3];
+    }
+}
+
+static inline uint64_t zigzag(uint64_t r)
+{
+    return (r << 1) ^ (uint64_t)((int64_t)r >> 63);
+}
+
+static inline uint64_t unzigzag(uint64_t u)
+{
+    return (u >> 1) ^ (0 - (u & 1));
+}
+
+static int bitWidth(uint64_t u)
+{
+    int w = 0;
+    while (u) { w++; u >>= 1; }
+    return w;
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* Bit I/O */
+///////////////////////////////////////////////////////////////////////////
+
+struct BitWriter
+{
+    std::vector<uint8_t> &out;
+    uint64_t acc;
+    int      nAcc;
+
+    BitWriter(std::vector<uint8_t> &o) : out(o), acc(0), nAcc(0) {}
+
+    /* Write the low nBits (<= 32) of val */
+    inline void put(uint64_t val, int nBits)
+    {
+        acc = (acc << nBits) | (val & ((1ull << nBits) - 1));
+        nAcc += nBits;
+        while (nAcc >= 8)
+        {
+            nAcc -= 8;
+            out.push_back((uint8_t)(acc >> nAcc));
+        }
+    }
+    inline void putWide(uint64_t val, int nBits)
+    {
+        if (nBits > 32)
+        {
+            put(val >> 32, nBits - 32);
+            put(val & 0xFFFFFFFFull, 32);
+        }
+        else if (nBits > 0)
+        {
+            put(val, nBits);
+        }
+    }
+    inline void flush()
+    {
+        if (nAcc > 0) put(0, 8 - nAcc);
+    }
+};
+
+struct BitReader
+{
+    const uint8_t *p, *end;
+    uint64_t cache;     /* MSB-aligned */
+    int      nCache;
+
+    BitReader(const uint8_t *b, const uint8_t *e) : p(b), end(e), cache(0), nCache(0) {}
+
+    inline void refill()
+    {
+        while (nCache <= 56)
+        {
+            uint64_t byte = (p < end) ? *p++ : 0;
+            cache |= byte << (56 - nCache);
+            nCache += 8;
+        }
+    }
+    inline uint64_t get(int nBits) /* nBits <= 32 */
+    {
+        if (nBits == 0) return 0;
+        refill();
+        uint64_t v = cache >> (64 - nBits);
+        cache <<= nBits;
+        nCache -= nBits;
+        return v;
+    }
+    inline uint64_t getWide(int nBits)
+    {
+        if (nBits > 32)
+        {
+            uint64_t hi = get(nBits - 32);
+            return (hi << 32) | get(32);
+        }
+        return get(nBits);
+    }
+    /* Count leading ones, up to ESCAPE_Q, consuming the terminating zero */
+    inline int unary()
+    {
+        refill();
+        int q = countLeadingZeros(~cache | 1);
+        if (q >= ESCAPE_Q)
+        {
+            cache <<= ESCAPE_Q;
+            nCache -= ESCAPE_Q;
+            return ESCAPE_Q;
+        }
+        cache <<= (q + 1);
+        nCache -= (q + 1);
+        return q;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////
+/* Block coding */
+///////////////////////////////////////////////////////////////////////////
+
+static double riceCost(const std::vector<uint64_t> &u, size_t first, int k, int eBits)
+{
+    double bits = 0.0;
+    for (size_t i = first; i < u.size(); i++)
+    {
+        uint64_t q = u[i] >> k;
+        bits += (q >= (uint64_t)ESCAPE_Q) ? (double)(ESCAPE_Q + eBits) : (double)(q + 1 + k);
+    }
+    return bits;
+}
+
+static void encodeBlock(const void *x, size_t i0, size_t n, int cls,
+                        std::vector<uint8_t> &out)
+{
+    std::vector<uint64_t> v(n), u(n);
+    for (size_t i = 0; i < n; i++) v[i] = toLane(x, i0 + i, cls);
+
+    /* Pick the predictor order with the smallest absolute residual sum */
+    double cost[MAX_ORDER+1] = {0.0, 0.0, 0.0, 0.0};
+    for (size_t i = MAX_ORDER; i < n; i++)
+    {
+        for (int o = 0; o <= MAX_ORDER; o++)
+        {
+            int64_t r = (int64_t)(v[i] - predict(v.data(), i, o));
+            cost[o] += fabs((double)r);
+        }
+    }
+    int order = 0;
+    for (int o = 1; o <= MAX_ORDER; o++)
+        if (cost[o] < cost[order]) order = o;
+    if ((size_t)order > n) order = (int)n;
+
+    /* Zig-zag residuals and escape width */
+    uint64_t uMax = 0;
+    double   uSum = 0.0;
+    for (size_t i = order; i < n; i++)
+    {
+        u[i] = zigzag(v[i] - predict(v.data(), i, order));
+        if (u[i] > uMax) uMax = u[i];
+        uSum += (double)u[i];
+    }
+    int eBits = bitWidth(uMax);
+
+    /* Rice parameter from the mean, refined on the exact cost */
+    size_t nRes = n - order;
+    int k = 0;
+    if (nRes > 0)
+    {
+        double mu = uSum / (double)nRes;
+        k = (mu > 1.0) ? std::min((int)floor(log2(mu)), 62) : 0;
+        double best = riceCost(u, order, k, eBits);
+        for (int dk = -1; dk <= 1; dk += 2)
+        {
+            int kk = k + dk;
+            if (kk < 0 || kk > 62) continue;
+            double c = riceCost(u, order, kk, eBits);
+            if (c < best) { best = c; k = kk; }
+        }
+    }
+
+    /* Header */
+    out.push_back((uint8_t)cls);
+    out.push_back((uint8_t)order);
+    out.push_back((uint8_t)k);
+    out.push_back((uint8_t)eBits);
+    for (int b = 0; b < 4; b++) out.push_back((uint8_t)(((uint32_t)n) >> (8*b)));
+
+    /* Warm-up samples stored raw */
+    int w = classBytes(cls);
+    for (int o = 0; o < order; o++)
+    {
+        const uint8_t *s = (const uint8_t *)x + (i0 + o) * w;
+        out.insert(out.end(), s, s + w);
+    }
+
+    /* Residuals */
+    BitWriter bw(out);
+    for (size_t i = order; i < n; i++)
+    {
+        uint64_t q = u[i] >> k;
+        if (q >= (uint64_t)ESCAPE_Q)
+        {
+            bw.put((1ull << ESCAPE_Q) - 1, ESCAPE_Q);
+            bw.putWide(u[i], eBits);
+            continue;
+        }
+        bw.put(((1ull << q) - 1) << 1, (int)q + 1);
+        bw.putWide(u[i] & ((k < 64) ? ((1ull << k) - 1) : ~0ull), k);
+    }
+    bw.flush();
+}
+
+static uint32_t blockSamples(const uint8_t *b)
+{
+    return (uint32_t)b[4] | ((uint32_t)b[5] << 8) |
+           ((uint32_t)b[6] << 16) | ((uint32_t)b[7] << 24);
+}
+
+/* Residual loop, specialised per class and order so that the inner
+ * loop carries no per-sample branching on either */
+template <int CLS, int ORDER>
+static void decodeResiduals(BitReader &br, int k, int eBits, size_t n,
+                            const uint64_t *hist, void *x, size_t i0)
+{
+    uint64_t v1 = ORDER > 0 ? hist[ORDER-1] : 0;
+    uint64_t v2 = ORDER > 1 ? hist[ORDER-2] : 0;
+    uint64_t v3 = ORDER > 2 ? hist[ORDER-3] : 0;
+    for (size_t i = ORDER; i < n; i++)
+    {
+        int q = br.unary();
+        uint64_t u = (q >= ESCAPE_Q) ? br.getWide(eBits)
+                                     : (((uint64_t)q << k) | br.getWide(k));
+        uint64_t pr = ORDER == 0 ? 0 :
+                      ORDER == 1 ? v1 :
+                      ORDER == 2 ? 2*v1 - v2 : 3*v1 - 3*v2 + v3;
+        uint64_t v = pr + unzigzag(u);
+        fromLane(v, x, i0 + i, CLS);
+        v3 = v2; v2 = v1; v1 = v;
+    }
+}
+
+template <int CLS>
+static void decodeResiduals(BitReader &br, int order, int k, int eBits,
+                            size_t n, const uint64_t *hist, void *x, size_t i0)
+{
+    switch (order)
+    {
+        case 0:  decodeResiduals<CLS,0>(br, k, eBits, n, hist, x, i0); break;
+        case 1:  decodeResiduals<CLS,1>(br, k, eBits, n, hist, x, i0); break;
+        case 2:  decodeResiduals<CLS,2>(br, k, eBits, n, hist, x, i0); break;
+        default: decodeResiduals<CLS,3>(br, k, eBits, n, hist, x, i0); break;
+    }
+}
+
+/* Checks the header fields of a block read from disk against its length:
+ * k and eBits are used as shift counts (k <= 62 is all the encoder
+ * writes; 63, the widest defined shift, is still read), and every
+ * residual takes at least min(k + 1, ESCAPE_Q + eBits) bits, so a
+ * corrupt or truncated block is rejected before it is decoded */
+static bool validBlock(const uint8_t *b, size_t nBytes)
+{
+    int cls = b[0], order = b[1], k = b[2], eBits = b[3];
+    if (cls < C_INT16 || cls > C_DOUBLE || order > MAX_ORDER || k > 63 || eBits > 64)
+        return false;
+    size_t n = blockSamples(b);
+    size_t nWarm = ((size_t)order < n) ? (size_t)order : n;
+    size_t head = (size_t)HEADER_BYTES + nWarm * (size_t)classBytes(cls);
+    if (head > nBytes)
+        return false;
+    size_t minBits = (size_t)std::min(k + 1, ESCAPE_Q + eBits);
+    return (n - nWarm) <= 8 * (nBytes - head) / minBits;
+}
+
+static void decodeBlock(const uint8_t *b, size_t nBytes, void *x, size_t i0)
+{
+    int      cls   = b[0];
+    int      order = b[1];
+    int      k     = b[2];
+    int      eBits = b[3];
+    size_t   n     = blockSamples(b);
+    int      w     = classBytes(cls);
+    const uint8_t *p = b + HEADER_BYTES;
+
+    uint64_t hist[MAX_ORDER] = {0, 0, 0};
+    if ((size_t)order > n) order = (int)n;
+    for (int o = 0; o < order; o++)
+    {
+        memcpy((uint8_t *)x + (i0 + o) * w, p, w);
+        p += w;
+        hist[o] = toLane(x, i0 + o, cls);
+    }
+
+    BitReader br(p, b + nBytes);
+    switch (cls)
+    {
+        case C_INT16:  decodeResiduals<C_INT16>(br, order, k, eBits, n, hist, x, i0);  break;
+        case C_INT32:  decodeResiduals<C_INT32>(br, order, k, eBits, n, hist, x, i0);  break;
+        case C_SINGLE: decodeResiduals<C_SINGLE>(br, order, k, eBits, n, hist, x, i0); break;
+        default:       decodeResiduals<C_DOUBLE>(br, order, k, eBits, n, hist, x, i0); break;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+static int mxToCodecClass(const mxArray *a)
+{
+    switch (mxGetClassID(a))
+    {
+        case mxINT16_CLASS:  return C_INT16;
+        case mxINT32_CLASS:  return C_INT32;
+        case mxSINGLE_CLASS: return C_SINGLE;
+        case mxDOUBLE_CLASS: return C_DOUBLE;
+        default:             return 0;
+    }
+}
+
+static mxClassID codecToMxClass(int cls)
+{
+    switch (cls)
+    {
+        case C_INT16:  return mxINT16_CLASS;
+        case C_INT32:  return mxINT32_CLASS;
+        case C_SINGLE: return mxSINGLE_CLASS;
+        default:       return mxDOUBLE_CLASS;
+    }
+}
+
+static void doEncode(mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    if (nrhs != 3)
+        mexErrMsgIdAndTxt("nigeLab:StreamCodec:BadInput",
+            "Encoding requires ('encode', x, blockSize).");
+    int cls = mxToCodecClass(DATA);
+    if (cls == 0 || mxIsComplex(DATA))
+        mexErrMsgIdAndTxt("nigeLab:StreamCodec:BadClass",
+            "Stream must be real int16, int32, single or double.");
+
+    size_t N = mxGetNumberOfElements(DATA);
+    size_t B = (size_t)mxGetScalar(BLOCK);
+    if (B < 1 || B > 0xFFFFFFFFu)
+        mexErrMsgIdAndTxt("nigeLab:StreamCodec:BadBlock",
+            "Block size must be a positive 32-bit integer.");
+
+    const void *x = mxGetData(DATA);
+    size_t nBlocks = (N + B - 1) / B;
+    std::vector< std::vector<uint8_t> > coded(nBlocks);
+
+    nigel::parallelFor(nBlocks, [&](size_t iB) {
+        size_t i0 = iB * B;
+        size_t n  = (i0 + B <= N) ? B : N - i0;
+        coded[iB].reserve(HEADER_BYTES + n * classBytes(cls));
+        encodeBlock(x, i0, n, cls, coded[iB]);
+    });
+
+    size_t nBytes = 0;
+    for (size_t iB = 0; iB < nBlocks; iB++) nBytes += coded[iB].size();
+
+    PAYLOAD = mxCreateNumericMatrix(1, nBytes, mxUINT8_CLASS, mxREAL);
+    IDX_OUT = mxCreateDoubleMatrix(2, nBlocks, mxREAL);
+    uint8_t *payload = (uint8_t *)mxGetData(PAYLOAD);
+    double  *index   = mxGetPr(IDX_OUT);
+    size_t off = 0;
+    for (size_t iB = 0; iB < nBlocks; iB++)
+    {
+        memcpy(payload + off, coded[iB].data(), coded[iB].size());
+        index[2*iB]   = (double)off;
+        index[2*iB+1] = (double)coded[iB].size();
+        off += coded[iB].size();
+    }
+}
+
+static void doDecode(mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    if (nrhs != 3)
+        mexErrMsgIdAndTxt("nigeLab:StreamCodec:BadInput",
+            "Decoding requires ('decode', payload, index).");
+    if (!mxIsUint8(DATA))
+        mexErrMsgIdAndTxt("nigeLab:StreamCodec:BadClass",
+            "Payload must be uint8.");
+    if (!mxIsDouble(INDEX) || mxGetM(INDEX) != 2)
+        mexErrMsgIdAndTxt("nigeLab:StreamCodec:BadIndex",
+            "Index must be a 2 x nBlocks double array.");
+
+    const uint8_t *payload = (const uint8_t *)mxGetData(DATA);
+    size_t nBytes  = mxGetNumberOfElements(DATA);
+    size_t nBlocks = mxGetN(INDEX);
+    const double *index = mxGetPr(INDEX);
+
+    /* First pass: validate headers and find each block's output offset */
+    std::vector<size_t> first(nBlocks + 1, 0);
+    int cls = 0;
+    for (size_t iB = 0; iB < nBlocks; iB++)
+    {
+        size_t off = (size_t)index[2*iB];
+        size_t len = (size_t)index[2*iB+1];
+        if (len < (size_t)HEADER_BYTES || off + len > nBytes)
+            mexErrMsgIdAndTxt("nigeLab:StreamCodec:Corrupt",
+                "Block %d lies outside of the payload.", (int)iB + 1);
+        const uint8_t *b = payload + off;
+        if (iB == 0) cls = b[0];
+        if (b[0] != cls || !validBlock(b, len))
+            mexErrMsgIdAndTxt("nigeLab:StreamCodec:Corrupt",
+                "Block %d has an invalid header or is truncated.", (int)iB + 1);
+        first[iB+1] = first[iB] + blockSamples(b);
+    }
+    if (cls == 0) cls = C_DOUBLE;
+
+    X_OUT = mxCreateNumericMatrix(1, first[nBlocks], codecToMxClass(cls), mxREAL);
+    void *x = mxGetData(X_OUT);
+
+    nigel::parallelFor(nBlocks, [&](size_t iB) {
+        size_t off = (size_t)index[2*iB];
+        size_t len = (size_t)index[2*iB+1];
+        decodeBlock(payload + off, len, x, first[iB]);
+    });
+}
+
+void mexFunction( int /* nlhs */, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    if (nrhs < 1 || !mxIsChar(MODE))
+        mexErrMsgIdAndTxt("nigeLab:StreamCodec:BadInput",
+            "First input must be 'encode' or 'decode'.");
+
+    char *mode = mxArrayToString(MODE);
+    bool isEncode = strcmp(mode, "encode") == 0;
+    bool isDecode = strcmp(mode, "decode") == 0;
+    mxFree(mode);
+
+    if (isEncode)
+        doEncode(plhs, nrhs, prhs);
+    else if (isDecode)
+        doDecode(plhs, nrhs, prhs);
+    else
+        mexErrMsgIdAndTxt("nigeLab:StreamCodec:BadMode",
+            "Unknown mode (must be 'encode' or 'decode').");
+}
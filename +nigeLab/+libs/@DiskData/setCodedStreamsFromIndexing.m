@@ -0,0 +1,123 @@
+function setCodedStreamsFromIndexing(obj,idx,data)
+%SETCODEDSTREAMSFROMINDEXING  Write 'lpc'-coded stream data by indexing
+%
+%  setCodedStreamsFromIndexing(obj,idx,data);
+%
+%  obj : nigeLab.libs.DiskData object with .codec_ == 'lpc'
+%  idx : Indexing vector (numeric); may extend past the current end
+%  data : Data to write to diskfile (same number of elements as idx)
+%
+%  Every coded block touched by `idx` is decoded, updated and re-coded.
+%  A re-coded block that fits in its old slot is written in place; one
+%  that does not is appended to the coded bytes and the block index is
+%  pointed at it, so an update never has to shift the rest of the file.
+%  The bytes left unused by either are counted in the 'CodecDead'
+%  attribute of /<name_>, and once they exceed DEAD_FRAC of the coded
+%  bytes the stream is compacted (see compactCodedStream; lockData also
+%  compacts). Samples between the old end of the stream and `idx` are
+%  zero-filled.
+
+DEAD_FRAC = 0.25;   % Compact once this fraction of coded bytes is dead
+DEAD_MIN = 2^20;    % ... and there are at least this many dead bytes
+
+if exist('StreamCodec_core','file')~=3
+   error(['nigeLab:' mfilename ':MissingKernel'],...
+      ['[DISKDATA]: ''lpc''-coded file requires StreamCodec_core ' ...
+      '(run nigeLab.utils.compileNativeKernels)']);
+end
+
+idx = reshape(idx,1,[]);
+data = cast(reshape(data,1,[]),obj.class_);
+if isempty(idx)
+   return;
+end
+
+N = obj.size_(2);
+newN = max(N,max(idx));
+B = obj.chunks_(end);
+blk = unique(ceil(idx/B));
+if newN > N % Partial tail block and any new blocks must be (re-)coded
+   blk = union(blk,max(ceil(N/B),1):ceil(newN/B));
+end
+starts = blk([true, diff(blk) > 1]); % Runs of consecutive blocks
+stops = blk([diff(blk) > 1, true]);
+
+varname_ = ['/' obj.name_];
+info = h5info(obj.diskfile_,varname_);
+nBytes = prod(info.Dataspace.Size);
+try
+   nDead = double(h5readatt(obj.diskfile_,varname_,'CodecDead'));
+catch
+   nDead = 0; % Written before dead bytes were tracked
+end
+nCoded = ceil(N/B); % Blocks that already have a slot
+for i = 1:numel(starts)
+   s0 = (starts(i)-1) * B; % Samples preceding this run
+   s1 = min(stops(i) * B, newN);
+   buf = zeros(1,s1-s0,obj.class_);
+   nOld = min(s1,N) - s0;
+   if nOld > 0
+      buf(1:nOld) = getCodedStreamsFromIndexing(obj,s0 + (1:nOld));
+   end
+   inRun = (idx > s0) & (idx <= s1);
+   buf(idx(inRun) - s0) = data(inRun);
+   
+   [payload,index] = StreamCodec_core('encode',buf,B);
+   nSlot = max(min(stops(i),nCoded) - starts(i) + 1,0);
+   slot = zeros(2,nSlot);
+   if nSlot > 0
+      slot = h5read(obj.diskfile_,[varname_ '_index'],[1 starts(i)],[2 nSlot]);
+   end
+   fits = false(1,size(index,2));
+   fits(1:nSlot) = index(2,1:nSlot) <= slot(2,:);
+   newIndex = index;
+   
+   % Blocks that fit their slot are written in place, each padded to the
+   % size of its slot so that adjacent slots take a single write
+   iFit = find(fits);
+   if ~isempty(iFit)
+      brk = [true, slot(1,iFit(2:end)) ~= ...
+         (slot(1,iFit(1:(end-1))) + slot(2,iFit(1:(end-1))))];
+      grp = cumsum(brk);
+      for g = 1:grp(end)
+         k = iFit(grp == g);
+         pos = [0, cumsum(slot(2,k))];
+         bytes = zeros(1,pos(end),'uint8');
+         for j = 1:numel(k)
+            bytes(pos(j) + (1:index(2,k(j)))) = ...
+               payload(index(1,k(j)) + (1:index(2,k(j))));
+         end
+         if ~isempty(bytes)
+            h5write(obj.diskfile_,varname_,bytes,[1 (slot(1,k(1))+1)],size(bytes));
+         end
+      end
+      newIndex(1,iFit) = slot(1,iFit);
+      nDead = nDead + sum(slot(2,iFit) - index(2,iFit));
+   end
+   
+   % The others are appended; their old slots (if any) are dead
+   iApp = find(~fits);
+   if ~isempty(iApp)
+      keep = false(size(payload));
+      for k = iApp
+         keep(index(1,k) + (1:index(2,k))) = true;
+      end
+      bytes = payload(keep);
+      newIndex(1,iApp) = nBytes + [0, cumsum(index(2,iApp(1:(end-1))))];
+      if ~isempty(bytes)
+         h5write(obj.diskfile_,varname_,bytes,[1 (nBytes+1)],size(bytes));
+      end
+      nBytes = nBytes + numel(bytes);
+      nDead = nDead + sum(slot(2,iApp(iApp <= nSlot)));
+   end
+   h5write(obj.diskfile_,[varname_ '_index'],newIndex,[1 starts(i)],size(newIndex));
+end
+
+obj.size_ = [1 newN];
+h5writeatt(obj.diskfile_,varname_,'CodecSize',obj.size_);
+h5writeatt(obj.diskfile_,varname_,'CodecDead',nDead);
+if (nDead >= DEAD_MIN) && (nDead > DEAD_FRAC * nBytes)
+   compactCodedStream(obj);
+end
+
+end
@@ -53,7 +53,7 @@ strideRow = diff(clustIdx(:));
 RowBlocks = [iRow(clustIdx(:)) [strideRow;numel(iRow)-sum(strideRow)]];
 
 % Do the H5 assignment
-varname_ = ['/' obj.name_];
+obj.index_ = []; % Event query index is now out of date
 
 % Iterate on columns, reading in the full column and then overwriting the
 % relevant rows. There should in general be many fewer Columns than rows,
@@ -70,8 +70,8 @@ stCol = 0;
 for ii = 1:size(ColBlocks,1)
     stRow = 0;
     for jj = 1:size(RowBlocks,1)
-        h5write(obj.diskfile_,varname_,data(stRow+1:stRow+RowBlocks(jj,2),stCol+1:stCol+ColBlocks(ii,2)),...
-            [RowBlocks(jj,1) ColBlocks(ii,1)],[RowBlocks(jj,2) ColBlocks(ii,2)]);
+        writeHyperslab(obj,data(stRow+1:stRow+RowBlocks(jj,2),stCol+1:stCol+ColBlocks(ii,2)),...
+            [RowBlocks(jj,1) ColBlocks(ii,1)],1);
         stRow = stRow + RowBlocks(jj,2);
     end
     stCol = stCol + ColBlocks(ii,2);
@@ -21,18 +21,26 @@ if isinf(idx)
    idx = 1:N;
 end
 
+% Cached pages of this stream are now out of date
+clearCachedPages(obj);
+
+% Native codec: re-code only the blocks touched by idx
+if isCoded(obj)
+   setCodedStreamsFromIndexing(obj,idx,data);
+   return;
+end
+
 % First step: make a list of "chunks" to read
 starts = idx([true, diff(idx) > 1]); % All "starts" of included indices
 stops = idx([diff(idx) > 1, true]);  % All "stops" of runs of consecutive
 counts = stops - starts + 1;         % Lengths of each "run"
 
 % Second step: read out data in "chunks"
-varname_ = ['/' obj.name_];
 iCur = 1;
 for i = 1:numel(starts)
    cur = iCur:(iCur+counts(i)-1);
    iCur = cur(end)+1;
-   h5write(obj.diskfile_,varname_,data(1,cur),[1 starts(i)],[1 counts(i)]);
+   writeHyperslab(obj,data(1,cur),[1 starts(i)],2);
 end
 
 end
@@ -666,21 +666,17 @@ classdef FeaturesUI < handle
 %          cy = pos(:,2);
 
          % Excellent mex version of InPolygon from Guillaume Jacquenot:
-         [IN,ON] = nigeLab.utils.InPolygon.InPolygon(obj.sdMesh.X,obj.sdMesh.Y,x,y);
-         pts = IN | ON;
+         % (IN alone is in or on the polygon)
+         pts = nigeLab.utils.InPolygon.InPolygon(obj.sdMesh.X,obj.sdMesh.Y,x,y);
          set(obj.Figure,'Pointer','watch');
          drawnow;    
 
-         % Match from Feature assignments     
-         idxInside = find(pts);
-         [row,col] = ind2sub(size(pts),idxInside);         
-         
-         iMove = [];
-         for ii = 1:numel(row)
-            moveIdx = find(binX == col(ii) & binY == row(ii) & fi);
-            iMove = [iMove; moveIdx]; %#ok<AGROW>
-         end
-         iMove = unique(iMove);
+         % Match from Feature assignments: visible spikes whose mesh bin
+         % (0: outside of the mesh) is inside the polygon
+         inMesh = (binX > 0) & (binY > 0) & fi;
+         hit = false(size(inMesh));
+         hit(inMesh) = pts(sub2ind(size(pts),binY(inMesh),binX(inMesh)));
+         iMove = find(hit);
          
          evtData = nigeLab.evt.assignClus(iMove,obj.CurClass);
          notify(obj,'ClassAssigned',evtData);
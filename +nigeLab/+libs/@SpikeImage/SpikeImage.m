@@ -53,7 +53,11 @@ classdef SpikeImage < handle
       YLim = [-300 150];
       XPoints = 60;     % Number of points for X resolution
       YPoints = 101;    % Number of points for Y resolution
+      DensityScale = 'linear'; % Scaling of spike images: 'linear' or 'log'
       T = 1.2;          % Approx. time (milliseconds) of waveform
+      RefractoryPeriod = 1.5; % (ms) Lags counted as refractory violations
+      CorrelogramEdges = -25:0.25:25; % (ms) Lag bin edges of correlograms
+      Correlograms      % Auto/cross-correlogram counts of current channel
       Defaults_File = 'SpikeImageDefaults.mat'; % Name of file with default
       PlotNames = cell(9,1);
       
@@ -222,6 +226,7 @@ classdef SpikeImage < handle
 
          % Set spike classes
          obj.Assign(obj.Parent.spk.class{obj.Parent.UI.ch});
+         obj.UpdateCorrelograms;
          
          % Flatten spike image
          obj.Flatten;
@@ -257,7 +262,8 @@ classdef SpikeImage < handle
       function set(obj,NAME,value)
          %SET   Overloaded class method
          
-         % Set 'numclus_max', 'ylim', or 'plotnames' properties and update.
+         % Set 'numclus_max', 'ylim', 'plotnames' or 'densityscale'
+         % properties and update.
          switch lower(NAME)
             case 'numclus_max'
                delete(obj.Figure.Axes);
@@ -276,6 +282,10 @@ classdef SpikeImage < handle
                obj.PlotNames = value;
                obj.Flatten;
                obj.Build;
+            case 'densityscale'
+               obj.DensityScale = value;
+               obj.Flatten(1:obj.NumClus_Max);
+               obj.Draw;
             case 'buttondownfcn'
                obj.PlotCB = value;
                obj.Refresh;
@@ -379,6 +389,7 @@ classdef SpikeImage < handle
             plotNum = reshape(plotNum,1,numel(plotNum));
          end
          
+         rpv = obj.GetRefractoryViolations;
          for iPlot = plotNum
             if iPlot > 1
                obj.PlotNames{iPlot} = ...
@@ -389,6 +400,66 @@ classdef SpikeImage < handle
                   sprintf('OUT        N = %d',...
                   sum(obj.Spikes.Class==iPlot));
             end
+            if ~isempty(rpv)
+               obj.PlotNames{iPlot} = [obj.PlotNames{iPlot} ...
+                  sprintf('        RPV = %.1f%%',100*rpv(iPlot))];
+            end
+         end
+      end
+      
+      % Update auto/cross-correlograms of the current channel
+      function UpdateCorrelograms(obj,subs,oldClass)
+         %UPDATECORRELOGRAMS  Update correlograms of the spike classes
+         %
+         %  obj.UpdateCorrelograms();
+         %  --> Count correlograms of all classes of the current channel
+         %
+         %  obj.UpdateCorrelograms(subs,oldClass);
+         %  --> Update them after spikes `subs` moved from `oldClass` to
+         %      their current class (only the pairs of those spikes are
+         %      recounted; see nigeLab.utils.correlograms)
+         
+         if ~isfield(obj.Parent.spk,'ts') % No spike times (standalone)
+            obj.Correlograms = [];
+            return;
+         end
+         ch = obj.Parent.UI.ch;
+         ts = obj.Parent.spk.ts{ch};
+         group = obj.Parent.spk.block{ch};
+         edges = obj.CorrelogramEdges * 1e-3; % Spike times are in seconds
+         if (nargin < 3) || isempty(obj.Correlograms)
+            obj.Correlograms = nigeLab.utils.correlograms(ts,...
+               obj.Spikes.Class,edges,'Group',group,...
+               'NumClus',obj.NumClus_Max);
+         else
+            obj.Correlograms = nigeLab.utils.correlograms(ts,...
+               obj.Spikes.Class,edges,'Group',group,...
+               'Counts',obj.Correlograms,'Moved',subs,'OldClass',oldClass);
+         end
+      end
+      
+      % Get refractory period violation rate of each class
+      function rpv = GetRefractoryViolations(obj)
+         %GETREFRACTORYVIOLATIONS  Fraction of ISIs < refractory period
+         %
+         %  rpv = obj.GetRefractoryViolations();
+         %  --> rpv(iClass) is the number of pairs of spikes of that class
+         %      closer than obj.RefractoryPeriod, divided by the number of
+         %      spikes (empty if there are no correlograms)
+         
+         if isempty(obj.Correlograms)
+            rpv = [];
+            return;
+         end
+         e = obj.CorrelogramEdges;
+         inBin = (e(1:(end-1)) >= -obj.RefractoryPeriod) & ...
+                 (e(2:end) <= obj.RefractoryPeriod);
+         rpv = zeros(obj.NumClus_Max,1);
+         for iC = 1:obj.NumClus_Max
+            n = sum(obj.Spikes.Class==iC);
+            if n > 0 % Each pair is in the ACG at +lag and -lag
+               rpv(iC) = sum(obj.Correlograms(inBin,iC,iC)) / 2 / n;
+            end
          end
       end
       
@@ -396,24 +467,12 @@ classdef SpikeImage < handle
       function Interpolate(obj,spikes)
          %INTERPOLATE    Interpolate spikes to make waveforms smoother
          
-         x = [1, size(spikes,2)];
-         xv = linspace(x(1),x(2),obj.XPoints);
-         
-         LoopFunction = @(xin) (nigeLab.utils.interp1qr((x(1):x(2))',spikes(xin,:)',xv'));
-         
-         % Make ProgressCircle object
-         pcirc = nigeLab.libs.ProgressCircle(LoopFunction);
-%          pCat = nigeLab.libs.ProgressCat(LoopFunction,obj.ProgCatPars);
-%          obj.ProgCatPars.pawsInterval = ...
-%             max(obj.ProgCatPars.pawsInterval*0.9,1e-6);
-%          obj.ProgCatPars.progPctThresh = ...
-%             min(obj.ProgCatPars.progPctThresh + 1, ...
-%             floor(100/obj.ProgCatPars.nImg));
-         
-         % Run ProgressCircle Loop
+         % Same linear interpolation as interp1qr, applied to all spikes
+         % at once (one matrix product; see nigeLab.utils.upsampleSnippets)
+         % and kept in single precision (only binned for the images)
          fprintf(1,'->\tInterpolating spikes...');
-         obj.Spikes.Waves = pcirc.RunLoop(size(spikes,1),obj.XPoints);
-%          obj.Spikes.Waves = pCat.RunLoop(size(spikes,1),obj.XPoints);
+         obj.Spikes.Waves = single(nigeLab.utils.upsampleSnippets(spikes,...
+            obj.XPoints,'linear'));
          fprintf(1,'complete.\n');
 
       end
@@ -615,34 +674,55 @@ classdef SpikeImage < handle
       % "Flatten" spikes (use mesh to 2D discretize them into an image)
       function Flatten(obj,plotNum)
          %FLATTEN   Condense spikes into matrix scaled from 0 to 1
+         %
+         %  obj.Flatten();
+         %  --> Count the waveform density of every class (amplitude bin
+         %      by time; see nigeLab.utils.spikeDensity) and scale all
+         %      images
+         %
+         %  obj.Flatten(plotNum);
+         %  --> Only scale the images indexed by plotNum from the current
+         %      counts (see UpdateDensity)
          
          if nargin < 2
             plotNum = 1:obj.NumClus_Max;
             obj.Spikes.C = cell(obj.NumClus_Max,1); % Colors (spike image)
-            obj.Spikes.A = cell(obj.NumClus_Max,1); % Assignments
+            
+            % Get bin edges
+            y_edge = linspace(obj.YLim(1),obj.YLim(2),obj.YPoints);
+            [obj.Spikes.Counts,obj.Spikes.A] = nigeLab.utils.spikeDensity(...
+               obj.Spikes.Waves,obj.Spikes.Class,y_edge,...
+               'NumClus',obj.NumClus_Max); % Counts; bin of each sample
          end
 
          plotNum = plotNum(:)';
-         % Get bin edges
-         y_edge = linspace(obj.YLim(1),obj.YLim(2),obj.YPoints);
-         
          for iC = plotNum
-             % Pre-allocate
-             clus = obj.Spikes.Waves(obj.Spikes.Class==iC,:);
-             obj.Spikes.C{iC} = zeros(obj.YPoints-1,obj.XPoints);
-             obj.Spikes.A{iC} = nan(size(clus));
-             for ii = 1:obj.XPoints
-                 [obj.Spikes.C{iC}(:,ii),obj.Spikes.A{iC}(:,ii)] = ...
-                     matlab.internal.math.histcounts(clus(:,ii),y_edge);
+             c = obj.Spikes.Counts(:,:,iC);
+             if strcmpi(obj.DensityScale,'log')
+                c = log1p(c);
              end
              
              % Normalize
-             obj.Spikes.C{iC} = obj.Spikes.C{iC}./...
-                 max(obj.Spikes.C{iC}(:));
+             obj.Spikes.C{iC} = c./max(c(:));
          end
          
       end
       
+      % Update density counts after spikes changed class
+      function UpdateDensity(obj,subs,oldClass)
+         %UPDATEDENSITY  Update waveform density counts of the classes
+         %
+         %  obj.UpdateDensity(subs,oldClass);
+         %  --> Spikes `subs` moved from `oldClass` to their current class:
+         %      only their bins move between the counts (see
+         %      nigeLab.utils.spikeDensity). Then Flatten(plotNum) scales
+         %      the images that changed.
+         
+         obj.Spikes.Counts = nigeLab.utils.spikeDensity(obj.Spikes.A,...
+            obj.Spikes.Class,[],'Counts',obj.Spikes.Counts,...
+            'Moved',subs,'OldClass',oldClass);
+      end
+      
       % CALLBACK: Triggered when figure window closes
       function CloseSpikeImageFigure(obj,src,~)
          %CLOSESPIKEIMAGEFIGURE  Trigger event when figure window closed
@@ -736,23 +816,22 @@ classdef SpikeImage < handle
 %          cy = pos(:,2);
 
          % Excellent mex version of InPolygon from Guillaume Jacquenot:
-         [IN,ON] = nigeLab.utils.InPolygon.InPolygon(px,py,x,y);
-         pts = IN | ON;
+         % (IN alone is in or on the polygon)
+         pts = nigeLab.utils.InPolygon.InPolygon(px,py,x,y);
          set(obj.Figure,'Pointer','watch');
          drawnow;
          
 
-         % Match from SpikeImage Assignments        
+         % Match from SpikeImage Assignments: spikes of this class with
+         % any sample in a bin inside the polygon
          start = find(sum(pts,1),1,'first'); % Skip "empty" start
          last = find(sum(pts,1),1,'last'); % Skip "empty" end
-         iMove = [];
-         for ii = start:last
-            addressVec = obj.Spikes.A{thisClass}(:,ii);
-            inPolyVec = find(pts(:,ii));
-            inPolyVec = repmat(inPolyVec.',numel(addressVec),1);
-            iMove = [iMove; find(any(addressVec == inPolyVec,2))]; %#ok<AGROW>
-         end
-         iMove = unique(iMove);
+         bin = double(obj.Spikes.A(subsetIndex,start:last));
+         col = repmat(start:last,numel(subsetIndex),1);
+         inBin = bin > 0; % 0: outside of YLim
+         hit = false(size(bin));
+         hit(inBin) = pts(sub2ind(size(pts),bin(inBin),col(inBin)));
+         iMove = find(any(hit,2));
          set(obj.Figure,'Pointer','arrow');
          
          
@@ -895,6 +974,7 @@ classdef SpikeImage < handle
          else
             obj.Spikes.Class = obj.Parent.spk.class{1};
          end
+         obj.UpdateCorrelograms;
          obj.ConfirmedChanges(obj.Parent.UI.ChannelSelector.Channel) = false;
          obj.UnsavedChanges(obj.Parent.UI.ChannelSelector.Channel) = false;
          obj.Flatten;
@@ -966,7 +1046,8 @@ classdef SpikeImage < handle
              unique(evt.class));
       
          % Identify plots to update
-         plotsToUpdate = unique(obj.Spikes.Class(evt.subs));
+         oldClass = obj.Spikes.Class(evt.subs);
+         plotsToUpdate = unique(oldClass);
          plotsToUpdate = reshape(plotsToUpdate,1,numel(plotsToUpdate));
          plotsToUpdate = unique([plotsToUpdate, newClasses]); % in case
          if ~isnan(evt.otherClassToUpdate)
@@ -977,6 +1058,8 @@ classdef SpikeImage < handle
              idx = evt.class == class;
              obj.Assign(class,evt.subs(idx));
          end
+         obj.UpdateCorrelograms(evt.subs,oldClass);
+         obj.UpdateDensity(evt.subs,oldClass);
          obj.SetPlotNames(plotsToUpdate);
          obj.Flatten(plotsToUpdate);
          obj.Draw(plotsToUpdate);
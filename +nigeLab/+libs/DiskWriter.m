@@ -0,0 +1,331 @@
+classdef DiskWriter < handle
+   %DISKWRITER  Write-behind queue for nigeLab.libs.DiskData HDF5 writes
+   %
+   %  w = nigeLab.libs.DiskWriter.instance();
+   %  --> Returns the (single) writer shared by all DiskData objects
+   %
+   %  nigeLab.libs.DiskWriter.write(fName,varname_,data,start,dim,chunk);
+   %  --> Queues h5write(fName,varname_,data,start,size(data)) and returns
+   %      immediately. Consecutive queued writes to the same dataset that
+   %      are contiguous along `dim` are merged into one write, and a
+   %      trailing write that does not end on a `chunk` boundary is held
+   %      back so the next append can be merged with it.
+   %
+   %  nigeLab.libs.DiskWriter.call(fName,fcn);
+   %  --> Queues fcn() to run (in MATLAB) once the writes to fName that
+   %      were queued before it are done (e.g. locking the file).
+   %
+   %  nigeLab.libs.DiskWriter.barrier(fName);
+   %  --> Blocks until every queued job on fName is done
+   %
+   %  nigeLab.libs.DiskWriter.barrier();
+   %  --> Blocks until the queue is empty (all files)
+   %
+   %  Queued writes run one at a time, in order, on the MATLAB background
+   %  thread pool (backgroundPool, R2021b+), so computing the next channel
+   %  overlaps with writing the previous one. If there is no background
+   %  pool, or the pool cannot run h5write, jobs run synchronously in the
+   %  same order (writes are still merged).
+   %
+   %  DiskData calls barrier before reading a dataset (or its size),
+   %  writing an attribute, or changing file permissions; nigelObj.save
+   %  and the pipeline stages call it before returning, so files on disk
+   %  are complete when a stage is done.
+
+   % % % PROPERTIES % % % % % % % % % %
+   % PUBLIC
+   properties (Access=public)
+      MaxQueueBytes  (1,1) double  = 512e6  % Producers block (drain) when queued data exceeds this
+   end
+
+   % READ-ONLY
+   properties (GetAccess=public,SetAccess=private)
+      Async          (1,1) logical = false  % True if jobs run on backgroundPool
+      QueueBytes     (1,1) double  = 0      % Bytes of data currently queued
+   end
+
+   % PRIVATE
+   properties (Access=private)
+      Queue                  % Struct array of queued jobs (FIFO)
+      Future                 % parallel.Future of job in flight (or [])
+      FutureJob              % Job struct that is in flight
+      Verified (1,1) logical = false % True once an async write succeeded
+   end
+   % % % % % % % % % % END PROPERTIES %
+
+   % % % METHODS% % % % % % % % % % % %
+   % PRIVATE (constructor)
+   methods (Access=private)
+      % Class constructor
+      function obj = DiskWriter()
+         %DISKWRITER  Use nigeLab.libs.DiskWriter.instance() instead
+
+         obj.Queue = nigeLab.libs.DiskWriter.emptyJob();
+         obj.Async = exist('backgroundPool','file')~=0;
+      end
+   end
+
+   % PUBLIC
+   methods (Access=public)
+      % Drain the queue before the writer is cleared
+      function delete(obj)
+         %DELETE  Make sure nothing queued is lost
+
+         try
+            drain(obj,'');
+         catch me
+            warning(me.identifier,'%s',me.message);
+         end
+      end
+
+      % Returns true if there are queued (or running) jobs on fName
+      function tf = hasPending(obj,fName)
+         %HASPENDING  True if jobs for fName (or any file) are not done
+         %
+         %  tf = hasPending(obj,fName);
+
+         if isempty(fName)
+            tf = ~isempty(obj.Queue) || ~isempty(obj.Future);
+            return;
+         end
+         tf = any(strcmp({obj.Queue.file},fName)) || ...
+            (~isempty(obj.Future) && strcmp(obj.FutureJob.file,fName));
+      end
+
+      % Run queued jobs until none remain on fName ('' for all files)
+      function drain(obj,fName)
+         %DRAIN  Blocking barrier (see nigeLab.libs.DiskWriter.barrier)
+
+         while hasPending(obj,fName)
+            step(obj);
+         end
+      end
+
+      % Add a job to the queue, merging it with the previous write if
+      % possible, then start whatever can be started without blocking
+      function push(obj,job)
+         %PUSH  Add a job to the queue
+
+         n = numel(obj.Queue);
+         if (n > 0) && nigeLab.libs.DiskWriter.canMerge(obj.Queue(n),job)
+            d = job.dim;
+            obj.Queue(n).data = cat(d,obj.Queue(n).data,job.data);
+         else
+            obj.Queue(n+1) = job;
+         end
+         obj.QueueBytes = obj.QueueBytes + job.bytes;
+
+         if obj.QueueBytes > obj.MaxQueueBytes
+            drain(obj,''); % Bounded queue: producer waits
+         else
+            poll(obj);
+         end
+      end
+   end
+
+   % PRIVATE
+   methods (Access=private)
+      % Start queued jobs as long as that does not require waiting
+      function poll(obj)
+         %POLL  Non-blocking pump of the queue
+
+         while true
+            if ~isempty(obj.Future)
+               if ~strcmp(obj.Future.State,'finished')
+                  return;
+               end
+               finish(obj);
+            end
+            if isempty(obj.Queue)
+               return;
+            end
+            % Hold back a lone trailing partial chunk for merging
+            job = obj.Queue(1);
+            if (numel(obj.Queue) == 1) && (job.dim > 0)
+               stop = job.start(job.dim) + size(job.data,job.dim) - 1;
+               if mod(stop,job.chunk) ~= 0
+                  return;
+               end
+            end
+            dispatch(obj);
+         end
+      end
+
+      % Wait for the running job, or start the next queued one
+      function step(obj)
+         %STEP  Make progress on the queue (blocking)
+
+         if ~isempty(obj.Future)
+            wait(obj.Future);
+            finish(obj);
+         elseif ~isempty(obj.Queue)
+            dispatch(obj);
+         end
+      end
+
+      % Start the job at the head of the queue
+      function dispatch(obj)
+         %DISPATCH  Remove head of queue and run it (async if possible)
+
+         job = obj.Queue(1);
+         obj.Queue(1) = [];
+         obj.QueueBytes = max(obj.QueueBytes - job.bytes,0);
+         if obj.Async && (job.dim > 0)
+            try
+               obj.Future = parfeval(backgroundPool,@h5write,0,...
+                  job.file,job.dset,job.data,job.start,size(job.data));
+               obj.FutureJob = job;
+               return;
+            catch
+               obj.Async = false; % No usable pool; run synchronously
+            end
+         end
+         nigeLab.libs.DiskWriter.run(job);
+      end
+
+      % Check the result of the job that was running
+      function finish(obj)
+         %FINISH  Collect finished job; re-run synchronously if the pool
+         %        turns out not to support h5write
+
+         f = obj.Future;
+         job = obj.FutureJob;
+         obj.Future = [];
+         obj.FutureJob = [];
+         if isempty(f.Error)
+            obj.Verified = true;
+            return;
+         end
+         if ~obj.Verified
+            obj.Async = false;
+            nigeLab.libs.DiskWriter.run(job);
+            return;
+         end
+         error(['nigeLab:' mfilename ':WriteFailed'],...
+            '[DISKWRITER]: Queued write to %s failed: %s',...
+            job.file,f.Error.message);
+      end
+   end
+
+   % STATIC,PUBLIC
+   methods (Static,Access=public)
+      % Returns the writer shared by all DiskData objects
+      function obj = instance()
+         %INSTANCE  Returns handle to the (single) DiskWriter
+         %
+         %  w = nigeLab.libs.DiskWriter.instance();
+
+         persistent w
+         if isempty(w) || ~isvalid(w)
+            w = nigeLab.libs.DiskWriter();
+         end
+         obj = w;
+      end
+
+      % Queue an HDF5 hyperslab write
+      function write(fName,dset,data,start,dim,chunk)
+         %WRITE  Queue h5write(fName,dset,data,start,size(data))
+         %
+         %  nigeLab.libs.DiskWriter.write(fName,dset,data,start,dim,chunk);
+         %
+         %  dim : Dimension along which consecutive writes are contiguous
+         %        (2 for 'Hybrid' streams, 1 for 'Event' rows)
+         %  chunk : Chunk extent along `dim` (for holding partial chunks)
+
+         job = nigeLab.libs.DiskWriter.emptyJob();
+         job(1).file = fName;
+         job.dset = dset;
+         job.data = data;
+         job.start = start;
+         job.dim = dim;
+         job.chunk = max(chunk,1);
+         w = whos('data');
+         job.bytes = w.bytes;
+         push(nigeLab.libs.DiskWriter.instance(),job);
+      end
+
+      % Queue a function to run after previously queued jobs on fName
+      function call(fName,fcn)
+         %CALL  Queue fcn() after the jobs already queued on fName
+         %
+         %  nigeLab.libs.DiskWriter.call(fName,fcn);
+
+         job = nigeLab.libs.DiskWriter.emptyJob();
+         job(1).file = fName;
+         job.dim = 0;   % Not a write (never merged)
+         job.bytes = 0;
+         job.fcn = fcn;
+         push(nigeLab.libs.DiskWriter.instance(),job);
+      end
+
+      % Block until queued jobs are done
+      function barrier(fName)
+         %BARRIER  Wait for queued jobs on fName (or all, if no input)
+         %
+         %  nigeLab.libs.DiskWriter.barrier(fName);
+         %  nigeLab.libs.DiskWriter.barrier();
+
+         if nargin < 1
+            fName = '';
+         end
+         drain(nigeLab.libs.DiskWriter.instance(),fName);
+      end
+
+      % Returns true if jobs on fName (or any) are not yet done
+      function tf = pending(fName)
+         %PENDING  True if queued jobs on fName (or any file) remain
+         %
+         %  tf = nigeLab.libs.DiskWriter.pending(fName);
+
+         if nargin < 1
+            fName = '';
+         end
+         tf = hasPending(nigeLab.libs.DiskWriter.instance(),fName);
+      end
+   end
+
+   % STATIC,PRIVATE
+   methods (Static,Access=private)
+      % Returns a job struct with no elements
+      function job = emptyJob()
+         %EMPTYJOB  Job struct template
+
+         job = struct('file',{},'dset',{},'data',{},'start',{},...
+            'dim',{},'chunk',{},'bytes',{},'fcn',{});
+      end
+
+      % Returns true if job b directly continues (queued) write a
+      function tf = canMerge(a,b)
+         %CANMERGE  Same dataset, contiguous along dim, same other extents
+
+         tf = false;
+         if (a.dim == 0) || (b.dim ~= a.dim)
+            return;
+         elseif ~strcmp(a.file,b.file) || ~strcmp(a.dset,b.dset)
+            return;
+         end
+         d = a.dim;
+         other = setdiff(1:numel(a.start),d);
+         szA = size(a.data);
+         szB = size(b.data);
+         if ~isequal(a.start(other),b.start(other)) || ...
+               ~isequal(szA(other),szB(other)) || ...
+               ~strcmp(class(a.data),class(b.data))
+            return;
+         end
+         tf = (a.start(d) + szA(d)) == b.start(d);
+      end
+
+      % Run a job in this thread
+      function run(job)
+         %RUN  Synchronous execution of queued job
+
+         if job.dim > 0
+            h5write(job.file,job.dset,job.data,job.start,size(job.data));
+         else
+            job.fcn();
+         end
+      end
+   end
+   % % % % % % % % % % END METHODS% % %
+end
@@ -3,22 +3,43 @@ function [locs pks]=peakseek(x,minpeakdist,minpeakh)
 % It really leaves findpeaks in the dust.  It also can handle ties between
 % peaks.  Findpeaks just erases both in a tie.  Shame on findpeaks.
 %
-% x is a vector input (generally a timecourse)
+% x is a vector input (generally a timecourse), double or single. If x is
+%   a matrix, each row is treated as one channel and locs, pks are
+%   returned as nChannels x 1 cell arrays.
 % minpeakdist is the minimum desired distance between peaks (optional, defaults to 1)
 % minpeakh is the minimum height of a peak (optional)
 %
+% If the compiled PeakSeek_core kernel is available (see
+% nigeLab.utils.compileNativeKernels), it is used instead of the MATLAB
+% code below; the output is the same.
+%
 % (c) 2010
 % Peter O'Connor
 % peter<dot>ed<dot>oconnor .AT. gmail<dot>com
 
+if nargin<2, minpeakdist=1; end % If no minpeakdist specified, default to 1.
+if nargin<3, minpeakh=nan; end % NaN: no minimum peak height
+
+if exist('PeakSeek_core','file')==3
+    [locs,pks]=PeakSeek_core(x,minpeakdist,minpeakh);
+    return;
+end
+
+if ~isvector(x) % Matrix: one channel per row
+    locs=cell(size(x,1),1);
+    pks=cell(size(x,1),1);
+    for iCh=1:size(x,1)
+        [locs{iCh},pks{iCh}]=nigeLab.libs.peakseek(x(iCh,:),minpeakdist,minpeakh);
+    end
+    return;
+end
+
 if size(x,2)==1, x=x'; end
 
 % Find all maxima and ties
 locs=find(x(2:end-1)>=x(1:end-2) & x(2:end-1)>=x(3:end))+1;
 
-if nargin<2, minpeakdist=1; end % If no minpeakdist specified, default to 1.
-
-if nargin>2 % If there's a minpeakheight
+if ~isnan(minpeakh) % If there's a minpeakheight
     locs(x(locs)<=minpeakh)=[];
 end
 
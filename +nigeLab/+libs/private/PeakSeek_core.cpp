@@ -0,0 +1,145 @@
+/*=================================================================
+ *
+ * PEAKSEEK_CORE.CPP	.MEX file for nigeLab.libs.peakseek
+ *
+ * The calling syntax is:
+ *
+ *		[locs, pks] = PeakSeek_core(x, minpeakdist, minpeakh)
+ *
+ *      x:              data (double or single). A vector is one channel;
+ *                      for a matrix, each row is one channel.
+ *      minpeakdist:    minimum distance between peaks (samples)
+ *      minpeakh:       minimum peak height (NaN for no minimum)
+ *      locs:           1 x nPeaks peak indices (double). For a matrix,
+ *                      nChannels x 1 cell of such vectors.
+ *      pks:            x(locs) (same class as x; cell for a matrix)
+ *
+ * Gives the same output as the MATLAB version of peakseek: local maxima
+ * (including ties) with x > minpeakh are found in one pass, then any two
+ * neighbouring peaks closer than minpeakdist lose the smaller of the two
+ * (the left one on a tie), with all conflicts of one "layer" resolved at
+ * once (see nigel::suppressPeaks in nigel_spikes.h). Channels of a
+ * matrix are processed in parallel.
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <math.h>
+#include <string.h>
+#include <vector>
+#include "mex.h"
+#include "nigel_spikes.h"
+#include "nigel_threads.h"
+
+/* Input Arguments */
+
+#define	DATA	prhs[0]
+#define	MINDIST	prhs[1]
+#define	MINH	prhs[2]
+
+/* Output Arguments */
+
+#define	LOCS	plhs[0]
+#define	PKS	plhs[1]
+
+///////////////////////////////////////////////////////////////////////////
+/* Peak detection for one channel */
+///////////////////////////////////////////////////////////////////////////
+
+/* x[i*step] for i = 0..n-1 is the channel; peak indices are 0-based */
+template <typename T>
+static void seekPeaks(const T *x, size_t n, size_t step,
+                      double minDist, double minH, bool useH,
+                      std::vector<size_t> &locs)
+{
+    std::vector<T> vals;
+    locs.clear();
+    for (size_t i = 1; i + 1 < n; i++)
+    {
+        T v = x[i*step];
+        if (v >= x[(i-1)*step] && v >= x[(i+1)*step])
+        {
+            if (useH && !((double)v > minH)) continue;
+            locs.push_back(i);
+            vals.push_back(v);
+        }
+    }
+    nigel::suppressPeaks<T>(locs, vals, minDist);
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* Output helpers */
+///////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+static void makeOutputs(const T *x, size_t step, mxClassID cls,
+                        const std::vector<size_t> &locs,
+                        mxArray **pLocs, mxArray **pPks)
+{
+    size_t m = locs.size();
+    *pLocs = mxCreateDoubleMatrix(1, m, mxREAL);
+    double *l = mxGetPr(*pLocs);
+    for (size_t k = 0; k < m; k++) l[k] = (double)(locs[k] + 1);
+    if (pPks == NULL) return;
+    *pPks = mxCreateNumericMatrix(1, m, cls, mxREAL);
+    T *p = (T *)mxGetData(*pPks);
+    for (size_t k = 0; k < m; k++) p[k] = x[locs[k]*step];
+}
+
+template <typename T>
+static void run(int nlhs, mxArray *plhs[], const mxArray *X,
+                double minDist, double minH, bool useH)
+{
+    const T *x = (const T *)mxGetData(X);
+    mxClassID cls = mxGetClassID(X);
+    size_t nRow = mxGetM(X), nCol = mxGetN(X);
+
+    if (nRow == 1 || nCol == 1) /* Vector: one channel */
+    {
+        std::vector<size_t> locs;
+        seekPeaks<T>(x, nRow * nCol, 1, minDist, minH, useH, locs);
+        makeOutputs<T>(x, 1, cls, locs, &LOCS, (nlhs > 1) ? &PKS : NULL);
+        return;
+    }
+
+    /* Matrix: each row is a channel (column-major, so stride is nRow) */
+    std::vector< std::vector<size_t> > locs(nRow);
+    nigel::parallelFor(nRow, [&](size_t ch) {
+        seekPeaks<T>(x + ch, nCol, nRow, minDist, minH, useH, locs[ch]);
+    });
+
+    LOCS = mxCreateCellMatrix(nRow, 1);
+    if (nlhs > 1) PKS = mxCreateCellMatrix(nRow, 1);
+    for (size_t ch = 0; ch < nRow; ch++)
+    {
+        mxArray *l, *p;
+        makeOutputs<T>(x + ch, nRow, cls, locs[ch], &l, (nlhs > 1) ? &p : NULL);
+        mxSetCell(LOCS, ch, l);
+        if (nlhs > 1) mxSetCell(PKS, ch, p);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+void mexFunction( int nlhs, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    if (nrhs < 1 || nrhs > 3)
+        mexErrMsgIdAndTxt("nigeLab:PeakSeek:BadInput",
+            "Requires (x), (x, minpeakdist) or (x, minpeakdist, minpeakh).");
+    if (mxIsComplex(DATA) || mxIsSparse(DATA) ||
+        !(mxIsDouble(DATA) || mxIsSingle(DATA)))
+        mexErrMsgIdAndTxt("nigeLab:PeakSeek:BadClass",
+            "x must be real, full double or single.");
+
+    double minDist = (nrhs > 1 && !mxIsEmpty(MINDIST)) ? mxGetScalar(MINDIST) : 1.0;
+    double minH = (nrhs > 2 && !mxIsEmpty(MINH)) ? mxGetScalar(MINH) : NAN;
+    bool useH = !isnan(minH);
+
+    if (mxIsDouble(DATA))
+        run<double>(nlhs, plhs, DATA, minDist, minH, useH);
+    else
+        run<float>(nlhs, plhs, DATA, minDist, minH, useH);
+}
@@ -26,88 +26,18 @@ end
 
 fprintf(1,'Beginning SPC...');
 
-cleanup(temppath,pars);
-
-inspk_aux = features(ind,:);
-save(fullfile(temppath, pars.FNameIn),'inspk_aux','-ascii');
-
-%% PRINT INPUT FILE FOR SPC
-fprintf(1,' writing input...');
-fid = fopen(sprintf('%s.run',fullfile(temppath,pars.FNAME_OUT)),'wt');
-fprintf(fid,'NumberOfPoints: %s\n',num2str(n_feat));
-fprintf(fid,'DataFile: %s\n',pars.FNameIn);
-fprintf(fid,'OutFile: %s\n', pars.FNameOut);
-fprintf(fid,'Dimensions: %s\n',num2str(K));
-fprintf(fid,'MinTemp: %s\n',num2str(pars.MinTemp));
-fprintf(fid,'MaxTemp: %s\n',num2str(pars.MaxTemp));
-fprintf(fid,'TempStep: %s\n',num2str(pars.TSTEP));
-fprintf(fid,'SWCycles: %s\n',num2str(pars.SWCyc));
-fprintf(fid,'KNearestNeighbours: %s\n',num2str(n_knn));
-fprintf(fid,'MSTree|\n');
-fprintf(fid,'DirectedGrowth|\n');
-fprintf(fid,'SaveSuscept|\n');
-fprintf(fid,'WriteLables|\n');
-fprintf(fid,'WriteCorFile~\n');
-if pars.randomseed ~= 0
-   fprintf(fid,'ForceRandomSeed: %s\n',num2str(pars.randomseed));
-end
-fclose(fid);
-
-%% EXECUTE CLUSTERING (DEPENDS ON OS)
-fprintf(1,' executing cluster.exe...');
-[str,~,~] = computer;
-switch str
-   case {'PCWIN','PCWIN64'}
-      if exist(fullfile(temppath,'tmp_cluster.exe'),'file')==0
-          copyfile(fullfile(localpath,'cluster.exe'),fullfile(temppath,'tmp_cluster.exe'));
-      end
-      oldfold = pwd;cd(temppath);
-      [~,~] = dos(sprintf('%s "%s.run" ', fullfile('tmp_cluster.exe'), pars.FNAME_OUT));
-      cd(oldfold);
-      fprintf(1,' cleaning up files...');
-      delete(fullfile(temppath,'tmp_cluster.exe'));
-   case 'MAC'
-      if exist([pwd '/cluster_mac.exe'],'file')==0
-         directory = which('cluster_mac.exe');
-         copyfile(directory,pwd);
-      end
-      run_mac = sprintf('./cluster_mac.exe %s.run',fname);
-      unix(run_mac);
-   otherwise  %(GLNX86, GLNXA64, GLNXI64 correspond to linux)
-      if exist([pwd '/cluster_linux.exe'],'file')==0
-         directory = which('cluster_linux.exe');
-         copyfile(directory,pwd);
-      end
-      run_linux = sprintf('./cluster_linux.exe %s.run',fname);
-      unix(run_linux);
-end
-
-%% READ OUTPUT FROM COMPILED CLUSTER.EXE
-if exist(fullfile(temppath,[pars.FNAME_OUT '.dg_01.lab']),'file')
-   clu = load(fullfile(temppath,[pars.FNAME_OUT '.dg_01.lab']));
-   tree = load(fullfile(temppath,[pars.FNAME_OUT '.dg_01']));
-   delete(fullfile(temppath,[pars.FNAME_OUT '.dg_01.lab']));
+if exist('SPC_core','file')==3
+   % In-process engine: no temporary files, no external executable, and
+   % temperatures are simulated in parallel.
+   fprintf(1,' clustering...');
+   temps = pars.MinTemp:pars.tempstep:pars.MaxTemp;
+   [clu,tree] = SPC_core(features(ind,:),temps,pars.SWCyc,n_knn,...
+      pars.randomseed);
 else
-   clu=nan;
-   tree=[];
-end
-
-delete(fullfile(temppath, [pars.FNAME_OUT '.dg_01']));
-delete(fullfile(temppath, pars.FNAME_IN));
-
-delete(fullfile(temppath,'*.run'));
-delete(fullfile(temppath,'*.edges'));
-delete(fullfile(temppath,'*.mag'));
-delete(fullfile(temppath,'*.param'));
-if exist(fullfile(temppath,[pars.FNAME_IN '.dg_01.lab']), 'file')
-   eval(sprintf('delete ''%s.dg_01.lab''',fullfile(temppath,pars.FNAME_IN)))
-end
-
-if exist(fullfile(temppath,[pars.FNAME_IN '.dg_01']), 'file')
-   eval(sprintf('delete ''%s.dg_01''',fullfile(temppath,pars.FNAME_IN)))
+   [clu,tree] = runClusterExe(localpath,temppath,pars,features(ind,:),...
+      n_feat,K,n_knn);
 end
 
-
 %% ESTIMATE TEMPERATURE
 fprintf(1,' finding temperature...');
 aux = tree(:,5:end); % First 4 columns are "other" info
@@ -143,7 +73,7 @@ end
 % % Anything assigned to 0 is "out"
 % class(class >= pars.NMaxClus) = pars.NMaxClus;
 
-class(class > max_clus) = nan; % Cast as "unassigned" again
+class(class > pars.max_clus) = nan; % Cast as "unassigned" again
 remvec = find(isnan(class));
 remvec = reshape(remvec,1,numel(remvec));
 
@@ -220,23 +150,108 @@ fprintf(1,'complete.\n');
 
 end
 
+function [clu,tree] = runClusterExe(localpath,temppath,pars,features,n_feat,K,n_knn)
+%% RUNCLUSTEREXE Runs the compiled cluster.exe (if SPC_core is not built)
+
+cleanup(temppath,pars);
+
+inspk_aux = features;
+save(fullfile(temppath, pars.FNameIn),'inspk_aux','-ascii');
+
+%% PRINT INPUT FILE FOR SPC
+fprintf(1,' writing input...');
+fid = fopen(sprintf('%s.run',fullfile(temppath,pars.FNameOut)),'wt');
+fprintf(fid,'NumberOfPoints: %s\n',num2str(n_feat));
+fprintf(fid,'DataFile: %s\n',pars.FNameIn);
+fprintf(fid,'OutFile: %s\n', pars.FNameOut);
+fprintf(fid,'Dimensions: %s\n',num2str(K));
+fprintf(fid,'MinTemp: %s\n',num2str(pars.MinTemp));
+fprintf(fid,'MaxTemp: %s\n',num2str(pars.MaxTemp));
+fprintf(fid,'TempStep: %s\n',num2str(pars.tempstep));
+fprintf(fid,'SWCycles: %s\n',num2str(pars.SWCyc));
+fprintf(fid,'KNearestNeighbours: %s\n',num2str(n_knn));
+fprintf(fid,'MSTree|\n');
+fprintf(fid,'DirectedGrowth|\n');
+fprintf(fid,'SaveSuscept|\n');
+fprintf(fid,'WriteLables|\n');
+fprintf(fid,'WriteCorFile~\n');
+if pars.randomseed ~= 0
+   fprintf(fid,'ForceRandomSeed: %s\n',num2str(pars.randomseed));
+end
+fclose(fid);
+
+%% EXECUTE CLUSTERING (DEPENDS ON OS)
+fprintf(1,' executing cluster.exe...');
+[str,~,~] = computer;
+switch str
+   case {'PCWIN','PCWIN64'}
+      if exist(fullfile(temppath,'tmp_cluster.exe'),'file')==0
+          copyfile(fullfile(localpath,'cluster.exe'),fullfile(temppath,'tmp_cluster.exe'));
+      end
+      oldfold = pwd;cd(temppath);
+      [~,~] = dos(sprintf('%s "%s.run" ', fullfile('tmp_cluster.exe'), pars.FNameOut));
+      cd(oldfold);
+      fprintf(1,' cleaning up files...');
+      delete(fullfile(temppath,'tmp_cluster.exe'));
+   case 'MAC'
+      if exist([pwd '/cluster_mac.exe'],'file')==0
+         directory = which('cluster_mac.exe');
+         copyfile(directory,pwd);
+      end
+      run_mac = sprintf('./cluster_mac.exe %s.run',fullfile(temppath,pars.FNameOut));
+      unix(run_mac);
+   otherwise  %(GLNX86, GLNXA64, GLNXI64 correspond to linux)
+      if exist([pwd '/cluster_linux.exe'],'file')==0
+         directory = which('cluster_linux.exe');
+         copyfile(directory,pwd);
+      end
+      run_linux = sprintf('./cluster_linux.exe %s.run',fullfile(temppath,pars.FNameOut));
+      unix(run_linux);
+end
+
+%% READ OUTPUT FROM COMPILED CLUSTER.EXE
+if exist(fullfile(temppath,[pars.FNameOut '.dg_01.lab']),'file')
+   clu = load(fullfile(temppath,[pars.FNameOut '.dg_01.lab']));
+   tree = load(fullfile(temppath,[pars.FNameOut '.dg_01']));
+   delete(fullfile(temppath,[pars.FNameOut '.dg_01.lab']));
+else
+   clu=nan;
+   tree=[];
+end
+
+delete(fullfile(temppath, [pars.FNameOut '.dg_01']));
+delete(fullfile(temppath, pars.FNameIn));
+
+delete(fullfile(temppath,'*.run'));
+delete(fullfile(temppath,'*.edges'));
+delete(fullfile(temppath,'*.mag'));
+delete(fullfile(temppath,'*.param'));
+if exist(fullfile(temppath,[pars.FNameIn '.dg_01.lab']), 'file')
+   eval(sprintf('delete ''%s.dg_01.lab''',fullfile(temppath,pars.FNameIn)))
+end
+
+if exist(fullfile(temppath,[pars.FNameIn '.dg_01']), 'file')
+   eval(sprintf('delete ''%s.dg_01''',fullfile(temppath,pars.FNameIn)))
+end
+end
+
 function cleanup(temppath,pars)
 %% CLEANUP cleans the workspce of old files
 warning off
-delete(fullfile(temppath, [pars.FNAME_OUT '.dg_01']));
-delete(fullfile(temppath, [pars.FNAME_OUT '.dg_01.lab']));
-delete(fullfile(temppath, pars.FNAME_IN));
+delete(fullfile(temppath, [pars.FNameOut '.dg_01']));
+delete(fullfile(temppath, [pars.FNameOut '.dg_01.lab']));
+delete(fullfile(temppath, pars.FNameIn));
 
 delete(fullfile(temppath,'*.run'));
 delete(fullfile(temppath,'*.edges'));
 delete(fullfile(temppath,'*.mag'));
 delete(fullfile(temppath,'*.param'));
-if exist(fullfile(temppath,[pars.FNAME_IN '.dg_01.lab']), 'file')
-   eval(sprintf('delete ''%s.dg_01.lab''',fullfile(temppath,pars.FNAME_IN)))
+if exist(fullfile(temppath,[pars.FNameIn '.dg_01.lab']), 'file')
+   eval(sprintf('delete ''%s.dg_01.lab''',fullfile(temppath,pars.FNameIn)))
 end
 
-if exist(fullfile(temppath,[pars.FNAME_IN '.dg_01']), 'file')
-   eval(sprintf('delete ''%s.dg_01''',fullfile(temppath,pars.FNAME_IN)))
+if exist(fullfile(temppath,[pars.FNameIn '.dg_01']), 'file')
+   eval(sprintf('delete ''%s.dg_01''',fullfile(temppath,pars.FNameIn)))
 end
 warning on
 end
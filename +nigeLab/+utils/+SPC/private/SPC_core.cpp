@@ -0,0 +1,334 @@
+/*=================================================================
+ *
+ * SPC_CORE.CPP	.MEX file for superparamagnetic clustering (SPC)
+ *
+ * The calling syntax is:
+ *
+ *		[clu, tree] = SPC_core(features, temps, swCycles, knn, seed)
+ *
+ *      features:   N x D feature matrix (double or single), one spike
+ *                  per row
+ *      temps:      vector of nT temperatures (e.g. MinTemp:step:MaxTemp)
+ *      swCycles:   Swendsen-Wang cycles measured at each temperature
+ *      knn:        number of nearest neighbours of each point
+ *      seed:       random seed (0: taken from the clock)
+ *
+ *      clu:        nT x (N+2) [iT, T, label of each point], as in the
+ *                  .dg_01.lab file of cluster.exe: iT is the 0-based
+ *                  temperature index and labels are 0-based, numbered
+ *                  by decreasing cluster size
+ *      tree:       nT x (4+NSIZE) [iT, T, nClusters, susceptibility,
+ *                  sizes of the NSIZE largest clusters], as in the .dg_01
+ *                  file of cluster.exe (0 for missing clusters)
+ *
+ * Same model as cluster.exe (Blatt, Wiseman & Domany 1996) run with
+ * 'MSTree' and 'DirectedGrowth'. Points are Q-state Potts spins coupled
+ * along the mutual K-nearest-neighbour graph plus the minimum spanning
+ * tree, with J = exp(-d^2/(2a^2))/Kmean (a: mean edge length, Kmean:
+ * mean number of neighbours). At each temperature, Swendsen-Wang cycles
+ * estimate the probability that two neighbours belong to the same SW
+ * cluster; pairs with spin-spin correlation > 0.5 are linked, every
+ * point is also linked to its most correlated neighbour, and the
+ * connected components are the clusters.
+ *
+ * Every temperature is simulated independently, from its own random
+ * stream (seed and temperature index), so temperatures run in parallel
+ * and the result for a given seed does not depend on the number of
+ * threads. No files are written and no process is spawned.
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "mex.h"
+#include "nigel_knn.h"
+#include "nigel_threads.h"
+
+/* Input Arguments */
+
+#define	FEATURES    prhs[0]
+#define	TEMPS	    prhs[1]
+#define	SWCYCLES    prhs[2]
+#define	KNN	    prhs[3]
+#define	SEED	    prhs[4]
+
+/* Constants */
+
+static const int    Q = 20;            /* Potts states */
+static const double CORR_TH = 0.5;     /* Spin-spin correlation threshold */
+static const size_t NSIZE = 16;        /* Cluster sizes reported in tree */
+static const double BURN_IN = 0.1;     /* Fraction of cycles discarded first */
+
+struct Graph {
+    size_t N;
+    std::vector<size_t> a, b;          /* Edge endpoints */
+    std::vector<double> J;             /* Coupling of each edge */
+    std::vector<size_t> start, nbr, edge; /* Adjacency (CSR) */
+};
+
+///////////////////////////////////////////////////////////////////////////
+/* Helpers */
+///////////////////////////////////////////////////////////////////////////
+
+/* splitmix64: small, portable random stream (same on every platform) */
+struct Rng {
+    uint64_t s;
+    explicit Rng(uint64_t seed) : s(seed) {}
+    uint64_t next()
+    {
+        uint64_t z = (s += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    double uniform() { return (double)(next() >> 11) * (1.0 / 9007199254740992.0); }
+    int spin() { return (int)(next() % (uint64_t)Q); }
+};
+
+static size_t findRoot(std::vector<size_t> &p, size_t i)
+{
+    while (p[i] != i)
+    {
+        p[i] = p[p[i]];
+        i = p[i];
+    }
+    return i;
+}
+
+static void unite(std::vector<size_t> &p, size_t i, size_t j)
+{
+    i = findRoot(p, i);
+    j = findRoot(p, j);
+    if (i == j) return;
+    if (i < j) p[j] = i; else p[i] = j;
+}
+
+/* Mutual KNN graph plus minimum spanning tree, with SPC couplings */
+static void buildGraph(const std::vector<double> &x, size_t N, size_t D,
+                       size_t k, Graph &g)
+{
+    g.N = N;
+    nigel::KdTree tree(x.data(), N, D);
+    std::vector<size_t> idx;
+    std::vector<double> d2;
+    nigel::knnGraph(tree, k, idx, d2);
+    size_t kk = (N > 0) ? idx.size() / N : 0;
+
+    std::vector< std::pair<size_t, size_t> > e, mst;
+    nigel::mutualEdges(idx, N, kk, e);
+    nigel::minimumSpanningTree(tree, mst);
+    for (size_t m = 0; m < mst.size(); m++)
+    {
+        size_t i = mst[m].first, j = mst[m].second;
+        e.push_back((i < j) ? std::make_pair(i, j) : std::make_pair(j, i));
+    }
+    std::sort(e.begin(), e.end());
+    e.erase(std::unique(e.begin(), e.end()), e.end());
+
+    size_t E = e.size();
+    g.a.resize(E);
+    g.b.resize(E);
+    g.J.resize(E);
+    std::vector<double> d(E);
+    double meanD = 0;
+    for (size_t m = 0; m < E; m++)
+    {
+        g.a[m] = e[m].first;
+        g.b[m] = e[m].second;
+        d[m] = sqrt(nigel::sqDist(&x[g.a[m] * D], &x[g.b[m] * D], D));
+        meanD += d[m];
+    }
+    meanD = (E > 0) ? meanD / (double)E : 1.0;
+    if (meanD <= 0) meanD = 1.0;
+    double kMean = (N > 0) ? 2.0 * (double)E / (double)N : 1.0;
+    for (size_t m = 0; m < E; m++)
+        g.J[m] = exp(-d[m] * d[m] / (2 * meanD * meanD)) / kMean;
+
+    /* Adjacency lists */
+    g.start.assign(N + 1, 0);
+    for (size_t m = 0; m < E; m++) { g.start[g.a[m] + 1]++; g.start[g.b[m] + 1]++; }
+    for (size_t i = 0; i < N; i++) g.start[i + 1] += g.start[i];
+    g.nbr.resize(2 * E);
+    g.edge.resize(2 * E);
+    std::vector<size_t> pos(g.start.begin(), g.start.end() - 1);
+    for (size_t m = 0; m < E; m++)
+    {
+        g.nbr[pos[g.a[m]]] = g.b[m]; g.edge[pos[g.a[m]]++] = m;
+        g.nbr[pos[g.b[m]]] = g.a[m]; g.edge[pos[g.b[m]]++] = m;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* Swendsen-Wang simulation at one temperature */
+///////////////////////////////////////////////////////////////////////////
+
+static void simulate(const Graph &g, double T, size_t nCycles, uint64_t seed,
+                     double *labels, double *sizes, double &nClus, double &chi)
+{
+    size_t N = g.N, E = g.a.size();
+    Rng rng(seed);
+    std::vector<int> s(N);
+    for (size_t i = 0; i < N; i++) s[i] = rng.spin();
+
+    /* Freezing probability of each (satisfied) bond */
+    std::vector<double> pFreeze(E);
+    for (size_t m = 0; m < E; m++)
+        pFreeze[m] = (T > 0) ? 1.0 - exp(-g.J[m] / T) : 1.0;
+
+    std::vector<size_t> parent(N), sameCount(E, 0);
+    std::vector<int> newSpin(N);
+    std::vector<size_t> count(Q);
+    size_t nBurn = (size_t)ceil(BURN_IN * (double)nCycles);
+    double m1 = 0, m2 = 0;
+    for (size_t c = 0; c < nBurn + nCycles; c++)
+    {
+        for (size_t i = 0; i < N; i++) parent[i] = i;
+        for (size_t m = 0; m < E; m++)
+        {
+            if (s[g.a[m]] == s[g.b[m]] && rng.uniform() < pFreeze[m])
+                unite(parent, g.a[m], g.b[m]);
+        }
+        for (size_t i = 0; i < N; i++) newSpin[i] = -1;
+        for (size_t i = 0; i < N; i++)
+        {
+            size_t r = findRoot(parent, i);
+            if (newSpin[r] < 0) newSpin[r] = rng.spin();
+            s[i] = newSpin[r];
+        }
+        if (c < nBurn) continue;
+
+        for (size_t m = 0; m < E; m++)
+            sameCount[m] += (findRoot(parent, g.a[m]) == findRoot(parent, g.b[m]));
+        std::fill(count.begin(), count.end(), 0);
+        for (size_t i = 0; i < N; i++) count[s[i]]++;
+        size_t nMax = *std::max_element(count.begin(), count.end());
+        double mag = ((double)nMax * Q / (double)N - 1) / (Q - 1);
+        m1 += mag;
+        m2 += mag * mag;
+    }
+    m1 /= (double)nCycles;
+    m2 /= (double)nCycles;
+    chi = (T > 0) ? (double)N / T * (m2 - m1 * m1) : 0.0;
+
+    /* Correlation G = ((Q-1)*C + 1)/Q, C = P(same SW cluster) */
+    std::vector<double> G(E);
+    for (size_t m = 0; m < E; m++)
+        G[m] = ((Q - 1) * (double)sameCount[m] / (double)nCycles + 1) / Q;
+
+    for (size_t i = 0; i < N; i++) parent[i] = i;
+    for (size_t m = 0; m < E; m++)
+        if (G[m] > CORR_TH) unite(parent, g.a[m], g.b[m]);
+    for (size_t i = 0; i < N; i++)
+    {
+        /* Directed growth: link to the most correlated neighbour */
+        size_t best = N;
+        double bestG = -1;
+        for (size_t p = g.start[i]; p < g.start[i + 1]; p++)
+        {
+            if (G[g.edge[p]] > bestG)
+            {
+                bestG = G[g.edge[p]];
+                best = g.nbr[p];
+            }
+        }
+        if (best < N) unite(parent, i, best);
+    }
+
+    /* Number clusters by decreasing size (ties: first member) */
+    std::vector<size_t> size(N, 0);
+    for (size_t i = 0; i < N; i++) size[findRoot(parent, i)]++;
+    std::vector<size_t> roots;
+    for (size_t i = 0; i < N; i++) if (parent[i] == i) roots.push_back(i);
+    std::stable_sort(roots.begin(), roots.end(),
+                     [&](size_t a, size_t b) { return size[a] > size[b]; });
+    std::vector<size_t> label(N);
+    for (size_t r = 0; r < roots.size(); r++) label[roots[r]] = r;
+    for (size_t i = 0; i < N; i++) labels[i] = (double)label[findRoot(parent, i)];
+    nClus = (double)roots.size();
+    for (size_t r = 0; r < NSIZE; r++)
+        sizes[r] = (r < roots.size()) ? (double)size[roots[r]] : 0.0;
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+void mexFunction( int nlhs, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    if (nrhs != 5)
+        mexErrMsgIdAndTxt("nigeLab:SPC:BadInput",
+            "Requires (features, temps, swCycles, knn, seed).");
+    if (mxIsComplex(FEATURES) || mxIsSparse(FEATURES) ||
+        !(mxIsDouble(FEATURES) || mxIsSingle(FEATURES)))
+        mexErrMsgIdAndTxt("nigeLab:SPC:BadClass",
+            "features must be a real, full double or single matrix.");
+    if (!mxIsDouble(TEMPS) || mxIsEmpty(TEMPS))
+        mexErrMsgIdAndTxt("nigeLab:SPC:BadTemps",
+            "temps must be a non-empty double vector.");
+
+    size_t N = mxGetM(FEATURES), D = mxGetN(FEATURES);
+    size_t nT = mxGetNumberOfElements(TEMPS);
+    const double *temps = mxGetPr(TEMPS);
+    double cyc = mxGetScalar(SWCYCLES), k = mxGetScalar(KNN);
+    double seedIn = mxGetScalar(SEED);
+    if (!(cyc >= 1) || !(k >= 1))
+        mexErrMsgIdAndTxt("nigeLab:SPC:BadInput",
+            "swCycles and knn must be >= 1.");
+    for (size_t t = 0; t < nT; t++)
+    {
+        if (!(temps[t] >= 0))
+            mexErrMsgIdAndTxt("nigeLab:SPC:BadTemps",
+                "Temperatures must be >= 0.");
+    }
+    uint64_t seed = (seedIn != 0) ? (uint64_t)(int64_t)seedIn
+                                  : (uint64_t)time(NULL);
+
+    /* Row-major copy of the features */
+    std::vector<double> x(N * D);
+    if (mxIsDouble(FEATURES))
+    {
+        const double *f = mxGetPr(FEATURES);
+        for (size_t i = 0; i < N; i++)
+            for (size_t d = 0; d < D; d++) x[i * D + d] = f[i + d * N];
+    }
+    else
+    {
+        const float *f = (const float *)mxGetData(FEATURES);
+        for (size_t i = 0; i < N; i++)
+            for (size_t d = 0; d < D; d++) x[i * D + d] = (double)f[i + d * N];
+    }
+
+    Graph g;
+    buildGraph(x, N, D, (size_t)k, g);
+
+    plhs[0] = mxCreateDoubleMatrix(nT, N + 2, mxREAL);
+    mxArray *tree = mxCreateDoubleMatrix(nT, 4 + NSIZE, mxREAL);
+    double *clu = mxGetPr(plhs[0]), *tr = mxGetPr(tree);
+    std::vector< std::vector<double> > lab(nT, std::vector<double>(N)),
+                                       sz(nT, std::vector<double>(NSIZE));
+    std::vector<double> nClus(nT), chi(nT);
+    nigel::parallelFor(nT, [&](size_t t) {
+        simulate(g, temps[t], (size_t)cyc, seed * 1000003ULL + t,
+                 lab[t].data(), sz[t].data(), nClus[t], chi[t]);
+    });
+
+    for (size_t t = 0; t < nT; t++)
+    {
+        clu[t] = (double)t;
+        clu[t + nT] = temps[t];
+        for (size_t i = 0; i < N; i++) clu[t + (i + 2) * nT] = lab[t][i];
+        tr[t] = (double)t;
+        tr[t + nT] = temps[t];
+        tr[t + 2 * nT] = nClus[t];
+        tr[t + 3 * nT] = chi[t];
+        for (size_t r = 0; r < NSIZE; r++) tr[t + (4 + r) * nT] = sz[t][r];
+    }
+    if (nlhs > 1) plhs[1] = tree; else mxDestroyArray(tree);
+}
@@ -123,6 +123,15 @@ classdef LinePlotReducer < handle
 %  Note: this version has been (very slightly) modified from the original 
 %        to incorporate into the "package" format within `nigeLab.utils`
 %
+%        Lines with more than nigeLab.utils.MinMaxPyramid.MIN_LENGTH
+%        uniformly spaced samples are reduced from a min/max pyramid
+%        (built once), so any zoom reads only a few values per pixel. A
+%        pyramid can also be passed in place of x and y, e.g. for a
+%        nigeLab.libs.DiskData stream that is not held in memory:
+%
+%        L = line(ax, xr, yr);
+%        LinePlotReducer(L, getMinMaxPyramid(stream));
+%
 % Copyright 2015, The MathWorks, Inc. and Tucker McClure
 
     properties
@@ -136,6 +145,9 @@ classdef LinePlotReducer < handle
         x;
         y;
         y_to_x_map;
+        pyramids = {};           % nigeLab.utils.MinMaxPyramid (or []) of
+                                 % each y, for long, uniformly sampled
+                                 % lines
         
         % Extrema
         x_min;
@@ -274,8 +286,19 @@ classdef LinePlotReducer < handle
             ym = [];
             for k = start:nargin+1
 
+                % A MinMaxPyramid is a line on its own (x is implied).
+                if k <= nargin ...
+                        && isa(varargin{k}, 'nigeLab.utils.MinMaxPyramid')
+
+                    o.x{end+1} = [];
+                    o.y{end+1} = [];
+                    o.y_to_x_map(end+1) = length(o.x);
+                    o.pyramids{length(o.y)} = varargin{k};
+                    ym = zeros(0, 1);
+                    km1_was_x = false;
+
                 % If it's a bunch of numbers...
-                if k <= nargin && isnumeric(varargin{k})
+                elseif k <= nargin && isnumeric(varargin{k})
 
                     % If we already have an x, then this must be y.
                     if km1_was_x
@@ -368,6 +391,17 @@ classdef LinePlotReducer < handle
             % We've now parsed up to k.
             start = k;
 
+            % Long, uniformly sampled lines are reduced from a min/max
+            % pyramid, which reads only a few values per pixel at any zoom.
+            o.pyramids(end+1:length(o.y)) = {[]};
+            for k = 1:length(o.y)
+                if isempty(o.pyramids{k})
+                    o.pyramids{k} = ...
+                        nigeLab.utils.MinMaxPyramid.fromUniform(...
+                            o.x{o.y_to_x_map(k)}, o.y{k});
+                end
+            end
+
             % Create cell arrays for the reduced data.
             x_r = cell(1, length(o.y));
             y_r = cell(1, length(o.y));
@@ -379,11 +413,7 @@ classdef LinePlotReducer < handle
 
             % Reduce the data!
             for k = 1:length(o.y)
-                [x_r{k}, y_r{k}] = nigeLab.utils.reduce_to_width(...
-                    o.x{o.y_to_x_map(k)}(:), ...
-                    o.y{k}(:), ...
-                    width, ...
-                    [-inf inf]);
+                [x_r{k}, y_r{k}] = o.ReduceLine(k, width, [-inf inf]);
             end
 
             % If taking over a plot, just update it. Otherwise, plot it.
@@ -547,10 +577,7 @@ classdef LinePlotReducer < handle
             for k = 1:length(o.h_plot)
                 
                 % Reduce the data.
-                [x_r, y_r] = nigeLab.utils.reduce_to_width(...
-                   o.x{o.y_to_x_map(k)}(:), ...
-                   o.y{k}(:), ...
-                   width, lims);
+                [x_r, y_r] = o.ReduceLine(k, width, lims);
                 
                 % Update the plot.
                 set(o.h_plot(k), 'XData', x_r, 'YData', y_r);
@@ -562,6 +589,18 @@ classdef LinePlotReducer < handle
             
         end
 
+        % Reduce line k for display on width pixels within lims.
+        function [x_r, y_r] = ReduceLine(o, k, width, lims)
+            if ~isempty(o.pyramids{k})
+                [x_r, y_r] = reduce(o.pyramids{k}, width, lims);
+            else
+                [x_r, y_r] = nigeLab.utils.reduce_to_width(...
+                   o.x{o.y_to_x_map(k)}(:), ...
+                   o.y{k}(:), ...
+                   width, lims);
+            end
+        end
+
         % Setting the units (which we do to change them to 'pixels' and
         % back when getting the axes width) also triggers callbacks for
         % both 'Position' and 'Units' (in that order). We'll want to make
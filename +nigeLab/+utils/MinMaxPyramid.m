@@ -0,0 +1,243 @@
+classdef MinMaxPyramid
+   %MINMAXPYRAMID  Multi-resolution min/max summary of a sampled signal
+   %
+   %  P = nigeLab.utils.MinMaxPyramid(y);
+   %  P = nigeLab.utils.MinMaxPyramid(y,x0,dx);
+   %  --> y  : Signal vector, or nigeLab.libs.DiskData stream (read in
+   %           chunks of CHUNK samples, never as a whole)
+   %      x0 : Position (e.g. time) of the first sample (default: 1)
+   %      dx : Spacing of samples (e.g. 1/fs; default: 1), so that by
+   %           default positions are sample indices
+   %
+   %  MINMAXPYRAMID Properties
+   %  Levels  --  Levels{k} is the nBin x 2 [min max] of each bin of
+   %              BASE*FACTOR^(k-1) samples (NaN ignored), down to a
+   %              single bin. Together they are about 1/24 the size of
+   %              the signal.
+   %
+   %  N  --  Number of samples
+   %
+   %  Source  --  The signal (y), read for zooms finer than BASE samples
+   %              per pixel
+   %
+   %  X0, DX  --  Position of sample i is X0 + (i-1)*DX
+   %
+   %  MINMAXPYRAMID Methods
+   %  reduce  --  Min/max decimation for display, as reduce_to_width
+   %     >> [xr,yr] = reduce(P,width,lims);
+   %        * Returns about 2*width points that plot like the samples
+   %          within lims (plus the first sample outside at each end)
+   %        * Uses the coarsest level with at least one bin per pixel,
+   %          so only width to FACTOR*width bins are read, whatever the
+   %          zoom; the extremes of a bin are placed at its centre
+   %        * Reads the samples themselves (reduce_to_width) when lims
+   %          span fewer than BASE samples per pixel
+   %
+   %  append  --  Add samples to the end of the signal
+   %     >> P = append(P,y);
+   %        * P.N must be a multiple of BASE
+   %
+   %  fromUniform  --  (Static) Pyramid of a long, uniformly sampled line
+   %     >> P = nigeLab.utils.MinMaxPyramid.fromUniform(x,y);
+   %        * Returns [] if numel(y) < MIN_LENGTH or x is not uniform
+   %
+   %  If the compiled MinMaxReduce_core kernel is available (see
+   %  nigeLab.utils.compileNativeKernels), the levels are built in
+   %  parallel blocks of bins; the output is the same.
+
+   % % % PROPERTIES % % % % % % % % % %
+   % CONSTANT,PUBLIC
+   properties (Constant,Access=public)
+      BASE        = 64     % Samples per bin of Levels{1}
+      FACTOR      = 4      % Bins of Levels{k} per bin of Levels{k+1}
+      CHUNK       = 2^20   % Samples per read of a DiskData stream
+      MIN_LENGTH  = 2^20   % Shortest line for which fromUniform builds one
+   end
+
+   % PUBLIC/PRIVATE
+   properties (GetAccess=public,SetAccess=private)
+      Levels      = {}     % [min max] of bins of BASE*FACTOR^(k-1) samples
+      N     (1,1) double = 0  % Number of samples
+   end
+
+   % PUBLIC
+   properties (Access=public)
+      Source            = []  % Signal vector or DiskData stream
+      X0    (1,1) double = 1  % Position of the first sample
+      DX    (1,1) double = 1  % Spacing of samples
+   end
+   % % % % % % % % % % END PROPERTIES %
+
+   % % % METHODS% % % % % % % % % % % %
+   % PUBLIC
+   methods (Access=public)
+      % Class constructor
+      function P = MinMaxPyramid(y,x0,dx)
+         %MINMAXPYRAMID  Build min/max pyramid of signal y
+         %
+         %  P = nigeLab.utils.MinMaxPyramid(y);
+         %  P = nigeLab.utils.MinMaxPyramid(y,x0,dx);
+
+         if nargin < 1
+            return;
+         end
+         if nargin > 2
+            P.X0 = x0;
+            P.DX = dx;
+         end
+
+         P.Source = y;
+         if isa(y,'nigeLab.libs.DiskData')
+            n = length(y);
+            for i0 = 1:P.CHUNK:n
+               P = appendBins(P,y(i0:min(i0+P.CHUNK-1,n)));
+            end
+         else
+            P = appendBins(P,y);
+         end
+         P = buildLevels(P);
+      end
+
+      % Add samples to the end of the signal
+      function P = append(P,y)
+         %APPEND  Add samples to the end of the signal
+         %
+         %  P = append(P,y);
+         %  --> If .Source is a vector, y is appended to it too (a
+         %      DiskData .Source is expected to have been appended to)
+
+         if isnumeric(P.Source)
+            P.Source = [reshape(P.Source,[],1); y(:)];
+         end
+         P = buildLevels(appendBins(P,y));
+      end
+
+      % Min/max decimation for display on width pixels
+      function [xr,yr] = reduce(P,width,lims)
+         %REDUCE  Min/max decimation for display on width pixels
+         %
+         %  [xr,yr] = reduce(P,width,lims);
+         %  --> Same form as nigeLab.utils.reduce_to_width(x,y,width,lims)
+
+         if P.N == 0
+            xr = zeros(0,1);
+            yr = zeros(0,1);
+            return;
+         end
+
+         % Samples i0:i1 cover lims, with the neighbour outside each end
+         i0 = min(max(floor((lims(1) - P.X0)/P.DX) + 1,1),P.N);
+         i1 = max(min(ceil((lims(2) - P.X0)/P.DX) + 1,P.N),i0);
+
+         % Coarsest level with at least one bin per pixel
+         k = floor(log((i1-i0+1)/(width*P.BASE))/log(P.FACTOR)) + 1;
+         k = min(k,numel(P.Levels));
+         if k < 1 && ~isempty(P.Source)
+            src = P.Source;
+            y = src(i0:i1);
+            x = P.X0 + ((i0:i1).' - 1)*P.DX;
+            [xr,yr] = nigeLab.utils.reduce_to_width(x,y(:),width,lims);
+            return;
+         end
+         k = max(k,1);
+
+         % Both extremes of each bin at its centre, in [min max] order
+         B = P.BASE * P.FACTOR^(k-1);
+         b = ((floor((i0-1)/B)+1):ceil(i1/B)).';
+         M = P.Levels{k}(b,:);
+         xc = P.X0 + (((b-1)*B + min(b*B,P.N) - 1)/2)*P.DX;
+         x = reshape([xc, xc].',[],1);
+         y = reshape(M.',[],1);
+         [xr,yr] = nigeLab.utils.reduce_to_width(x,y,width,lims);
+      end
+   end
+
+   % PRIVATE
+   methods (Access=private)
+      % Add the bins of the next samples to Levels{1}
+      function P = appendBins(P,y)
+         %APPENDBINS  Add [min max] of bins of BASE samples of y
+         %
+         %  P = appendBins(P,y);
+
+         if mod(P.N,P.BASE) ~= 0
+            error(['nigeLab:' mfilename ':Unaligned'],...
+               ['[MINMAXPYRAMID]: Samples can only be appended after ' ...
+               'a multiple of %g samples (N = %g)'],P.BASE,P.N);
+         end
+         y = y(:);
+         if ~isfloat(y)
+            y = double(y);
+         end
+         if isempty(y)
+            return;
+         end
+         if isempty(P.Levels)
+            P.Levels = {zeros(0,2,'like',y)};
+         end
+         P.Levels{1} = [P.Levels{1}; ...
+            nigeLab.utils.MinMaxPyramid.minMaxBins(y,P.BASE)];
+         P.N = P.N + numel(y);
+      end
+
+      % (Re)build the coarser levels from Levels{1}
+      function P = buildLevels(P)
+         %BUILDLEVELS  Levels{k+1} from Levels{k}, down to a single bin
+         %
+         %  P = buildLevels(P);
+
+         P.Levels(2:end) = [];
+         while ~isempty(P.Levels) && (size(P.Levels{end},1) > 1)
+            P.Levels{end+1} = nigeLab.utils.MinMaxPyramid.minMaxBins(...
+               P.Levels{end},P.FACTOR);
+         end
+      end
+   end
+
+   % STATIC,PUBLIC
+   methods (Static,Access=public)
+      % Pyramid of a long line with uniformly spaced x, or []
+      function P = fromUniform(x,y)
+         %FROMUNIFORM  Pyramid of a long, uniformly sampled line
+         %
+         %  P = nigeLab.utils.MinMaxPyramid.fromUniform(x,y);
+         %  --> Returns [] if numel(y) < MIN_LENGTH, or if the spacing of
+         %      x varies by more than 1/1000 of a sample
+
+         P = [];
+         n = numel(y);
+         if (n < nigeLab.utils.MinMaxPyramid.MIN_LENGTH) || (numel(x) ~= n)
+            return;
+         end
+         dx = (double(x(end)) - double(x(1))) / (n - 1);
+         if ~(dx > 0) || (max(abs(diff(double(x(:))) - dx)) > 1e-3*dx)
+            return;
+         end
+         P = nigeLab.utils.MinMaxPyramid(y,double(x(1)),dx);
+      end
+   end
+
+   % STATIC,PRIVATE
+   methods (Static,Access=private)
+      % [min max] of bins of B rows of samples or of [min max] pairs
+      function M = minMaxBins(y,B)
+         %MINMAXBINS  [min max] of each bin of B rows (NaN ignored)
+         %
+         %  M = nigeLab.utils.MinMaxPyramid.minMaxBins(y,B);
+         %  --> y : Column of samples or n x 2 [min max] of finer bins
+
+         if exist('MinMaxReduce_core','file')==3
+            M = MinMaxReduce_core('bins',y,B);
+            return;
+         end
+
+         n = size(y,1);
+         nBin = ceil(n/B);
+         pad = nan(nBin*B - n,1,'like',y);
+         lo = reshape([y(:,1); pad],B,nBin);
+         hi = reshape([y(:,end); pad],B,nBin);
+         M = [min(lo,[],1).', max(hi,[],1).'];
+      end
+   end
+   % % % % % % % % % % END METHODS% % %
+end
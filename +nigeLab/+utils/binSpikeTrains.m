@@ -0,0 +1,82 @@
+function [counts,rate,psth] = binSpikeTrains(ts,align,edges,sigma)
+%BINSPIKETRAINS  Trial-aligned spike counts, rates and PSTHs of many units
+%
+%  counts = nigeLab.utils.binSpikeTrains(ts,align,edges);
+%  [counts,rate,psth] = nigeLab.utils.binSpikeTrains(ts,align,edges);
+%  [counts,rate,psth] = nigeLab.utils.binSpikeTrains(ts,align,edges,sigma);
+%
+%  ts     : Spike times of each unit (cell array of nUnit vectors; a
+%           single vector for one unit), e.g. from getSpikeTimes
+%  align  : nTrial alignment times, in the same units as ts (e.g. event
+%           times from getEventData). NaN trials have no spikes.
+%  edges  : nBin+1 increasing bin edges, relative to align
+%  sigma  : (Optional) SD, in bins, of the Gaussian that smooths rate
+%           (default: 0, no smoothing)
+%
+%  counts : nTrial x nBin x nUnit spike counts (bins as histcounts of
+%           ts - align(iTrial))
+%  rate   : counts ./ diff(edges) (spikes/s for times in seconds),
+%           smoothed along bins if sigma > 0
+%  psth   : nBin x nUnit mean rate over the non-NaN trials
+%
+%  If the compiled SpikeBins_core kernel is available (see
+%  nigeLab.utils.compileNativeKernels), each trial window is located by
+%  binary search in the (sorted) spike times and units are binned in
+%  parallel; the output is the same.
+
+if nargin < 4
+   sigma = 0;
+end
+if ~iscell(ts)
+   ts = {ts};
+end
+align = double(align(:));
+edges = double(edges(:).');
+
+if exist('SpikeBins_core','file')==3
+   ts = cellfun(@double,ts,'UniformOutput',false);
+   switch nargout
+      case {0,1}
+         counts = SpikeBins_core(ts,align,edges,sigma);
+      case 2
+         [counts,rate] = SpikeBins_core(ts,align,edges,sigma);
+      otherwise
+         [counts,rate,psth] = SpikeBins_core(ts,align,edges,sigma);
+   end
+   return;
+end
+
+nTrial = numel(align);
+nBin = numel(edges) - 1;
+nUnit = numel(ts);
+counts = zeros(nTrial,nBin,nUnit);
+for iU = 1:nUnit
+   t = sort(double(ts{iU}(:)));
+   for iT = 1:nTrial
+      if isnan(align(iT))
+         continue;
+      end
+      lo = find(t >= (align(iT) + edges(1)),1,'first');
+      hi = find(t <= (align(iT) + edges(end)),1,'last');
+      if isempty(lo) || isempty(hi) || hi < lo
+         continue;
+      end
+      counts(iT,:,iU) = histcounts(t(max(lo-1,1):min(hi+1,end)) - align(iT),edges);
+   end
+end
+
+if nargout < 2
+   return;
+end
+rate = counts ./ diff(edges);
+if sigma > 0
+   h = ceil(4*sigma);
+   g = exp(-0.5*((-h:h)/sigma).^2);
+   g = reshape(g / sum(g),1,[]);
+   for iU = 1:nUnit
+      rate(:,:,iU) = conv2(rate(:,:,iU),g,'same');
+   end
+end
+psth = reshape(mean(rate(~isnan(align),:,:),1),nBin,nUnit);
+
+end
@@ -0,0 +1,95 @@
+function T = combineIntervals(A,B,op,gap)
+%COMBINEINTERVALS  Union or intersection of two lists of intervals
+%
+%  T = nigeLab.utils.combineIntervals(A,B,'union');
+%  --> Sorted, disjoint intervals covering every point in A or in B
+%
+%  T = nigeLab.utils.combineIntervals(A,B,'intersect');
+%  --> Sorted, disjoint intervals covering every point in both A and B
+%
+%  T = nigeLab.utils.combineIntervals(A);
+%  --> Same as combineIntervals(A,[],'union'): sorts A and merges its
+%      overlapping intervals
+%
+%  T = nigeLab.utils.combineIntervals(A,B,'union',gap);
+%  --> Also merges intervals separated by at most gap. Use gap = 1 for
+%      sample indices, so that touching intervals ([1 5] and [6 9]) are
+%      merged into one ([1 9])
+%
+%  A, B : nA x 2 and nB x 2 [start stop] closed intervals (times or
+%         sample indices), in any order and possibly overlapping
+%  gap  : (Optional) largest gap merged by 'union' (default: 0)
+%  T    : nT x 2 [start stop]
+%
+%  If the compiled PointProcess_core kernel is available (see
+%  nigeLab.utils.compileNativeKernels), both lists are combined in one
+%  merge pass; the output is the same.
+
+if nargin < 2
+   B = zeros(0,2);
+end
+if nargin < 3
+   op = 'union';
+end
+if nargin < 4
+   gap = 0;
+end
+op = lower(op);
+if ~ismember(op,{'union','intersect'})
+   error(['nigeLab:' mfilename ':BadOp'],...
+      '[COMBINEINTERVALS]: Unknown operation: %s',op);
+end
+if isempty(A)
+   A = zeros(0,2);
+end
+if isempty(B)
+   B = zeros(0,2);
+end
+
+if exist('PointProcess_core','file')==3
+   if strcmp(op,'union')
+      T = PointProcess_core(op,double(A),double(B),gap);
+   else
+      T = PointProcess_core(op,double(A),double(B));
+   end
+   return;
+end
+
+A = mergeIntervals(double(A),0);
+B = mergeIntervals(double(B),0);
+switch op
+   case 'union'
+      T = mergeIntervals([A; B],gap);
+   case 'intersect'
+      T = zeros(0,2);
+      i = 1;
+      j = 1;
+      while i <= size(A,1) && j <= size(B,1)
+         lo = max(A(i,1),B(j,1));
+         hi = min(A(i,2),B(j,2));
+         if lo <= hi
+            T(end+1,:) = [lo hi]; %#ok<AGROW>
+         end
+         if A(i,2) < B(j,2)
+            i = i + 1;
+         else
+            j = j + 1;
+         end
+      end
+end
+
+end
+
+function T = mergeIntervals(A,gap)
+% MERGEINTERVALS  Sort intervals and merge the ones that overlap (or are
+%                 separated by at most gap)
+A = sortrows(A(A(:,1) <= A(:,2),:));
+T = zeros(0,2);
+for i = 1:size(A,1)
+   if ~isempty(T) && A(i,1) <= T(end,2) + gap
+      T(end,2) = max(T(end,2),A(i,2));
+   else
+      T(end+1,:) = A(i,:); %#ok<AGROW>
+   end
+end
+end
@@ -0,0 +1,95 @@
+function flag = compileNativeKernels(name,varargin)
+%COMPILENATIVEKERNELS  Compile the nigeLab native (MEX) kernels
+%
+%  flag = nigeLab.utils.compileNativeKernels();
+%  --> Compiles every kernel listed in SRC (below)
+%
+%  flag = nigeLab.utils.compileNativeKernels('StreamCodec_core');
+%  --> Compiles only the named kernel(s) (char or cellstr)
+%
+%  flag = nigeLab.utils.compileNativeKernels(___,'-debug');
+%  --> Any additional char arguments are passed to MEX
+%
+%  Kernels are compiled next to their source file, so that kernels in a
+%  class `private` folder are only visible to that class (as for
+%  SpikeDetection_PTSD_core). Shared headers are in +utils/native.
+%
+%  Every MATLAB caller checks for the compiled kernel and falls back on
+%  the original MATLAB implementation if it is missing, so compiling is
+%  optional unless a feature explicitly requires it (for example the
+%  'lpc' DiskData codec, or the nigeLab.utils.robustStats sketch modes).
+%
+%  flag : Logical array, true for each kernel compiled successfully
+%
+%  Requires a C++11 compiler configured via `mex -setup C++`
+
+% List of kernel sources (relative to +nigeLab)
+SRC = { ...
+   fullfile('+libs','@DiskData','private','StreamCodec_core.cpp') ...
+   fullfile('+libs','@DiskData','private','EventIndex_core.cpp') ...
+   fullfile('+libs','@DiskData','private','PageCache_core.cpp') ...
+   fullfile('+libs','private','PeakSeek_core.cpp') ...
+   fullfile('@Block','private','SpikeDetection_SNEO_core.cpp') ...
+   fullfile('@Block','private','SpikeDetection_SWTTEO_core.cpp') ...
+   fullfile('@Block','private','SpikeDetection_TIFCO_core.cpp') ...
+   fullfile('@Block','private','WaveletFeatures_core.cpp') ...
+   fullfile('@Block','private','PcaFeatures_core.cpp') ...
+   fullfile('@Block','private','TimeFrequency_core.cpp') ...
+   fullfile('@Block','private','ChannelStats_core.cpp') ...
+   fullfile('@Block','private','ArtifactBlanking_core.cpp') ...
+   fullfile('@Block','private','StimSuppress_core.cpp') ...
+   fullfile('+utils','private','RobustStats_core.cpp') ...
+   fullfile('+utils','private','KnnGraph_core.cpp') ...
+   fullfile('+utils','private','SlidingXcorr_core.cpp') ...
+   fullfile('+utils','private','PointProcess_core.cpp') ...
+   fullfile('+utils','private','SpikeBins_core.cpp') ...
+   fullfile('+utils','private','Correlogram_core.cpp') ...
+   fullfile('+utils','private','MinMaxReduce_core.cpp') ...
+   fullfile('+utils','private','SpikeDensity_core.cpp') ...
+   fullfile('+utils','+SPC','private','SPC_core.cpp') ...
+   fullfile('+utils','+InPolygon','InPolygon.cpp') ...
+   };
+
+if nargin < 1
+   name = {};
+elseif ischar(name)
+   name = {name};
+end
+
+root = fileparts(fileparts(mfilename('fullpath'))); % +nigeLab folder
+inc = fullfile(root,'+utils','native');
+
+if ~isempty(name)
+   [~,srcName] = cellfun(@fileparts,SRC,'UniformOutput',false);
+   SRC = SRC(ismember(srcName,name));
+   if isempty(SRC)
+      error(['nigeLab:' mfilename ':BadKernel'],...
+         '[COMPILENATIVEKERNELS]: No kernel source matches the request');
+   end
+end
+
+opts = {'-O','-largeArrayDims',['-I' inc]};
+if isunix
+   opts = [opts, {'CXXFLAGS=$CXXFLAGS -std=c++11 -pthread',...
+                  'LDFLAGS=$LDFLAGS -pthread'}];
+end
+opts = [opts, varargin];
+
+flag = false(size(SRC));
+for i = 1:numel(SRC)
+   src = fullfile(root,SRC{i});
+   [p,f] = fileparts(src);
+   nigeLab.utils.cprintf('Text','\t->\tCompiling ');
+   nigeLab.utils.cprintf('Keywords*','%s',f);
+   nigeLab.utils.cprintf('Text','...');
+   try
+      mex(opts{:},'-outdir',p,src);
+      flag(i) = true;
+      nigeLab.utils.cprintf('Keywords*','done\n');
+   catch me
+      nigeLab.utils.cprintf('Errors*','failed\n');
+      nigeLab.utils.cprintf('Errors','\t\t%s\n',me.message);
+   end
+end
+
+end
@@ -0,0 +1,115 @@
+function C = correlograms(ts,class,edges,varargin)
+%CORRELOGRAMS  Auto- and cross-correlograms of all clusters of spikes
+%
+%  C = nigeLab.utils.correlograms(ts,class,edges);
+%  --> C(k,a,b) is the number of pairs of distinct spikes i (cluster a)
+%      and j (cluster b) with edges(k) <= ts(j) - ts(i) < edges(k+1)
+%      (the last bin includes edges(end)). C(:,a,a) is the
+%      autocorrelogram (ACG) of cluster a; C(:,a,b) is the
+%      cross-correlogram (CCG) of a and b.
+%
+%  C = nigeLab.utils.correlograms(___,'Group',group,'NumClus',nClus);
+%  --> Only pairs of spikes with the same group (e.g. the Block index of
+%      each spike, as nigeLab.Sort spk.block) are counted, and C has
+%      nClus clusters (default: max(class)). Spikes with labels outside
+%      1 .. nClus are not counted.
+%
+%  C = nigeLab.utils.correlograms(___,'Counts',C,'Moved',subs,...
+%                                     'OldClass',oldClass);
+%  --> Update of C, the correlograms of the labels before the spikes
+%      subs moved from oldClass to their label in class (as
+%      nigeLab.libs.SpikeImage/UpdateClusterAssignments); the result is
+%      the same as a full recount with class.
+%
+%  ts    : Spike times (e.g. seconds); spikes of several channels can be
+%          combined, with distinct class labels, for CCGs across channels
+%  class : Cluster label of each spike
+%  edges : nBin+1 increasing lag bin edges (same units as ts)
+%
+%  If the compiled Correlogram_core kernel is available (see
+%  nigeLab.utils.compileNativeKernels), each spike is paired only with
+%  those within max(abs(edges)) of it in a sorted sweep run in parallel,
+%  and an update only revisits the pairs of the moved spikes; otherwise
+%  the same sweep is vectorized in MATLAB and updates are full recounts.
+%  The output is the same.
+
+p = struct('Group',[],'NumClus',[],'Counts',[],'Moved',[],'OldClass',[]);
+for iV = 1:2:numel(varargin)
+   switch lower(varargin{iV})
+      case 'group'
+         p.Group = varargin{iV+1};
+      case 'numclus'
+         p.NumClus = varargin{iV+1};
+      case 'counts'
+         p.Counts = varargin{iV+1};
+      case 'moved'
+         p.Moved = varargin{iV+1};
+      case 'oldclass'
+         p.OldClass = varargin{iV+1};
+      otherwise
+         error(['nigeLab:' mfilename ':BadParam'],...
+            '[CORRELOGRAMS]: Unknown parameter: %s',varargin{iV});
+   end
+end
+
+ts = double(ts(:));
+class = double(class(:));
+group = double(p.Group(:));
+edges = double(edges(:).');
+isUpdate = ~isempty(p.Counts);
+if islogical(p.Moved)
+   p.Moved = find(p.Moved);
+end
+if isUpdate
+   nClus = size(p.Counts,2);
+elseif isempty(p.NumClus)
+   nClus = max([class; 1]);
+else
+   nClus = p.NumClus;
+end
+
+if exist('Correlogram_core','file')==3
+   if isUpdate
+      C = Correlogram_core('update',ts,class,group,edges,double(p.Counts),...
+         double(p.Moved(:)),double(p.OldClass(:)));
+   else
+      C = Correlogram_core('full',ts,class,group,edges,nClus);
+   end
+   return;
+end
+
+% MATLAB implementation: pair each spike with the s-th next one, for
+% increasing s, until no pair of the same group is within reach
+nBin = numel(edges) - 1;
+if isempty(group)
+   group = zeros(size(ts));
+end
+keep = ~isnan(ts) & ~isnan(group) & (class >= 1) & (class <= nClus) & ...
+   (class == round(class));
+[~,order] = sortrows([group(keep) ts(keep)]);
+t = ts(keep);
+t = t(order);
+c = class(keep);
+c = c(order);
+g = group(keep);
+g = g(order);
+reach = max(abs(edges([1 end])));
+C = zeros(nBin,nClus,nClus);
+for s = 1:(numel(t)-1)
+   dt = t((1+s):end) - t(1:(end-s));
+   ok = (g((1+s):end) == g(1:(end-s))) & (dt <= reach);
+   if ~any(ok)
+      break;
+   end
+   a = c(1:(end-s));
+   b = c((1+s):end);
+   C = C + countPairs(discretize(dt(ok),edges),a(ok),b(ok));
+   C = C + countPairs(discretize(-dt(ok),edges),b(ok),a(ok));
+end
+
+   % Helper function: counts of lag bins k for pairs of clusters (a,b)
+   function n = countPairs(k,a,b)
+      in = ~isnan(k);
+      n = accumarray([k(in) a(in) b(in)],1,[nBin nClus nClus]);
+   end
+end
@@ -6,6 +6,11 @@ function ts = debouncePointProcess(ts,debounce)
 %
 %  ts  --  List of times or sample indices
 %  debounce  --  Debounce threshold, in units that correspond to ts.
+%
+%  Returns the sorted times (column), keeping each time that follows the
+%  previously kept one by at least debounce. Done in one pass (in the
+%  compiled PointProcess_core kernel, if available), instead of deleting
+%  elements one at a time.
 
 %Handle input
 if nargin < 2
@@ -24,16 +29,23 @@ if isinf(debounce)
    return;
 end
 
-%Use loop to iteratively remove ts based on time differences
+if exist('PointProcess_core','file')==3 && isa(ts,'double')
+   ts = PointProcess_core('debounce',ts,double(debounce));
+   return;
+end
+
+%Single pass: compare each time to the last one that was kept
 ts = sort(ts,'ascend');
 ts = reshape(ts,numel(ts),1); % Get fixed orientation
-idx = 1;
-while (idx < numel(ts))
-   if (ts(idx+1)-ts(idx)) < debounce
-      ts(idx+1) = [];
+keep = true(size(ts));
+last = 1;
+for idx = 2:numel(ts)
+   if (ts(idx)-ts(last)) < debounce
+      keep(idx) = false;
    else
-      idx = idx + 1;
+      last = idx;
    end
 end
+ts = ts(keep);
 
 end
\ No newline at end of file
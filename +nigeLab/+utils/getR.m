@@ -1,8 +1,9 @@
-function [R,lag] = getR(x,y,wLen)
+function [R,lag] = getR(x,y,wLen,mode)
 %% GETR  Get covariance matrix of two one-dimensional time-series.
 %
 %  R = nigeLab.utils.getR(x,y);
 %  R = nigeLab.utils.getR(x,y,wLen);
+%  [Rmax,bestLag] = nigeLab.utils.getR(x,y,wLen,'BestLag');
 %
 %  --------
 %   INPUTS
@@ -13,28 +14,80 @@ function [R,lag] = getR(x,y,wLen)
 %
 %    wLen      :     (Optional) window length (samples) default: 5000
 %
+%    mode      :     (Optional) 'Full' (default) or 'BestLag'. 'BestLag'
+%                       returns only the maximum of each column of R and
+%                       its lag (memory proportional to the number of
+%                       windows instead of (2*wLen-1) x windows).
+%
 %  --------
 %   OUTPUT
 %  --------
 %     R        :     Correlation matrix between x and y.
+%                    ('BestLag': 1 x nWindows max(R))
 %
 %    lag       :     Lags corresponding to rows of R.
+%                    ('BestLag': 1 x nWindows lag of max(R) per window)
+%
+%  If the compiled SlidingXcorr_core kernel is available (see
+%  nigeLab.utils.compileNativeKernels), each window is updated from the
+%  previous one in O(wLen) (with an exact FFT restart every 1024 windows)
+%  and windows run in parallel, instead of one xcorr per window.
 %
 % By: Max Murphy  v1.0  08/20/2018  Original version (R2017b)
 
 %% DEFAULTS
-if nargin < 3
+if nargin < 3 || isempty(wLen)
    wLen = 5000;
 end
 
+if nargin < 4
+   mode = 'full';
+end
+
+switch lower(mode)
+   case 'full'
+      best = false;
+   case 'bestlag'
+      best = true;
+   otherwise
+      error(['nigeLab:' mfilename ':BadMode'],...
+         '[GETR]: Unknown mode: %s',mode);
+end
+
 %% GET CORRELATION ON SERIES OF WINDOWS
-M = min(numel(x),numel(y)) - wLen + 1;
+if exist('SlidingXcorr_core','file')==3
+   if best
+      [R,lag] = SlidingXcorr_core(double(x),double(y),wLen,'best');
+   else
+      R = SlidingXcorr_core(double(x),double(y),wLen,'full');
+      lag = -(wLen-1):(wLen-1);
+   end
+   return;
+end
+
+M = max(min(numel(x),numel(y)) - wLen + 1,0);
 
-R = nan(2*wLen-1,M);
+if best
+   R = nan(1,M);
+   lag = nan(1,M);
+else
+   R = nan(2*wLen-1,M);
+end
+lagVec = -(wLen-1):(wLen-1);
 
 for iM = 1:M
    vec = iM:(iM+wLen-1);
-   [R(:,iM),lag] = xcorr(x(vec) - mean(x(vec)),y(vec) - mean(y(vec)));
+   r = xcorr(x(vec) - mean(x(vec)),y(vec) - mean(y(vec)));
+   if best
+      [R(iM),iMax] = max(r);
+      lag(iM) = lagVec(iMax);
+   else
+      R(:,iM) = r;
+   end
 end
 
-end
\ No newline at end of file
+if ~best
+   lag = lagVec;
+end
+
+end
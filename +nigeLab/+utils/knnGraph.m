@@ -0,0 +1,90 @@
+function [idx,d,E] = knnGraph(X,k,varargin)
+%KNNGRAPH  K-nearest-neighbour graph of points in feature space
+%
+%  [idx,d] = nigeLab.utils.knnGraph(X,k);
+%  --> idx(i,:) are the k nearest neighbours of X(i,:) (excluding i), by
+%      increasing distance; d(i,:) are their Euclidean distances
+%
+%  [idx,d,E] = nigeLab.utils.knnGraph(X,k,'Edges',type);
+%  --> Also returns undirected edges E = [i j dist] (i < j, sorted):
+%        'knn'        : i and j are neighbours (either way)
+%        'mutual'     : i and j are each other's neighbours
+%        'mst'        : Euclidean minimum spanning tree
+%        'mutual+mst' : union of the two (connected; the graph of SPC)
+%
+%  X : nPoints x nDims (double or single), e.g. spike features
+%  k : number of neighbours (at most nPoints-1)
+%
+%  If the compiled KnnGraph_core kernel is available (see
+%  nigeLab.utils.compileNativeKernels), neighbours and the spanning tree
+%  come from a KD-tree queried in parallel, without forming the nPoints x
+%  nPoints distance matrix; the result is the same.
+
+p = struct('Edges','none');
+for iV = 1:2:numel(varargin)
+   switch lower(varargin{iV})
+      case 'edges'
+         p.Edges = lower(varargin{iV+1});
+      otherwise
+         error(['nigeLab:' mfilename ':BadParam'],...
+            '[KNNGRAPH]: Unknown parameter: %s',varargin{iV});
+   end
+end
+if ~ismember(p.Edges,{'none','knn','mutual','mst','mutual+mst'})
+   error(['nigeLab:' mfilename ':BadEdges'],...
+      '[KNNGRAPH]: Unknown edge type: %s',p.Edges);
+end
+if nargout > 2 && strcmp(p.Edges,'none')
+   error(['nigeLab:' mfilename ':BadEdges'],...
+      '[KNNGRAPH]: Specify ''Edges'' to return E.');
+end
+
+if exist('KnnGraph_core','file')==3 && isfloat(X) && isreal(X) && ...
+      ~issparse(X)
+   if nargout > 2
+      [idx,d,E] = KnnGraph_core(X,k,p.Edges);
+   else
+      [idx,d] = KnnGraph_core(X,k);
+   end
+   return;
+end
+
+% MATLAB implementation: exhaustive search, in blocks of rows
+X = double(X);
+N = size(X,1);
+k = min(k,max(N-1,0));
+idx = zeros(N,k);
+d = zeros(N,k);
+sq = sum(X.^2,2);
+blockSize = max(1,floor(2^24/max(N,1)));
+for iStart = 1:blockSize:N
+   iB = iStart:min(iStart+blockSize-1,N);
+   D2 = max(sq(iB) + sq.' - 2*X(iB,:)*X.',0);
+   D2(sub2ind(size(D2),1:numel(iB),iB)) = inf; % Exclude each point
+   [D2,ord] = sort(D2,2); % Stable: ties by index
+   idx(iB,:) = ord(:,1:k);
+   d(iB,:) = sqrt(D2(:,1:k));
+end
+
+if nargout < 3
+   return;
+end
+i = repmat((1:N).',1,k);
+switch p.Edges
+   case 'knn'
+      E = unique(sort([i(:) idx(:)],2),'rows');
+   case {'mutual','mutual+mst'}
+      A = sparse(i(:),idx(:),true,N,N);
+      [a,b] = find(triu(A & A.'));
+      E = sortrows([a b]);
+   otherwise
+      E = zeros(0,2);
+end
+if ismember(p.Edges,{'mst','mutual+mst'}) && N > 1
+   D2 = max(sq + sq.' - 2*(X*X.'),0);
+   T = minspantree(graph(sqrt(D2),'upper'));
+   E = unique([E; sort(T.Edges.EndNodes,2)],'rows');
+end
+E = [E, sqrt(sum((X(E(:,1),:) - X(E(:,2),:)).^2,2))];
+
+end
@@ -11,6 +11,8 @@ function diskFile = makeDiskFile(diskPars,data)
 %     --> 'class' (class of output 'data' variable)
 %     --> 'size'  (size of the output 'data' variable)
 %     --> 'access' ('r' for 'read only' or 'w' for 'write')
+%     --> 'codec' (optional; 'deflate' (default) or 'lpc' for streams)
+%     --> 'writebehind' (optional; false (default) or true to queue writes)
 %
 %  diskFile: Output, which is a nigeLab.libs.DiskData object that points to
 %              where the data is on the disk.
@@ -41,6 +43,12 @@ end
 if ~isfield(diskPars,'verbose')
    diskPars.verbose = true;
 end
+if ~isfield(diskPars,'codec')
+   diskPars.codec = 'deflate';
+end
+if ~isfield(diskPars,'writebehind')
+   diskPars.writebehind = false;
+end
 
 % Then create new pre-allocated diskFile
 if nargin < 2
@@ -50,7 +58,9 @@ if nargin < 2
       'class',diskPars.class,...
       'size',diskPars.size,...
       'access',diskPars.access,...
-      'verbose',diskPars.verbose);
+      'verbose',diskPars.verbose,...
+      'codec',diskPars.codec,...
+      'writebehind',diskPars.writebehind);
 else
    diskFile = nigeLab.libs.DiskData(...
       diskPars.format,...
@@ -60,6 +70,8 @@ else
       'size',diskPars.size,...
       'access',diskPars.access,...
       'verbose',diskPars.verbose,...
+      'codec',diskPars.codec,...
+      'writebehind',diskPars.writebehind,...
       'overwrite',true);
 end
 end
\ No newline at end of file
@@ -114,6 +114,12 @@ end
       % Make assignment since these are not changed regardless:
       tStart(1:k) = ts_on;
       
+      % Smallest "stop" >= each "start": one sorted merge in the kernel
+      if exist('PointProcess_core','file')==3 && isa(ts_off,'double')
+         tStop(1:k) = PointProcess_core('pair',double(tStart(1:k)),ts_off);
+         return;
+      end
+      
       % Iterate on number of elements of `ts_on` (if N > numel(ts_on), then
       % the last [N - numel(ts_on)] rows are just `NaN`
       for i = 1:k
@@ -24,6 +24,11 @@ function ts_out = matchWindowedPointElements(ts_in,ts_match,window)
 %                 entries from ts_in, or no elements from ts_in at all (if
 %                 window is specified; in which case elements outside the
 %                 window are NaN). 
+%
+%  If the compiled PointProcess_core kernel is available (see
+%  nigeLab.utils.compileNativeKernels), both vectors are walked once in
+%  sorted order (O(n + m)) instead of scanning all of ts_in for each
+%  element of ts_match; the output is the same.
 
 %%
 if nargin < 3
@@ -37,6 +42,12 @@ if nargin < 2
 end
 
 %%
+if exist('PointProcess_core','file')==3
+   ts_out = PointProcess_core('match',double(ts_in),double(ts_match),...
+      double(window));
+   return;
+end
+
 ts_out = nan(numel(ts_match),1);
 for i = 1:numel(ts_match)
    [val,idx] = min(abs(ts_in - ts_match(i)));
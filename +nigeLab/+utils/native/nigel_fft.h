@@ -0,0 +1,179 @@
+/*=================================================================
+ *
+ * nigel_fft.h   Radix-2 complex FFT for nigeLab MEX kernels
+ *
+ * Header-only, no external library. A plan holds the twiddle factors
+ * for one power-of-two length and can be shared (read-only) by several
+ * nigel::parallelFor workers:
+ *
+ *    nigel::FFT plan(n);          -> plan for length n (power of 2)
+ *    plan.forward(x);             -> X(k) = sum(x(j) * exp(-2*pi*i*j*k/n))
+ *    plan.inverse(x);             -> x(j) = sum(X(k) * exp(2*pi*i*j*k/n))/n
+ *    plan.backward(x);            -> same as inverse, without the 1/n
+ *    nigel::FFT::nextPow2(m)      -> smallest power of 2 >= m
+ *
+ * Both transforms work in place on n std::complex<double> values, so
+ * they match MATLAB fft / ifft for a power-of-two length.
+ *
+ * A chirp-z plan evaluates the DFT of n real samples at K equally spaced
+ * frequencies only (f0, f0+df, ... in cycles/sample), e.g. one band of a
+ * spectrogram, with two FFTs of length nextPow2(n+K-1) (Bluestein):
+ *
+ *    nigel::ChirpZ cz(n, K, f0, df);
+ *    cz.transform(x, X, work);    -> X(k) = sum(x(j) * exp(-2*pi*i*j*(f0+k*df)))
+ *
+ * where work holds cz.workSize() values (one per worker).
+ *
+ *=================================================================*/
+
+#ifndef NIGEL_FFT_H
+#define NIGEL_FFT_H
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace nigel {
+
+typedef std::complex<double> cplx;
+
+/* a*b without the NaN/Inf recovery of operator* (much faster) */
+inline cplx cmul(const cplx &a, const cplx &b)
+{
+    return cplx(a.real() * b.real() - a.imag() * b.imag(),
+                a.real() * b.imag() + a.imag() * b.real());
+}
+
+class FFT {
+public:
+    explicit FFT(size_t n) : n_(n), w_(n > 1 ? n - 1 : 0)
+    {
+        /* Twiddles of each stage stored contiguously: stage len uses
+         * w_[len/2-1 + j] = exp(-2*pi*i*j/len), j = 0..len/2-1 */
+        const double PI = 3.14159265358979323846;
+        for (size_t len = 2; len <= n; len <<= 1)
+        {
+            size_t half = len / 2;
+            for (size_t j = 0; j < half; j++)
+            {
+                double a = -2.0 * PI * (double)j / (double)len;
+                w_[half - 1 + j] = cplx(std::cos(a), std::sin(a));
+            }
+        }
+    }
+
+    size_t size() const { return n_; }
+
+    void forward(cplx *x) const { transform(x); }
+
+    /* Inverse transform without the 1/n factor */
+    void backward(cplx *x) const
+    {
+        for (size_t i = 0; i < n_; i++) x[i] = std::conj(x[i]);
+        transform(x);
+        for (size_t i = 0; i < n_; i++) x[i] = std::conj(x[i]);
+    }
+
+    void inverse(cplx *x) const
+    {
+        backward(x);
+        double s = 1.0 / (double)n_;
+        for (size_t i = 0; i < n_; i++) x[i] *= s;
+    }
+
+    static size_t nextPow2(size_t m)
+    {
+        size_t n = 1;
+        while (n < m) n <<= 1;
+        return n;
+    }
+
+private:
+    size_t n_;
+    std::vector<cplx> w_;
+
+    void transform(cplx *x) const
+    {
+        size_t n = n_;
+        if (n < 2) return;
+
+        /* Bit-reversal permutation */
+        for (size_t i = 1, j = 0; i < n; i++)
+        {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1) j ^= bit;
+            j ^= bit;
+            if (i < j) std::swap(x[i], x[j]);
+        }
+
+        /* Butterflies */
+        for (size_t len = 2; len <= n; len <<= 1)
+        {
+            size_t half = len / 2;
+            const cplx *w = &w_[half - 1];
+            for (size_t i = 0; i < n; i += len)
+            {
+                cplx *a = x + i, *b = x + i + half;
+                for (size_t j = 0; j < half; j++)
+                {
+                    cplx v = cmul(b[j], w[j]);
+                    b[j] = a[j] - v;
+                    a[j] += v;
+                }
+            }
+        }
+    }
+};
+
+class ChirpZ {
+public:
+    ChirpZ(size_t n, size_t K, double f0, double df)
+        : n_(n), K_(K), fft_(FFT::nextPow2(n + (K > 0 ? K : 1) - 1)),
+          pre_(n), post_(K), v_(fft_.size(), cplx(0.0, 0.0))
+    {
+        const double PI = 3.14159265358979323846;
+        size_t L = fft_.size();
+        /* nk = (n^2 + k^2 - (k-n)^2) / 2; phases are reduced mod 2*pi
+         * before scaling so large n^2 keep full precision */
+        for (size_t j = 0; j < n; j++)
+        {
+            double a = std::fmod(2.0 * f0 * (double)j + df * (double)j * (double)j, 2.0);
+            pre_[j] = cplx(std::cos(PI * a), -std::sin(PI * a));
+        }
+        for (size_t k = 0; k < K; k++)
+        {
+            double a = std::fmod(df * (double)k * (double)k, 2.0);
+            post_[k] = cplx(std::cos(PI * a), -std::sin(PI * a));
+            v_[k] = std::conj(post_[k]);
+        }
+        for (size_t j = 1; j < n; j++)
+        {
+            double a = std::fmod(df * (double)j * (double)j, 2.0);
+            v_[L - j] = cplx(std::cos(PI * a), std::sin(PI * a));
+        }
+        fft_.forward(v_.data());
+    }
+
+    size_t workSize() const { return fft_.size(); }
+
+    void transform(const double *x, cplx *X, cplx *work) const
+    {
+        size_t L = fft_.size();
+        for (size_t j = 0; j < n_; j++) work[j] = pre_[j] * x[j];
+        for (size_t j = n_; j < L; j++) work[j] = cplx(0.0, 0.0);
+        fft_.forward(work);
+        for (size_t j = 0; j < L; j++) work[j] = cmul(work[j], v_[j]);
+        fft_.inverse(work);
+        for (size_t k = 0; k < K_; k++) X[k] = cmul(work[k], post_[k]);
+    }
+
+private:
+    size_t n_, K_;
+    FFT fft_;
+    std::vector<cplx> pre_, post_, v_;
+};
+
+} /* namespace nigel */
+
+#endif /* NIGEL_FFT_H */
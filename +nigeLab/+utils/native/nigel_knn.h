@@ -0,0 +1,401 @@
+/*=================================================================
+ *
+ * nigel_knn.h   Nearest-neighbour graphs for nigeLab MEX kernels
+ *
+ * Header-only. Points are stored row-major (point i is
+ * x[i*D .. i*D+D-1]), which keeps each distance computation in one
+ * cache line for the low-dimensional spike feature spaces used here:
+ *
+ *    nigel::sqDist(a, b, D)           -> squared Euclidean distance
+ *    nigel::KdTree(x, N, D)           -> KD-tree over the points (x is
+ *                                        not copied and must outlive it)
+ *    nigel::knnGraph(x, N, D, k, idx, d2, nT)
+ *                                     -> k nearest neighbours of every
+ *                                        point (idx[i*k + j], ascending
+ *                                        distance, ties by index; d2 holds
+ *                                        squared distances)
+ *    nigel::mutualEdges(idx, N, k, edges)
+ *                                     -> edges (i < j) where i and j are
+ *                                        in each other's neighbour list
+ *    nigel::minimumSpanningTree(x, N, D, edges, nT)
+ *                                     -> N-1 edges (i, j) of the
+ *                                        Euclidean minimum spanning tree
+ *
+ * Queries descend the KD-tree nearer child first and prune boxes that
+ * are farther than the current k-th neighbour, so a query costs about
+ * O(log N) for the 3-15 dimensional feature spaces of spike sorting
+ * (instead of O(N) for exhaustive search). Pruning is strict, so results
+ * are exactly those of exhaustive search, ties included. The spanning
+ * tree is built by Boruvka rounds: each round, every component except
+ * the largest finds its nearest point in another component with a
+ * KD-tree query that skips subtrees lying entirely in its own component.
+ *
+ * None of these call the mx* API.
+ *
+ *=================================================================*/
+
+#ifndef NIGEL_KNN_H
+#define NIGEL_KNN_H
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "nigel_threads.h"
+
+namespace nigel {
+
+inline double sqDist(const double *a, const double *b, size_t D)
+{
+    double s = 0;
+    for (size_t d = 0; d < D; d++)
+    {
+        double t = a[d] - b[d];
+        s += t * t;
+    }
+    return s;
+}
+
+/* (squared distance, index) candidates, ordered by distance then index */
+typedef std::pair<double, size_t> Neighbour;
+
+const size_t KNN_NONE = (size_t)-1;    /* No point / no single component */
+const size_t KNN_LEAF_SIZE = 16;       /* Max points in a KD-tree leaf */
+
+class KdTree {
+public:
+    KdTree(const double *x, size_t N, size_t D) : x_(x), N_(N), D_(D)
+    {
+        perm_.resize(N);
+        for (size_t i = 0; i < N; i++) perm_[i] = i;
+        if (N > 0) build(0, N);
+    }
+
+    size_t size() const { return N_; }
+    size_t dims() const { return D_; }
+    const double *point(size_t i) const { return x_ + i * D_; }
+    /* Points in leaf order (neighbouring entries are close in space) */
+    size_t order(size_t p) const { return perm_[p]; }
+
+    /* k nearest points to x(qi) other than qi itself, ascending. If comp
+     * is given, points with comp[j] == comp[qi] are skipped as well
+     * (nodeComp: component shared by all points of a node, or KNN_NONE).
+     * Points farther than maxD2 (squared) are not returned. */
+    void knn(size_t qi, size_t k, std::vector<Neighbour> &heap,
+             const size_t *comp = 0,
+             const std::vector<size_t> *nodeComp = 0,
+             double maxD2 = std::numeric_limits<double>::infinity()) const
+    {
+        heap.clear();
+        if (k == 0 || N_ == 0) return;
+        Query q = { point(qi), qi, k, comp, nodeComp,
+                    comp ? comp[qi] : KNN_NONE, maxD2, &heap };
+        search(0, boxDist(0, q.p), q);
+        std::sort_heap(heap.begin(), heap.end());
+    }
+
+    /* Component of every node: c if all its points have comp c, else KNN_NONE */
+    void nodeComponents(const size_t *comp, std::vector<size_t> &nodeComp) const
+    {
+        nodeComp.assign(lo_.size(), KNN_NONE);
+        for (size_t n = lo_.size(); n-- > 0; )
+        {
+            if (left_[n] == 0)
+            {
+                size_t c = comp[perm_[lo_[n]]];
+                for (size_t p = lo_[n] + 1; p < hi_[n] && c != KNN_NONE; p++)
+                    if (comp[perm_[p]] != c) c = KNN_NONE;
+                nodeComp[n] = c;
+            }
+            else
+            {
+                size_t a = nodeComp[left_[n]], b = nodeComp[right_[n]];
+                nodeComp[n] = (a == b) ? a : KNN_NONE;
+            }
+        }
+    }
+
+private:
+    struct Query {
+        const double *p;
+        size_t qi, k;
+        const size_t *comp;
+        const std::vector<size_t> *nodeComp;
+        size_t c;
+        double maxD2;
+        std::vector<Neighbour> *heap;
+    };
+
+    const double *x_;
+    size_t N_, D_;
+    std::vector<size_t> perm_;
+    std::vector<size_t> lo_, hi_, left_, right_; /* left_ == 0: leaf */
+    std::vector<double> box_;             /* [min(D) max(D)] of each node */
+
+    size_t build(size_t lo, size_t hi)
+    {
+        size_t n = lo_.size();
+        lo_.push_back(lo);
+        hi_.push_back(hi);
+        left_.push_back(0);
+        right_.push_back(0);
+        box_.resize(box_.size() + 2 * D_);
+        double *bmin = &box_[n * 2 * D_], *bmax = bmin + D_;
+        for (size_t d = 0; d < D_; d++)
+        {
+            bmin[d] = std::numeric_limits<double>::infinity();
+            bmax[d] = -std::numeric_limits<double>::infinity();
+        }
+        for (size_t p = lo; p < hi; p++)
+        {
+            const double *xp = point(perm_[p]);
+            for (size_t d = 0; d < D_; d++)
+            {
+                if (xp[d] < bmin[d]) bmin[d] = xp[d];
+                if (xp[d] > bmax[d]) bmax[d] = xp[d];
+            }
+        }
+        if (hi - lo <= KNN_LEAF_SIZE) return n;
+
+        /* Split the widest dimension at its median */
+        size_t dim = 0;
+        double w = -1;
+        for (size_t d = 0; d < D_; d++)
+        {
+            if (bmax[d] - bmin[d] > w)
+            {
+                w = bmax[d] - bmin[d];
+                dim = d;
+            }
+        }
+        if (w <= 0) return n; /* All points identical */
+        size_t mid = lo + (hi - lo) / 2;
+        const double *x = x_;
+        size_t D = D_;
+        std::nth_element(perm_.begin() + lo, perm_.begin() + mid,
+                         perm_.begin() + hi, [x, D, dim](size_t a, size_t b) {
+                             return x[a * D + dim] < x[b * D + dim];
+                         });
+        size_t l = build(lo, mid);
+        size_t r = build(mid, hi);
+        left_[n] = l;
+        right_[n] = r;
+        return n;
+    }
+
+    double boxDist(size_t n, const double *p) const
+    {
+        const double *bmin = &box_[n * 2 * D_], *bmax = bmin + D_;
+        double s = 0;
+        for (size_t d = 0; d < D_; d++)
+        {
+            double t = (p[d] < bmin[d]) ? bmin[d] - p[d]
+                     : (p[d] > bmax[d]) ? p[d] - bmax[d] : 0.0;
+            s += t * t;
+        }
+        return s;
+    }
+
+    bool full(const Query &q) const { return q.heap->size() == q.k; }
+
+    void search(size_t n, double bd, Query &q) const
+    {
+        if (q.nodeComp && (*q.nodeComp)[n] == q.c) return;
+        if (bd > q.maxD2 || (full(q) && bd > q.heap->front().first)) return;
+        if (left_[n] == 0)
+        {
+            std::vector<Neighbour> &heap = *q.heap;
+            for (size_t p = lo_[n]; p < hi_[n]; p++)
+            {
+                size_t j = perm_[p];
+                if (j == q.qi || (q.comp && q.comp[j] == q.c)) continue;
+                Neighbour c(sqDist(q.p, point(j), D_), j);
+                if (c.first > q.maxD2) continue;
+                if (heap.size() < q.k)
+                {
+                    heap.push_back(c);
+                    std::push_heap(heap.begin(), heap.end());
+                }
+                else if (c < heap.front())
+                {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.back() = c;
+                    std::push_heap(heap.begin(), heap.end());
+                }
+            }
+            return;
+        }
+        size_t a = left_[n], b = right_[n];
+        double da = boxDist(a, q.p), db = boxDist(b, q.p);
+        if (db < da)
+        {
+            std::swap(a, b);
+            std::swap(da, db);
+        }
+        search(a, da, q);
+        search(b, db, q);
+    }
+};
+
+/* k nearest neighbours (excluding the point itself) of all N points;
+ * points are queried in parallel */
+inline void knnGraph(const KdTree &tree, size_t k,
+                     std::vector<size_t> &idx, std::vector<double> &d2,
+                     unsigned nThreads = 0)
+{
+    size_t N = tree.size();
+    if (k > N - 1) k = (N > 0) ? N - 1 : 0;
+    idx.assign(N * k, 0);
+    d2.assign(N * k, 0.0);
+    if (k == 0) return;
+
+    parallelFor(N, [&](size_t p) {
+        size_t i = tree.order(p); /* Consecutive queries share tree paths */
+        std::vector<Neighbour> heap;
+        heap.reserve(k + 1);
+        tree.knn(i, k, heap);
+        for (size_t j = 0; j < k; j++)
+        {
+            idx[i * k + j] = heap[j].second;
+            d2[i * k + j] = heap[j].first;
+        }
+    }, nThreads);
+}
+
+inline void knnGraph(const double *x, size_t N, size_t D, size_t k,
+                     std::vector<size_t> &idx, std::vector<double> &d2,
+                     unsigned nThreads = 0)
+{
+    KdTree tree(x, N, D);
+    knnGraph(tree, k, idx, d2, nThreads);
+}
+
+/* Mutual neighbours of a knnGraph result (k per point), as i < j pairs
+ * in ascending order */
+inline void mutualEdges(const std::vector<size_t> &idx, size_t N, size_t k,
+                        std::vector< std::pair<size_t, size_t> > &edges)
+{
+    edges.clear();
+    for (size_t i = 0; i < N; i++)
+    {
+        for (size_t m = 0; m < k; m++)
+        {
+            size_t j = idx[i * k + m];
+            if (j < i) continue;
+            const size_t *nj = &idx[j * k];
+            if (std::find(nj, nj + k, i) != nj + k)
+                edges.push_back(std::make_pair(i, j));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+}
+
+/* Euclidean minimum spanning tree by Boruvka rounds (see above) */
+inline void minimumSpanningTree(const KdTree &tree,
+                                std::vector< std::pair<size_t, size_t> > &edges,
+                                unsigned nThreads = 0)
+{
+    size_t N = tree.size();
+    edges.clear();
+    if (N < 2) return;
+
+    struct Cand { double d; size_t a, b; };
+    std::vector<size_t> parent(N), comp(N), nodeComp, size(N);
+    for (size_t i = 0; i < N; i++) parent[i] = i;
+    /* Nearest point in another component found so far (KNN_NONE: only a
+     * lower bound on its distance is known) */
+    std::vector<Neighbour> near(N, Neighbour(0.0, KNN_NONE));
+    while (edges.size() < N - 1)
+    {
+        /* Component labels (roots) and the largest component */
+        std::fill(size.begin(), size.end(), 0);
+        for (size_t i = 0; i < N; i++)
+        {
+            size_t r = i;
+            while (parent[r] != r) r = parent[r];
+            for (size_t j = i; parent[j] != r; )
+            {
+                size_t nxt = parent[j];
+                parent[j] = r;
+                j = nxt;
+            }
+            comp[i] = r;
+            size[r]++;
+        }
+        size_t big = (size_t)(std::max_element(size.begin(), size.end()) - size.begin());
+        tree.nodeComponents(comp.data(), nodeComp);
+
+        /* Members of each component except the largest */
+        std::vector<size_t> roots, start(N + 1, 0), member(N);
+        for (size_t i = 0; i < N; i++) start[comp[i] + 1]++;
+        for (size_t r = 0; r < N; r++)
+        {
+            if (size[r] > 0 && r != big) roots.push_back(r);
+            start[r + 1] += start[r];
+        }
+        std::vector<size_t> pos(start.begin(), start.end() - 1);
+        for (size_t i = 0; i < N; i++) member[pos[comp[i]]++] = i;
+
+        /* Shortest edge from each component to another one, in (d2, min,
+         * max) order; the best edge so far bounds the following queries */
+        std::vector<Cand> best(roots.size());
+        parallelFor(roots.size(), [&](size_t m) {
+            size_t r = roots[m];
+            Cand c = { std::numeric_limits<double>::infinity(),
+                       KNN_NONE, KNN_NONE };
+            std::vector<Neighbour> heap;
+            for (size_t p = start[r]; p < start[r + 1]; p++)
+            {
+                size_t i = member[p];
+                Neighbour nn = near[i];
+                if (nn.second == KNN_NONE || comp[nn.second] == comp[i])
+                {
+                    /* Components only grow, so near[i].first still bounds
+                     * the distance to the nearest foreign point */
+                    if (nn.first > c.d) continue;
+                    tree.knn(i, 1, heap, comp.data(), &nodeComp, c.d);
+                    if (heap.empty())
+                    {
+                        near[i] = Neighbour(c.d, KNN_NONE);
+                        continue;
+                    }
+                    nn = near[i] = heap[0];
+                }
+                size_t a = std::min(i, nn.second);
+                size_t b = std::max(i, nn.second);
+                if (nn.first < c.d ||
+                    (nn.first == c.d && (a < c.a || (a == c.a && b < c.b))))
+                {
+                    c.d = nn.first;
+                    c.a = a;
+                    c.b = b;
+                }
+            }
+            best[m] = c;
+        }, nThreads);
+
+        for (size_t r = 0; r < best.size(); r++)
+        {
+            if (best[r].a == KNN_NONE) continue;
+            size_t ra = best[r].a, rb = best[r].b;
+            while (parent[ra] != ra) ra = parent[ra];
+            while (parent[rb] != rb) rb = parent[rb];
+            if (ra == rb) continue;
+            parent[std::max(ra, rb)] = std::min(ra, rb);
+            edges.push_back(std::make_pair(best[r].a, best[r].b));
+        }
+    }
+}
+
+inline void minimumSpanningTree(const double *x, size_t N, size_t D,
+                                std::vector< std::pair<size_t, size_t> > &edges,
+                                unsigned nThreads = 0)
+{
+    KdTree tree(x, N, D);
+    minimumSpanningTree(tree, edges, nThreads);
+}
+
+} /* namespace nigel */
+
+#endif /* NIGEL_KNN_H */
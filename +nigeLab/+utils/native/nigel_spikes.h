@@ -0,0 +1,268 @@
+/*=================================================================
+ *
+ * nigel_spikes.h   Shared spike-picking helpers for nigeLab MEX kernels
+ *
+ * Header-only. These reproduce the steps that the SD_* detectors in
+ * @Block/private share with nigeLab.libs.peakseek, so every native
+ * detector returns exactly what its MATLAB version returns:
+ *
+ *    nigel::suppressPeaks(locs, vals, minDist)
+ *                                     -> peakseek minpeakdist rule
+ *    nigel::pickSpikes(data, N, z, E, dataTh, minDist, pol, plp, out)
+ *                                     -> peakseek on the thresholded
+ *                                        signal z, then the peak-to-peak
+ *                                        step of SD_SNEO / SD_SWTTEO /
+ *                                        SD_TIFCO
+ *    nigel::runDetector(nlhs, plhs, X, detect)
+ *                                     -> gateway shared by the SD_*
+ *                                        kernels (vector or matrix input)
+ *
+ * The median and prctile thresholds come from nigel_stats.h.
+ *
+ * Only getChannel, spikeField and runDetector call the mx* API (on the
+ * MATLAB thread); everything else is safe to use from nigel::parallelFor
+ * workers.
+ *
+ *=================================================================*/
+
+#ifndef NIGEL_SPIKES_H
+#define NIGEL_SPIKES_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "mex.h"
+#include "nigel_stats.h"
+#include "nigel_threads.h"
+
+namespace nigel {
+
+/* Enforce minpeakdist on peaks (ascending locs, vals = x(locs)).
+ *
+ * Same result as the loop in peakseek.m: any two neighbouring peaks
+ * closer than minDist lose the smaller one (the left one on a tie), and
+ * all conflicts of one "layer" are resolved at once. Deleting a peak can
+ * only create a conflict between the two peaks that become neighbours,
+ * so only those pairs are checked for the next layer. */
+template <typename T>
+void suppressPeaks(std::vector<size_t> &locs, std::vector<T> &vals, double minDist)
+{
+    size_t nPk = locs.size();
+    if (!(minDist > 1) || nPk < 2) return;
+
+    const size_t NONE = (size_t)-1;
+    std::vector<size_t> prev(nPk), next(nPk);
+    std::vector<char> dead(nPk, 0), queued(nPk, 0);
+    for (size_t k = 0; k < nPk; k++)
+    {
+        prev[k] = (k == 0) ? NONE : k - 1;
+        next[k] = (k + 1 == nPk) ? NONE : k + 1;
+    }
+
+    /* Conflicting pairs (k, next[k]), identified by left peak k */
+    std::vector<size_t> pairs, doomed;
+    for (size_t k = 0; k + 1 < nPk; k++)
+    {
+        if ((double)(locs[k+1] - locs[k]) < minDist) pairs.push_back(k);
+    }
+
+    while (!pairs.empty())
+    {
+        /* Resolve every conflict of this layer against the same list */
+        doomed.clear();
+        for (size_t j = 0; j < pairs.size(); j++)
+        {
+            size_t a = pairs[j], b = next[a];
+            size_t d = (vals[a] <= vals[b]) ? a : b;
+            if (!dead[d])
+            {
+                dead[d] = 1;
+                doomed.push_back(d);
+            }
+        }
+
+        /* Unlink, then check only the pairs that the deletions created */
+        for (size_t j = 0; j < doomed.size(); j++)
+        {
+            size_t d = doomed[j];
+            if (prev[d] != NONE) next[prev[d]] = next[d];
+            if (next[d] != NONE) prev[next[d]] = prev[d];
+        }
+        pairs.clear();
+        for (size_t j = 0; j < doomed.size(); j++)
+        {
+            size_t a = prev[doomed[j]];
+            while (a != NONE && dead[a]) a = prev[a];
+            if (a == NONE || queued[a] || next[a] == NONE) continue;
+            if ((double)(locs[next[a]] - locs[a]) < minDist)
+            {
+                queued[a] = 1;
+                pairs.push_back(a);
+            }
+        }
+        for (size_t j = 0; j < pairs.size(); j++) queued[pairs[j]] = 0;
+    }
+
+    size_t m = 0;
+    for (size_t k = 0; k < nPk; k++)
+    {
+        if (dead[k]) continue;
+        locs[m] = locs[k];
+        vals[m++] = vals[k];
+    }
+    locs.resize(m);
+    vals.resize(m);
+}
+
+/* Detected spikes of one channel (1-based ts, as returned to MATLAB) */
+struct SpikeSet {
+    std::vector<double> ts, p2pamp, pmin, pW, E;
+};
+
+/* Peak picking shared by the SD_* detectors:
+ *
+ *    [ts,pmin] = peakseek(z, minDist, dataTh); pmin = pmin.*pol;
+ *    E = energy(ts);
+ *    pmax, Imax = max of data(ts-plp : ts+plp) (clipped to 1..N)
+ *    pW = abs(Imax-plp); p2pamp = pmax + pmin;  (pmax <= 0 excluded)
+ *
+ * z(i) is called once for each i = 0..N-1, in order, so the thresholded
+ * signal never has to be stored. data is anything that can be indexed
+ * with data[j], j = 0..N-1 (e.g. a pointer). */
+template <class Data, class ZFn>
+void pickSpikes(const Data &data, size_t N, ZFn z, const double *energy,
+                double dataTh, double minDist, double pol, ptrdiff_t plp,
+                SpikeSet &out)
+{
+    std::vector<size_t> locs;
+    std::vector<double> vals;
+    if (N >= 3)
+    {
+        double z0 = z(0), z1 = z(1);
+        for (size_t i = 1; i + 1 < N; i++)
+        {
+            double z2 = z(i + 1);
+            if (z1 >= z0 && z1 >= z2 && !(z1 <= dataTh))
+            {
+                locs.push_back(i);
+                vals.push_back(z1);
+            }
+            z0 = z1;
+            z1 = z2;
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < N; i++) z(i);
+    }
+    suppressPeaks<double>(locs, vals, minDist);
+
+    size_t m = locs.size();
+    out.ts.clear(); out.p2pamp.clear(); out.pmin.clear();
+    out.pW.clear(); out.E.clear();
+    for (size_t k = 0; k < m; k++)
+    {
+        ptrdiff_t t = (ptrdiff_t)locs[k];
+        double pmax = std::numeric_limits<double>::quiet_NaN();
+        ptrdiff_t iMax = 0;
+        for (ptrdiff_t o = -plp; o <= plp; o++)
+        {
+            ptrdiff_t j = t + o;
+            if (j < 0) j = 0;
+            if (j > (ptrdiff_t)N - 1) j = (ptrdiff_t)N - 1;
+            double v = data[j];
+            if (!std::isnan(v) && (std::isnan(pmax) || v > pmax))
+            {
+                pmax = v;
+                iMax = o + plp;
+            }
+        }
+        if (pmax <= 0) continue;
+        double pmin = vals[k] * pol;
+        out.ts.push_back((double)(t + 1));
+        out.pmin.push_back(pmin);
+        out.p2pamp.push_back(pmax + pmin);
+        out.pW.push_back(std::fabs((double)(iMax + 1 - plp)));
+        out.E.push_back(energy[t]);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MATLAB-thread helpers (these call the mx* API) */
+///////////////////////////////////////////////////////////////////////////
+
+/* Copies x[i] = X(first + i*step), i = 0..n-1, as double */
+inline void getChannel(const mxArray *X, size_t first, size_t step, size_t n,
+                       std::vector<double> &x)
+{
+    x.resize(n);
+    if (mxIsDouble(X))
+    {
+        const double *d = mxGetPr(X);
+        for (size_t i = 0; i < n; i++) x[i] = d[first + i*step];
+    }
+    else
+    {
+        const float *f = (const float *)mxGetData(X);
+        for (size_t i = 0; i < n; i++) x[i] = (double)f[first + i*step];
+    }
+}
+
+/* 1 x numel(v) double row, or [] */
+inline mxArray *spikeField(const std::vector<double> &v, bool empty)
+{
+    if (empty) return mxCreateDoubleMatrix(0, 0, mxREAL);
+    mxArray *a = mxCreateDoubleMatrix(1, v.size(), mxREAL);
+    double *d = mxGetPr(a);
+    for (size_t i = 0; i < v.size(); i++) d[i] = v[i];
+    return a;
+}
+
+/* Gateway shared by the SD_* kernels: [ts, p2pamp, pmin, pW, E] for a
+ * double or single vector, or (as nChannels x 1 cells, with channels
+ * processed in parallel) for a matrix with one channel per row.
+ *
+ * detect(x, out) runs on a worker; it returns false if the detector
+ * returns [] for all outputs (e.g. too few threshold crossings). */
+template <class Detect>
+void runDetector(int nlhs, mxArray *plhs[], const mxArray *X, Detect detect)
+{
+    if (mxIsComplex(X) || mxIsSparse(X) || !(mxIsDouble(X) || mxIsSingle(X)))
+        mexErrMsgIdAndTxt("nigeLab:SpikeDetection:BadClass",
+            "data must be real, full double or single.");
+
+    size_t nRow = mxGetM(X), nCol = mxGetN(X);
+    bool isVec = (nRow == 1 || nCol == 1);
+    size_t nCh = isVec ? 1 : nRow;
+    size_t N = isVec ? nRow * nCol : nCol;
+
+    std::vector< std::vector<double> > x(nCh);
+    for (size_t ch = 0; ch < nCh; ch++)
+        getChannel(X, ch, isVec ? 1 : nRow, N, x[ch]);
+    std::vector<SpikeSet> s(nCh);
+    std::vector<char> found(nCh, 0);
+    parallelFor(nCh, [&](size_t ch) {
+        found[ch] = detect(x[ch], s[ch]) ? 1 : 0;
+        std::vector<double>().swap(x[ch]);
+    });
+
+    int nOut = (nlhs < 1) ? 1 : ((nlhs > 5) ? 5 : nlhs);
+    for (int i = 0; i < nOut; i++)
+    {
+        if (!isVec) plhs[i] = mxCreateCellMatrix(nCh, 1);
+        for (size_t ch = 0; ch < nCh; ch++)
+        {
+            const std::vector<double> *v[5] = {&s[ch].ts, &s[ch].p2pamp,
+                &s[ch].pmin, &s[ch].pW, &s[ch].E};
+            mxArray *a = spikeField(*v[i], !found[ch]);
+            if (isVec) plhs[i] = a;
+            else mxSetCell(plhs[i], ch, a);
+        }
+    }
+}
+
+} /* namespace nigel */
+
+#endif /* NIGEL_SPIKES_H */
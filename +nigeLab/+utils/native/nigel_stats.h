@@ -0,0 +1,342 @@
+/*=================================================================
+ *
+ * nigel_stats.h   Shared robust statistics for nigeLab MEX kernels
+ *
+ * Header-only. Exact order statistics use linear-time selection
+ * (std::nth_element) on a scratch copy instead of a full sort, and
+ * match MATLAB to the last bit for double data:
+ *
+ *    nigel::medianInPlace(v)          -> median(v) (NaN if any NaN)
+ *    nigel::prctileInPlace(v, p)      -> prctile(v,p) (NaN ignored)
+ *    nigel::prctilesInPlace(v, p, nP, out)
+ *                                     -> prctile(v,p) for a vector p,
+ *                                        one selection pass per rank
+ *    nigel::madInPlace(v)             -> mad(v,1) (NaN ignored)
+ *
+ * All of these reorder v. For data that do not fit in memory (or that
+ * arrive in chunks), nigel::QuantileSketch keeps a KLL sketch: a stack
+ * of sorted "compactors" whose items stand for 2^level samples each.
+ * It uses O(k) memory, two sketches of the same k can be merged, and
+ * the rank of every quantile it returns is within about 2/k of the
+ * requested one (k = 200: ~1%; k = 2000: ~0.1%); mad() estimates
+ * mad(x,1) from the same items.
+ *
+ * Nothing here calls the mx* API, so it is safe to use from
+ * nigel::parallelFor workers.
+ *
+ *=================================================================*/
+
+#ifndef NIGEL_STATS_H
+#define NIGEL_STATS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace nigel {
+
+/* Removes NaN values from v */
+inline void dropNaN(std::vector<double> &v)
+{
+    v.erase(std::remove_if(v.begin(), v.end(),
+                           [](double a) { return std::isnan(a); }), v.end());
+}
+
+/* median(v) as in MATLAB; v is reordered */
+inline double medianInPlace(std::vector<double> &v)
+{
+    size_t n = v.size();
+    if (n == 0) return std::numeric_limits<double>::quiet_NaN();
+    for (size_t i = 0; i < n; i++)
+    {
+        if (std::isnan(v[i])) return v[i];
+    }
+    size_t h = n / 2;
+    std::nth_element(v.begin(), v.begin() + h, v.end());
+    double hi = v[h];
+    if (n % 2) return hi;
+    double lo = *std::max_element(v.begin(), v.begin() + h);
+    return lo + (hi - lo) / 2;
+}
+
+/* prctile(v,p) as in MATLAB ('exact' method) for every p[j], j < nP, of a
+ * NaN-free v. The needed ranks are selected in ascending order, each
+ * within the part of v above the previous one. v is reordered. */
+inline void selectPrctiles(std::vector<double> &v, const double *p, size_t nP,
+                           double *out)
+{
+    size_t n = v.size();
+    if (n == 0)
+    {
+        for (size_t j = 0; j < nP; j++)
+            out[j] = std::numeric_limits<double>::quiet_NaN();
+        return;
+    }
+
+    /* 1-based sorted position r of each p: interpolate v(k), v(k+1) */
+    std::vector<size_t> ranks;
+    std::vector<size_t> k(nP);
+    std::vector<double> f(nP);
+    for (size_t j = 0; j < nP; j++)
+    {
+        double r = p[j] / 100.0 * (double)n + 0.5;
+        if (!(r > 1)) r = 1;
+        if (r > (double)n) r = (double)n;
+        k[j] = (size_t)std::floor(r);
+        f[j] = r - (double)k[j];
+        ranks.push_back(k[j] - 1);
+        if (f[j] > 0) ranks.push_back(k[j]);
+    }
+    std::sort(ranks.begin(), ranks.end());
+    ranks.erase(std::unique(ranks.begin(), ranks.end()), ranks.end());
+
+    size_t lo = 0;
+    for (size_t i = 0; i < ranks.size(); i++)
+    {
+        std::nth_element(v.begin() + lo, v.begin() + ranks[i], v.end());
+        lo = ranks[i] + 1;
+    }
+    for (size_t j = 0; j < nP; j++)
+    {
+        double a = v[k[j] - 1];
+        out[j] = (f[j] > 0) ? a + f[j] * (v[k[j]] - a) : a;
+    }
+}
+
+/* prctile(v,p) for a vector p (NaN ignored); v is reordered */
+inline void prctilesInPlace(std::vector<double> &v, const double *p, size_t nP,
+                            double *out)
+{
+    dropNaN(v);
+    selectPrctiles(v, p, nP, out);
+}
+
+/* prctile(v,p) as in MATLAB ('exact' method, NaN ignored); v is reordered */
+inline double prctileInPlace(std::vector<double> &v, double p)
+{
+    double out;
+    prctilesInPlace(v, &p, 1, &out);
+    return out;
+}
+
+/* mad(v,1) = median(abs(v - median(v))), NaN ignored; v is reordered */
+inline double madInPlace(std::vector<double> &v)
+{
+    dropNaN(v);
+    if (v.empty()) return std::numeric_limits<double>::quiet_NaN();
+    double m = medianInPlace(v);
+    for (size_t i = 0; i < v.size(); i++) v[i] = std::fabs(v[i] - m);
+    return medianInPlace(v);
+}
+
+/* Mergeable KLL quantile sketch (see header). Level h holds items that
+ * each stand for 2^h samples; a full level is sorted and every other
+ * item (alternating between the odd and even ones) is promoted. */
+class QuantileSketch {
+public:
+    explicit QuantileSketch(size_t k = 200)
+        : k_(k < 8 ? 8 : k), n_(0),
+          min_(std::numeric_limits<double>::quiet_NaN()),
+          max_(std::numeric_limits<double>::quiet_NaN()) {}
+
+    size_t k() const { return k_; }
+    double count() const { return n_; }
+
+    /* Adds the non-NaN values of x[0..n-1] */
+    void add(const double *x, size_t n)
+    {
+        if (levels_.empty()) grow();
+        for (size_t i = 0; i < n; i++)
+        {
+            double v = x[i];
+            if (std::isnan(v)) continue;
+            if (n_ == 0 || v < min_) min_ = v;
+            if (n_ == 0 || v > max_) max_ = v;
+            n_ += 1;
+            levels_[0].push_back(v);
+            if (levels_[0].size() >= capacity(0)) compress();
+        }
+    }
+
+    /* Adds every sample summarized by another sketch */
+    void merge(const QuantileSketch &o)
+    {
+        if (o.n_ == 0) return;
+        if (n_ == 0 || o.min_ < min_) min_ = o.min_;
+        if (n_ == 0 || o.max_ > max_) max_ = o.max_;
+        n_ += o.n_;
+        while (levels_.size() < o.levels_.size()) grow();
+        for (size_t h = 0; h < o.levels_.size(); h++)
+            levels_[h].insert(levels_[h].end(), o.levels_[h].begin(),
+                              o.levels_[h].end());
+        compress();
+    }
+
+    /* Approximate prctile(x,p[j]) ('exact' ranks) of all added samples */
+    void prctiles(const double *p, size_t nP, double *out) const
+    {
+        std::vector< std::pair<double, double> > items; /* value, weight */
+        for (size_t h = 0; h < levels_.size(); h++)
+        {
+            double w = std::ldexp(1.0, (int)h);
+            for (size_t i = 0; i < levels_[h].size(); i++)
+                items.push_back(std::make_pair(levels_[h][i], w));
+        }
+        std::sort(items.begin(), items.end());
+        for (size_t j = 0; j < nP; j++)
+        {
+            if (n_ == 0)
+            {
+                out[j] = std::numeric_limits<double>::quiet_NaN();
+                continue;
+            }
+            double r = p[j] / 100.0 * n_ + 0.5;
+            if (!(r > 1)) { out[j] = min_; continue; }
+            if (r >= n_) { out[j] = max_; continue; }
+            double cum = 0;
+            out[j] = max_;
+            for (size_t i = 0; i < items.size(); i++)
+            {
+                cum += items[i].second;
+                if (cum >= r) { out[j] = items[i].first; break; }
+            }
+        }
+    }
+
+    /* Approximate mad(x,1) of all added samples: the median of
+     * abs(item - median) over the weighted items */
+    double mad() const
+    {
+        if (n_ == 0) return std::numeric_limits<double>::quiet_NaN();
+        double p = 50, m;
+        prctiles(&p, 1, &m);
+        std::vector< std::pair<double, double> > items;
+        for (size_t h = 0; h < levels_.size(); h++)
+        {
+            double w = std::ldexp(1.0, (int)h);
+            for (size_t i = 0; i < levels_[h].size(); i++)
+                items.push_back(std::make_pair(std::fabs(levels_[h][i] - m), w));
+        }
+        std::sort(items.begin(), items.end());
+        double r = 0.5 * n_ + 0.5, cum = 0;
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            cum += items[i].second;
+            if (cum >= r) return items[i].first;
+        }
+        return items.empty() ? 0.0 : items.back().first;
+    }
+
+    /* Flat representation [VERSION k n min max nLevels toggles(nLevels)
+     * sizes(nLevels) items...], so a sketch can live in a MATLAB array */
+    static const int VERSION = 1;
+
+    void serialize(std::vector<double> &s) const
+    {
+        size_t H = levels_.size();
+        s.clear();
+        s.push_back(VERSION);
+        s.push_back((double)k_);
+        s.push_back(n_);
+        s.push_back(min_);
+        s.push_back(max_);
+        s.push_back((double)H);
+        for (size_t h = 0; h < H; h++) s.push_back(toggle_[h]);
+        for (size_t h = 0; h < H; h++) s.push_back((double)levels_[h].size());
+        for (size_t h = 0; h < H; h++)
+            s.insert(s.end(), levels_[h].begin(), levels_[h].end());
+    }
+
+    /* Returns false if s is not a (consistent) serialized sketch */
+    bool deserialize(const double *s, size_t n)
+    {
+        if (n < 6 || s[0] != VERSION || !(s[1] >= 8) || !(s[2] >= 0)) return false;
+        double H = s[5];
+        if (!(H >= 0) || H != std::floor(H) || 6 + 2 * H > (double)n) return false;
+        size_t nH = (size_t)H, pos = 6 + 2 * nH, total = 0;
+        for (size_t h = 0; h < nH; h++)
+        {
+            double sz = s[6 + nH + h];
+            if (!(sz >= 0) || sz != std::floor(sz)) return false;
+            total += (size_t)sz;
+        }
+        if (pos + total != n) return false;
+
+        k_ = (size_t)s[1];
+        n_ = s[2];
+        min_ = s[3];
+        max_ = s[4];
+        toggle_.assign(nH, 0);
+        levels_.assign(nH, std::vector<double>());
+        for (size_t h = 0; h < nH; h++)
+        {
+            toggle_[h] = (s[6 + h] != 0) ? 1 : 0;
+            size_t sz = (size_t)s[6 + nH + h];
+            levels_[h].assign(s + pos, s + pos + sz);
+            pos += sz;
+        }
+        return true;
+    }
+
+private:
+    size_t k_;
+    double n_;
+    double min_, max_;
+    std::vector< std::vector<double> > levels_;
+    std::vector<char> toggle_;
+
+    void grow()
+    {
+        levels_.push_back(std::vector<double>());
+        toggle_.push_back(0);
+    }
+
+    /* Lower levels get geometrically (2/3) smaller capacity, min. 2 */
+    size_t capacity(size_t h) const
+    {
+        size_t depth = levels_.size() - 1 - h;
+        double c = std::ceil((double)k_ * std::pow(2.0 / 3.0, (double)depth));
+        return (c < 2) ? 2 : (size_t)c;
+    }
+
+    size_t totalCapacity() const
+    {
+        size_t c = 0;
+        for (size_t h = 0; h < levels_.size(); h++) c += capacity(h);
+        return c;
+    }
+
+    size_t size() const
+    {
+        size_t s = 0;
+        for (size_t h = 0; h < levels_.size(); h++) s += levels_[h].size();
+        return s;
+    }
+
+    /* Compacts the lowest full level until the sketch fits again */
+    void compress()
+    {
+        while (size() >= totalCapacity())
+        {
+            size_t h = 0;
+            while (levels_[h].size() < capacity(h)) h++;
+            if (h + 1 == levels_.size()) grow();
+
+            std::vector<double> &a = levels_[h];
+            std::sort(a.begin(), a.end());
+            size_t keep = a.size() % 2;        /* odd item stays here */
+            size_t off = (size_t)toggle_[h];
+            toggle_[h] ^= 1;
+            std::vector<double> &up = levels_[h + 1];
+            for (size_t i = keep + off; i < a.size(); i += 2) up.push_back(a[i]);
+            a.resize(keep);
+        }
+    }
+};
+
+} /* namespace nigel */
+
+#endif /* NIGEL_STATS_H */
@@ -0,0 +1,68 @@
+/*=================================================================
+ *
+ * nigel_threads.h   Shared worker-pool helpers for nigeLab MEX kernels
+ *
+ * Header-only. Compute loops are split across std::thread workers;
+ * workers must never call any mx* or mex* API function (those are
+ * only safe on the MATLAB thread), so each kernel copies its inputs
+ * and allocates its outputs before dispatching work here.
+ *
+ *    nigel::numThreads(nWork)          -> worker count for nWork items
+ *    nigel::parallelFor(nWork, fn)     -> calls fn(i) for i = 0..nWork-1
+ *    nigel::parallelFor(nWork, fn, nT) -> same, with explicit nT workers
+ *
+ * Work items are handed out dynamically (atomic counter), so uneven
+ * per-item cost (e.g. channels with very different spike counts)
+ * still balances across workers.
+ *
+ *=================================================================*/
+
+#ifndef NIGEL_THREADS_H
+#define NIGEL_THREADS_H
+
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace nigel {
+
+/* Number of workers to use for nWork independent items */
+inline unsigned numThreads(size_t nWork, unsigned requested = 0)
+{
+    unsigned nT = requested;
+    if (nT == 0)
+    {
+        nT = std::thread::hardware_concurrency();
+        if (nT == 0) nT = 1;
+    }
+    if (nWork < nT) nT = (unsigned)(nWork > 0 ? nWork : 1);
+    return nT;
+}
+
+/* Run fn(i) for every i in [0, nWork) across a pool of workers */
+template <class Fn>
+void parallelFor(size_t nWork, Fn fn, unsigned requested = 0)
+{
+    unsigned nT = numThreads(nWork, requested);
+    if (nT <= 1)
+    {
+        for (size_t i = 0; i < nWork; i++) fn(i);
+        return;
+    }
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> pool;
+    pool.reserve(nT);
+    for (unsigned t = 0; t < nT; t++)
+    {
+        pool.emplace_back([&]() {
+            size_t i;
+            while ((i = next.fetch_add(1)) < nWork) fn(i);
+        });
+    }
+    for (auto &th : pool) th.join();
+}
+
+} /* namespace nigel */
+
+#endif /* NIGEL_THREADS_H */
@@ -3,6 +3,7 @@ function VideoStartGuess = parseR(R,lag,fs,K)
 %
 %  VideoStartGuess = nigeLab.utils.ParseR(R,lag,fs);
 %  VideoStartGuess = nigeLab.utils.ParseR(R,lag,fs,K);
+%  VideoStartGuess = nigeLab.utils.ParseR([],bestLag,fs);
 %
 %  --------
 %   INPUTS
@@ -11,6 +12,8 @@ function VideoStartGuess = parseR(R,lag,fs,K)
 %                 probability estimates for the presence of grasping paw.
 %
 %    lag    :     Vector of lag values corresponding to rows of R.
+%                    (If R is empty: lag of the max of each column of R,
+%                     as returned by nigeLab.utils.getR(...,'BestLag'))
 %
 %     fs    :     Sample rate of resampled streams that were used in the
 %                    cross-correlation.
@@ -28,8 +31,12 @@ if nargin < 4
 end
 
 %%
-[~,maxR_i] = max(R);
-lagval = lag(maxR_i)/fs;
+if isempty(R)
+   lagval = lag/fs;
+else
+   [~,maxR_i] = max(R);
+   lagval = lag(maxR_i)/fs;
+end
 
 [nCount,edge] = histcounts(lagval);
 
@@ -0,0 +1,308 @@
+/*=================================================================
+ *
+ * CORRELOGRAM_CORE.CPP	.MEX file for nigeLab.utils.correlograms
+ *
+ * The calling syntax is:
+ *
+ *		C = Correlogram_core('full', ts, class, group, edges, nClus)
+ *		C = Correlogram_core('update', ts, class, group, edges, C, subs, oldClass)
+ *
+ *      ts:         N spike times (double)
+ *      class:      N cluster labels; only spikes with labels 1 .. nClus
+ *                  are counted
+ *      group:      N group labels (e.g. the Block of each spike); pairs
+ *                  are only counted within a group. Empty: one group
+ *      edges:      nBin+1 increasing lag edges (same units as ts)
+ *      nClus:      number of clusters
+ *
+ *      C:          nBin x nClus x nClus counts; C(k,a,b) is the number of
+ *                  pairs of distinct spikes i (in a) and j (in b) of the
+ *                  same group with edges(k) <= ts(j) - ts(i) < edges(k+1)
+ *                  (the last bin includes edges(end)). C(:,a,a) is the
+ *                  autocorrelogram of a, C(:,a,b) the cross-correlogram
+ *
+ *      'update':   C is the output for the labels before spikes subs
+ *                  (1-based) moved from oldClass to their label in class;
+ *                  returns the output for class
+ *
+ * Spikes are sorted by (group, time) once (skipped if they already are)
+ * and each spike is paired only with the spikes that follow it by at
+ * most max(abs(edges)), so the sweep costs O(N * spikes in the window)
+ * instead of the O(N^2) of all pairwise differences; blocks of spikes run
+ * in parallel. An update only revisits the pairs of the moved spikes:
+ * their contributions under the old labels are removed and those under
+ * the new labels added, so the cost is O(numel(subs) * spikes in the
+ * window) and the result equals a full recount.
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <math.h>
+#include <stddef.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "mex.h"
+#include "nigel_threads.h"
+
+/* Input Arguments */
+
+#define	MODE	prhs[0]
+#define	TS	prhs[1]
+#define	CLASS	prhs[2]
+#define	GROUP	prhs[3]
+#define	EDGES	prhs[4]
+#define	NCLUS	prhs[5]
+#define	C_IN	prhs[5]
+#define	SUBS	prhs[6]
+#define	OLDCLASS	prhs[7]
+
+/* Constants */
+
+static const size_t SPIKE_BLOCK = 4096;  /* Sorted spikes per work item */
+
+///////////////////////////////////////////////////////////////////////////
+/* Helpers */
+///////////////////////////////////////////////////////////////////////////
+
+/* Spikes sorted by (group, time); NaN last, ties by original index */
+struct Train {
+    std::vector<double> t, g;
+    std::vector<ptrdiff_t> c;      /* 0-based cluster, -1: not counted */
+    std::vector<size_t> pos;       /* pos[i]: sorted position of spike i */
+};
+
+struct Lags {
+    std::vector<double> e;
+    double reach;                  /* max(abs(edges)) */
+    size_t nBin, nClus;
+
+    /* Bin of lag v, or -1 if outside the edges */
+    ptrdiff_t bin(double v) const
+    {
+        if (!(v >= e[0]) || v > e[nBin]) return -1;
+        size_t k = (size_t)(std::upper_bound(e.begin(), e.end(), v) - e.begin());
+        return (k > nBin) ? (ptrdiff_t)nBin - 1 : (ptrdiff_t)k - 1;
+    }
+
+    /* Adds w times the pair (p, q), p before q, with labels cp and cq */
+    void add(double *C, const Train &s, size_t p, size_t q, ptrdiff_t cp,
+             ptrdiff_t cq, double w) const
+    {
+        if (cp < 0 || cq < 0) return;
+        double dt = s.t[q] - s.t[p];
+        ptrdiff_t k = bin(dt);
+        if (k >= 0) C[k + nBin * (cp + nClus * cq)] += w;
+        k = bin(-dt);
+        if (k >= 0) C[k + nBin * (cq + nClus * cp)] += w;
+    }
+};
+
+static bool lessNaN(double a, double b)
+{
+    if (a != a) return false;
+    if (b != b) return true;
+    return a < b;
+}
+
+static std::vector<double> getVector(const mxArray *A, const char *name)
+{
+    if (!mxIsEmpty(A) && (!mxIsDouble(A) || mxIsComplex(A) || mxIsSparse(A)))
+        mexErrMsgIdAndTxt("nigeLab:Correlogram:BadClass",
+            "%s must be a real, full double vector.", name);
+    const double *p = mxIsEmpty(A) ? 0 : mxGetPr(A);
+    return std::vector<double>(p, p + (p ? mxGetNumberOfElements(A) : 0));
+}
+
+static void prepareTrain(const mxArray *prhs[], size_t nClus, Train &s)
+{
+    std::vector<double> t = getVector(TS, "ts");
+    std::vector<double> label = getVector(CLASS, "class");
+    std::vector<double> g = getVector(GROUP, "group");
+    size_t N = t.size();
+    if (label.size() != N || (!g.empty() && g.size() != N))
+        mexErrMsgIdAndTxt("nigeLab:Correlogram:SizeMismatch",
+            "ts, class and group must have the same number of elements.");
+    if (g.empty()) g.assign(N, 0.0);
+
+    std::vector<size_t> order(N);
+    for (size_t i = 0; i < N; i++) order[i] = i;
+    bool isSorted = true;
+    for (size_t i = 1; i < N && isSorted; i++)
+        isSorted = (g[i] == g[i - 1]) ? !lessNaN(t[i], t[i - 1])
+                                      : lessNaN(g[i - 1], g[i]);
+    if (!isSorted)
+    {
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            if (g[a] == g[b] || (g[a] != g[a] && g[b] != g[b]))
+                return lessNaN(t[a], t[b]);
+            return lessNaN(g[a], g[b]);
+        });
+    }
+    s.t.resize(N);
+    s.g.resize(N);
+    s.c.resize(N);
+    s.pos.resize(N);
+    for (size_t p = 0; p < N; p++)
+    {
+        size_t i = order[p];
+        s.t[p] = t[i];
+        s.g[p] = g[i];
+        s.pos[i] = p;
+    }
+    for (size_t i = 0; i < N; i++)
+    {
+        double c = label[i];
+        s.c[s.pos[i]] = (c >= 1 && c <= (double)nClus && c == floor(c) && t[i] == t[i])
+                        ? (ptrdiff_t)c - 1 : -1;
+    }
+}
+
+static Lags getLags(const mxArray *A)
+{
+    if (!mxIsDouble(A) || mxIsComplex(A))
+        mexErrMsgIdAndTxt("nigeLab:Correlogram:BadEdges",
+            "edges must be a real double vector.");
+    Lags L;
+    L.e.assign(mxGetPr(A), mxGetPr(A) + mxGetNumberOfElements(A));
+    if (L.e.size() < 2)
+        mexErrMsgIdAndTxt("nigeLab:Correlogram:BadEdges",
+            "edges must have at least 2 elements.");
+    L.nBin = L.e.size() - 1;
+    for (size_t k = 0; k < L.nBin; k++)
+        if (!(L.e[k + 1] > L.e[k]))
+            mexErrMsgIdAndTxt("nigeLab:Correlogram:BadEdges",
+                "edges must be strictly increasing.");
+    L.reach = std::max(fabs(L.e[0]), fabs(L.e[L.nBin]));
+    return L;
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* Modes */
+///////////////////////////////////////////////////////////////////////////
+
+static void doFull(int nrhs, const mxArray *prhs[], mxArray *plhs[])
+{
+    if (nrhs != 6)
+        mexErrMsgIdAndTxt("nigeLab:Correlogram:BadInput",
+            "Requires ('full', ts, class, group, edges, nClus).");
+    Lags L = getLags(EDGES);
+    double k = mxGetScalar(NCLUS);
+    if (!(k >= 1) || k != floor(k))
+        mexErrMsgIdAndTxt("nigeLab:Correlogram:BadNumClus",
+            "nClus must be a positive integer.");
+    L.nClus = (size_t)k;
+    Train s;
+    prepareTrain(prhs, L.nClus, s);
+
+    mwSize dims[3] = { (mwSize)L.nBin, (mwSize)L.nClus, (mwSize)L.nClus };
+    plhs[0] = mxCreateNumericArray(3, dims, mxDOUBLE_CLASS, mxREAL);
+    double *C = mxGetPr(plhs[0]);
+    size_t nC = L.nBin * L.nClus * L.nClus;
+
+    /* Each block counts into its own tensor; summed afterwards */
+    size_t N = s.t.size();
+    size_t nBlock = (N + SPIKE_BLOCK - 1) / SPIKE_BLOCK;
+    std::vector< std::vector<double> > part(nBlock);
+    nigel::parallelFor(nBlock, [&](size_t b) {
+        size_t p0 = b * SPIKE_BLOCK;
+        size_t p1 = (p0 + SPIKE_BLOCK < N) ? p0 + SPIKE_BLOCK : N;
+        std::vector<double> &Cb = part[b];
+        Cb.assign(nC, 0.0);
+        for (size_t p = p0; p < p1; p++)
+        {
+            if (s.c[p] < 0) continue;
+            for (size_t q = p + 1; q < N && s.g[q] == s.g[p]; q++)
+            {
+                if (!(s.t[q] - s.t[p] <= L.reach)) break;
+                L.add(Cb.data(), s, p, q, s.c[p], s.c[q], 1.0);
+            }
+        }
+    });
+    for (size_t b = 0; b < nBlock; b++)
+        for (size_t m = 0; m < nC; m++) C[m] += part[b][m];
+}
+
+static void doUpdate(int nrhs, const mxArray *prhs[], mxArray *plhs[])
+{
+    if (nrhs != 8)
+        mexErrMsgIdAndTxt("nigeLab:Correlogram:BadInput",
+            "Requires ('update', ts, class, group, edges, C, subs, oldClass).");
+    Lags L = getLags(EDGES);
+    if (!mxIsDouble(C_IN) || mxIsComplex(C_IN) ||
+        mxGetNumberOfElements(C_IN) == 0 || mxGetM(C_IN) != L.nBin)
+        mexErrMsgIdAndTxt("nigeLab:Correlogram:BadCounts",
+            "C must be an nBin x nClus x nClus double array.");
+    L.nClus = mxGetNumberOfDimensions(C_IN) > 1 ? mxGetDimensions(C_IN)[1] : 1;
+    if (mxGetNumberOfElements(C_IN) != L.nBin * L.nClus * L.nClus)
+        mexErrMsgIdAndTxt("nigeLab:Correlogram:BadCounts",
+            "C must be an nBin x nClus x nClus double array.");
+    Train s;
+    prepareTrain(prhs, L.nClus, s);
+    std::vector<double> subs = getVector(SUBS, "subs");
+    std::vector<double> old = getVector(OLDCLASS, "oldClass");
+    size_t N = s.t.size();
+    if (old.size() != subs.size() && old.size() != 1)
+        mexErrMsgIdAndTxt("nigeLab:Correlogram:SizeMismatch",
+            "oldClass must be scalar or match subs.");
+
+    /* Labels before the move, by sorted position */
+    std::vector<ptrdiff_t> cOld(s.c);
+    std::vector<char> moved(N, 0);
+    for (size_t m = 0; m < subs.size(); m++)
+    {
+        double i = subs[m];
+        if (!(i >= 1 && i <= (double)N) || i != floor(i))
+            mexErrMsgIdAndTxt("nigeLab:Correlogram:BadSubs",
+                "subs must be indices into ts.");
+        size_t p = s.pos[(size_t)i - 1];
+        double c = (old.size() == 1) ? old[0] : old[m];
+        moved[p] = 1;
+        cOld[p] = (c >= 1 && c <= (double)L.nClus && c == floor(c) &&
+                   s.t[p] == s.t[p]) ? (ptrdiff_t)c - 1 : -1;
+    }
+
+    plhs[0] = mxDuplicateArray(C_IN);
+    double *C = mxGetPr(plhs[0]);
+    for (size_t p = 0; p < N; p++)
+    {
+        if (!moved[p]) continue;
+        /* Pairs with an earlier moved spike were done from that spike */
+        for (size_t q = p; q-- > 0 && s.g[q] == s.g[p];)
+        {
+            if (!(s.t[p] - s.t[q] <= L.reach)) break;
+            if (moved[q]) continue;
+            L.add(C, s, q, p, cOld[q], cOld[p], -1.0);
+            L.add(C, s, q, p, s.c[q], s.c[p], 1.0);
+        }
+        for (size_t q = p + 1; q < N && s.g[q] == s.g[p]; q++)
+        {
+            if (!(s.t[q] - s.t[p] <= L.reach)) break;
+            L.add(C, s, p, q, cOld[p], cOld[q], -1.0);
+            L.add(C, s, p, q, s.c[p], s.c[q], 1.0);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+void mexFunction( int /* nlhs */, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    if (nrhs < 1 || !mxIsChar(MODE))
+        mexErrMsgIdAndTxt("nigeLab:Correlogram:BadInput",
+            "First input must be a mode (char).");
+    char *c = mxArrayToString(MODE);
+    std::string mode(c);
+    mxFree(c);
+
+    if (mode == "full")
+        doFull(nrhs, prhs, plhs);
+    else if (mode == "update")
+        doUpdate(nrhs, prhs, plhs);
+    else
+        mexErrMsgIdAndTxt("nigeLab:Correlogram:BadMode",
+            "Unknown mode '%s'.", mode.c_str());
+}
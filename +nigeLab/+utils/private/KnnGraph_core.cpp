@@ -0,0 +1,168 @@
+/*=================================================================
+ *
+ * KNNGRAPH_CORE.CPP	.MEX file for nigeLab.utils.knnGraph
+ *
+ * The calling syntax is:
+ *
+ *		[idx, d, E] = KnnGraph_core(X, k, edges)
+ *
+ *      X:          N x D points (double or single), one per row
+ *      k:          number of neighbours (at most N-1)
+ *      edges:      'none', 'knn', 'mutual', 'mst' or 'mutual+mst'
+ *
+ *      idx:        N x k indices (1-based) of the nearest neighbours of
+ *                  each point, by increasing distance (ties by index)
+ *      d:          N x k Euclidean distances to those neighbours
+ *      E:          nE x 3 [i j dist] undirected edges (i < j, sorted):
+ *                  'knn', j among the neighbours of i or i among those of
+ *                  j; 'mutual', both; 'mst', the Euclidean minimum
+ *                  spanning tree; 'mutual+mst', the union of the two
+ *                  (the connected graph used by SPC)
+ *
+ * Neighbours come from a KD-tree (nigel_knn.h), queried for all points in
+ * parallel; the results are the same as those of exhaustive search. The
+ * minimum spanning tree uses the same tree, so no N x N distance matrix
+ * is ever formed.
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+#include "mex.h"
+#include "nigel_knn.h"
+
+/* Input Arguments */
+
+#define	X	prhs[0]
+#define	K	prhs[1]
+#define	EDGES	prhs[2]
+
+/* Constants */
+
+enum EdgeMode { NONE, KNN, MUTUAL, MST, MUTUAL_MST };
+
+///////////////////////////////////////////////////////////////////////////
+/* Helpers */
+///////////////////////////////////////////////////////////////////////////
+
+static EdgeMode parseMode(const mxArray *A)
+{
+    if (!mxIsChar(A))
+        mexErrMsgIdAndTxt("nigeLab:KnnGraph:BadEdges",
+            "edges must be a char array.");
+    char *c = mxArrayToString(A);
+    std::string mode(c);
+    mxFree(c);
+    if (mode == "none") return NONE;
+    if (mode == "knn") return KNN;
+    if (mode == "mutual") return MUTUAL;
+    if (mode == "mst") return MST;
+    if (mode == "mutual+mst") return MUTUAL_MST;
+    mexErrMsgIdAndTxt("nigeLab:KnnGraph:BadEdges",
+        "Unknown edges '%s'.", mode.c_str());
+    return NONE;
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+void mexFunction( int nlhs, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    if (nrhs < 2)
+        mexErrMsgIdAndTxt("nigeLab:KnnGraph:BadInput",
+            "Requires (X, k, [edges]).");
+    if (mxIsComplex(X) || mxIsSparse(X) || !(mxIsDouble(X) || mxIsSingle(X)))
+        mexErrMsgIdAndTxt("nigeLab:KnnGraph:BadClass",
+            "X must be a real, full double or single matrix.");
+    EdgeMode mode = (nrhs > 2) ? parseMode(EDGES) : NONE;
+    if (nlhs > 2 && mode == NONE)
+        mexErrMsgIdAndTxt("nigeLab:KnnGraph:BadEdges",
+            "Specify which edges to return.");
+
+    size_t N = mxGetM(X), D = mxGetN(X);
+    double kIn = mxGetScalar(K);
+    if (!(kIn >= 0) || kIn != floor(kIn))
+        mexErrMsgIdAndTxt("nigeLab:KnnGraph:BadK",
+            "k must be a non-negative integer.");
+    size_t k = (size_t)kIn;
+    if (N > 0 && k > N - 1) k = N - 1;
+    if (N == 0) k = 0;
+
+    /* Row-major copy of the points */
+    std::vector<double> x(N * D);
+    if (mxIsDouble(X))
+    {
+        const double *f = mxGetPr(X);
+        for (size_t i = 0; i < N; i++)
+            for (size_t d = 0; d < D; d++) x[i * D + d] = f[i + d * N];
+    }
+    else
+    {
+        const float *f = (const float *)mxGetData(X);
+        for (size_t i = 0; i < N; i++)
+            for (size_t d = 0; d < D; d++) x[i * D + d] = (double)f[i + d * N];
+    }
+
+    nigel::KdTree tree(x.data(), N, D);
+    std::vector<size_t> idx;
+    std::vector<double> d2;
+    nigel::knnGraph(tree, k, idx, d2);
+
+    plhs[0] = mxCreateDoubleMatrix(N, k, mxREAL);
+    double *pIdx = mxGetPr(plhs[0]);
+    for (size_t i = 0; i < N; i++)
+        for (size_t m = 0; m < k; m++) pIdx[i + m * N] = (double)(idx[i * k + m] + 1);
+    if (nlhs > 1)
+    {
+        plhs[1] = mxCreateDoubleMatrix(N, k, mxREAL);
+        double *pD = mxGetPr(plhs[1]);
+        for (size_t i = 0; i < N; i++)
+            for (size_t m = 0; m < k; m++) pD[i + m * N] = sqrt(d2[i * k + m]);
+    }
+    if (nlhs < 3) return;
+
+    std::vector< std::pair<size_t, size_t> > e, mst;
+    if (mode == KNN)
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            for (size_t m = 0; m < k; m++)
+            {
+                size_t j = idx[i * k + m];
+                e.push_back((i < j) ? std::make_pair(i, j) : std::make_pair(j, i));
+            }
+        }
+    }
+    else if (mode == MUTUAL || mode == MUTUAL_MST)
+    {
+        nigel::mutualEdges(idx, N, k, e);
+    }
+    if (mode == MST || mode == MUTUAL_MST)
+    {
+        nigel::minimumSpanningTree(tree, mst);
+        for (size_t m = 0; m < mst.size(); m++)
+        {
+            size_t i = mst[m].first, j = mst[m].second;
+            e.push_back((i < j) ? std::make_pair(i, j) : std::make_pair(j, i));
+        }
+    }
+    std::sort(e.begin(), e.end());
+    e.erase(std::unique(e.begin(), e.end()), e.end());
+
+    size_t nE = e.size();
+    plhs[2] = mxCreateDoubleMatrix(nE, 3, mxREAL);
+    double *pE = mxGetPr(plhs[2]);
+    for (size_t m = 0; m < nE; m++)
+    {
+        pE[m] = (double)(e[m].first + 1);
+        pE[m + nE] = (double)(e[m].second + 1);
+        pE[m + 2 * nE] = sqrt(nigel::sqDist(&x[e[m].first * D],
+                                            &x[e[m].second * D], D));
+    }
+}
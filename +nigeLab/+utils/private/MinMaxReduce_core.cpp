@@ -0,0 +1,255 @@
+/*=================================================================
+ *
+ * MINMAXREDUCE_CORE.CPP	.MEX file for min/max decimation of line plots
+ *
+ * The calling syntax is:
+ *
+ *		[xr, yr] = MinMaxReduce_core('reduce', x, y, width, lims)
+ *		M = MinMaxReduce_core('bins', y, B)
+ *
+ *      'reduce':   x:      n x 1 (or n x m) sorted sample positions
+ *                  y:      n x m samples (double or single)
+ *                  width:  number of pixels
+ *                  lims:   [lo hi] axis limits (may be infinite)
+ *
+ *                  xr, yr: 2*width x m (double): the last sample at or
+ *                          before lo, the first at or after hi, and the
+ *                          min and max (in sample order) of each pixel
+ *                          between them, exactly as
+ *                          nigeLab.utils.reduce_to_width
+ *
+ *      'bins':     y:      n x 1 samples, or n x 2 [min max] of finer
+ *                          bins (double or single)
+ *                  B:      samples (or finer bins) per bin
+ *
+ *                  M:      ceil(n/B) x 2 [min max] of each bin of B
+ *                          consecutive rows (the last may be shorter);
+ *                          NaN is ignored, as by min and max, unless the
+ *                          whole bin is NaN (same class as y)
+ *
+ * 'reduce' finds the pixel edges by binary search and scans each pixel
+ * once, in one pass over the samples in the limits, instead of a MATLAB
+ * loop over pixels; the columns run in parallel. 'bins' builds the
+ * levels of nigeLab.utils.MinMaxPyramid, in parallel blocks of bins.
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <math.h>
+#include <stddef.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "mex.h"
+#include "nigel_threads.h"
+
+/* Input Arguments */
+
+#define	MODE	prhs[0]
+#define	X_IN	prhs[1]
+#define	Y_IN	prhs[2]
+#define	WIDTH	prhs[3]
+#define	LIMS	prhs[4]
+#define	B_IN	prhs[2]
+
+/* Constants */
+
+static const size_t BIN_BLOCK = 4096;   /* Bins per parallel work item */
+
+///////////////////////////////////////////////////////////////////////////
+/* Helpers */
+///////////////////////////////////////////////////////////////////////////
+
+static void checkFloat(const mxArray *A, const char *name)
+{
+    if (mxIsComplex(A) || mxIsSparse(A) || !(mxIsDouble(A) || mxIsSingle(A)))
+        mexErrMsgIdAndTxt("nigeLab:MinMaxReduce:BadClass",
+            "%s must be a real, full double or single matrix.", name);
+}
+
+/* Binary search of reduce_to_width, on 1-based bounds [L, U] */
+template <typename X>
+static void binarySearch(const X *x, X v, size_t &L, size_t &U)
+{
+    while (L + 1 < U)
+    {
+        size_t C = (L + U) / 2;
+        if (x[C - 1] < v)
+            L = C;
+        else
+            U = C;
+    }
+}
+
+/* One column: indices (1-based) of the 2*width reduced points */
+template <typename X, typename Y>
+static void reduceColumn(const X *x, const Y *y, size_t n, size_t width,
+                         double lo, double hi, size_t *idx)
+{
+    size_t lower = 1, upper = n;
+    binarySearch(x, (X)lo, lower, upper);
+    size_t from = lower;
+    upper = n;
+    binarySearch(x, (X)hi, from, upper);
+    X d1 = x[lower - 1], d2 = x[upper - 1];
+
+    idx[0] = lower;
+    idx[2 * width - 1] = upper;
+    size_t right = lower;
+    for (size_t z = 1; z < width; z++)
+    {
+        /* linspace(d1, d2, width + 1), as MATLAB computes it */
+        X div = d1 + ((X)z * (d2 - d1)) / (X)width;
+        size_t left = right;
+        from = left;
+        right = upper;
+        binarySearch(x, div, from, right);
+
+        /* First max and min of y(left:right), ignoring NaN */
+        size_t iMax = left, iMin = left;
+        double vMax = NAN, vMin = NAN;
+        for (size_t i = left; i <= right; i++)
+        {
+            double v = (double)y[i - 1];
+            if (v != v) continue;
+            if (vMax != vMax || v > vMax) { vMax = v; iMax = i; }
+            if (vMin != vMin || v < vMin) { vMin = v; iMin = i; }
+        }
+        idx[2 * z - 1] = std::min(iMin, iMax);
+        idx[2 * z] = std::max(iMin, iMax);
+    }
+}
+
+template <typename X, typename Y>
+static void reduceAll(const X *x, size_t mx, const Y *y, size_t n, size_t m,
+                      size_t width, double lo, double hi, double *xr, double *yr)
+{
+    size_t nOut = 2 * width;
+    nigel::parallelFor(m, [&](size_t k) {
+        /* Columns of y beyond those of x use the last x */
+        const X *xt = x + std::min(k, mx - 1) * n;
+        const Y *yt = y + k * n;
+        std::vector<size_t> idx(nOut);
+        reduceColumn(xt, yt, n, width, lo, hi, idx.data());
+        for (size_t i = 0; i < nOut; i++)
+        {
+            xr[k * nOut + i] = (double)xt[idx[i] - 1];
+            yr[k * nOut + i] = (double)yt[idx[i] - 1];
+        }
+    });
+}
+
+/* [min max] of bins of B rows; hi == lo for samples */
+template <typename T>
+static void binAll(const T *lo, const T *hi, size_t n, size_t B, T *out)
+{
+    size_t nb = (n + B - 1) / B;
+    size_t nBlk = (nb + BIN_BLOCK - 1) / BIN_BLOCK;
+    nigel::parallelFor(nBlk, [&](size_t blk) {
+        size_t b1 = std::min(nb, (blk + 1) * BIN_BLOCK);
+        for (size_t b = blk * BIN_BLOCK; b < b1; b++)
+        {
+            size_t i1 = std::min(n, (b + 1) * B);
+            T vMin = (T)NAN, vMax = (T)NAN;
+            for (size_t i = b * B; i < i1; i++)
+            {
+                if (lo[i] == lo[i] && !(lo[i] >= vMin)) vMin = lo[i];
+                if (hi[i] == hi[i] && !(hi[i] <= vMax)) vMax = hi[i];
+            }
+            out[b] = vMin;
+            out[b + nb] = vMax;
+        }
+    });
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* Modes */
+///////////////////////////////////////////////////////////////////////////
+
+static void doReduce(int nrhs, const mxArray *prhs[], mxArray *plhs[])
+{
+    if (nrhs != 5)
+        mexErrMsgIdAndTxt("nigeLab:MinMaxReduce:BadInput",
+            "'reduce' requires (x, y, width, lims).");
+    checkFloat(X_IN, "x");
+    checkFloat(Y_IN, "y");
+    size_t n = mxGetM(Y_IN), m = mxGetN(Y_IN), mx = mxGetN(X_IN);
+    if (mxGetM(X_IN) != n || mx < 1 || n < 1)
+        mexErrMsgIdAndTxt("nigeLab:MinMaxReduce:BadSize",
+            "x and y must have the same (non-zero) number of rows.");
+    double w = mxGetScalar(WIDTH);
+    if (!(w >= 1) || w != floor(w))
+        mexErrMsgIdAndTxt("nigeLab:MinMaxReduce:BadWidth",
+            "width must be a positive integer.");
+    if (!mxIsDouble(LIMS) || mxGetNumberOfElements(LIMS) != 2)
+        mexErrMsgIdAndTxt("nigeLab:MinMaxReduce:BadLims",
+            "lims must be a [lo hi] double vector.");
+    size_t width = (size_t)w;
+    double lo = mxGetPr(LIMS)[0], hi = mxGetPr(LIMS)[1];
+
+    plhs[0] = mxCreateDoubleMatrix(2 * width, m, mxREAL);
+    plhs[1] = mxCreateDoubleMatrix(2 * width, m, mxREAL);
+    double *xr = mxGetPr(plhs[0]), *yr = mxGetPr(plhs[1]);
+    bool xd = mxIsDouble(X_IN), yd = mxIsDouble(Y_IN);
+    const void *x = mxGetData(X_IN), *y = mxGetData(Y_IN);
+    if (xd && yd)
+        reduceAll((const double *)x, mx, (const double *)y, n, m, width, lo, hi, xr, yr);
+    else if (xd)
+        reduceAll((const double *)x, mx, (const float *)y, n, m, width, lo, hi, xr, yr);
+    else if (yd)
+        reduceAll((const float *)x, mx, (const double *)y, n, m, width, lo, hi, xr, yr);
+    else
+        reduceAll((const float *)x, mx, (const float *)y, n, m, width, lo, hi, xr, yr);
+}
+
+static void doBins(int nrhs, const mxArray *prhs[], mxArray *plhs[])
+{
+    if (nrhs != 3)
+        mexErrMsgIdAndTxt("nigeLab:MinMaxReduce:BadInput",
+            "'bins' requires (y, B).");
+    checkFloat(X_IN, "y");
+    double b = mxGetScalar(B_IN);
+    if (!(b >= 1) || b != floor(b))
+        mexErrMsgIdAndTxt("nigeLab:MinMaxReduce:BadBin",
+            "B must be a positive integer.");
+    size_t B = (size_t)b, n = mxGetM(X_IN), nCol = mxGetN(X_IN);
+    if (nCol != 1 && nCol != 2)
+        mexErrMsgIdAndTxt("nigeLab:MinMaxReduce:BadSize",
+            "y must be a column or an n x 2 [min max] matrix.");
+
+    size_t nb = (n + B - 1) / B;
+    plhs[0] = mxCreateNumericMatrix(nb, 2, mxGetClassID(X_IN), mxREAL);
+    if (mxIsDouble(X_IN))
+    {
+        const double *y = mxGetPr(X_IN);
+        binAll(y, y + (nCol - 1) * n, n, B, mxGetPr(plhs[0]));
+    }
+    else
+    {
+        const float *y = (const float *)mxGetData(X_IN);
+        binAll(y, y + (nCol - 1) * n, n, B, (float *)mxGetData(plhs[0]));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+void mexFunction( int /* nlhs */, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    if (nrhs < 1 || !mxIsChar(MODE))
+        mexErrMsgIdAndTxt("nigeLab:MinMaxReduce:BadInput",
+            "First input must be a mode (char).");
+    char *c = mxArrayToString(MODE);
+    std::string mode(c);
+    mxFree(c);
+
+    if (mode == "reduce")
+        doReduce(nrhs, prhs, plhs);
+    else if (mode == "bins")
+        doBins(nrhs, prhs, plhs);
+    else
+        mexErrMsgIdAndTxt("nigeLab:MinMaxReduce:BadMode",
+            "Unknown mode '%s'.", mode.c_str());
+}
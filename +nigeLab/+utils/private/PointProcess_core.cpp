@@ -0,0 +1,342 @@
+/*=================================================================
+ *
+ * POINTPROCESS_CORE.CPP	.MEX file for point-process utilities
+ *
+ * The calling syntax is:
+ *
+ *		ts_out = PointProcess_core('match', ts_in, ts_match, window)
+ *		ts = PointProcess_core('debounce', ts, debounce)
+ *		ts_stop = PointProcess_core('pair', ts_start, ts_off)
+ *		T = PointProcess_core('union', A, B)
+ *		T = PointProcess_core('union', A, B, gap)
+ *		T = PointProcess_core('intersect', A, B)
+ *
+ *      'match':    ts_out(i) is the element of ts_in closest to
+ *                  ts_match(i) (the first one, in the order of ts_in, if
+ *                  two are equally close), or NaN if it is not strictly
+ *                  closer than window (see matchWindowedPointElements)
+ *      'debounce': sorted ts (column) without the elements that follow
+ *                  the previous kept element by less than debounce (see
+ *                  debouncePointProcess)
+ *      'pair':     ts_stop(i) is the smallest element of ts_off that is
+ *                  >= ts_start(i), or NaN (see matchEpochStartStopTimes)
+ *      'union', 'intersect':
+ *                  A, B: nA x 2 and nB x 2 [start stop] closed intervals
+ *                  (in any order, possibly overlapping); T: nT x 2
+ *                  sorted, disjoint intervals covering the points in A
+ *                  or B ('union') or in both ('intersect'); 'union'
+ *                  also merges intervals separated by at most gap
+ *                  (default 0; 1 joins touching sample intervals such
+ *                  as [1 5] and [6 9])
+ *
+ * Every mode is a single merge pass over sorted inputs: O(N + M) time
+ * when the inputs are already sorted (as event times almost always are),
+ * O(N log N) when they need sorting first, instead of the O(N * M)
+ * distance scans and O(N^2) element deletions of the MATLAB versions.
+ * Outputs are double and keep the orientation of the vector they match.
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <math.h>
+#include <stddef.h>
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+#include "mex.h"
+
+/* Input Arguments */
+
+#define	MODE	prhs[0]
+#define	A_IN	prhs[1]
+#define	B_IN	prhs[2]
+#define	PAR	prhs[3]
+
+typedef std::pair<double, double> Interval;
+
+///////////////////////////////////////////////////////////////////////////
+/* Helpers */
+///////////////////////////////////////////////////////////////////////////
+
+static std::vector<double> getVector(const mxArray *A, const char *name)
+{
+    if (!mxIsDouble(A) || mxIsComplex(A) || mxIsSparse(A))
+        mexErrMsgIdAndTxt("nigeLab:PointProcess:BadClass",
+            "%s must be a real, full double vector.", name);
+    const double *p = mxGetPr(A);
+    return std::vector<double>(p, p + mxGetNumberOfElements(A));
+}
+
+static mxArray *createLike(const mxArray *A, size_t n)
+{
+    return (mxGetM(A) == 1 && mxGetNumberOfElements(A) > 0)
+        ? mxCreateDoubleMatrix(1, n, mxREAL)
+        : mxCreateDoubleMatrix(n, 1, mxREAL);
+}
+
+/* a < b, with NaN last (as sort) */
+static bool lessNaN(double a, double b)
+{
+    return a < b || (a == a && b != b);
+}
+
+/* Order that sorts v (stable); identity if v is already sorted */
+static std::vector<size_t> sortOrder(const std::vector<double> &v)
+{
+    std::vector<size_t> ord(v.size());
+    for (size_t i = 0; i < v.size(); i++) ord[i] = i;
+    bool sorted = true;
+    for (size_t i = 1; i < v.size() && sorted; i++) sorted = !lessNaN(v[i], v[i - 1]);
+    if (!sorted)
+        std::stable_sort(ord.begin(), ord.end(),
+                         [&v](size_t a, size_t b) { return lessNaN(v[a], v[b]); });
+    return ord;
+}
+
+/* Non-NaN values of v, sorted, with their original indices */
+static void sortedValues(const std::vector<double> &v, std::vector<double> &s,
+                         std::vector<size_t> &idx)
+{
+    std::vector<double> w;
+    std::vector<size_t> orig;
+    for (size_t i = 0; i < v.size(); i++)
+    {
+        if (v[i] == v[i])
+        {
+            w.push_back(v[i]);
+            orig.push_back(i);
+        }
+    }
+    std::vector<size_t> ord = sortOrder(w);
+    s.resize(w.size());
+    idx.resize(w.size());
+    for (size_t i = 0; i < w.size(); i++)
+    {
+        s[i] = w[ord[i]];
+        idx[i] = orig[ord[i]];
+    }
+}
+
+/* nA x 2 [start stop] matrix as a sorted list of disjoint intervals */
+static std::vector<Interval> getIntervals(const mxArray *A)
+{
+    if (!mxIsDouble(A) || mxIsComplex(A) || mxIsSparse(A) ||
+        (!mxIsEmpty(A) && mxGetN(A) != 2))
+        mexErrMsgIdAndTxt("nigeLab:PointProcess:BadIntervals",
+            "Intervals must be an n x 2 [start stop] double matrix.");
+    size_t n = mxIsEmpty(A) ? 0 : mxGetM(A);
+    const double *p = mxGetPr(A);
+    std::vector<Interval> v;
+    v.reserve(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        if (p[i] <= p[i + n]) v.push_back(Interval(p[i], p[i + n]));
+    }
+    std::sort(v.begin(), v.end());
+    std::vector<Interval> out;
+    for (size_t i = 0; i < v.size(); i++)
+    {
+        if (!out.empty() && v[i].first <= out.back().second)
+            out.back().second = std::max(out.back().second, v[i].second);
+        else
+            out.push_back(v[i]);
+    }
+    return out;
+}
+
+static mxArray *intervalMatrix(const std::vector<Interval> &v)
+{
+    mxArray *T = mxCreateDoubleMatrix(v.size(), 2, mxREAL);
+    double *p = mxGetPr(T);
+    for (size_t i = 0; i < v.size(); i++)
+    {
+        p[i] = v[i].first;
+        p[i + v.size()] = v[i].second;
+    }
+    return T;
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* Modes */
+///////////////////////////////////////////////////////////////////////////
+
+static void doMatch(int nrhs, const mxArray *prhs[], mxArray *plhs[])
+{
+    if (nrhs != 4)
+        mexErrMsgIdAndTxt("nigeLab:PointProcess:BadInput",
+            "'match' requires (ts_in, ts_match, window).");
+    std::vector<double> in = getVector(A_IN, "ts_in");
+    std::vector<double> q = getVector(B_IN, "ts_match");
+    double window = mxGetScalar(PAR);
+
+    std::vector<double> s;
+    std::vector<size_t> idx;
+    sortedValues(in, s, idx);
+    std::vector<size_t> qOrd = sortOrder(q);
+
+    /* Equal values are interchangeable, except that min() returns the
+     * first in the original order: keep the smallest index of each run */
+    std::vector<size_t> first(idx);
+    for (size_t k = 1; k < s.size(); k++)
+        if (s[k] == s[k - 1]) first[k] = std::min(first[k], first[k - 1]);
+    for (size_t k = s.size(); k-- > 1; )
+        if (s[k] == s[k - 1]) first[k - 1] = first[k];
+    const double NaN = mxGetNaN();
+
+    plhs[0] = mxCreateDoubleMatrix(q.size(), 1, mxREAL);
+    double *out = mxGetPr(plhs[0]);
+    size_t j = 0; /* First element of s that is >= the query */
+    for (size_t m = 0; m < q.size(); m++)
+    {
+        size_t i = qOrd[m];
+        double t = q[i];
+        out[i] = NaN;
+        if (t != t || s.empty()) continue;
+        while (j < s.size() && s[j] < t) j++;
+
+        /* Nearest below and above; the earlier one (in the order of
+         * ts_in) if both are equally close */
+        double best = INFINITY;
+        size_t bestIdx = 0;
+        if (j > 0)
+        {
+            best = t - s[j - 1];
+            bestIdx = first[j - 1];
+        }
+        if (j < s.size())
+        {
+            double d = s[j] - t;
+            if (j == 0 || d < best || (d == best && first[j] < bestIdx))
+            {
+                best = d;
+                bestIdx = first[j];
+            }
+        }
+        if (best < window) out[i] = in[bestIdx];
+    }
+}
+
+static void doDebounce(int nrhs, const mxArray *prhs[], mxArray *plhs[])
+{
+    if (nrhs != 3)
+        mexErrMsgIdAndTxt("nigeLab:PointProcess:BadInput",
+            "'debounce' requires (ts, debounce).");
+    std::vector<double> ts = getVector(A_IN, "ts");
+    double debounce = mxGetScalar(B_IN);
+
+    /* sort puts NaN last; NaN differences never debounce */
+    std::vector<double> v, nan;
+    for (size_t i = 0; i < ts.size(); i++)
+    {
+        if (ts[i] == ts[i]) v.push_back(ts[i]); else nan.push_back(ts[i]);
+    }
+    std::vector<size_t> ord = sortOrder(v);
+    std::vector<double> keep;
+    keep.reserve(ts.size());
+    for (size_t i = 0; i < v.size(); i++)
+    {
+        double t = v[ord[i]];
+        if (keep.empty() || !(t - keep.back() < debounce)) keep.push_back(t);
+    }
+    keep.insert(keep.end(), nan.begin(), nan.end());
+
+    plhs[0] = mxCreateDoubleMatrix(keep.size(), 1, mxREAL);
+    std::copy(keep.begin(), keep.end(), mxGetPr(plhs[0]));
+}
+
+static void doPair(int nrhs, const mxArray *prhs[], mxArray *plhs[])
+{
+    if (nrhs != 3)
+        mexErrMsgIdAndTxt("nigeLab:PointProcess:BadInput",
+            "'pair' requires (ts_start, ts_off).");
+    std::vector<double> on = getVector(A_IN, "ts_start");
+    std::vector<double> off = getVector(B_IN, "ts_off");
+
+    std::vector<double> s;
+    std::vector<size_t> idx;
+    sortedValues(off, s, idx);
+    std::vector<size_t> ord = sortOrder(on);
+
+    plhs[0] = createLike(A_IN, on.size());
+    double *out = mxGetPr(plhs[0]);
+    const double NaN = mxGetNaN();
+    size_t j = 0; /* First element of s that is >= the start */
+    for (size_t m = 0; m < on.size(); m++)
+    {
+        size_t i = ord[m];
+        out[i] = NaN;
+        if (on[i] != on[i]) continue;
+        while (j < s.size() && s[j] < on[i]) j++;
+        if (j < s.size()) out[i] = s[j];
+    }
+}
+
+static void doIntervals(bool isUnion, int nrhs, const mxArray *prhs[],
+                        mxArray *plhs[])
+{
+    if (nrhs != 3 && !(isUnion && nrhs == 4))
+        mexErrMsgIdAndTxt("nigeLab:PointProcess:BadInput",
+            "Interval modes require (A, B) ('union' also takes gap).");
+    double gap = (nrhs > 3) ? mxGetScalar(PAR) : 0.0;
+    if (!(gap >= 0))
+        mexErrMsgIdAndTxt("nigeLab:PointProcess:BadInput",
+            "gap must be non-negative.");
+    std::vector<Interval> a = getIntervals(A_IN), b = getIntervals(B_IN);
+    std::vector<Interval> out;
+    if (isUnion)
+    {
+        std::vector<Interval> all;
+        all.reserve(a.size() + b.size());
+        std::merge(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(all));
+        for (size_t i = 0; i < all.size(); i++)
+        {
+            if (!out.empty() && all[i].first <= out.back().second + gap)
+                out.back().second = std::max(out.back().second, all[i].second);
+            else
+                out.push_back(all[i]);
+        }
+    }
+    else
+    {
+        size_t i = 0, j = 0;
+        while (i < a.size() && j < b.size())
+        {
+            double lo = std::max(a[i].first, b[j].first);
+            double hi = std::min(a[i].second, b[j].second);
+            if (lo <= hi) out.push_back(Interval(lo, hi));
+            if (a[i].second < b[j].second) i++; else j++;
+        }
+    }
+    plhs[0] = intervalMatrix(out);
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+void mexFunction( int /* nlhs */, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    if (nrhs < 1 || !mxIsChar(MODE))
+        mexErrMsgIdAndTxt("nigeLab:PointProcess:BadInput",
+            "First input must be a mode (char).");
+    char *c = mxArrayToString(MODE);
+    std::string mode(c);
+    mxFree(c);
+
+    if (mode == "match")
+        doMatch(nrhs, prhs, plhs);
+    else if (mode == "debounce")
+        doDebounce(nrhs, prhs, plhs);
+    else if (mode == "pair")
+        doPair(nrhs, prhs, plhs);
+    else if (mode == "union")
+        doIntervals(true, nrhs, prhs, plhs);
+    else if (mode == "intersect")
+        doIntervals(false, nrhs, prhs, plhs);
+    else
+        mexErrMsgIdAndTxt("nigeLab:PointProcess:BadMode",
+            "Unknown mode '%s'.", mode.c_str());
+}
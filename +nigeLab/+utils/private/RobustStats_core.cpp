@@ -0,0 +1,318 @@
+/*=================================================================
+ *
+ * ROBUSTSTATS_CORE.CPP	.MEX file for nigeLab.utils.robustStats
+ *
+ * The calling syntax is:
+ *
+ *		v = RobustStats_core('median', x, win)
+ *		v = RobustStats_core('medianabs', x, win)
+ *		v = RobustStats_core('mad', x, win)
+ *		v = RobustStats_core('prctile', x, win, p)
+ *		S = RobustStats_core('sketch', x, S, k)
+ *		S = RobustStats_core('merge', S1, S2)
+ *		v = RobustStats_core('query', S, p)
+ *
+ *      x:          real double or single vector or matrix
+ *      win:        [] (statistic of each column, or of the whole vector),
+ *                  or nWin x 2 [start stop] sample indices (1-based,
+ *                  inclusive) of windows of the vector x
+ *      p:          percentiles (0 - 100)
+ *      v:          median(x), median(abs(x)), mad(x,1) or prctile(x,p),
+ *                  of the same class as x. Without win, v has the shape
+ *                  MATLAB returns (1 x nCol, or nP x nCol for prctile;
+ *                  prctile of a vector is oriented like x). With win,
+ *                  v is nWin x 1 (nWin x nP for prctile)
+ *      S:          quantile sketch (1 x n double, [] for a new one)
+ *      k:          sketch accuracy (rank error ~2/k; default: 200).
+ *                  Ignored if S is not empty
+ *
+ * Exact statistics use linear-time selection on one scratch copy of each
+ * column or window (nigel_stats.h) instead of sorting, and columns or
+ * windows are processed in parallel. The sketch modes summarize data that
+ * arrive in chunks (e.g. a DiskData channel read one page at a time) in
+ * O(k) memory; sketches of separate chunks or channels can be merged.
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <math.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "mex.h"
+#include "nigel_stats.h"
+#include "nigel_threads.h"
+
+/* Input Arguments */
+
+#define	MODE	prhs[0]
+#define	X	prhs[1]
+#define	WIN	prhs[2]
+#define	PCT	prhs[3]
+
+/* Constants */
+
+static const double DEFAULT_K = 200; /* Default sketch accuracy */
+
+enum Stat { MEDIAN, MEDIANABS, MAD, PRCTILE };
+
+///////////////////////////////////////////////////////////////////////////
+/* Helpers */
+///////////////////////////////////////////////////////////////////////////
+
+/* Copies x(first .. first+n-1) (0-based, linear index) as double */
+static void copySamples(const mxArray *A, size_t first, size_t n, bool rectify,
+                        std::vector<double> &v)
+{
+    v.resize(n);
+    if (mxIsDouble(A))
+    {
+        const double *d = mxGetPr(A) + first;
+        for (size_t i = 0; i < n; i++) v[i] = d[i];
+    }
+    else
+    {
+        const float *f = (const float *)mxGetData(A) + first;
+        for (size_t i = 0; i < n; i++) v[i] = (double)f[i];
+    }
+    if (rectify)
+    {
+        for (size_t i = 0; i < n; i++) v[i] = fabs(v[i]);
+    }
+}
+
+/* Checks that A is a real, full double or single array */
+static void checkData(const mxArray *A, const char *name)
+{
+    if (mxIsComplex(A) || mxIsSparse(A) || !(mxIsDouble(A) || mxIsSingle(A)))
+        mexErrMsgIdAndTxt("nigeLab:RobustStats:BadClass",
+            "%s must be real, full double or single.", name);
+}
+
+static std::vector<double> getDoubles(const mxArray *A)
+{
+    checkData(A, "Input");
+    std::vector<double> v;
+    copySamples(A, 0, mxGetNumberOfElements(A), false, v);
+    return v;
+}
+
+static void getSketch(const mxArray *A, nigel::QuantileSketch &s)
+{
+    if (mxIsEmpty(A)) return;
+    if (!mxIsDouble(A) || mxIsComplex(A) ||
+        !s.deserialize(mxGetPr(A), mxGetNumberOfElements(A)))
+        mexErrMsgIdAndTxt("nigeLab:RobustStats:BadSketch",
+            "Not a quantile sketch (use the output of 'sketch' or 'merge').");
+}
+
+static mxArray *putSketch(const nigel::QuantileSketch &s)
+{
+    std::vector<double> v;
+    s.serialize(v);
+    mxArray *a = mxCreateDoubleMatrix(1, v.size(), mxREAL);
+    if (!v.empty()) memcpy(mxGetPr(a), v.data(), v.size() * sizeof(double));
+    return a;
+}
+
+/* m x n output of the class of x, filled from double values */
+static mxArray *putValues(const std::vector<double> &v, size_t m, size_t n,
+                          bool isSingle)
+{
+    if (!isSingle)
+    {
+        mxArray *a = mxCreateDoubleMatrix(m, n, mxREAL);
+        if (!v.empty()) memcpy(mxGetPr(a), v.data(), v.size() * sizeof(double));
+        return a;
+    }
+    mxArray *a = mxCreateNumericMatrix(m, n, mxSINGLE_CLASS, mxREAL);
+    float *f = (float *)mxGetData(a);
+    for (size_t i = 0; i < v.size(); i++) f[i] = (float)v[i];
+    return a;
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* Exact statistics */
+///////////////////////////////////////////////////////////////////////////
+
+static void doExact(Stat stat, mxArray *plhs[],
+                    int nrhs, const mxArray *prhs[])
+{
+    if (nrhs < 3 || (stat == PRCTILE && nrhs < 4))
+        mexErrMsgIdAndTxt("nigeLab:RobustStats:BadInput",
+            "Requires (mode, x, win%s).", (stat == PRCTILE) ? ", p" : "");
+    checkData(X, "x");
+    if (mxGetNumberOfDimensions(X) > 2)
+        mexErrMsgIdAndTxt("nigeLab:RobustStats:BadSize",
+            "x must be a vector or a matrix.");
+
+    std::vector<double> p(1, 50.0);
+    if (stat == PRCTILE) p = getDoubles(PCT);
+    for (size_t j = 0; j < p.size(); j++)
+    {
+        if (!(p[j] >= 0 && p[j] <= 100))
+            mexErrMsgIdAndTxt("nigeLab:RobustStats:BadPercentile",
+                "Percentiles must be between 0 and 100.");
+    }
+    size_t nP = (stat == PRCTILE) ? p.size() : 1;
+
+    size_t nRow = mxGetM(X), nCol = mxGetN(X);
+    bool isVec = (nRow == 1 || nCol == 1);
+
+    /* Each work item is one [first, first+len) stretch of x */
+    std::vector<size_t> first, len;
+    size_t outM, outN;
+    bool byItemRows;  /* true: item j fills row j; false: column j */
+    if (!mxIsEmpty(WIN))
+    {
+        if (!isVec)
+            mexErrMsgIdAndTxt("nigeLab:RobustStats:BadWindow",
+                "Windows require a vector x.");
+        if (mxGetN(WIN) != 2)
+            mexErrMsgIdAndTxt("nigeLab:RobustStats:BadWindow",
+                "win must be nWin x 2 [start stop].");
+        std::vector<double> w = getDoubles(WIN);
+        size_t nWin = mxGetM(WIN), nX = nRow * nCol;
+        for (size_t j = 0; j < nWin; j++)
+        {
+            double a = w[j], b = w[j + nWin];
+            if (!(a >= 1 && b <= (double)nX && a <= b + 1) ||
+                a != floor(a) || b != floor(b))
+                mexErrMsgIdAndTxt("nigeLab:RobustStats:BadWindow",
+                    "Window %d is not within 1 .. numel(x).", (int)j + 1);
+            first.push_back((size_t)a - 1);
+            len.push_back((size_t)(b - a + 1));
+        }
+        outM = nWin; outN = nP; byItemRows = true;
+    }
+    else if (isVec)
+    {
+        first.push_back(0);
+        len.push_back(nRow * nCol);
+        byItemRows = (nRow == 1); /* prctile of a row is a row */
+        outM = byItemRows ? 1 : nP;
+        outN = byItemRows ? nP : 1;
+    }
+    else
+    {
+        for (size_t c = 0; c < nCol; c++)
+        {
+            first.push_back(c * nRow);
+            len.push_back(nRow);
+        }
+        outM = nP; outN = nCol; byItemRows = false;
+    }
+
+    /* Copy on the MATLAB thread, compute on the workers */
+    size_t nItem = first.size();
+    std::vector< std::vector<double> > buf(nItem);
+    for (size_t j = 0; j < nItem; j++)
+        copySamples(X, first[j], len[j], stat == MEDIANABS, buf[j]);
+
+    std::vector<double> out(outM * outN);
+    nigel::parallelFor(nItem, [&](size_t j) {
+        std::vector<double> &v = buf[j];
+        std::vector<double> res(nP);
+        if (stat == PRCTILE) nigel::prctilesInPlace(v, p.data(), nP, res.data());
+        else if (stat == MAD) res[0] = nigel::madInPlace(v);
+        else res[0] = nigel::medianInPlace(v);
+        std::vector<double>().swap(v);
+        for (size_t q = 0; q < nP; q++)
+        {
+            if (byItemRows) out[j + q * outM] = res[q];
+            else out[q + j * outM] = res[q];
+        }
+    });
+
+    plhs[0] = putValues(out, outM, outN, mxIsSingle(X));
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* Sketch */
+///////////////////////////////////////////////////////////////////////////
+
+static void doSketch(mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    if (nrhs < 2)
+        mexErrMsgIdAndTxt("nigeLab:RobustStats:BadInput",
+            "Requires ('sketch', x, S, k).");
+    double k = (nrhs > 3 && !mxIsEmpty(prhs[3])) ? mxGetScalar(prhs[3]) : DEFAULT_K;
+    if (!(k >= 8 && k <= 1e7))
+        mexErrMsgIdAndTxt("nigeLab:RobustStats:BadK",
+            "k must be between 8 and 1e7.");
+    nigel::QuantileSketch s((size_t)k);
+    if (nrhs > 2) getSketch(prhs[2], s);
+
+    std::vector<double> x = getDoubles(X);
+    s.add(x.data(), x.size());
+    plhs[0] = putSketch(s);
+}
+
+static void doMerge(mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    if (nrhs < 3)
+        mexErrMsgIdAndTxt("nigeLab:RobustStats:BadInput",
+            "Requires ('merge', S1, S2).");
+    nigel::QuantileSketch a, b;
+    getSketch(prhs[1], a);
+    getSketch(prhs[2], b);
+    if (mxIsEmpty(prhs[1]))
+    {
+        plhs[0] = putSketch(b);
+        return;
+    }
+    a.merge(b);
+    plhs[0] = putSketch(a);
+}
+
+static void doQuery(mxArray *plhs[], int nrhs, const mxArray *prhs[])
+{
+    if (nrhs < 3)
+        mexErrMsgIdAndTxt("nigeLab:RobustStats:BadInput",
+            "Requires ('query', S, p).");
+    nigel::QuantileSketch s;
+    getSketch(prhs[1], s);
+    std::vector<double> p = getDoubles(prhs[2]);
+    for (size_t j = 0; j < p.size(); j++)
+    {
+        if (!(p[j] >= 0 && p[j] <= 100))
+            mexErrMsgIdAndTxt("nigeLab:RobustStats:BadPercentile",
+                "Percentiles must be between 0 and 100.");
+    }
+    std::vector<double> out(p.size());
+    s.prctiles(p.data(), p.size(), out.data());
+    plhs[0] = putValues(out, mxGetM(prhs[2]), mxGetN(prhs[2]), false);
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+void mexFunction( int /* nlhs */, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    if (nrhs < 1 || !mxIsChar(MODE))
+        mexErrMsgIdAndTxt("nigeLab:RobustStats:BadInput",
+            "First input must be a statistic (char).");
+    char *c = mxArrayToString(MODE);
+    std::string mode(c);
+    mxFree(c);
+
+    if (mode == "median")
+        doExact(MEDIAN, plhs, nrhs, prhs);
+    else if (mode == "medianabs")
+        doExact(MEDIANABS, plhs, nrhs, prhs);
+    else if (mode == "mad")
+        doExact(MAD, plhs, nrhs, prhs);
+    else if (mode == "prctile")
+        doExact(PRCTILE, plhs, nrhs, prhs);
+    else if (mode == "sketch")
+        doSketch(plhs, nrhs, prhs);
+    else if (mode == "merge")
+        doMerge(plhs, nrhs, prhs);
+    else if (mode == "query")
+        doQuery(plhs, nrhs, prhs);
+    else
+        mexErrMsgIdAndTxt("nigeLab:RobustStats:BadMode",
+            "Unknown statistic '%s'.", mode.c_str());
+}
@@ -0,0 +1,212 @@
+/*=================================================================
+ *
+ * SLIDINGXCORR_CORE.CPP	.MEX file for nigeLab.utils.getR
+ *
+ * The calling syntax is:
+ *
+ *		R = SlidingXcorr_core(x, y, wLen, 'full')
+ *		[Rmax, bestLag] = SlidingXcorr_core(x, y, wLen, 'best')
+ *
+ *      x, y:       real double vectors
+ *      wLen:       window length (samples)
+ *
+ *      R:          (2*wLen-1) x M matrix; R(:,m) is
+ *                  xcorr(x(w) - mean(x(w)), y(w) - mean(y(w))) for the
+ *                  window w = m:(m+wLen-1), M = min(numel(x),numel(y))
+ *                  - wLen + 1 (rows: lags -(wLen-1) .. wLen-1)
+ *      Rmax:       1 x M max(R)
+ *      bestLag:    1 x M lag of the (first) maximum of each column
+ *
+ * Consecutive windows share all but one sample, so the raw (not
+ * detrended) correlation of window m+1 at each lag is that of window m
+ * minus the product that leaves the window plus the one that enters:
+ * O(wLen) per window instead of an O(wLen log wLen) FFT per window (or
+ * the O(wLen^2) of xcorr). Windows are processed in blocks; the first
+ * window of each block is computed exactly with the built-in radix-2 FFT
+ * (nigel_fft.h), which bounds the rounding drift of the updates, and
+ * blocks run in parallel. The means are removed afterwards from prefix
+ * sums of the window, so each column equals the detrended xcorr. The
+ * 'best' mode keeps only the maximum of each column, so its memory is
+ * proportional to the number of windows.
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <math.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include "mex.h"
+#include "nigel_fft.h"
+#include "nigel_threads.h"
+
+/* Input Arguments */
+
+#define	X	prhs[0]
+#define	Y	prhs[1]
+#define	WLEN	prhs[2]
+#define	MODE	prhs[3]
+
+/* Constants */
+
+static const size_t WINDOW_BLOCK = 1024; /* Windows per exact restart */
+
+using nigel::cplx;
+
+///////////////////////////////////////////////////////////////////////////
+/* Helpers */
+///////////////////////////////////////////////////////////////////////////
+
+/* Raw correlation S(r) = sum(a(n+l) * b(n)), l = r - (L-1), of the windows
+ * a = x(m0 .. m0+L-1) and b = y(m0 .. m0+L-1) */
+static void exactCorr(const double *x, const double *y, size_t L,
+                      const nigel::FFT &plan, std::vector<cplx> &fa,
+                      std::vector<cplx> &fb, double *S)
+{
+    size_t P = plan.size();
+    for (size_t i = 0; i < P; i++)
+    {
+        fa[i] = (i < L) ? cplx(x[i], 0.0) : cplx(0.0, 0.0);
+        fb[i] = (i < L) ? cplx(y[i], 0.0) : cplx(0.0, 0.0);
+    }
+    plan.forward(fa.data());
+    plan.forward(fb.data());
+    for (size_t i = 0; i < P; i++) fa[i] = nigel::cmul(fa[i], std::conj(fb[i]));
+    plan.inverse(fa.data());
+    for (size_t r = 0; r < 2 * L - 1; r++)
+    {
+        ptrdiff_t l = (ptrdiff_t)r - (ptrdiff_t)(L - 1);
+        S[r] = fa[(l < 0) ? (size_t)((ptrdiff_t)P + l) : (size_t)l].real();
+    }
+}
+
+/* Slides S from window m to window m+1 */
+static void slide(const double *x, const double *y, size_t L, size_t m,
+                  double *S)
+{
+    /* l < 0: leaves x(m) * y(m-l), enters x(m+L+l) * y(m+L) */
+    for (size_t r = 0; r < L - 1; r++)
+    {
+        size_t a = L - 1 - r; /* -l */
+        S[r] += x[m + L - a] * y[m + L] - x[m] * y[m + a];
+    }
+    /* l >= 0: leaves x(m+l) * y(m), enters x(m+L) * y(m+L-l) */
+    for (size_t r = L - 1; r < 2 * L - 1; r++)
+    {
+        size_t l = r - (L - 1);
+        S[r] += x[m + L] * y[m + L - l] - x[m + l] * y[m];
+    }
+}
+
+/* Removes the window means from the raw correlation S of window m */
+static void detrend(const double *x, const double *y, size_t L, size_t m,
+                    const double *S, std::vector<double> &px,
+                    std::vector<double> &py, double *R)
+{
+    px[0] = 0;
+    py[0] = 0;
+    for (size_t i = 0; i < L; i++)
+    {
+        px[i + 1] = px[i] + x[m + i];
+        py[i + 1] = py[i] + y[m + i];
+    }
+    double mx = px[L] / (double)L, my = py[L] / (double)L;
+    for (size_t r = 0; r < 2 * L - 1; r++)
+    {
+        double sx, sy, cnt;
+        if (r < L - 1)
+        {
+            size_t a = L - 1 - r; /* -l */
+            sx = px[L - a];
+            sy = py[L] - py[a];
+            cnt = (double)(L - a);
+        }
+        else
+        {
+            size_t l = r - (L - 1);
+            sx = px[L] - px[l];
+            sy = py[L - l];
+            cnt = (double)(L - l);
+        }
+        R[r] = S[r] - my * sx - mx * sy + cnt * mx * my;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+void mexFunction( int nlhs, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    if (nrhs != 4 || !mxIsChar(MODE))
+        mexErrMsgIdAndTxt("nigeLab:SlidingXcorr:BadInput",
+            "Requires (x, y, wLen, 'full' | 'best').");
+    if (!mxIsDouble(X) || !mxIsDouble(Y) || mxIsComplex(X) || mxIsComplex(Y) ||
+        mxIsSparse(X) || mxIsSparse(Y))
+        mexErrMsgIdAndTxt("nigeLab:SlidingXcorr:BadClass",
+            "x and y must be real, full double vectors.");
+    char *c = mxArrayToString(MODE);
+    std::string mode(c);
+    mxFree(c);
+    bool best = (mode == "best");
+    if (!best && mode != "full")
+        mexErrMsgIdAndTxt("nigeLab:SlidingXcorr:BadMode",
+            "Unknown mode '%s'.", mode.c_str());
+    double w = mxGetScalar(WLEN);
+    if (!(w >= 1) || w != floor(w))
+        mexErrMsgIdAndTxt("nigeLab:SlidingXcorr:BadWindow",
+            "wLen must be a positive integer.");
+    size_t L = (size_t)w;
+
+    size_t n = mxGetNumberOfElements(X);
+    if (mxGetNumberOfElements(Y) < n) n = mxGetNumberOfElements(Y);
+    size_t M = (n >= L) ? n - L + 1 : 0;
+
+    /* Constant offsets do not change the detrended correlation; removing
+     * the global means keeps the raw sums (and their rounding) small */
+    std::vector<double> x(mxGetPr(X), mxGetPr(X) + n), y(mxGetPr(Y), mxGetPr(Y) + n);
+    double mx = 0, my = 0;
+    for (size_t i = 0; i < n; i++) { mx += x[i]; my += y[i]; }
+    if (n > 0) { mx /= (double)n; my /= (double)n; }
+    for (size_t i = 0; i < n; i++) { x[i] -= mx; y[i] -= my; }
+
+    size_t nR = 2 * L - 1;
+    double *R = 0, *Rmax = 0, *lagOut = 0;
+    if (best)
+    {
+        plhs[0] = mxCreateDoubleMatrix(1, M, mxREAL);
+        Rmax = mxGetPr(plhs[0]);
+        if (nlhs > 1) plhs[1] = mxCreateDoubleMatrix(1, M, mxREAL);
+        lagOut = (nlhs > 1) ? mxGetPr(plhs[1]) : 0;
+    }
+    else
+    {
+        plhs[0] = mxCreateDoubleMatrix(nR, M, mxREAL);
+        R = mxGetPr(plhs[0]);
+    }
+    if (M == 0) return;
+
+    nigel::FFT plan(nigel::FFT::nextPow2(nR));
+    size_t nBlock = (M + WINDOW_BLOCK - 1) / WINDOW_BLOCK;
+    nigel::parallelFor(nBlock, [&](size_t b) {
+        size_t m0 = b * WINDOW_BLOCK;
+        size_t m1 = (m0 + WINDOW_BLOCK < M) ? m0 + WINDOW_BLOCK : M;
+        std::vector<cplx> fa(plan.size()), fb(plan.size());
+        std::vector<double> S(nR), col(nR), px(L + 1), py(L + 1);
+        exactCorr(&x[m0], &y[m0], L, plan, fa, fb, S.data());
+        for (size_t m = m0; m < m1; m++)
+        {
+            if (m > m0) slide(x.data(), y.data(), L, m - 1, S.data());
+            double *out = best ? col.data() : R + m * nR;
+            detrend(x.data(), y.data(), L, m, S.data(), px, py, out);
+            if (!best) continue;
+            size_t iMax = 0; /* First maximum, ignoring NaN (as max) */
+            for (size_t r = 1; r < nR; r++)
+                if (out[r] > out[iMax] || (out[iMax] != out[iMax] && out[r] == out[r]))
+                    iMax = r;
+            Rmax[m] = out[iMax];
+            if (lagOut) lagOut[m] = (double)iMax - (double)(L - 1);
+        }
+    });
+}
@@ -0,0 +1,220 @@
+/*=================================================================
+ *
+ * SPIKEBINS_CORE.CPP	.MEX file for nigeLab.utils.binSpikeTrains
+ *
+ * The calling syntax is:
+ *
+ *		[counts, rate, psth] = SpikeBins_core(ts, align, edges, sigma)
+ *
+ *      ts:         spike times of each unit: cell array of nUnit double
+ *                  vectors (or one double vector for a single unit)
+ *      align:      nTrial alignment times (same units as ts; NaN trials
+ *                  have no spikes)
+ *      edges:      nBin+1 increasing bin edges, relative to align
+ *      sigma:      SD (in bins) of the Gaussian that smooths rate (0: no
+ *                  smoothing)
+ *
+ *      counts:     nTrial x nBin x nUnit spike counts; bin k holds the
+ *                  spikes with edges(k) <= ts - align < edges(k+1) (the
+ *                  last bin includes edges(end)), as histcounts
+ *      rate:       counts ./ bin widths (spikes/s for times in seconds),
+ *                  smoothed along bins if sigma > 0
+ *      psth:       nBin x nUnit mean rate over the (non-NaN) trials
+ *
+ * Spike times of each unit are sorted once (skipped if they already are)
+ * and the first spike of every trial window is found by binary search,
+ * so a trial costs O(log nSpikes + spikes in the window) instead of a
+ * pass over the whole train. Units (and blocks of trials of each unit)
+ * are processed in parallel.
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <math.h>
+#include <stddef.h>
+#include <algorithm>
+#include <vector>
+#include "mex.h"
+#include "nigel_threads.h"
+
+/* Input Arguments */
+
+#define	TS	prhs[0]
+#define	ALIGN	prhs[1]
+#define	EDGES	prhs[2]
+#define	SIGMA	prhs[3]
+
+/* Constants */
+
+static const size_t TRIAL_BLOCK = 256;   /* Trials per parallel work item */
+static const double KERNEL_SD = 4.0;     /* Gaussian truncated at +/- 4 SD */
+
+///////////////////////////////////////////////////////////////////////////
+/* Helpers */
+///////////////////////////////////////////////////////////////////////////
+
+struct Unit {
+    const double *ts;              /* Sorted spike times */
+    size_t n;
+    std::vector<double> sorted;    /* Sorted copy, if ts was not sorted */
+};
+
+static void prepareUnit(Unit &u)
+{
+    bool isSorted = true;
+    for (size_t i = 1; i < u.n && isSorted; i++) isSorted = !(u.ts[i] < u.ts[i - 1]);
+    if (isSorted) return;
+    u.sorted.assign(u.ts, u.ts + u.n);
+    std::sort(u.sorted.begin(), u.sorted.end());
+    u.ts = u.sorted.data();
+}
+
+/* Counts of one trial (nBin values, stride nTrial in c) */
+static void binTrial(const Unit &u, double a, const std::vector<double> &e,
+                     double *c, size_t stride)
+{
+    size_t nBin = e.size() - 1;
+    for (size_t k = 0; k < nBin; k++) c[k * stride] = 0;
+    if (a != a) return;
+    const double *first = std::lower_bound(u.ts, u.ts + u.n, a + e[0]);
+    while (first > u.ts && first[-1] - a >= e[0]) first--;
+    for (const double *t = first; t < u.ts + u.n; t++)
+    {
+        double v = *t - a;
+        if (v < e[0]) continue;
+        if (v > e[nBin]) break;
+        size_t k = (size_t)(std::upper_bound(e.begin(), e.end(), v) - e.begin());
+        k = (k > nBin) ? nBin - 1 : k - 1; /* v == edges(end): last bin */
+        c[k * stride] += 1;
+    }
+}
+
+/* Rate of one trial: counts ./ widths, smoothed by the kernel g */
+static void rateTrial(const double *c, const std::vector<double> &w,
+                      const std::vector<double> &g, double *r, size_t stride,
+                      std::vector<double> &buf)
+{
+    size_t nBin = w.size();
+    if (g.size() <= 1)
+    {
+        for (size_t k = 0; k < nBin; k++) r[k * stride] = c[k * stride] / w[k];
+        return;
+    }
+    ptrdiff_t h = (ptrdiff_t)g.size() / 2;
+    buf.resize(nBin);
+    for (size_t k = 0; k < nBin; k++) buf[k] = c[k * stride] / w[k];
+    for (ptrdiff_t k = 0; k < (ptrdiff_t)nBin; k++)
+    {
+        double s = 0;
+        for (ptrdiff_t j = -h; j <= h; j++)
+        {
+            ptrdiff_t m = k + j;
+            if (m >= 0 && m < (ptrdiff_t)nBin) s += g[j + h] * buf[m];
+        }
+        r[k * stride] = s;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+void mexFunction( int nlhs, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    if (nrhs != 4)
+        mexErrMsgIdAndTxt("nigeLab:SpikeBins:BadInput",
+            "Requires (ts, align, edges, sigma).");
+    if (!mxIsDouble(ALIGN) || !mxIsDouble(EDGES) || mxIsComplex(ALIGN) ||
+        mxIsComplex(EDGES))
+        mexErrMsgIdAndTxt("nigeLab:SpikeBins:BadClass",
+            "align and edges must be real double vectors.");
+
+    /* Units (pointers only; workers do not touch mxArrays) */
+    size_t nUnit = mxIsCell(TS) ? mxGetNumberOfElements(TS) : 1;
+    std::vector<Unit> units(nUnit);
+    for (size_t u = 0; u < nUnit; u++)
+    {
+        const mxArray *A = mxIsCell(TS) ? mxGetCell(TS, u) : TS;
+        if (A != 0 && !mxIsEmpty(A) && (!mxIsDouble(A) || mxIsComplex(A)))
+            mexErrMsgIdAndTxt("nigeLab:SpikeBins:BadClass",
+                "Spike times must be real double vectors.");
+        units[u].ts = (A != 0 && !mxIsEmpty(A)) ? mxGetPr(A) : 0;
+        units[u].n = (A != 0) ? mxGetNumberOfElements(A) : 0;
+    }
+
+    size_t nTrial = mxGetNumberOfElements(ALIGN);
+    const double *align = mxGetPr(ALIGN);
+    std::vector<double> e(mxGetPr(EDGES), mxGetPr(EDGES) + mxGetNumberOfElements(EDGES));
+    if (e.size() < 2)
+        mexErrMsgIdAndTxt("nigeLab:SpikeBins:BadEdges",
+            "edges must have at least 2 elements.");
+    size_t nBin = e.size() - 1;
+    std::vector<double> w(nBin);
+    for (size_t k = 0; k < nBin; k++)
+    {
+        w[k] = e[k + 1] - e[k];
+        if (!(w[k] > 0))
+            mexErrMsgIdAndTxt("nigeLab:SpikeBins:BadEdges",
+                "edges must be strictly increasing.");
+    }
+
+    /* Normalized Gaussian smoothing kernel */
+    double sigma = mxGetScalar(SIGMA);
+    std::vector<double> g(1, 1.0);
+    if (sigma > 0)
+    {
+        ptrdiff_t h = (ptrdiff_t)ceil(KERNEL_SD * sigma);
+        g.assign(2 * h + 1, 0.0);
+        double s = 0;
+        for (ptrdiff_t j = -h; j <= h; j++)
+        {
+            g[j + h] = exp(-0.5 * (double)(j * j) / (sigma * sigma));
+            s += g[j + h];
+        }
+        for (size_t j = 0; j < g.size(); j++) g[j] /= s;
+    }
+
+    mwSize dims[3] = { (mwSize)nTrial, (mwSize)nBin, (mwSize)nUnit };
+    plhs[0] = mxCreateNumericArray(3, dims, mxDOUBLE_CLASS, mxREAL);
+    double *counts = mxGetPr(plhs[0]);
+    mxArray *R = (nlhs > 1) ? mxCreateNumericArray(3, dims, mxDOUBLE_CLASS, mxREAL) : 0;
+    double *rate = R ? mxGetPr(R) : 0;
+    mxArray *P = (nlhs > 2) ? mxCreateDoubleMatrix(nBin, nUnit, mxREAL) : 0;
+    double *psth = P ? mxGetPr(P) : 0;
+
+    nigel::parallelFor(nUnit, [&](size_t u) { prepareUnit(units[u]); });
+
+    size_t nTB = (nTrial + TRIAL_BLOCK - 1) / TRIAL_BLOCK;
+    nigel::parallelFor(nUnit * nTB, [&](size_t job) {
+        size_t u = job / nTB, b = job % nTB;
+        size_t t0 = b * TRIAL_BLOCK;
+        size_t t1 = (t0 + TRIAL_BLOCK < nTrial) ? t0 + TRIAL_BLOCK : nTrial;
+        double *cu = counts + u * nTrial * nBin;
+        double *ru = rate ? rate + u * nTrial * nBin : 0;
+        std::vector<double> buf;
+        for (size_t t = t0; t < t1; t++)
+        {
+            binTrial(units[u], align[t], e, cu + t, nTrial);
+            if (ru) rateTrial(cu + t, w, g, ru + t, nTrial, buf);
+        }
+    });
+
+    if (psth)
+    {
+        const double NaN = mxGetNaN();
+        size_t nValid = 0;
+        for (size_t t = 0; t < nTrial; t++) nValid += (align[t] == align[t]);
+        nigel::parallelFor(nUnit, [&](size_t u) {
+            const double *ru = rate + u * nTrial * nBin;
+            for (size_t k = 0; k < nBin; k++)
+            {
+                double s = 0;
+                for (size_t t = 0; t < nTrial; t++) s += ru[t + k * nTrial];
+                psth[k + u * nBin] = (nValid > 0) ? s / (double)nValid : NaN;
+            }
+        });
+    }
+    if (R) plhs[1] = R;
+    if (P) plhs[2] = P;
+}
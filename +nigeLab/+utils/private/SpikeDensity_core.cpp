@@ -0,0 +1,238 @@
+/*=================================================================
+ *
+ * SPIKEDENSITY_CORE.CPP	.MEX file for nigeLab.utils.spikeDensity
+ *
+ * The calling syntax is:
+ *
+ *		[C, A] = SpikeDensity_core('build', W, class, edges, nClus)
+ *		C = SpikeDensity_core('update', A, class, C, subs, oldClass)
+ *
+ *      W:          nSpike x nX (interpolated) waveforms (double or single)
+ *      class:      nSpike cluster labels; only spikes with labels
+ *                  1 .. nClus are counted
+ *      edges:      nBin+1 increasing amplitude edges (nBin < 65536)
+ *      nClus:      number of clusters
+ *
+ *      C:          nBin x nX x nClus (single) counts; C(k,x,c) is the
+ *                  number of spikes of cluster c with
+ *                  edges(k) <= W(:,x) < edges(k+1) (the last bin includes
+ *                  edges(end)), as histcounts of each column
+ *      A:          nSpike x nX (uint16) bin of each sample of W; 0 where
+ *                  it is outside the edges (or NaN)
+ *
+ *      'update':   C is the output for the labels before spikes subs
+ *                  (1-based) moved from oldClass to their label in class;
+ *                  returns the output for class
+ *
+ * The bins of every sample are found once, when the waveforms (or
+ * edges) change, each from its position between evenly spaced edges
+ * (checked against the actual edges); a reassignment then only moves the
+ * bins of the moved spikes between clusters, O(numel(subs) * nX), and
+ * the result equals a full recount. Columns of W run in parallel.
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "mex.h"
+#include "nigel_threads.h"
+
+/* Input Arguments */
+
+#define	MODE	prhs[0]
+#define	W_IN	prhs[1]
+#define	A_IN	prhs[1]
+#define	CLASS	prhs[2]
+#define	EDGES	prhs[3]
+#define	NCLUS	prhs[4]
+#define	C_IN	prhs[3]
+#define	SUBS	prhs[4]
+#define	OLD	prhs[5]
+
+/* Constants */
+
+static const size_t MAX_BINS = 65535;   /* Bins must fit a uint16 (0: none) */
+
+///////////////////////////////////////////////////////////////////////////
+/* Helpers */
+///////////////////////////////////////////////////////////////////////////
+
+static void checkDouble(const mxArray *A, const char *name)
+{
+    if (!mxIsDouble(A) || mxIsComplex(A) || mxIsSparse(A))
+        mexErrMsgIdAndTxt("nigeLab:SpikeDensity:BadClass",
+            "%s must be a real, full double array.", name);
+}
+
+/* Cluster index (0-based) of label c, or -1 if not counted */
+static ptrdiff_t clusterIndex(double c, size_t nClus)
+{
+    if (!(c >= 1) || c > (double)nClus || c != floor(c)) return -1;
+    return (ptrdiff_t)c - 1;
+}
+
+/* Bins (1-based; 0 outside) and counts of column x of W */
+template <typename T>
+static void binColumn(const T *w, const double *cls, size_t nSpike,
+                      const std::vector<double> &e, size_t nClus,
+                      uint16_t *a, float *C, size_t nX, size_t x)
+{
+    size_t nBin = e.size() - 1;
+    double scale = (double)nBin / (e.back() - e.front());
+    for (size_t i = 0; i < nSpike; i++)
+    {
+        double v = (double)w[i];
+        uint16_t k = 0;
+        if (v >= e.front() && v <= e.back())
+        {
+            /* Guess from evenly spaced edges, then step to the bin with
+             * edges(k) <= v < edges(k+1) (the last bin at edges(end)) */
+            size_t j = std::min((size_t)((v - e.front()) * scale), nBin - 1);
+            while (j > 0 && v < e[j]) j--;
+            while (j + 1 < nBin && v >= e[j + 1]) j++;
+            k = (uint16_t)(j + 1);
+        }
+        a[i] = k;
+        ptrdiff_t c = clusterIndex(cls[i], nClus);
+        if (k && c >= 0) C[(k - 1) + nBin * (x + nX * (size_t)c)] += 1.0f;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* Modes */
+///////////////////////////////////////////////////////////////////////////
+
+static void doBuild(int nrhs, const mxArray *prhs[], int nlhs, mxArray *plhs[])
+{
+    if (nrhs != 5)
+        mexErrMsgIdAndTxt("nigeLab:SpikeDensity:BadInput",
+            "'build' requires (W, class, edges, nClus).");
+    if (mxIsComplex(W_IN) || mxIsSparse(W_IN) || !(mxIsDouble(W_IN) || mxIsSingle(W_IN)))
+        mexErrMsgIdAndTxt("nigeLab:SpikeDensity:BadClass",
+            "W must be a real, full double or single matrix.");
+    checkDouble(CLASS, "class");
+    checkDouble(EDGES, "edges");
+    size_t nSpike = mxGetM(W_IN), nX = mxGetN(W_IN);
+    if (mxGetNumberOfElements(CLASS) != nSpike)
+        mexErrMsgIdAndTxt("nigeLab:SpikeDensity:BadSize",
+            "class must have one label per row of W.");
+    std::vector<double> e(mxGetPr(EDGES), mxGetPr(EDGES) + mxGetNumberOfElements(EDGES));
+    if (e.size() < 2 || e.size() - 1 > MAX_BINS)
+        mexErrMsgIdAndTxt("nigeLab:SpikeDensity:BadEdges",
+            "edges must define 1 to %d bins.", (int)MAX_BINS);
+    for (size_t k = 1; k < e.size(); k++)
+        if (!(e[k] > e[k - 1]))
+            mexErrMsgIdAndTxt("nigeLab:SpikeDensity:BadEdges",
+                "edges must be increasing.");
+    double nc = mxGetScalar(NCLUS);
+    if (!(nc >= 1) || nc != floor(nc))
+        mexErrMsgIdAndTxt("nigeLab:SpikeDensity:BadInput",
+            "nClus must be a positive integer.");
+    size_t nClus = (size_t)nc, nBin = e.size() - 1;
+
+    mwSize dims[3] = {(mwSize)nBin, (mwSize)nX, (mwSize)nClus};
+    plhs[0] = mxCreateNumericArray(3, dims, mxSINGLE_CLASS, mxREAL);
+    mxArray *A = mxCreateNumericMatrix(nSpike, nX, mxUINT16_CLASS, mxREAL);
+    float *C = (float *)mxGetData(plhs[0]);
+    uint16_t *a = (uint16_t *)mxGetData(A);
+    const double *cls = mxGetPr(CLASS);
+    const double *wd = mxIsDouble(W_IN) ? mxGetPr(W_IN) : 0;
+    const float *wf = mxIsSingle(W_IN) ? (const float *)mxGetData(W_IN) : 0;
+
+    /* Each column writes its own bins and its own slice of C */
+    nigel::parallelFor(nX, [&](size_t x) {
+        if (wd)
+            binColumn(wd + x * nSpike, cls, nSpike, e, nClus, a + x * nSpike, C, nX, x);
+        else
+            binColumn(wf + x * nSpike, cls, nSpike, e, nClus, a + x * nSpike, C, nX, x);
+    });
+
+    if (nlhs > 1)
+        plhs[1] = A;
+    else
+        mxDestroyArray(A);
+}
+
+static void doUpdate(int nrhs, const mxArray *prhs[], mxArray *plhs[])
+{
+    if (nrhs != 6)
+        mexErrMsgIdAndTxt("nigeLab:SpikeDensity:BadInput",
+            "'update' requires (A, class, C, subs, oldClass).");
+    if (mxGetClassID(A_IN) != mxUINT16_CLASS)
+        mexErrMsgIdAndTxt("nigeLab:SpikeDensity:BadClass",
+            "A must be the uint16 bins returned by 'build'.");
+    if (!mxIsSingle(C_IN) || mxIsComplex(C_IN))
+        mexErrMsgIdAndTxt("nigeLab:SpikeDensity:BadClass",
+            "C must be the single counts returned by 'build'.");
+    checkDouble(CLASS, "class");
+    checkDouble(SUBS, "subs");
+    checkDouble(OLD, "oldClass");
+    size_t nSpike = mxGetM(A_IN), nX = mxGetN(A_IN), nBin = mxGetM(C_IN);
+    size_t nMoved = mxGetNumberOfElements(SUBS);
+    if (mxGetNumberOfElements(CLASS) != nSpike ||
+        mxGetNumberOfElements(OLD) != nMoved || nBin == 0 || nX == 0 ||
+        mxGetNumberOfElements(C_IN) % (nBin * nX) != 0)
+        mexErrMsgIdAndTxt("nigeLab:SpikeDensity:BadSize",
+            "A, class, C, subs and oldClass sizes do not match.");
+    size_t nClus = mxGetNumberOfElements(C_IN) / (nBin * nX);
+
+    /* Moved spikes whose counted cluster changed */
+    const double *cls = mxGetPr(CLASS), *subs = mxGetPr(SUBS), *old = mxGetPr(OLD);
+    std::vector<size_t> row;
+    std::vector<ptrdiff_t> from, to;
+    for (size_t j = 0; j < nMoved; j++)
+    {
+        double s = subs[j];
+        if (!(s >= 1) || s > (double)nSpike || s != floor(s))
+            mexErrMsgIdAndTxt("nigeLab:SpikeDensity:BadSubs",
+                "subs must be row indices of A.");
+        size_t i = (size_t)s - 1;
+        ptrdiff_t c0 = clusterIndex(old[j], nClus), c1 = clusterIndex(cls[i], nClus);
+        if (c0 == c1) continue;
+        row.push_back(i);
+        from.push_back(c0);
+        to.push_back(c1);
+    }
+
+    plhs[0] = mxDuplicateArray(C_IN);
+    float *C = (float *)mxGetData(plhs[0]);
+    const uint16_t *a = (const uint16_t *)mxGetData(A_IN);
+    nigel::parallelFor(nX, [&](size_t x) {
+        const uint16_t *ax = a + x * nSpike;
+        for (size_t j = 0; j < row.size(); j++)
+        {
+            size_t k = ax[row[j]];
+            if (k == 0 || k > nBin) continue;
+            if (from[j] >= 0) C[(k - 1) + nBin * (x + nX * (size_t)from[j])] -= 1.0f;
+            if (to[j] >= 0) C[(k - 1) + nBin * (x + nX * (size_t)to[j])] += 1.0f;
+        }
+    });
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+void mexFunction( int nlhs, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    if (nrhs < 1 || !mxIsChar(MODE))
+        mexErrMsgIdAndTxt("nigeLab:SpikeDensity:BadInput",
+            "First input must be a mode (char).");
+    char *c = mxArrayToString(MODE);
+    std::string mode(c);
+    mxFree(c);
+
+    if (mode == "build")
+        doBuild(nrhs, prhs, nlhs, plhs);
+    else if (mode == "update")
+        doUpdate(nrhs, prhs, plhs);
+    else
+        mexErrMsgIdAndTxt("nigeLab:SpikeDensity:BadMode",
+            "Unknown mode '%s'.", mode.c_str());
+}
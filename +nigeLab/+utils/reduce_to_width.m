@@ -28,6 +28,12 @@ function [x_reduced, y_reduced] = reduce_to_width(x, y, width, lims)
 % plot(xr, yr); % This contains many fewer points than plot(x, y) but looks
 %                 the same.
 %
+% If the compiled MinMaxReduce_core kernel is available (see
+% nigeLab.utils.compileNativeKernels), each column is reduced in one pass
+% over the samples within the limits (columns in parallel); the output is
+% the same. For long, uniformly sampled data, nigeLab.utils.MinMaxPyramid
+% serves any zoom without scanning the samples.
+%
 % Tucker McClure
 % Copyright 2013, The MathWorks, Inc.
 
@@ -43,6 +49,13 @@ function [x_reduced, y_reduced] = reduce_to_width(x, y, width, lims)
         return;
     end
 
+    if exist('MinMaxReduce_core', 'file') == 3 ...
+            && isfloat(x) && isfloat(y) && isreal(x) && isreal(y)
+        [x_reduced, y_reduced] = MinMaxReduce_core('reduce', x, y, ...
+                                                   width, double(lims));
+        return;
+    end
+
     % Reduce the data to the new axis size.
     x_reduced = nan(n_points, size(y, 2));
     y_reduced = nan(n_points, size(y, 2));
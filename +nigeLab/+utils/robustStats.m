@@ -0,0 +1,124 @@
+function v = robustStats(x,stat,varargin)
+%ROBUSTSTATS  Median, MAD and percentiles used by detection thresholds
+%
+%  v = nigeLab.utils.robustStats(x,'median');
+%  --> median(x)
+%
+%  v = nigeLab.utils.robustStats(x,'medianabs');
+%  --> median(abs(x)), without making the abs(x) copy
+%
+%  v = nigeLab.utils.robustStats(x,'mad');
+%  --> mad(x,1)
+%
+%  v = nigeLab.utils.robustStats(x,'prctile',p);
+%  --> prctile(x,p)
+%
+%  v = nigeLab.utils.robustStats(___,'Windows',win);
+%  --> Statistic of each window of the vector x. win is an nWin x 2
+%      matrix of [start stop] sample indices; v is nWin x 1 (nWin x
+%      numel(p) for 'prctile').
+%
+%  S = nigeLab.utils.robustStats(x,'sketch');
+%  S = nigeLab.utils.robustStats(x,'sketch',S);
+%  S = nigeLab.utils.robustStats(x,'sketch',S,k);
+%  --> Adds the samples of x to the quantile sketch S (a new one if S is
+%      omitted or empty). S summarizes data that are read in chunks (for
+%      example, one DiskData page at a time) in fixed memory; the rank of
+%      any percentile it returns is within about 2/k (default k: 200).
+%
+%  S = nigeLab.utils.robustStats(S1,'merge',S2);
+%  --> Sketch of the samples of both S1 and S2 (e.g. separate chunks)
+%
+%  v = nigeLab.utils.robustStats(S,'query',p);
+%  --> Approximate prctile(data,p) of all samples added to S
+%
+%  x may be double or single (v has the class of x). As with median and
+%  prctile, a matrix gives the statistic of each column.
+%
+%  If the compiled RobustStats_core kernel is available (see
+%  nigeLab.utils.compileNativeKernels), exact statistics use linear-time
+%  selection instead of sorting (columns and windows in parallel); the
+%  output is the same. The sketch modes require the kernel.
+
+if nargin < 2
+   error(['nigeLab:' mfilename ':TooFewInputs'],...
+      '[ROBUSTSTATS]: Requires at least two inputs (x, stat).');
+end
+
+switch lower(stat)
+   case {'median','medianabs','mad','prctile'}
+      stat = lower(stat);
+   case {'sketch','merge','query'}
+      if exist('RobustStats_core','file')~=3
+         error(['nigeLab:' mfilename ':NoKernel'],...
+            ['[ROBUSTSTATS]: ''%s'' requires the compiled RobustStats_core ' ...
+             '(see nigeLab.utils.compileNativeKernels)'],stat);
+      end
+      v = RobustStats_core(lower(stat),x,varargin{:});
+      return;
+   otherwise
+      error(['nigeLab:' mfilename ':BadStat'],...
+         '[ROBUSTSTATS]: Unknown statistic: %s',stat);
+end
+
+% Parse percentiles and 'Windows'
+if strcmp(stat,'prctile')
+   if isempty(varargin)
+      error(['nigeLab:' mfilename ':TooFewInputs'],...
+         '[ROBUSTSTATS]: ''prctile'' requires percentiles (p).');
+   end
+   p = varargin{1};
+   varargin(1) = [];
+else
+   p = 50;
+end
+win = [];
+for iV = 1:2:numel(varargin)
+   switch lower(varargin{iV})
+      case 'windows'
+         win = varargin{iV+1};
+      otherwise
+         error(['nigeLab:' mfilename ':BadParam'],...
+            '[ROBUSTSTATS]: Unknown parameter: %s',varargin{iV});
+   end
+end
+
+if exist('RobustStats_core','file')==3 && isfloat(x) && isreal(x) && ...
+      ~issparse(x) && ismatrix(x) && ~isempty(x)
+   v = RobustStats_core(stat,x,win,p);
+   return;
+end
+
+if isempty(win)
+   v = getStat(x,stat,p);
+   return;
+end
+
+nWin = size(win,1);
+if strcmp(stat,'prctile')
+   v = nan(nWin,numel(p));
+else
+   v = nan(nWin,1);
+end
+if isa(x,'single')
+   v = single(v);
+end
+for iW = 1:nWin
+   v(iW,:) = reshape(getStat(x(win(iW,1):win(iW,2)),stat,p),1,[]);
+end
+
+end
+
+function v = getStat(x,stat,p)
+% GETSTAT  Statistic of x (MATLAB implementation)
+switch stat
+   case 'median'
+      v = median(x);
+   case 'medianabs'
+      v = median(abs(x));
+   case 'mad'
+      v = mad(x,1);
+   case 'prctile'
+      v = prctile(x,p);
+end
+end
@@ -0,0 +1,101 @@
+function [C,A] = spikeDensity(W,class,edges,varargin)
+%SPIKEDENSITY  Waveform density (amplitude x time) images of each cluster
+%
+%  [C,A] = nigeLab.utils.spikeDensity(W,class,edges);
+%  --> C(k,x,c) is the number of spikes of cluster c whose waveform
+%      sample x is in amplitude bin k: edges(k) <= W(:,x) < edges(k+1)
+%      (the last bin includes edges(end)), as histcounts of each column.
+%      A(i,x) is the bin of W(i,x) (0 if outside the edges or NaN).
+%
+%  [C,A] = nigeLab.utils.spikeDensity(___,'NumClus',nClus);
+%  --> C has nClus clusters (default: max(class)). Spikes with labels
+%      outside 1 .. nClus are not counted.
+%
+%  C = nigeLab.utils.spikeDensity(A,class,[],'Counts',C,'Moved',subs,...
+%                                 'OldClass',oldClass);
+%  --> Update of C (with the bins A it was returned with), the counts of
+%      the labels before the spikes subs moved from oldClass to their
+%      label in class (as nigeLab.libs.SpikeImage/UpdateClusterAssignments);
+%      the result is the same as a full recount with class.
+%
+%  W     : nSpike x nX (interpolated) spike waveforms
+%  class : Cluster label of each spike
+%  edges : nBin+1 increasing amplitude bin edges (nBin < 65536)
+%
+%  C is single and A is uint16. If the compiled SpikeDensity_core kernel
+%  is available (see nigeLab.utils.compileNativeKernels), the columns of
+%  W are binned in parallel and an update only moves the bins of the
+%  moved spikes between clusters; otherwise the same is vectorized in
+%  MATLAB. The output is the same.
+
+p = struct('NumClus',[],'Counts',[],'Moved',[],'OldClass',[]);
+for iV = 1:2:numel(varargin)
+   switch lower(varargin{iV})
+      case 'numclus'
+         p.NumClus = varargin{iV+1};
+      case 'counts'
+         p.Counts = varargin{iV+1};
+      case 'moved'
+         p.Moved = varargin{iV+1};
+      case 'oldclass'
+         p.OldClass = varargin{iV+1};
+      otherwise
+         error(['nigeLab:' mfilename ':BadParam'],...
+            '[SPIKEDENSITY]: Unknown parameter: %s',varargin{iV});
+   end
+end
+
+class = double(class(:));
+isUpdate = ~isempty(p.Counts);
+if islogical(p.Moved)
+   p.Moved = find(p.Moved);
+end
+if isUpdate
+   A = W;
+   nClus = size(p.Counts,3);
+elseif isempty(p.NumClus)
+   nClus = max([class; 1]);
+else
+   nClus = p.NumClus;
+end
+
+if exist('SpikeDensity_core','file')==3
+   if isUpdate
+      C = SpikeDensity_core('update',A,class,single(p.Counts),...
+         double(p.Moved(:)),double(p.OldClass(:)));
+   else
+      if ~isfloat(W)
+         W = double(W);
+      end
+      [C,A] = SpikeDensity_core('build',W,class,double(edges(:).'),nClus);
+   end
+   return;
+end
+
+% MATLAB implementation: bins of all samples at once, then counts of
+% (bin, column, cluster) triplets
+if isUpdate
+   subs = p.Moved(:);
+   C = p.Counts + countBins(subs,class(subs),1,size(p.Counts)) - ...
+      countBins(subs,double(p.OldClass(:)),1,size(p.Counts));
+else
+   nBin = numel(edges) - 1;
+   if nBin > intmax('uint16')
+      error(['nigeLab:' mfilename ':BadEdges'],...
+         '[SPIKEDENSITY]: Too many amplitude bins (%g)',nBin);
+   end
+   A = discretize(double(W),edges);
+   A(isnan(A)) = 0;
+   A = uint16(A);
+   C = countBins((1:size(A,1)).',class,1,[nBin size(A,2) nClus]);
+end
+
+   % Helper function: counts of the bins of spikes `rows` with labels `c`
+   function n = countBins(rows,c,w,sz)
+      k = double(A(rows,:));
+      x = repmat(1:size(A,2),numel(rows),1);
+      c = repmat(c(:),1,size(A,2));
+      in = (k > 0) & (c >= 1) & (c <= sz(3)) & (c == round(c));
+      n = single(accumarray([k(in) x(in) c(in)],w,[sz(1) sz(2) sz(3)]));
+   end
+end
@@ -0,0 +1,34 @@
+function uTest_combineIntervals()
+%UTEST_COMBINEINTERVALS  Automatic test of nigeLab.utils.combineIntervals
+%
+%  nigeLab.utils.uTest_combineIntervals();
+%  --> Stops with an error on failure. Tests whichever implementation
+%      combineIntervals uses (PointProcess_core if it is compiled, the
+%      MATLAB version otherwise); run it with and without the kernel.
+
+ErrID = ['nigeLab:' mfilename ':Failed'];
+f = @nigeLab.utils.combineIntervals;
+
+% Overlapping intervals are merged; touching ones only with gap = 1
+check(f([6 9; 1 5]),[1 5; 6 9],'touching intervals (gap = 0)');
+check(f([6 9; 1 5],[],'union',1),[1 9],'touching intervals (gap = 1)');
+check(f([1 5],[6 9],'union',1),[1 9],'touching intervals of A and B');
+check(f([1 5; 7 9],[],'union',1),[1 5; 7 9],'separated intervals (gap = 1)');
+check(f([1 5; 3 9; 20 30]),[1 9; 20 30],'overlapping intervals');
+
+% Intersection of sample intervals is not affected by touching
+check(f([1 5; 6 9],[5 6],'intersect'),[5 5; 6 6],'intersect');
+check(f([1 5],[6 9],'intersect'),zeros(0,2),'disjoint intersect');
+
+% Empty and reversed intervals
+check(f(zeros(0,2),[],'union',1),zeros(0,2),'empty input');
+check(f([5 1; 2 3]),[2 3],'reversed interval is dropped');
+
+fprintf(1,'%s: all tests passed\n',mfilename);
+
+   function check(T,expected,name)
+      if ~isequal(size(T),size(expected)) || any(T(:) ~= expected(:))
+         error(ErrID,'[UTEST_COMBINEINTERVALS]: Failed: %s',name);
+      end
+   end
+end
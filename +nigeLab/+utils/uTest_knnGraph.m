@@ -0,0 +1,47 @@
+function uTest_knnGraph()
+%UTEST_KNNGRAPH  Automatic test of nigeLab.utils.knnGraph
+%
+%  nigeLab.utils.uTest_knnGraph();
+%  --> Stops with an error on failure. Tests whichever implementation
+%      knnGraph uses (KnnGraph_core if it is compiled, the MATLAB version
+%      otherwise); run it with and without the kernel.
+
+ErrID = ['nigeLab:' mfilename ':Failed'];
+f = @nigeLab.utils.knnGraph;
+
+% Points on a line: 0 1 3 7 12 (no ties)
+X = [0; 1; 3; 7; 12];
+
+% Default call, without edges
+[idx,d] = f(X,2);
+check(idx,[2 3; 1 3; 2 1; 3 5; 4 3],'neighbours');
+check(d,[1 3; 1 2; 2 3; 4 5; 5 9],'distances');
+idx = f(single(X),1);
+check(idx,[2; 1; 2; 3; 4],'single, one output');
+
+% Edges
+[~,~,E] = f(X,1,'Edges','knn');
+check(E,[1 2 1; 2 3 2; 3 4 4; 4 5 5],'knn edges');
+[~,~,E] = f(X,1,'Edges','mutual');
+check(E,[1 2 1],'mutual edges');
+[~,~,E] = f(X,1,'Edges','mst');
+check(E,[1 2 1; 2 3 2; 3 4 4; 4 5 5],'mst edges');
+
+% Requesting E without an edge type is an error
+try
+   [~,~,E] = f(X,1); %#ok<ASGLU>
+   error(ErrID,'[UTEST_KNNGRAPH]: Failed: E without ''Edges''');
+catch me
+   if strcmp(me.identifier,ErrID)
+      rethrow(me);
+   end
+end
+
+fprintf(1,'%s: all tests passed\n',mfilename);
+
+   function check(T,expected,name)
+      if ~isequal(size(T),size(expected)) || any(T(:) ~= expected(:))
+         error(ErrID,'[UTEST_KNNGRAPH]: Failed: %s',name);
+      end
+   end
+end
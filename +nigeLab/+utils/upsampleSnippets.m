@@ -0,0 +1,65 @@
+function Y = upsampleSnippets(X,nOut,method)
+%UPSAMPLESNIPPETS  Interpolate every spike snippet to nOut samples
+%
+%  Y = nigeLab.utils.upsampleSnippets(X,nOut);
+%  --> Same as:
+%        n = size(X,2);
+%        Y = interp1(1:n,X.',linspace(1,n,nOut),'spline').';
+%
+%  Y = nigeLab.utils.upsampleSnippets(X,nOut,method);
+%  --> Uses another interp1 method (e.g. 'linear'; 'pchip' and 'makima'
+%      are not linear in the data and are not supported)
+%
+%  X : nSpikes x n snippets (double or single; Y has the same class)
+%  Y : nSpikes x nOut interpolated snippets
+%
+%  Spline (and linear) interpolation at fixed sample positions is a linear
+%  map of the snippet, so it is a single n x nOut matrix for a given
+%  (n, nOut, method). That matrix is computed once and cached, and all
+%  snippets are interpolated by one matrix product (BLAS: blocked and
+%  multithreaded, in single precision for single snippets) instead of
+%  solving the spline system for every spike.
+
+if nargin < 3
+   method = 'spline';
+end
+
+switch lower(method)
+   case {'spline','linear','nearest','previous','next'}
+      method = lower(method);
+   otherwise
+      error(['nigeLab:' mfilename ':BadMethod'],...
+         '[UPSAMPLESNIPPETS]: ''%s'' is not a linear interpolation method',...
+         method);
+end
+
+n = size(X,2);
+W = getInterpMatrix(n,nOut,method);
+if isa(X,'single')
+   W = single(W);
+end
+Y = X * W;
+
+end
+
+function W = getInterpMatrix(n,nOut,method)
+% GETINTERPMATRIX  n x nOut matrix with Y = X * W (cached)
+persistent cache
+if isempty(cache)
+   cache = containers.Map('KeyType','char','ValueType','any');
+end
+
+key = sprintf('%d_%d_%s',n,nOut,method);
+if isKey(cache,key)
+   W = cache(key);
+   return;
+end
+
+if n < 2
+   W = ones(n,nOut); % Constant snippet
+else
+   W = interp1(1:n,eye(n),linspace(1,n,nOut),method).';
+end
+cache(key) = W;
+
+end
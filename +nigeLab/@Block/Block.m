@@ -1004,6 +1004,7 @@ classdef Block < nigeLab.nigelObj
       idx = getSpikeTrain(blockObj,ch,class)   % Get spike sample indices
       spikes = getSpikes(blockObj,ch,class,type)   % Get spike waveforms
       features = getSpikeFeatures(blockObj,ch,class) % Get extracted features
+      [psth,counts,rate] = getPSTH(blockObj,ch,class,align,edges,sigma) % Get binned peri-event spike trains
       sortIdx = getSort(blockObj,ch,suppress)  % Get spike sorted classes
       clusIdx = getClus(blockObj,ch,suppress)  % Get spike cluster classes
       [tag,str] = getTag(blockObj,ch)          % Get spike sorted tags
@@ -1016,9 +1017,10 @@ classdef Block < nigeLab.nigelObj
       [flag,idx] = setEventData(blockObj,fieldName,eventName,propName,value,rowIdx,colIdx);
       
       % Computational methods:
-      [tf_map,times_in_ms] = analyzeERS(blockObj,options) % Event-related synchronization (ERS)
+      [tf_map,times_in_ms,freqs,pow] = analyzeERS(blockObj,options) % Event-related synchronization (ERS)
       analyzeLFPSyncIndex(blockObj)  % LFP synchronization index
       rms_out = analyzeRMS(blockObj,type,sampleIndices)  % Compute RMS for channels
+      stats = analyzeChannelStats(blockObj,field,varargin) % One-pass stream statistics and spectra
       
       % Methods for visualizing data:
       flag = plotWaves(blockObj,ax,field,idx,computeRMS)          % Plot stream snippets
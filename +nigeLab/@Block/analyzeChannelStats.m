@@ -0,0 +1,178 @@
+function stats = analyzeChannelStats(blockObj,field,varargin)
+%ANALYZECHANNELSTATS  One-pass amplitude and spectral statistics of streams
+%
+%  stats = ANALYZECHANNELSTATS(blockObj,field);
+%  stats = ANALYZECHANNELSTATS(blockObj,field,'NAME',value,...);
+%
+%  --------
+%   INPUTS
+%  --------
+%  blockObj    :     nigeLab.Block class object.
+%
+%    field     :     Stream to analyze ('Raw', 'Filt', 'CAR' or 'LFP').
+%
+%  varargin    :     (Optional) 'NAME', value pairs:
+%     -> 'Channels'   : Channel indices (default: blockObj.Mask)
+%     -> 'NFFT'       : Welch segment length (samples; power of 2;
+%                          default: 2^nextpow2(fs), ~1 Hz resolution; 0
+%                          for no spectra)
+%     -> 'Window'     : Band-power window length (sec; default: 60; 0
+%                          for none)
+%     -> 'Bands'      : nBand x 2 [low high] (Hz) band edges (default:
+%                          [0 4; 4 100])
+%     -> 'Saturation' : Samples with abs(x) >= this count as saturated
+%                          (default: inf)
+%
+%  --------
+%   OUTPUT
+%  --------
+%    stats     :     Struct of arrays (one column per channel):
+%     -> Channels, N (non-NaN samples), Mean, RMS, Median, MAD (mad(x,1)),
+%        Min, Max, NSaturated
+%     -> Freqs (nFreq x 1) and PSD (nFreq x nCh): Welch estimate (Hann
+%        windows, 50% overlap, one-sided, as pwelch)
+%     -> WindowTimes (nWin x 1, sec; window starts) and BandPower
+%        (nBand x nWin x nCh): mean band power of the Welch segments
+%        that start in each window
+%
+%  Each stream is read once, in chunks of about 2^20 samples of all
+%  channels. If the compiled ChannelStats_core kernel is available (see
+%  nigeLab.utils.compileNativeKernels), every statistic is accumulated
+%  from each chunk in one pass, with channels in parallel; Median and MAD
+%  then come from a quantile sketch (rank error about 1%). Otherwise each
+%  channel is loaded in full and the same statistics (Median and MAD
+%  exact) are computed in MATLAB.
+
+CHUNK_SAMPLES = 2^20; % Approx. samples of each channel per read
+
+% PARSE INPUT
+if strcmpi(field,'LFP')
+   fs = blockObj.Pars.LFP.DownSampledRate;
+else
+   fs = blockObj.SampleRate;
+end
+p = struct('Channels',blockObj.Mask,'NFFT',2^nextpow2(fs),...
+   'Window',60,'Bands',[0 4; 4 100],'Saturation',inf);
+for iV = 1:2:numel(varargin)
+   f = fieldnames(p);
+   idx = strcmpi(f,varargin{iV});
+   if ~any(idx)
+      error(['nigeLab:' mfilename ':BadParam'],...
+         '[ANALYZECHANNELSTATS]: Unknown parameter: %s',varargin{iV});
+   end
+   p.(f{idx}) = varargin{iV+1};
+end
+ch = reshape(p.Channels,1,numel(p.Channels));
+nCh = numel(ch);
+nfft = p.NFFT;
+hop = max(nfft/2,1);
+winLen = round(p.Window*fs/hop)*hop; % Windows hold whole hops
+nBand = size(p.Bands,1);
+N = blockObj.Channels(ch(1)).(field).length;
+
+stats = struct('Channels',ch,'N',zeros(1,nCh),'Mean',nan(1,nCh),...
+   'RMS',nan(1,nCh),'Median',nan(1,nCh),'MAD',nan(1,nCh),...
+   'Min',nan(1,nCh),'Max',nan(1,nCh),'NSaturated',zeros(1,nCh),...
+   'Freqs',(0:(nfft/2)).'*fs/max(nfft,1),'PSD',zeros(floor(nfft/2)+1,nCh),...
+   'WindowTimes',zeros(0,1),'BandPower',zeros(nBand,0,nCh));
+if nfft == 0
+   stats.Freqs = zeros(0,1);
+   stats.PSD = zeros(0,nCh);
+end
+
+if exist('ChannelStats_core','file')==3
+   % Chunks start on window (and segment) boundaries
+   if winLen > 0
+      L = max(1,round(CHUNK_SAMPLES/winLen))*winLen;
+   else
+      L = max(1,round(CHUNK_SAMPLES/hop))*hop;
+   end
+   mom = zeros(9,nCh);
+   mom(4,:) = inf;
+   mom(5,:) = -inf;
+   bp = cell(1,ceil(N/L));
+   S = {};
+   for iChunk = 1:ceil(N/L)
+      c0 = (iChunk-1)*L;
+      nNew = min(L,N-c0);
+      vec = (c0+1):min(c0+L+max(nfft-hop,0),N);
+      X = zeros(numel(vec),nCh);
+      for iCh = 1:nCh
+         X(:,iCh) = blockObj.Channels(ch(iCh)).(field)(vec);
+      end
+      [m,psd,bp{iChunk},S] = ChannelStats_core(X,nNew,p.Saturation,...
+         nfft,hop,winLen,p.Bands,fs,S);
+      mom([1:3 6 7],:) = mom([1:3 6 7],:) + m([1:3 6 7],:);
+      mom(4,:) = min(mom(4,:),m(4,:));
+      mom(5,:) = max(mom(5,:),m(5,:));
+      mom(8:9,:) = m(8:9,:);
+      stats.PSD = stats.PSD + psd;
+   end
+   nSeg = mom(7,:);
+   stats.N = mom(1,:);
+   stats.Mean = mom(2,:) ./ mom(1,:);
+   stats.RMS = sqrt(mom(3,:) ./ mom(1,:));
+   stats.Median = mom(8,:);
+   stats.MAD = mom(9,:);
+   stats.Min = mom(4,:);
+   stats.Max = mom(5,:);
+   stats.NSaturated = mom(6,:);
+   stats.BandPower = cat(2,zeros(nBand,0,nCh),bp{:});
+else
+   nSeg = zeros(1,nCh);
+   bp = cell(1,nCh);
+   for iCh = 1:nCh
+      x = double(blockObj.Channels(ch(iCh)).(field)(:));
+      x = reshape(x,numel(x),1);
+      v = x(~isnan(x));
+      stats.N(iCh) = numel(v);
+      stats.Mean(iCh) = mean(v);
+      stats.RMS(iCh) = sqrt(mean(v.^2));
+      stats.Median(iCh) = median(v);
+      stats.MAD(iCh) = mad(v,1);
+      stats.Min(iCh) = min([v; nan]);
+      stats.Max(iCh) = max([v; nan]);
+      stats.NSaturated(iCh) = sum(abs(v) >= p.Saturation);
+      [stats.PSD(:,iCh),nSeg(iCh),bp{iCh}] = welchSegments(x);
+   end
+   stats.BandPower = cat(3,zeros(nBand,0,0),bp{:});
+end
+stats.PSD = stats.PSD ./ nSeg;
+stats.WindowTimes = (0:(size(stats.BandPower,2)-1)).' * winLen / fs;
+
+   % Helper function: Welch PSD (sum over segments) and window band power
+   function [psd,nSeg,bp] = welchSegments(x)
+      n = numel(x);
+      psd = zeros(floor(nfft/2)+1,1);
+      nSeg = 0;
+      if nfft == 0
+         bp = zeros(nBand,0);
+         return;
+      end
+      nWin = 0;
+      if winLen > 0
+         nWin = floor(n/winLen);
+      end
+      bp = zeros(nBand,nWin);
+      w = hann(nfft);
+      k = (0:(nfft/2)).';
+      side = 2 - ((k == 0) | (k == nfft/2));
+      inBand = (k*fs/nfft > p.Bands(:,1).') & (k*fs/nfft <= p.Bands(:,2).');
+      starts = 0:hop:(n-nfft);
+      nInWin = zeros(1,nWin);
+      for iB = 1:1024:numel(starts)
+         s0 = starts(iB:min(iB+1023,end));
+         F = fft(w .* x((1:nfft).' + s0));
+         P = side .* abs(F(1:(nfft/2+1),:)).^2 / (fs*sum(w.^2));
+         psd = psd + sum(P,2);
+         iw = floor(s0/max(winLen,1)) + 1;
+         keep = iw <= nWin;
+         bp = bp + (inBand.' * P(:,keep)) * sparse(1:nnz(keep),iw(keep),...
+            1,nnz(keep),nWin) * fs/nfft;
+         nInWin = nInWin + accumarray(iw(keep).',1,[nWin 1]).';
+      end
+      nSeg = numel(starts);
+      bp = bp ./ nInWin;
+   end
+
+end
@@ -1,89 +1,150 @@
-function  [tf_map,times_in_ms]=analyzeERS(blockObj,options)
-
-%% performs the event relater power spectrum analysis on the data provided 
-% blockObj contains the recording and the metadata
-% options is a structure where some parameters are specified such as the
-% filtering options
-% window depth for the spectrogram
-% window step for the spectrogram
-% frequency resolution we want to investigate the data
-% The event structure has information about the events. It is a structure
-% array where each element has the fields:
-% time
-% label
+function  [tf_map,times_in_ms,freqs,pow] = analyzeERS(blockObj,options)
+%ANALYZEERS  Event-related synchronization / desynchronization (ERS/ERD)
+%
+%  [tf_map,times_in_ms] = ANALYZEERS(blockObj,options);
+%  [tf_map,times_in_ms,freqs,pow] = ANALYZEERS(blockObj,options);
+%
+%  --------
+%   INPUTS
+%  --------
+%  blockObj    :     nigeLab.Block class object.
+%
+%  options     :     Struct with any of the following fields:
+%     -> 'Event'    : Trigger times (sec), or name of an event (char)
+%                       read with getEventData (required)
+%     -> 'pretrig'  : Start of each epoch (sec, relative; default: -1)
+%     -> 'posttrig' : End of each epoch (sec, relative; default: 2)
+%     -> 'baseline' : [start stop] of the baseline (sec, relative;
+%                       default: [pretrig 0]). Empty: no normalization
+%     -> 'Field'    : Stream to analyze (default: 'LFP')
+%     -> 'Channels' : Channel indices (default: blockObj.Mask)
+%     -> 'Freqs'    : Frequencies (Hz; default: 1:300, up to Nyquist)
+%     -> 'Window'   : Window length (sec; default: 2/3)
+%     -> 'Step'     : Window step (sec; default: 0.03)
+%     -> 'Tapers'   : 1 for a Hann window, K > 1 for a multitaper
+%                       estimate with K sine tapers (default: 1)
+%
+%  --------
+%   OUTPUT
+%  --------
+%   tf_map     :     nFreq x nTime x nChannel trial-averaged ERS/ERD (%),
+%                       100 * (P - B) ./ B, where P is the power of a trial
+%                       and B its mean power in the baseline. Definition:
+%                       https://doi.org/10.1016/S1388-2457(99)00141-8
+%                       (mean power if there is no baseline)
 %
-% different events type are defined by different labes
+%  times_in_ms :     1 x nTime window centers (ms) relative to the events
+%
+%     freqs    :     1 x nFreq frequencies (Hz)
+%
+%      pow     :     nFreq x nTime x nChannel trial-averaged power
+%                       spectral density
+%
+%  Only the samples of the epochs (events whose epoch lies within the
+%  record) are read. If the compiled TimeFrequency_core kernel is
+%  available (see nigeLab.utils.compileNativeKernels), power is computed
+%  only in the requested band (chirp-z transform) and the baseline and
+%  trial averages are accumulated in the same pass, with channels in
+%  parallel; the output is the same.
 
-hp = 1;
-lp = 300;
-% Fs = blockObj.Downsampling_rate;
-large_window = 2/3; % window length in sec
-step_window  = 0.03; % step length in sec, smaller will make calculation take longer time
-frequencies  = hp:lp; % in Hz, resolution 1 Hz
+% PARSE INPUT
+if nargin < 2 || ~isfield(options,'Event')
+   error(['nigeLab:' mfilename ':BadInput'],...
+      '[ANALYZEERS]: options.Event (trigger times or name) is required.');
+end
+p = struct('pretrig',-1,'posttrig',2,'Field','LFP',...
+   'Channels',blockObj.Mask,'Freqs',1:300,'Window',2/3,'Step',0.03,...
+   'Tapers',1);
+f = fieldnames(options);
+for iF = 1:numel(f)
+   p.(f{iF}) = options.(f{iF});
+end
+if ~isfield(p,'baseline')
+   p.baseline = [p.pretrig 0];
+end
 
-% window2 = hann( round(Fs*large_window) ); % in points/samples
-window2 = round(Fs*large_window); % in points/samples
-overlap = round( Fs*(large_window-step_window)); % in points/samples (integer)
+if strcmpi(p.Field,'LFP')
+   fs = blockObj.Pars.LFP.DownSampledRate;
+else
+   fs = blockObj.SampleRate;
+end
+freqs = p.Freqs(p.Freqs <= fs/2);
+freqs = reshape(freqs,1,numel(freqs));
+if ischar(p.Event)
+   evt = getEventData(blockObj,[],'ts',p.Event);
+else
+   evt = p.Event;
+end
+evt = evt(~isnan(evt(:)));
 
+% FRAMES: window centers from pretrig to posttrig, every step
+nWin = round(fs*p.Window);
+tFrame = p.pretrig:p.Step:p.posttrig;
+frameStart = round(tFrame*fs) - floor(nWin/2);
+offset = frameStart(1);
+frameStart = frameStart - offset;
+nSamples = frameStart(end) + nWin;
+times_in_ms = 1000*tFrame;
+if isempty(p.baseline)
+   baseFrames = [];
+else
+   baseFrames = find((tFrame >= p.baseline(1)) & (tFrame <= p.baseline(2)));
+end
 
-for i=1:blockObj.numChannels
-    fprintf(1,'channel %d of %d\n', i,blockObj.numChannels);
-    
-    
-    [~, F, T, P] = spectrogram(blockObj.Channels(i).filtData(:), window2, overlap, frequencies, Fs);
-    P = medfilt2(P,[5 5]);  % smooth the spectrogram
-    
-    
-    % get map of each type of triggers
-    for iter_conditions = 1:conditions_num
-        %prepare parameters
-        pretrig=options.pretrig*blockObj.Sample_rate;
-        posttrig=options.posttrig*blockObj.Sample_rate;
-        baseline=options.baseline*blockObj.Sample_rate;
-     
-        event_time = cat(1, events.time);
-        
-        %delete those cannot be used
-        event_time(event_time+1.1*pretrig/Fs<1)=[];  %delete first several events that do not have enough time for pretrig
-        event_time(event_time+1.1*posttrig/Fs>size(blockObj.Channels(i).filtData(:),2))=[]; %delete last several events that do not have enough time for posttrig
-        
-        nf=size(P,1);  %frequency channel number
-        Nsamples=posttrig-pretrig+1; % time in sample points
-        
-        ntrig=length(event_time); %number of triggers
-        
-        epoched_data=zeros(ntrig,nf,Nsamples);
-        event_sample=event_time*Fs;
-        for ii=1:ntrig
-            interval=[event_sample+pretrig:event_sample+posttrig];
-            base_interval=event_sample+baseline(1):baseline(2)+event_sample;
-            if interval(1)>=1 && interval(end)<=length(time_axis)
-                epoched_baselines(ii,:)=mean(P(:,base_interval),2);
-                epoched_base_vars(ii,:)=var(P(:,base_interval),2);
-                epoched_data(ii,:,:)=(P(:,interval)-epoched_baselines(ii,:))./...
-                epoched_base_vars(ii,:)*ones(1,Nsamples);         
-            end
-        end
-        
- 
-        
-        tf_map=100*squeeze(mean(epoched_data,1)); % definition of ERS/ERD, refer to https://doi.org/10.1016/S1388-2457(99)00141-8
-        
-        times_in_ms=1000/Fs*[pretrig:posttrig]; %time_in_ms = 1000ms*[Ts*sample_point], Ts = 1/Fs
-        
-        
-        
-        %save result to structure
-        ers_erd_sensor(iter_conditions).condition_name = triggers(iter_conditions).condition_name;
-        ers_erd_sensor(iter_conditions).time_axis = times;
-        ers_erd_sensor(iter_conditions).frequency_axis = frequencies;
-        ers_erd_sensor(iter_conditions).tf_map(i,:,:) = tf_map;
-        ers_erd_sensor(iter_conditions).label{i} = source.label{i};
-    end
-    
+% EPOCHS: only events with the whole epoch in the record
+ch = p.Channels;
+N = blockObj.Channels(ch(1)).(p.Field).length;
+first = round(evt*fs) + 1 + offset; % First sample (1-based) of epochs
+first = first((first >= 1) & (first + nSamples - 1 <= N));
+idx = first(:).' + (0:(nSamples-1)).';
+[u,~,iu] = unique(idx(:));
+X = zeros(nSamples,numel(first),numel(ch));
+for iCh = 1:numel(ch)
+   data = blockObj.Channels(ch(iCh)).(p.Field)(u.');
+   X(:,:,iCh) = reshape(data(iu),nSamples,numel(first));
 end
 
-n_range=3;
+if exist('TimeFrequency_core','file')==3
+   [tf_map,pow] = TimeFrequency_core(X,fs,freqs,nWin,frameStart,...
+      baseFrames,p.Tapers);
+   return;
+end
 
+% MATLAB implementation: DFT of the tapered frames at freqs
+n = (0:(nWin-1)).';
+if p.Tapers > 1
+   w = sin(pi*(n+1)*(1:p.Tapers)/(nWin+1));
+else
+   w = hann(nWin);
+end
+scale = 1 ./ (fs * sum(w.^2,1) * size(w,2));
+side = 2 - ((freqs == 0) | (abs(freqs) == fs/2));
+E = exp(-2i*pi*freqs(:)*n.'/fs); % nFreq x nWin
+frameIdx = (1:nWin).' + frameStart; % nWin x nFrame
+nF = numel(freqs);
+nFrame = numel(tFrame);
+tf_map = zeros(nF,nFrame,numel(ch));
+pow = zeros(nF,nFrame,numel(ch));
+for iCh = 1:numel(ch)
+   for iT = 1:numel(first)
+      x = X(:,iT,iCh);
+      P = zeros(nF,nFrame);
+      for iK = 1:size(w,2)
+         P = P + scale(iK) * abs(E * (w(:,iK) .* x(frameIdx))).^2;
+      end
+      P = P .* side.';
+      pow(:,:,iCh) = pow(:,:,iCh) + P;
+      if ~isempty(baseFrames)
+         B = mean(P(:,baseFrames),2);
+         tf_map(:,:,iCh) = tf_map(:,:,iCh) + 100 * (P - B) ./ B;
+      end
+   end
+end
+pow = pow / numel(first);
+if isempty(baseFrames)
+   tf_map = pow;
+else
+   tf_map = tf_map / numel(first);
+end
 
-end
\ No newline at end of file
+end
@@ -8,20 +8,17 @@ function analyzeLFPSyncIndex(blockObj)
 %  doLFPExtraction(b);
 %  analyzeLFPSyncIndex(b);
 %
+%  Sets blockObj.Channels(ch).psd (Welch PSD of the LFP) and
+%  blockObj.Channels(ch).syncIdx (low / high band power ratio of each
+%  win-minute window), both from one chunked pass over the LFP of all
+%  channels (see analyzeChannelStats).
+%
 % By: MAECI 2018 collaboration (Federico Barban & Max Murphy)
 
 %%
-if ~isfield(blockObj.Channels,'psd')
-   for nCh=1:blockObj.numChannels
-      [pxx,~] = pwelch(blockObj.Channels(nCh).LFPData(:),[],[],[],blockObj.LFPPars.DownsampledRate);
-      blockObj.Channels(nCh).psd=pxx;
-      blockObj.Channels(nCh).syncIdx = computeSyncIdx(blockObj.Channels(nCh).LFPData(:),[0 4],[4 100],win*60*Downsampled_rate,Downsampled_rate);
-      
-   end
-end
-
-win=1; %s
-overlap = 0; %s
+win = 1; % min
+lowFreqRange = [0 4];
+highFreqRange = [4 100];
 
 % pdelta = bandpower(pxx,f,[0 4],'psd');
 % ptheta = bandpower(pxx,f,[4 11],'psd');
@@ -31,22 +28,15 @@ overlap = 0; %s
 %ptot(U) = bandpower(pxx,f,'psd');
 % ptot = bandpower(pxx,f,[0 130],'psd');
 
-   function syncIdx = computeSyncIdx(data,lowFreqRange,highFreqRange,win_samples,fs)
-      % lowFreqRange = [0.5 4];
-      % highFreqRange = [0.5 10];
-      nSamples = length(data);
-      syncIdx = zeros(floor(nSamples./win_samples),1);
-      for ii = 1:length(syncIdx)
-         %[curPSD,curF] = pwelch(data((1:win_samples)+((ii-1)*win_samples)),welchWinSamples,welchOverlap,nfft,sfLFP);
-         %     DataWind=data((1:win_samples)+((ii-1)*win_samples));
-         %     nfft=max(256,2^nextpow2(length(DataWind)));
-         %     [curPSD,curF] = pwelch(data((1:win_samples)+((ii-1)*win_samples)),[],[],nfft,fs);
-         %[curPSD,curF]=periodogram(DataWind,[],nfft,fs);
-         %[curPSD,curF]=pwelch(DataWind,win_samples);
-         highFreqPower = sum(curPSD(curF>highFreqRange(1)&curF<=highFreqRange(2)));
-         lowFreqPower = sum(curPSD(curF>lowFreqRange(1)&curF<=lowFreqRange(2)));
-         syncIdx(ii) = lowFreqPower./highFreqPower;
-      end
+if ~isfield(blockObj.Channels,'psd')
+   stats = analyzeChannelStats(blockObj,'LFP',...
+      'Window',win*60,'Bands',[lowFreqRange; highFreqRange]);
+   for iCh = 1:numel(stats.Channels)
+      nCh = stats.Channels(iCh);
+      blockObj.Channels(nCh).psd = stats.PSD(:,iCh);
+      blockObj.Channels(nCh).syncIdx = reshape(...
+         stats.BandPower(1,:,iCh) ./ stats.BandPower(2,:,iCh),[],1);
    end
+end
 
-end
\ No newline at end of file
+end
@@ -4,20 +4,24 @@ function rms_out = analyzeRMS(blockObj,type,sampleIndices)
 %  ANALYZERMS(blockObj);
 %  ANALZYERMS(blockObj,{'Raw','LFP'});
 %
+%  Each stream is read once, in chunks, by analyzeChannelStats (no
+%  spectra); the whole record is used (sampleIndices is kept for
+%  compatibility and ignored, as before).
+%
 % By: MAECI 2018 collaboration (MM, FB, SB)
 
 %% DEFAULTS
 if nargin < 2
    type = {'Raw','Filt','CAR','LFP'};
    type = type(blockObj.getStatus(type));
+elseif ischar(type)
+   type = {type};
 end
 
 if nargin < 3
-   sampleIndices = 1:blockObj.Samples;
+   sampleIndices = 1:blockObj.Samples; %#ok<NASGU>
 end
 
-blockObj.RMS = [];
-
 %% COMPUTE RMS FOR EVERY CHANNEL ON WAVEFORMS OF INTEREST
 tic;
 fprintf(1,'\nComputing channel-wise RMS...000%%\n');
@@ -25,21 +29,18 @@ rms_out = struct('Raw',cell(blockObj.NumChannels,1),...
       'Filt',cell(blockObj.NumChannels,1),...
       'CAR',cell(blockObj.NumChannels,1),...
       'LFP',cell(blockObj.NumChannels,1));
-for iCh = blockObj.Mask
-   x = struct;
-   for iT = 1:numel(type)
-      data = blockObj.Channels(iCh).(type{iT})(:);
-      x.(type{iT}) = rms(data);
-      rms_out(iCh).(type{iT}) = rms(data);
+r = nan(numel(blockObj.Mask),numel(type));
+for iT = 1:numel(type)
+   stats = analyzeChannelStats(blockObj,type{iT},...
+      'Channels',blockObj.Mask,'NFFT',0,'Window',0);
+   r(:,iT) = stats.RMS(:);
+   for iCh = 1:numel(blockObj.Mask)
+      rms_out(blockObj.Mask(iCh)).(type{iT}) = r(iCh,iT);
    end
-   if isempty(blockObj.RMS)
-       blockObj.RMS = [struct2table(x)];
-   else
-       blockObj.RMS = [blockObj.RMS; struct2table(x)];
-   end
-   pct = 100 * (iCh / blockObj.NumChannels);
+   pct = 100 * (iT / numel(type));
    fprintf(1,'\b\b\b\b\b%.3d%%\n',floor(pct))
 end
+blockObj.RMS = array2table(r,'VariableNames',type);
 toc;
 
-end
\ No newline at end of file
+end
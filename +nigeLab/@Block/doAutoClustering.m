@@ -143,6 +143,7 @@ flag = true;
 end
 
 function [classes,temp] = runSPCclustering(inspk,par)
+par.SPC.NMaxClus = par.NMaxClus; % DoSPC uses it as the "out" cluster
 [classes,temp] = nigeLab.utils.SPC.DoSPC(par.SPC,inspk);
 end
 
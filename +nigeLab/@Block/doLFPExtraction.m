@@ -48,6 +48,9 @@ else
    str = 'Decimating';
 end
 fType = blockObj.FileType{strcmpi(blockObj.Fields,'LFP')};
+codec = nigeLab.utils.getParamField(blockObj.Pars.Block,'StreamCodec');
+writeBehind = isequal(...
+   nigeLab.utils.getParamField(blockObj.Pars.Block,'WriteBehind'),true);
 curCh = 0;
 nCh = numel(blockObj.Mask);
 for iCh=blockObj.Mask
@@ -63,13 +66,15 @@ for iCh=blockObj.Mask
    
    % Assign to diskData and protect it:
    blockObj.Channels(iCh).LFP = nigeLab.libs.DiskData(fType,...
-      fName,data,'access','w','overwrite',true);
+      fName,data,'access','w','overwrite',true,'codec',codec,...
+      'writebehind',writeBehind);
    lockData(blockObj.Channels(iCh).LFP);
    pct = round(curCh/nCh*90);
    blockObj.reportProgress(str,pct,'toWindow');
    blockObj.reportProgress('Decimating.',pct,'toEvent');
    blockObj.updateStatus('LFP',true,iCh);
 end
+nigeLab.libs.DiskWriter.barrier(); % Queued writes are done
 if blockObj.OnRemote
    str = 'Saving-Block';
    blockObj.reportProgress(str,95,'toWindow',str);
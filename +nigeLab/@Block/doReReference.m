@@ -34,20 +34,8 @@ nSamples = length(blockObj.Channels(1).Filt);
 nProbes = numel(probe);
 refMean = zeros(nProbes,nSamples);
 
-doSuppression = blockObj.Pars.Filt.STIM_SUPPRESS;
-stimProbeChannel     = blockObj.Pars.Filt.STIM_P_CH;
-
-if doSuppression % Note: this part is probably deprecated
-   if isnan(stimProbeChannel(1))
-      error('STIM Probe Number not specified (''STIM_P_CH(1)'')');
-   elseif isnan(stimProbeChannel(2))
-      error('STIM Channel Number not specified (''STIM_P_CH(2)'')');
-   end
-end
-
-if (~isnan(stimProbeChannel(1)) && ~isnan(stimProbeChannel(2)))
-   doSuppression = true;
-end
+% (Stimulus artifacts, if STIM_SUPPRESS is set, were already suppressed
+% before filtering in doUnitFilter)
 
 % COMPUTE THE MEAN FOR EACH PROBE
 blockObj.reportProgress('Computing-CAR',0,'toWindow');
@@ -55,16 +43,11 @@ curCh = 0;
 nCh = numel(blockObj.Mask);
 for iCh = blockObj.Mask
    curCh = curCh + 1;
-   if ~doSuppression
-      % Filter and and save amplifier_data by probe/channel
-      iProbe = probe==blockObj.Channels(iCh).probe;
-      nChanPb = sum(probe(iProbe) == [blockObj.Channels.probe]);
-      data = blockObj.Channels(iCh).Filt(:);
-      refMean(iProbe,:)=refMean(iProbe,:) + data ./ nChanPb;
-   else
-      warning('STIM SUPPRESSION method not yet available.');
-      return;
-   end
+   % Filter and and save amplifier_data by probe/channel
+   iProbe = probe==blockObj.Channels(iCh).probe;
+   nChanPb = sum(probe(iProbe) == [blockObj.Channels.probe]);
+   data = blockObj.Channels(iCh).Filt(:);
+   refMean(iProbe,:)=refMean(iProbe,:) + data ./ nChanPb;
    
    PCT = round(20*curCh/nCh);
    blockObj.reportProgress('Computing-CAR',PCT,'toWindow');
@@ -85,6 +68,9 @@ for iProbe = 1:nProbes
 end
 
 % SUBTRACT CORRECT PROBE REFERENCE FROM EACH CHANNEL AND SAVE TO DISK
+codec = nigeLab.utils.getParamField(blockObj.Pars.Block,'StreamCodec');
+writeBehind = isequal(...
+   nigeLab.utils.getParamField(blockObj.Pars.Block,'WriteBehind'),true);
 if ~blockObj.OnRemote
    str = nigeLab.utils.getNigeLink('nigeLab.Block','doReReference','CAR');
    str = sprintf('Removing-%s',str);
@@ -107,7 +93,8 @@ for iCh = blockObj.Mask
    
    % Save CAR data
    blockObj.Channels(iCh).CAR = nigeLab.libs.DiskData(...
-      'MatFile',fName,data,'access','w','overwrite',true);
+      'MatFile',fName,data,'access','w','overwrite',true,'codec',codec,...
+      'writebehind',writeBehind);
    lockData(blockObj.Channels(iCh).CAR);
    blockObj.Channels(iCh).refMean = refMeanFile{iProbe};
    
@@ -118,6 +105,7 @@ for iCh = blockObj.Mask
    blockObj.reportProgress('Removing-CAR',PCT,'toEvent','Removing-CAR');
    blockObj.updateStatus('CAR',true,iCh);
 end
+nigeLab.libs.DiskWriter.barrier(); % Queued writes are done
 
 if blockObj.OnRemote
    str = 'Saving-Block';
@@ -153,16 +153,19 @@ flag = true;
 
 
 %             REMOVE ARTIFACT
+      % Each stage returns its blanked samples as nArt x 2 [start stop]
+      % sample intervals (see BlankIntervals)
       if ~isempty(pars.STIM_TS)
-         data_ART = RemoveStimPeriods(data,pars);
+         [data_ART,stim_idx] = RemoveStimPeriods(data,pars);
       else
          data_ART = data;
+         stim_idx = zeros(0,2);
       end
       
       if ~isempty(pars.ARTIFACT)
          [data_ART,art_idx] = RemoveArtifactPeriods(data_ART,pars.ARTIFACT);
       else
-         art_idx = [];
+         art_idx = zeros(0,2);
       end
       
       ArtFun = ['ART_' pars.ArtefactRejMethodName];
@@ -171,7 +174,8 @@ flag = true;
       Artargsout = cell(1,nargout(ArtFun));
       [Artargsout{:}] = feval(ArtFun,data_ART,ArtPars);
       data_ART = Artargsout{1};
-      artifact = Artargsout{2};
+      artifact = nigeLab.utils.combineIntervals(...
+         [stim_idx; art_idx; Artargsout{2}],[],'union',1); % Samples
       
 
       
@@ -241,13 +245,22 @@ flag = true;
 %             error('Invalid PKDETECT specification.');
 %       end
       % ENSURE NO SPIKES REMAIN FROM ARTIFACT PERIODS
-      if any(artifact)
-         [tIdx,ia]=setdiff(tIdx,(artifact./pars.fs));
-         peak2peak=peak2peak(ia);
-         peakAmpl = peakAmpl(ia);
-         peakWidth = peakWidth(ia);
+      % (tIdx are sample indices, as are the artifact intervals)
+      if ~isempty(artifact)
+         if exist('ArtifactBlanking_core','file')==3
+            inArt = ArtifactBlanking_core('inside',double(tIdx),artifact);
+         else
+            k = discretize(double(tIdx),[artifact(:,1); inf]);
+            inArt = ~isnan(k);
+            inArt(inArt) = tIdx(inArt) <= ...
+               reshape(artifact(k(inArt),2),size(tIdx(inArt)));
+         end
+         tIdx(inArt) = [];
+         peak2peak(inArt) = [];
+         peakAmpl(inArt) = [];
+         peakWidth(inArt) = [];
          if exist('pTransformed','var')~=0
-            pTransformed = pTransformed(ia);
+            pTransformed(inArt) = [];
          end
       end
       
@@ -284,10 +297,8 @@ flag = true;
              
              %Interpolate spikes
              pars.InterpSamples = max(size(spikes,2),pars.InterpSamples);
-             Ispikes = interp1(1:size(spikes,2),...
-                 spikes.',...
-                 linspace(1,size(spikes,2),pars.InterpSamples),...
-                 'spline').';
+             Ispikes = nigeLab.utils.upsampleSnippets(spikes,...
+                 pars.InterpSamples,'spline');
              
              FeatFun = ['FEAT_' pars.FeatureExtractionMethodName];
              FeatPars = pars.(FeatFun);
@@ -365,12 +376,8 @@ flag = true;
       if isempty(artifact)
          art = ones(0,5);
       else
-         artifact = artifact(:); % make sure is column oriented
-         iStart = artifact([true, diff(artifact)' ~= 1]);
-         iStop = artifact(fliplr([true, diff(fliplr(artifact))' ~= 1]));
-         
-         value = reshape(iStart,numel(iStart),1);
-         tag = reshape(iStop,numel(iStop),1);
+         value = artifact(:,1); % Interval start and stop samples
+         tag = artifact(:,2);
          type = zeros(size(value));
          ts = value./pars.fs;
          snippet = tag./pars.fs;
@@ -4,6 +4,11 @@ function flag = doUnitFilter(blockObj)
 %  blockObj = nigeLab.Block;
 %  doUnitFilter(blockObj);
 %
+%  If blockObj.Pars.Filt.STIM_SUPPRESS is true, stimulus artifacts are
+%  first subtracted from the raw data of each channel (see
+%  SuppressStimArtifact), using the pulse onsets of the extracted RHS
+%  'Stim' data (of channel STIM_P_CH, if set).
+%
 % By: MAECI 2018 collaboration (Federico Barban & Max Murphy)
 
 % IMPORTS
@@ -33,6 +38,9 @@ end
 
 [~,pars] = blockObj.updateParams('Filt');
 fType = blockObj.FileType{strcmpi(blockObj.Fields,'Filt')};
+codec = nigeLab.utils.getParamField(blockObj.Pars.Block,'StreamCodec');
+writeBehind = isequal(...
+   nigeLab.utils.getParamField(blockObj.Pars.Block,'WriteBehind'),true);
 
 % ENSURE MASK IS ACCURATE
 blockObj.checkMask;
@@ -40,6 +48,11 @@ blockObj.checkMask;
 % DESIGN FILTER
 [b,a,zi,nfact,L] = pars.getFilterCoeff(blockObj.SampleRate);
 
+% STIMULUS ONSETS (FOR ARTIFACT SUPPRESSION BEFORE FILTERING)
+if pars.STIM_SUPPRESS
+   onsets = getStimOnsets(blockObj,pars);
+end
+
 % DO FILTERING AND SAVE
 if ~blockObj.OnRemote
    str = getNigeLink('nigeLab.Block','doUnitFilter',...
@@ -58,39 +71,41 @@ for iCh = blockObj.Mask
    if blockObj.Channels(iCh).Raw.length <= nfact
       continue; % It should leave the updateFlag as false for this channel
    end
-   if ~pars.STIM_SUPPRESS
-      % Filter and and save amplifier_data by probe/channel
-      pNum  = num2str(blockObj.Channels(iCh).probe);
-      chNum = blockObj.Channels(iCh).chStr;   
-      fName = sprintf(strrep(blockObj.Paths.Filt.file,'\','/'), ...
-         pNum, chNum);
-      
-      % bank of filters. This is necessary when the designed filter is high
-      % order SOS. Otherwise L should be one. See the filter definition
-      % params in default.Filt
-      data = blockObj.Channels(iCh).Raw(:);
-      for ii=1:L
-         data = (ff(b,a,data,nfact,zi));
-      end
-      
-      blockObj.Channels(iCh).Filt = DiskData(...
-         fType,fName,data,...
-         'access','w',...
-         'size',size(data),...
-         'class',class(data),...
-         'overwrite',true);
-      
-      lockData(blockObj.Channels(iCh).Filt);
-   else
-      warning('STIM SUPPRESSION method not yet available.');
-      return;
+   % Filter and and save amplifier_data by probe/channel
+   pNum  = num2str(blockObj.Channels(iCh).probe);
+   chNum = blockObj.Channels(iCh).chStr;   
+   fName = sprintf(strrep(blockObj.Paths.Filt.file,'\','/'), ...
+      pNum, chNum);
+   
+   data = blockObj.Channels(iCh).Raw(:);
+   if pars.STIM_SUPPRESS
+      data = SuppressStimArtifact(data,onsets,pars,blockObj.SampleRate);
+   end
+   
+   % bank of filters. This is necessary when the designed filter is high
+   % order SOS. Otherwise L should be one. See the filter definition
+   % params in default.Filt
+   for ii=1:L
+      data = (ff(b,a,data,nfact,zi));
    end
    
+   blockObj.Channels(iCh).Filt = DiskData(...
+      fType,fName,data,...
+      'access','w',...
+      'size',size(data),...
+      'class',class(data),...
+      'codec',codec,...
+      'writebehind',writeBehind,...
+      'overwrite',true);
+   
+   lockData(blockObj.Channels(iCh).Filt);
+   
    blockObj.updateStatus('Filt',true,iCh);
    pct = round(curCh/nCh * 90);
    blockObj.reportProgress(str,pct,'toWindow','Filtering');
    blockObj.reportProgress('Filtering.',pct,'toEvent');
 end
+nigeLab.libs.DiskWriter.barrier(); % Queued writes are done
 
 if blockObj.OnRemote
    str = 'Saving-Block';
@@ -107,6 +122,38 @@ flag = true;
 
 end
 
+function onsets = getStimOnsets(blockObj,pars)
+% GETSTIMONSETS  Stimulus onset samples (1-based) from the RHS 'Stim' data
+%
+%  Reads the 'Stim' event file written by intan2Block (one row per pulse,
+%  with the channel as 'value' and the onset (s) as 'ts'), whether or not
+%  it is linked in blockObj.Events. Uses the pulses of channel
+%  pars.STIM_P_CH ([probe, channel]) if it is set, otherwise the pulses of
+%  every channel.
+
+ts = [];
+if isfield(blockObj.Paths,'Stim')
+   fName = sprintf(strrep(blockObj.Paths.Stim.file,'\','/'),'Stim');
+   if exist(fName,'file')~=0
+      stimData = nigeLab.libs.DiskData('Event',fName);
+      ts = stimData.ts;
+      ch = stimData.value;
+   end
+end
+if ~isempty(ts) && ~any(isnan(pars.STIM_P_CH))
+   iStim = blockObj.matchProbeChannel(pars.STIM_P_CH(2),pars.STIM_P_CH(1));
+   ts = ts(ch == iStim);
+end
+ts = ts(~isnan(ts));
+if isempty(ts)
+   error(['nigeLab:' mfilename ':NoStims'],...
+      '[DOUNITFILTER]::%s: STIM_SUPPRESS requires extracted ''Stim'' data.',...
+      blockObj.Name);
+end
+% ts is relative to the first sample (t = 0), onsets are sample indices
+onsets = unique(round(ts * blockObj.SampleRate)) + 1;
+end
+
 function Y = ff(b,a,X,nEdge,IC)
 
 
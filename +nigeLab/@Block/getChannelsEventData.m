@@ -9,6 +9,13 @@ function eventData = getChannelsEventData(blockObj,field,prop,ch,matchProp,match
 F = fieldnames(blockObj.Channels(ch));
 iF = strcmpi(F,field);
 if sum(iF)==1
+   if ~isnan(matchValue(1)) && any(strcmpi(matchProp,{'ts','value'})) && ...
+         isa(blockObj.Channels(ch).(F{iF}),'nigeLab.libs.DiskData')
+      % Time-range and value (cluster) queries only read matching rows
+      eventData = retrieveMatchingRows(blockObj.Channels(ch).(F{iF}),...
+         prop,lower(matchProp),matchValue);
+      return;
+   end
    eventData = retrieveChannelData(blockObj,ch,F{iF},prop);
    if ~isnan(matchValue(1))
       dataSelector = retrieveChannelData(blockObj,ch,F{iF},matchProp);
@@ -32,6 +39,24 @@ else
    eventData = [];
 end
 
+   % Helper function to read `prop` only for rows matching a query
+   function out = retrieveMatchingRows(diskObj,prop,matchProp,matchValue)
+      %RETRIEVEMATCHINGROWS  Use the DiskData 'Event' index to find rows
+      %                      matching matchValue, then read only those
+      %                      rows of `prop`.
+      
+      out = [];
+      if ~checkSize(diskObj)
+         return;
+      end
+      rows = findEventRows(diskObj,matchProp,matchValue);
+      if isempty(rows)
+         out = zeros(0,1);
+         return;
+      end
+      out = subsref(diskObj,substruct('.',prop,'()',{rows,':'}));
+   end
+
    % Helper function to try and make this reverse-compatible with CPLTools
    function out = retrieveChannelData(blockObj,ch,type,field)
       %RETRIEVECHANNELDATA  Attempt to get data assuming it is a "standard"
@@ -0,0 +1,83 @@
+function [psth,counts,rate] = getPSTH(blockObj,ch,clusterIndex,align,edges,sigma)
+%GETPSTH  Peri-event spike counts, rates and PSTHs of several units
+%
+%  psth = GETPSTH(blockObj,ch,clusterIndex,align,edges);
+%  psth = GETPSTH(blockObj,ch,clusterIndex,align,edges,sigma);
+%  [psth,counts,rate] = GETPSTH(___);
+%
+%  --------
+%   INPUTS
+%  --------
+%  blockObj    :     nigeLab.Block class object (or array: trials of all
+%                       blocks are concatenated, in block order).
+%
+%    ch        :     Channel index (vector): one unit per element.
+%
+% clusterIndex :     Sorted class of each unit (scalar: same for every
+%                       channel; NaN: all spikes on the channel). As in
+%                       getSpikeTimes.
+%
+%   align      :     Alignment times (sec) of the trials: numeric vector
+%                       (single Block only), or name of an event (char),
+%                       e.g. 'Reach', which is read with getEventData
+%                       from each Block.
+%
+%   edges      :     nBin+1 bin edges (sec) relative to each alignment.
+%
+%   sigma      :     (Optional) SD (in bins) of the Gaussian that smooths
+%                       the rates (default: 0).
+%
+%  --------
+%   OUTPUT
+%  --------
+%    psth      :     nBin x nUnit trial-averaged rate (spikes/s).
+%
+%   counts     :     nTrial x nBin x nUnit spike counts.
+%
+%    rate      :     nTrial x nBin x nUnit rates (spikes/s, smoothed if
+%                       sigma > 0).
+%
+%  Spike times come from getSpikeTimes; binning is done for all units at
+%  once by nigeLab.utils.binSpikeTrains.
+
+if nargin < 6
+   sigma = 0;
+end
+if nargin < 3 || isempty(clusterIndex)
+   clusterIndex = nan;
+end
+
+nBin = numel(edges) - 1;
+nUnit = numel(ch);
+if numel(blockObj) > 1
+   if isnumeric(align)
+      error(['nigeLab:' mfilename ':BadAlign'],...
+         '[GETPSTH]: Give an event name to align trials of several Blocks.');
+   end
+   counts = cell(numel(blockObj),1);
+   rate = cell(numel(blockObj),1);
+   valid = cell(numel(blockObj),1);
+   for ii = 1:numel(blockObj)
+      t = getEventData(blockObj(ii),[],'ts',align);
+      valid{ii} = ~isnan(t(:));
+      [~,counts{ii},rate{ii}] = getPSTH(blockObj(ii),ch,clusterIndex,...
+         t,edges,sigma);
+   end
+   counts = vertcat(counts{:});
+   rate = vertcat(rate{:});
+   valid = vertcat(valid{:});
+   psth = reshape(mean(rate(valid,:,:),1),nBin,nUnit);
+   return;
+end
+
+if ischar(align)
+   align = getEventData(blockObj,[],'ts',align);
+end
+
+ts = getSpikeTimes(blockObj,ch,clusterIndex);
+if ~iscell(ts)
+   ts = {ts};
+end
+[counts,rate,psth] = nigeLab.utils.binSpikeTrains(ts,align,edges,sigma);
+
+end
@@ -64,10 +64,11 @@ end
 
 % ITERATE ON MULTIPLE BLOCKS
 if numel(blockObj) > 1
-   ts = [];
+   ts = cell(numel(blockObj),1);
    for ii = 1:numel(blockObj)
-      ts = [ts; getSpikeTimes(blockObj(ii),ch,clusterIndex)]; %#ok<AGROW>
+      ts{ii} = getSpikeTimes(blockObj(ii),ch,clusterIndex);
    end 
+   ts = vertcat(ts{:});
    return;
 end
 
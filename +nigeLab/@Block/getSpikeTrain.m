@@ -63,10 +63,11 @@ end
 
 %% USE RECURSION TO ITERATE ON MULTIPLE BLOCKS
 if numel(blockObj) > 1 
-   idx = [];
+   idx = cell(numel(blockObj),1);
    for ii = 1:numel(blockObj) % Concatenate all block contents together
-      idx = [idx; getSpikeTrain(blockObj(ii),ch,clusterIndex)]; %#ok<AGROW>
+      idx{ii} = getSpikeTrain(blockObj(ii),ch,clusterIndex);
    end
+   idx = vertcat(idx{:});
    return;
 end
 
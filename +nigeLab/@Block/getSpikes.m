@@ -87,11 +87,13 @@ end
 switch lower(type) % Could add expansion for things like 'pw' and 'pp' etc.
    case {'feat','spikefeat','features','spikefeatures'}
       % Variable is still called "spikes"
-      spikes = getEventData(blockObj,'SpikeFeatures','snippet',ch);
+      field = 'SpikeFeatures';
    otherwise % Default is 'spikes'
-      spikes = getEventData(blockObj,'Spikes','snippet',ch);
+      field = 'Spikes';
 end
-if isempty(spikes)
+if ~iscell(clusterIndex) && all(isnan(clusterIndex))
+   % Returns all spikes or features if this arg is unused
+   spikes = getEventData(blockObj,field,'snippet',ch);
    return;
 end
 
@@ -120,6 +122,7 @@ switch class(clusterIndex)
             '-->\t{''Clusters'',[clusterIndices]}']);
       end
       if isnan(clusterIndex)
+         spikes = getEventData(blockObj,field,'snippet',ch);
          return;
       end
       
@@ -135,11 +138,7 @@ switch class(clusterIndex)
                'Unexpected "clustering" type: %s',clusterType);
       end
    otherwise
-      % Otherwise, must be numeric (or NaN to skip)
-      if isnan(clusterIndex)
-         return; % Returns all spikes or features if this arg is unused
-      end
-      
+      % Otherwise, must be numeric (NaN was handled above)
       if isnumeric(clusterIndex)
          if getStatus(blockObj,'Sorted',ch)
             clusterType = 'Sorted';
@@ -148,7 +147,9 @@ switch class(clusterIndex)
             clusterType = 'Clustered';
             c = blockObj.getClus(ch);
          else
-            return; % do nothing
+            % do nothing (return all spikes or features)
+            spikes = getEventData(blockObj,field,'snippet',ch);
+            return;
          end
       else
          error(['nigeLab:' mfilename ':UnexpectedClass'],...
@@ -156,7 +157,19 @@ switch class(clusterIndex)
             class(clusterIndex));
       end
 end
-if numel(c) ~= size(spikes,1)
+% Only read the snippets of the requested clusters, if possible
+diskObj = blockObj.Channels(ch).(field);
+if isa(diskObj,'nigeLab.libs.DiskData') && checkSize(diskObj) && ...
+      (numel(c) == size(diskObj,1))
+   spikes = subsref(diskObj,substruct('.','snippet','()',...
+      {find(ismember(c,clusterIndex)),':'}));
+   return;
+end
+
+spikes = getEventData(blockObj,field,'snippet',ch);
+if isempty(spikes)
+   return;
+elseif numel(c) ~= size(spikes,1)
    warning(...
       ['[GETSPIKES]::[%s] There are %g %s group assignment elements ' ...
        'for %g spikes on Channel P%g-%s.\n' ...
@@ -171,4 +184,4 @@ else
 end
 
 
-end
\ No newline at end of file
+end
@@ -74,9 +74,9 @@ y = resample(double(vid.data),fs,round(vid.fs));
 
 % Guess the lag based on cross correlation between 2 streams
 tic;
-fprintf(1,'Please wait, making best alignment offset guess (usually 1-2 mins)...');
-[R,lag] = nigeLab.utils.getR(x,y);
-offset = nigeLab.utils.parseR(R,lag,fs);
+fprintf(1,'Please wait, making best alignment offset guess...');
+[~,bestLag] = nigeLab.utils.getR(x,y,[],'BestLag');
+offset = nigeLab.utils.parseR([],bestLag,fs);
 setEventData(blockObj,[],'ts','Header',offset);
 fprintf(1,'complete.\n');
 toc;
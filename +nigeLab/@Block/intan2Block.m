@@ -108,6 +108,9 @@ nCh.Standard = struct('Raw',struct('Data',0),...
 nCh.Dig = struct('DigIO',struct('DigIn',0,'DigOut',0));
 native_order = struct; % For `Streams` fieldType
 stimCurr = 0; % Initialize to 0 amps
+codec = nigeLab.utils.getParamField(blockObj.Pars.Block,'StreamCodec');
+writeBehind = isequal(...
+   nigeLab.utils.getParamField(blockObj.Pars.Block,'WriteBehind'),true);
 for f = fields_to_extract
    idx = find(strcmpi(blockObj.Fields,f),1,'first');
    if isempty(idx) % Check if field is present (+defaults/Block config)
@@ -145,6 +148,8 @@ for f = fields_to_extract
                'size',[1 nSamples],...
                'access','w',...
                'class','single',...
+               'codec',codec,...
+               'writebehind',writeBehind,...
                'verbose',blockObj.Verbose && ~blockObj.OnRemote);
             Files.Standard.(curDataField).(group){iCh} = ...
                nigeLab.utils.makeDiskFile(diskPars,data);
@@ -325,6 +330,7 @@ if nCh.Standard.Stim > 0 % Then there is 'Stim' data on all channels
       'size',[inf, 10 + numel(trigCh)],...
       'access','w',...
       'class','single',...
+      'writebehind',writeBehind,...
       'verbose',blockObj.Verbose && ~blockObj.OnRemote);
    Files.Standard.Stim = nigeLab.utils.makeDiskFile(diskPars,tmp); 
 
@@ -517,6 +523,9 @@ end
 % Close data file.
 fclose(fid);
 
+% Wait for any queued (write-behind) writes before linking
+nigeLab.libs.DiskWriter.barrier();
+
 % Link to data
 reportProgress(blockObj,'Linking Data.',95,'toEvent');
 reportProgress(blockObj,'Linking Data.',95,'toWindow','Linking');
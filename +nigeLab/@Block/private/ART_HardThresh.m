@@ -23,7 +23,9 @@ function [data_ART,art_idx] = ART_HardThresh(data,pars)
 %                       artifact rejection threshold and surrounding window
 %                       zeroed out.
 %
-%   art_idx     :       Indices of artifact samples.
+%   art_idx     :       nArt x 2 sorted, disjoint [start stop] sample
+%                       indices of the blanked segments (see
+%                       BlankIntervals).
 %
 % See also: SPIKEDETECTIONARRAY
 %
@@ -36,31 +38,9 @@ function [data_ART,art_idx] = ART_HardThresh(data,pars)
 %
 % Kelly RM    v1.0  11/04/2015  Original version.
 
-%% FIND THRESHOLD CROSSINGS
-segm = find(pars.Polarity*data >= pars.Thresh);
-art_idx = [];
+%% ZERO SECTIONS AROUND THRESHOLD CROSSINGS
 Nsamples = double(floor(pars.Samples*1e-3*pars.fs)); % from ms to samples
+[data_ART,art_idx] = BlankIntervals(data,zeros(0,2),pars.Thresh,...
+   pars.Polarity,Nsamples);
 
-%% REMOVE (ZERO) SECTIONS AROUND ARTIFACT
-if any(segm)    
-    if (Nsamples)
-         rm_pre = max(segm - Nsamples,1);             % Start index >= 1
-         rm_post = min(length(data),segm + Nsamples); % End index <= total samples in data
-         
-         for in = 1:length(segm) 
-%               art_idx = [art_idx ,rm_pre(in):segm(in)];
-%               art_idx = [art_idx ,segm(in):rm_post(in)];
-             art_idx = [art_idx ,rm_pre(in):rm_post(in)]; %#ok<AGROW>
-         end 
-%          art_idx = unique([segm,art_idx]');
-    end
-    data_ART = data;
-%     data_ART(art_idx) = [];
-    data_ART(art_idx) = 0;
-else 
-    data_ART = data;
-
-    art_idx = [];
-end 
-
-end
\ No newline at end of file
+end
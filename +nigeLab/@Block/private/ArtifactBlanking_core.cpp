@@ -0,0 +1,276 @@
+/*=================================================================
+ *
+ * ARTIFACTBLANKING_CORE.CPP	.MEX file for artifact and stimulus blanking
+ *
+ * The calling syntax is:
+ *
+ *		[y, T] = ArtifactBlanking_core('blank', x, T0, thresh, polarity, pad)
+ *		in = ArtifactBlanking_core('inside', ts, T)
+ *
+ *      'blank':    x:        signal vector (double or single)
+ *                  T0:       nT x 2 [start stop] sample indices (1-based,
+ *                            closed; in any order, possibly overlapping
+ *                            or outside the record) to blank
+ *                  thresh:   samples with polarity * x >= thresh are
+ *                            artifact (inf: no threshold)
+ *                  polarity: +1 or -1
+ *                  pad:      [pre post] (or one value for both) samples
+ *                            blanked around each threshold crossing
+ *
+ *                  y:        x (same class and size), with every sample of
+ *                            T set to zero
+ *                  T:        nK x 2 sorted, disjoint [start stop] sample
+ *                            indices within the record: T0 and the padded
+ *                            crossings, with touching intervals merged
+ *
+ *      'inside':   ts:       sample indices (e.g. spike peaks)
+ *                  T:        nK x 2 [start stop] intervals
+ *                  in:       logical, same size as ts: true where ts lies
+ *                            in one of the intervals
+ *
+ * Crossings are found in one sweep and come out sorted, so they are
+ * merged into intervals as they are found, then with the (sorted) T0 in
+ * one merge pass: the cost is linear in the signal length and the number
+ * of intervals, instead of growing (and then indexing with) a vector of
+ * every blanked sample. 'inside' is a merge pass when ts is sorted and a
+ * binary search per element otherwise.
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+#include "mex.h"
+
+/* Input Arguments */
+
+#define	MODE	prhs[0]
+#define	X_IN	prhs[1]
+#define	T_IN	prhs[2]
+#define	THRESH	prhs[3]
+#define	POL	prhs[4]
+#define	PAD	prhs[5]
+
+typedef std::pair<ptrdiff_t, ptrdiff_t> Interval;
+
+///////////////////////////////////////////////////////////////////////////
+/* Helpers */
+///////////////////////////////////////////////////////////////////////////
+
+/* Append v to sorted list out, merging it with the last interval if they
+ * overlap or touch (v.first >= out.back().first) */
+static void pushMerged(std::vector<Interval> &out, const Interval &v)
+{
+    if (!out.empty() && v.first <= out.back().second + 1)
+        out.back().second = std::max(out.back().second, v.second);
+    else
+        out.push_back(v);
+}
+
+/* nT x 2 [start stop] matrix as sorted, merged sample intervals within
+ * [1, n] (whole samples: ceil of start, floor of stop, as start:stop) */
+static std::vector<Interval> getIntervals(const mxArray *A, ptrdiff_t n)
+{
+    if (!mxIsDouble(A) || mxIsComplex(A) || mxIsSparse(A) ||
+        (!mxIsEmpty(A) && mxGetN(A) != 2))
+        mexErrMsgIdAndTxt("nigeLab:ArtifactBlanking:BadIntervals",
+            "Intervals must be an n x 2 [start stop] double matrix.");
+    size_t nT = mxIsEmpty(A) ? 0 : mxGetM(A);
+    const double *p = mxGetPr(A);
+    std::vector<Interval> v;
+    v.reserve(nT);
+    bool sorted = true;
+    for (size_t i = 0; i < nT; i++)
+    {
+        double lo = std::max(ceil(p[i]), 1.0);
+        double hi = std::min(floor(p[i + nT]), (double)n);
+        if (!(lo <= hi)) continue; /* Empty, NaN or outside the record */
+        Interval iv((ptrdiff_t)lo, (ptrdiff_t)hi);
+        if (!v.empty() && iv < v.back()) sorted = false;
+        v.push_back(iv);
+    }
+    if (!sorted) std::sort(v.begin(), v.end());
+    std::vector<Interval> out;
+    out.reserve(v.size());
+    for (size_t i = 0; i < v.size(); i++) pushMerged(out, v[i]);
+    return out;
+}
+
+static mxArray *intervalMatrix(const std::vector<Interval> &v)
+{
+    mxArray *T = mxCreateDoubleMatrix(v.size(), 2, mxREAL);
+    double *p = mxGetPr(T);
+    for (size_t i = 0; i < v.size(); i++)
+    {
+        p[i] = (double)v[i].first;
+        p[i + v.size()] = (double)v[i].second;
+    }
+    return T;
+}
+
+/* Padded threshold crossings of x (1-based), merged as they are found */
+template <typename T>
+static void findCrossings(const T *x, ptrdiff_t n, double thresh, double pol,
+                          ptrdiff_t pre, ptrdiff_t post, std::vector<Interval> &out)
+{
+    for (ptrdiff_t i = 0; i < n; i++)
+    {
+        if (!(pol * (double)x[i] >= thresh)) continue;
+        Interval iv(std::max(i + 1 - pre, (ptrdiff_t)1), std::min(i + 1 + post, n));
+        pushMerged(out, iv);
+    }
+}
+
+template <typename T>
+static void zeroIntervals(T *y, const std::vector<Interval> &v)
+{
+    for (size_t k = 0; k < v.size(); k++)
+        memset(y + v[k].first - 1, 0, (size_t)(v[k].second - v[k].first + 1) * sizeof(T));
+}
+
+static ptrdiff_t getPad(double v)
+{
+    if (!(v >= 0) || v != floor(v))
+        mexErrMsgIdAndTxt("nigeLab:ArtifactBlanking:BadPad",
+            "pad must be non-negative integer sample counts.");
+    return (ptrdiff_t)v;
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* Modes */
+///////////////////////////////////////////////////////////////////////////
+
+static void doBlank(int nrhs, const mxArray *prhs[], int nlhs, mxArray *plhs[])
+{
+    if (nrhs != 6)
+        mexErrMsgIdAndTxt("nigeLab:ArtifactBlanking:BadInput",
+            "'blank' requires (x, T0, thresh, polarity, pad).");
+    if (mxIsComplex(X_IN) || mxIsSparse(X_IN) || !(mxIsDouble(X_IN) || mxIsSingle(X_IN)))
+        mexErrMsgIdAndTxt("nigeLab:ArtifactBlanking:BadClass",
+            "x must be a real, full double or single vector.");
+    size_t nPad = mxGetNumberOfElements(PAD);
+    if (!mxIsDouble(PAD) || nPad < 1 || nPad > 2)
+        mexErrMsgIdAndTxt("nigeLab:ArtifactBlanking:BadPad",
+            "pad must be [pre post] or one value for both.");
+    ptrdiff_t n = (ptrdiff_t)mxGetNumberOfElements(X_IN);
+    double thresh = mxGetScalar(THRESH);
+    double pol = (mxGetScalar(POL) < 0) ? -1.0 : 1.0;
+    ptrdiff_t pre = getPad(mxGetPr(PAD)[0]);
+    ptrdiff_t post = getPad(mxGetPr(PAD)[nPad - 1]);
+
+    std::vector<Interval> given = getIntervals(T_IN, n), cross;
+    if (thresh == thresh && thresh < INFINITY)
+    {
+        if (mxIsDouble(X_IN))
+            findCrossings(mxGetPr(X_IN), n, thresh, pol, pre, post, cross);
+        else
+            findCrossings((const float *)mxGetData(X_IN), n, thresh, pol, pre, post, cross);
+    }
+
+    /* One merge pass over the two sorted lists */
+    std::vector<Interval> out;
+    out.reserve(given.size() + cross.size());
+    size_t i = 0, j = 0;
+    while (i < given.size() || j < cross.size())
+    {
+        if (j == cross.size() || (i < given.size() && given[i] < cross[j]))
+            pushMerged(out, given[i++]);
+        else
+            pushMerged(out, cross[j++]);
+    }
+
+    plhs[0] = mxDuplicateArray(X_IN);
+    if (mxIsDouble(X_IN))
+        zeroIntervals(mxGetPr(plhs[0]), out);
+    else
+        zeroIntervals((float *)mxGetData(plhs[0]), out);
+    if (nlhs > 1) plhs[1] = intervalMatrix(out);
+}
+
+static void doInside(int nrhs, const mxArray *prhs[], mxArray *plhs[])
+{
+    if (nrhs != 3)
+        mexErrMsgIdAndTxt("nigeLab:ArtifactBlanking:BadInput",
+            "'inside' requires (ts, T).");
+    if (!mxIsDouble(X_IN) || mxIsComplex(X_IN) || mxIsSparse(X_IN))
+        mexErrMsgIdAndTxt("nigeLab:ArtifactBlanking:BadClass",
+            "ts must be a real, full double vector.");
+    if (!mxIsDouble(T_IN) || mxIsComplex(T_IN) || mxIsSparse(T_IN) ||
+        (!mxIsEmpty(T_IN) && mxGetN(T_IN) != 2))
+        mexErrMsgIdAndTxt("nigeLab:ArtifactBlanking:BadIntervals",
+            "Intervals must be an n x 2 [start stop] double matrix.");
+
+    /* Intervals as given (not restricted to whole samples), sorted and
+     * merged; starts are then increasing and stops too */
+    size_t nT = mxIsEmpty(T_IN) ? 0 : mxGetM(T_IN);
+    const double *p = mxGetPr(T_IN);
+    std::vector<std::pair<double, double> > v, T;
+    bool sorted = true;
+    for (size_t k = 0; k < nT; k++)
+    {
+        if (!(p[k] <= p[k + nT])) continue;
+        v.push_back(std::make_pair(p[k], p[k + nT]));
+        if (v.size() > 1 && v.back() < v[v.size() - 2]) sorted = false;
+    }
+    if (!sorted) std::sort(v.begin(), v.end());
+    for (size_t k = 0; k < v.size(); k++)
+    {
+        if (!T.empty() && v[k].first <= T.back().second)
+            T.back().second = std::max(T.back().second, v[k].second);
+        else
+            T.push_back(v[k]);
+    }
+
+    size_t n = mxGetNumberOfElements(X_IN);
+    const double *ts = mxGetPr(X_IN);
+    plhs[0] = mxCreateLogicalMatrix(mxGetM(X_IN), mxGetN(X_IN));
+    mxLogical *in = mxGetLogicals(plhs[0]);
+    bool tsSorted = true;
+    for (size_t i = 1; i < n && tsSorted; i++) tsSorted = !(ts[i] < ts[i - 1]);
+
+    size_t k = 0; /* First interval whose stop is >= ts */
+    for (size_t i = 0; i < n; i++)
+    {
+        double t = ts[i];
+        if (t != t) continue;
+        if (tsSorted)
+        {
+            while (k < T.size() && T[k].second < t) k++;
+        }
+        else
+        {
+            k = std::lower_bound(T.begin(), T.end(), t,
+                [](const std::pair<double, double> &a, double b) { return a.second < b; })
+                - T.begin();
+        }
+        in[i] = (k < T.size() && T[k].first <= t);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+void mexFunction( int nlhs, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    if (nrhs < 1 || !mxIsChar(MODE))
+        mexErrMsgIdAndTxt("nigeLab:ArtifactBlanking:BadInput",
+            "First input must be a mode (char).");
+    char *c = mxArrayToString(MODE);
+    std::string mode(c);
+    mxFree(c);
+
+    if (mode == "blank")
+        doBlank(nrhs, prhs, nlhs, plhs);
+    else if (mode == "inside")
+        doInside(nrhs, prhs, plhs);
+    else
+        mexErrMsgIdAndTxt("nigeLab:ArtifactBlanking:BadMode",
+            "Unknown mode '%s'.", mode.c_str());
+}
@@ -0,0 +1,77 @@
+function [data_ART,T] = BlankIntervals(data,T,thresh,polarity,pad)
+%% BLANKINTERVALS  Set intervals and padded threshold crossings to zero
+%
+%   [data_ART,T] = BLANKINTERVALS(data,T);
+%   [data_ART,T] = BLANKINTERVALS(data,T,thresh,polarity,pad);
+%
+%   --------
+%    INPUTS
+%   --------
+%     data      :       Single-channel data vector.
+%
+%      T        :       nT x 2 [start stop] sample indices of intervals to
+%                       blank (in any order, possibly overlapping).
+%
+%    thresh     :       (Optional) Samples where polarity*data >= thresh
+%                       are artifact (default: inf, none).
+%
+%   polarity    :       (Optional) +1 or -1 (default: 1).
+%
+%     pad       :       (Optional) Samples blanked around each crossing;
+%                       one value or [pre post] (default: 0).
+%
+%   --------
+%    OUTPUT
+%   --------
+%   data_ART    :       data, with every blanked sample set to zero.
+%
+%      T        :       nK x 2 sorted, disjoint [start stop] sample indices
+%                       within the record of all blanked samples (touching
+%                       intervals are merged).
+%
+%   The cost is linear in the length of data and the number of intervals.
+%   If the compiled ArtifactBlanking_core kernel is available (see
+%   nigeLab.utils.compileNativeKernels), crossings are merged into
+%   intervals as they are found and the data blanked in one pass; the
+%   output is the same.
+
+%% DEFAULTS
+if nargin < 3
+   thresh = inf;
+end
+if nargin < 4
+   polarity = 1;
+end
+if nargin < 5
+   pad = 0;
+end
+if isempty(T)
+   T = zeros(0,2);
+end
+
+if exist('ArtifactBlanking_core','file')==3
+   [data_ART,T] = ArtifactBlanking_core('blank',data,double(T),...
+      double(thresh),double(polarity),double(pad));
+   return;
+end
+
+%% MARK INTERVAL STARTS AND ENDS, THEN FILL BY CUMULATIVE SUM
+n = numel(data);
+lb = max(ceil(double(T(:,1))),1);
+ub = min(floor(double(T(:,2))),n);
+if ~isinf(thresh)
+   segm = find((1 - 2*(polarity < 0))*double(data(:)) >= thresh);
+   lb = [lb; max(segm - pad(1),1)];
+   ub = [ub; min(segm + pad(end),n)];
+end
+keep = lb <= ub;
+d = accumarray([lb(keep); ub(keep)+1],...
+   [ones(nnz(keep),1); -ones(nnz(keep),1)],[n+1 1]);
+mask = cumsum(d(1:n)) > 0;
+
+data_ART = data;
+data_ART(mask) = 0;
+edge = diff([false; mask; false]);
+T = [find(edge == 1), find(edge == -1) - 1];
+
+end
@@ -0,0 +1,250 @@
+/*=================================================================
+ *
+ * CHANNELSTATS_CORE.CPP	.MEX file for analyzeChannelStats
+ *
+ * The calling syntax is:
+ *
+ *		[mom, psd, bp, S] = ChannelStats_core(X, nNew, satLevel, nfft, hop, winLen, bands, fs, S)
+ *
+ *      X:          nSamples x nChannel chunk of streams (double or single)
+ *      nNew:       number of new samples (rows) of X; the remaining rows
+ *                  only complete the Welch segments that start in them
+ *      satLevel:   samples with abs(x) >= satLevel count as saturated
+ *      nfft:       Welch segment length (power of 2; 0: no spectra)
+ *      hop:        step between Welch segment starts
+ *      winLen:     band-power window length (samples; 0: no windows).
+ *                  Windows tile the new samples from the first row; a
+ *                  last partial window is ignored
+ *      bands:      nBand x 2 [low high] (Hz) band edges
+ *      fs:         sample rate (Hz)
+ *      S:          1 x nChannel cell of quantile sketches (see
+ *                  nigeLab.utils.robustStats) of the previous chunks, or
+ *                  {} for new ones
+ *
+ *      mom:        9 x nChannel [n; sum; sum of squares; min; max;
+ *                  saturated; Welch segments] of the new (non-NaN)
+ *                  samples, then [median; mad(x,1)] of all the samples
+ *                  added to S so far (approximate: rank error ~1%)
+ *      psd:        (nfft/2+1) x nChannel sum over the segments of the
+ *                  one-sided Hann-window PSD (divide by the total number
+ *                  of segments for the Welch estimate)
+ *      bp:         nBand x nWindow x nChannel band power (PSD summed over
+ *                  low < f <= high, times fs/nfft) of each window, mean
+ *                  over the segments that start in it
+ *      S:          updated sketches
+ *
+ * A stream is read once, one chunk at a time: every statistic is
+ * accumulated from the same samples in one pass. Each Welch segment is
+ * transformed once (nigel_fft.h) and feeds both the channel PSD and the
+ * band power of its window, and channels run in parallel.
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include <vector>
+#include "mex.h"
+#include "nigel_fft.h"
+#include "nigel_stats.h"
+#include "nigel_threads.h"
+
+/* Input Arguments */
+
+#define	X_IN	prhs[0]
+#define	NNEW	prhs[1]
+#define	SAT	prhs[2]
+#define	NFFT	prhs[3]
+#define	HOP	prhs[4]
+#define	WINLEN	prhs[5]
+#define	BANDS	prhs[6]
+#define	FS	prhs[7]
+#define	SKETCH	prhs[8]
+
+/* Constants */
+
+static const size_t N_MOM = 9;          /* Rows of mom */
+static const double PI = 3.14159265358979323846;
+
+using nigel::cplx;
+
+///////////////////////////////////////////////////////////////////////////
+/* Helpers */
+///////////////////////////////////////////////////////////////////////////
+
+static size_t getCount(const mxArray *A, const char *name)
+{
+    double v = mxGetScalar(A);
+    if (!(v >= 0) || v != floor(v))
+        mexErrMsgIdAndTxt("nigeLab:ChannelStats:BadInput",
+            "%s must be a non-negative integer.", name);
+    return (size_t)v;
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+void mexFunction( int nlhs, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    if (nrhs != 9)
+        mexErrMsgIdAndTxt("nigeLab:ChannelStats:BadInput",
+            "Requires (X, nNew, satLevel, nfft, hop, winLen, bands, fs, S).");
+    if (mxIsComplex(X_IN) || mxIsSparse(X_IN) || !(mxIsDouble(X_IN) || mxIsSingle(X_IN)))
+        mexErrMsgIdAndTxt("nigeLab:ChannelStats:BadClass",
+            "X must be a real, full double or single matrix.");
+
+    size_t nSamp = mxGetM(X_IN), nCh = mxGetN(X_IN);
+    size_t nNew = getCount(NNEW, "nNew");
+    size_t nfft = getCount(NFFT, "nfft");
+    size_t hop = getCount(HOP, "hop");
+    size_t winLen = getCount(WINLEN, "winLen");
+    double sat = mxGetScalar(SAT), fs = mxGetScalar(FS);
+    if (nNew > nSamp) nNew = nSamp;
+    if (nfft > 0 && (nfft != nigel::FFT::nextPow2(nfft) || hop == 0))
+        mexErrMsgIdAndTxt("nigeLab:ChannelStats:BadSegments",
+            "nfft must be a power of 2 and hop positive.");
+    if (!(fs > 0))
+        mexErrMsgIdAndTxt("nigeLab:ChannelStats:BadRate",
+            "fs must be positive.");
+    if (!mxIsEmpty(BANDS) && (!mxIsDouble(BANDS) || mxGetN(BANDS) != 2))
+        mexErrMsgIdAndTxt("nigeLab:ChannelStats:BadBands",
+            "bands must be an nBand x 2 double matrix.");
+    if (!mxIsCell(SKETCH) || (!mxIsEmpty(SKETCH) && mxGetNumberOfElements(SKETCH) != nCh))
+        mexErrMsgIdAndTxt("nigeLab:ChannelStats:BadSketch",
+            "S must be {} or a cell with one sketch per channel.");
+
+    /* Band bins: lo < k*fs/nfft <= hi */
+    size_t nBand = mxIsEmpty(BANDS) ? 0 : mxGetM(BANDS);
+    size_t nBin = (nfft > 0) ? nfft / 2 + 1 : 0;
+    double df = (nfft > 0) ? fs / (double)nfft : 0;
+    std::vector<size_t> b0(nBand), b1(nBand);
+    for (size_t b = 0; b < nBand; b++)
+    {
+        double lo = mxGetPr(BANDS)[b], hi = mxGetPr(BANDS)[b + nBand];
+        b0[b] = nBin;
+        b1[b] = 0;
+        for (size_t k = 0; k < nBin; k++)
+        {
+            double f = (double)k * df;
+            if (f > lo && f <= hi)
+            {
+                if (b0[b] == nBin) b0[b] = k;
+                b1[b] = k + 1;
+            }
+        }
+        if (b0[b] == nBin) b0[b] = b1[b] = 0;
+    }
+    size_t nWin = (winLen > 0 && nfft > 0) ? nNew / winLen : 0;
+
+    /* Sketches (deserialized here; workers only add samples) */
+    std::vector<nigel::QuantileSketch> sk(nCh);
+    for (size_t c = 0; c < nCh && !mxIsEmpty(SKETCH); c++)
+    {
+        const mxArray *A = mxGetCell(SKETCH, c);
+        if (A == 0 || mxIsEmpty(A)) continue;
+        if (!mxIsDouble(A) || !sk[c].deserialize(mxGetPr(A), mxGetNumberOfElements(A)))
+            mexErrMsgIdAndTxt("nigeLab:ChannelStats:BadSketch",
+                "Not a quantile sketch.");
+    }
+
+    plhs[0] = mxCreateDoubleMatrix(N_MOM, nCh, mxREAL);
+    double *mom = mxGetPr(plhs[0]);
+    mxArray *PSD = mxCreateDoubleMatrix(nBin, nCh, mxREAL);
+    double *psd = mxGetPr(PSD);
+    mwSize bpDims[3] = { (mwSize)nBand, (mwSize)nWin, (mwSize)nCh };
+    mxArray *BP = mxCreateNumericArray(3, bpDims, mxDOUBLE_CLASS, mxREAL);
+    double *bp = mxGetPr(BP);
+
+    /* Hann window and one-sided PSD scale 1 / (fs * sum(w.^2)) */
+    std::vector<double> w(nfft), side(nBin, 2.0);
+    double u = 0;
+    for (size_t j = 0; j < nfft; j++)
+    {
+        w[j] = (nfft > 1) ? 0.5 * (1.0 - cos(2.0 * PI * (double)j / (double)(nfft - 1))) : 1.0;
+        u += w[j] * w[j];
+    }
+    if (nBin > 0) side[0] = 1.0;
+    if (nBin > 1) side[nBin - 1] = 1.0;
+    double scale = (u > 0) ? 1.0 / (fs * u) : 0;
+    nigel::FFT plan(nfft > 0 ? nfft : 1);
+
+    const double NaN = mxGetNaN();
+    const double *xd = mxIsDouble(X_IN) ? mxGetPr(X_IN) : 0;
+    const float *xf = mxIsSingle(X_IN) ? (const float *)mxGetData(X_IN) : 0;
+    nigel::parallelFor(nCh, [&](size_t c) {
+        std::vector<double> x(nSamp);
+        for (size_t j = 0; j < nSamp; j++)
+            x[j] = xd ? xd[c * nSamp + j] : (double)xf[c * nSamp + j];
+
+        /* Moments, extremes and saturation of the new samples */
+        double n = 0, s1 = 0, s2 = 0, mn = 0, mx = 0, nSat = 0;
+        for (size_t j = 0; j < nNew; j++)
+        {
+            double v = x[j];
+            if (v != v) continue;
+            if (n == 0 || v < mn) mn = v;
+            if (n == 0 || v > mx) mx = v;
+            n += 1;
+            s1 += v;
+            s2 += v * v;
+            nSat += (fabs(v) >= sat);
+        }
+        sk[c].add(x.data(), nNew);
+
+        /* Welch segments that start in the new samples */
+        double nSeg = 0;
+        double *pc = psd + c * nBin;
+        double *bc = bp + c * nBand * nWin;
+        std::vector<double> nInWin(nWin, 0.0);
+        std::vector<cplx> F(nfft);
+        for (size_t s0 = 0; nfft > 0 && s0 < nNew && s0 + nfft <= nSamp; s0 += hop)
+        {
+            for (size_t j = 0; j < nfft; j++) F[j] = cplx(x[s0 + j] * w[j], 0.0);
+            plan.forward(F.data());
+            for (size_t k = 0; k < nBin; k++) pc[k] += side[k] * scale * std::norm(F[k]);
+            nSeg += 1;
+            size_t iw = (winLen > 0) ? s0 / winLen : nWin;
+            if (iw >= nWin) continue;
+            nInWin[iw] += 1;
+            for (size_t b = 0; b < nBand; b++)
+            {
+                double p = 0;
+                for (size_t k = b0[b]; k < b1[b]; k++) p += side[k] * scale * std::norm(F[k]);
+                bc[b + iw * nBand] += p * df;
+            }
+        }
+        for (size_t iw = 0; iw < nWin; iw++)
+            for (size_t b = 0; b < nBand; b++)
+                bc[b + iw * nBand] /= nInWin[iw]; /* NaN if no segment */
+
+        double *m = mom + c * N_MOM;
+        m[0] = n;
+        m[1] = s1;
+        m[2] = s2;
+        m[3] = (n > 0) ? mn : NaN;
+        m[4] = (n > 0) ? mx : NaN;
+        m[5] = nSat;
+        m[6] = nSeg;
+        double p = 50;
+        sk[c].prctiles(&p, 1, &m[7]);
+        m[8] = sk[c].mad();
+    });
+
+    if (nlhs > 1) plhs[1] = PSD; else mxDestroyArray(PSD);
+    if (nlhs > 2) plhs[2] = BP; else mxDestroyArray(BP);
+    if (nlhs > 3)
+    {
+        plhs[3] = mxCreateCellMatrix(1, nCh);
+        for (size_t c = 0; c < nCh; c++)
+        {
+            std::vector<double> v;
+            sk[c].serialize(v);
+            mxArray *a = mxCreateDoubleMatrix(1, v.size(), mxREAL);
+            if (!v.empty()) memcpy(mxGetPr(a), v.data(), v.size() * sizeof(double));
+            mxSetCell(plhs[3], c, a);
+        }
+    }
+}
@@ -34,11 +34,21 @@ if N <= 10
    return;
 end
 
+if exist('PcaFeatures_core','file')==3
+   % Only the kept components, from the snippet covariance (see
+   % PcaFeatures_core.cpp); same scores as pca up to rounding
+   feat = PcaFeatures_core(spikes,pars.NOut,pars.ExplVar);
+   return;
+end
+
 [~, SCORE, LATENT] = pca(spikes);
-if isinf(coeff.ExplVar)
-    K = pars.NOut;
+if isinf(pars.ExplVar)
+    K = min(pars.NOut,size(SCORE,2));
 else
     K = find( cumsum(LATENT)./sum(LATENT) > pars.ExplVar,1);
+    if isempty(K)
+       K = size(SCORE,2);
+    end
 end
 %% CREATES INPUT MATRIX FOR SPC
 feat = SCORE(:,1:K);
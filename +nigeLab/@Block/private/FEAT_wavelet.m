@@ -39,29 +39,29 @@ M =size(spikes,2);   % # samples per spike
 
 %% CALCULATES Wavelt decomposition features
       K = pars.NOut;
-      cc = zeros(N,floor(M/2));
-      for iN=1:N  % Wavelet decomposition (been using 3 scales, 'bior1.3')
-         [C,L] = wavedec(spikes(iN,:), ...
-            pars.NScales, ...
-            pars.LoD,...
-            pars.HiD);
-         cc(iN,:) = C((sum(L(1:pars.NScales))+2):(end-1));
-      end
-      
-      % Remove columns (features) that are mostly 0
-      aux = [];
-      for iC = 1:size(cc,2)
-         if sum(abs(cc(:,iC))<eps)<0.1*size(cc,1)
-            aux = [aux, cc(:,iC)]; %#ok<AGROW>
+      if exist('WaveletFeatures_core','file')==3
+         % Same coefficients, normalization, kurtosis and skewness for
+         % all spikes in one call; see WaveletFeatures_core.cpp
+         [cc,y,ySkew] = WaveletFeatures_core(spikes,pars.HiD);
+      else
+         nC = floor((M + numel(pars.HiD) - 1)/2) - 2; % numel(cD1) - 2
+         cc = zeros(N,nC);
+         for iN=1:N  % Wavelet decomposition (been using 3 scales, 'bior1.3')
+            [C,L] = wavedec(spikes(iN,:), ...
+               pars.NScales, ...
+               pars.LoD,...
+               pars.HiD);
+            cc(iN,:) = C((sum(L(1:pars.NScales))+2):(end-1));
          end
-      end
 
-      % Normalize features
-      cc = cc - mean(cc,1);
-      cc = cc./std(cc,[],1);
+         % Normalize features
+         cc = cc - mean(cc,1);
+         cc = cc./std(cc,[],1);
+         y = kurtosis(cc);
+         ySkew = skewness(cc);
+      end
       
       % Find kurtosis peaks in the time-series distribution
-      y = kurtosis(cc);
       [k_pk,k_loc] = findpeaks(y);
       try
          [~,ind] = sort(k_pk,'descend');
@@ -73,7 +73,7 @@ M =size(spikes,2);   % # samples per spike
       if (numel(loc) >= K)
          coeff = loc(1:K);
       else  % Not enough coefficients, look for skewness
-         y = skewness(cc);
+         y = ySkew;
          try
             [p_pk, p_loc] = findpeaks(y);
             [p_pk,ind] = sort(p_pk,'descend');
@@ -132,12 +132,7 @@ M =size(spikes,2);   % # samples per spike
    
 
 %% Format Output
-feat=zeros(N,K);
-for iN=1:N
-   for iK=1:K
-      feat(iN,iK)=cc(iN,coeff(iK));
-   end
-end
+feat=cc(:,coeff);
 
 featName =  arrayfun(@(ii) sprintf('wave-%.2d',ii),1:K,'UniformOutput',false);
 
@@ -0,0 +1,325 @@
+/*=================================================================
+ *
+ * PCAFEATURES_CORE.CPP	.MEX file for FEAT_pca principal components
+ *
+ * The calling syntax is:
+ *
+ *		[score, latent, coeff] = PcaFeatures_core(spikes, nOut, explVar)
+ *
+ *      spikes:     N x M spike snippets (double or single), or a cell
+ *                  array of such matrices (one per channel; every output
+ *                  is then a cell of the same size)
+ *      nOut:       number of components to keep if explVar is Inf
+ *      explVar:    fraction of variance to explain (0 - 1); keeps the
+ *                  fewest components whose cumulative fraction of the
+ *                  variance exceeds explVar (Inf: use nOut instead)
+ *
+ *      score:      N x K double; principal component scores
+ *      latent:     min(M,N-1) x 1 variances of all components
+ *      coeff:      M x K component coefficients
+ *
+ * Equivalent to [coeff, score, latent] = pca(spikes) truncated to K
+ * components, with the same sign convention (the largest coefficient of
+ * each component is positive). Snippets are short (M is tens of
+ * samples), so instead of an SVD of the N x M data the M x M covariance
+ * is accumulated (upper triangle only, in cache-sized row tiles) and
+ * diagonalized by cyclic Jacobi rotations, which is exact, needs no
+ * random start and is cheap next to the covariance itself. Row tiles
+ * are summed in a fixed order, so the result does not depend on the
+ * number of threads. Channels of a cell input are processed in
+ * parallel; a single channel uses all threads for its tiles.
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "mex.h"
+#include "nigel_threads.h"
+
+/* Input Arguments */
+
+#define	SPIKES	    prhs[0]
+#define	NOUT	    prhs[1]
+#define	EXPLVAR	    prhs[2]
+
+/* Constants */
+
+static const size_t SLAB = 16384;   /* Rows per partial covariance (fixed) */
+static const size_t TILE = 512;     /* Rows per cache tile within a slab */
+static const int    MAX_SWEEP = 100; /* Max. Jacobi sweeps */
+
+struct PcaResult {
+    std::vector<double> score;   /* N x K */
+    std::vector<double> latent;  /* nComp */
+    std::vector<double> coeff;   /* M x K */
+    size_t K;
+};
+
+///////////////////////////////////////////////////////////////////////////
+/* Covariance and eigen-decomposition */
+///////////////////////////////////////////////////////////////////////////
+
+/* Upper triangle of xc(r0:r1-1,:)' * xc(r0:r1-1,:) added to G (M x M) */
+static void gramSlab(const double *xc, size_t N, size_t M, size_t r0,
+                     size_t r1, double *G)
+{
+    for (size_t t0 = r0; t0 < r1; t0 += TILE)
+    {
+        size_t t1 = (t0 + TILE < r1) ? t0 + TILE : r1;
+        for (size_t a = 0; a < M; a++)
+        {
+            const double *ca = xc + a * N;
+            for (size_t b = a; b < M; b++)
+            {
+                const double *cb = xc + b * N;
+                double s = 0;
+                for (size_t i = t0; i < t1; i++) s += ca[i] * cb[i];
+                G[a + b * M] += s;
+            }
+        }
+    }
+}
+
+/* Eigen-decomposition of symmetric A (M x M, upper triangle used) by
+ * cyclic Jacobi; returns eigenvalues in d and eigenvectors in V */
+static void jacobiEig(std::vector<double> A, size_t M, std::vector<double> &d,
+                      std::vector<double> &V)
+{
+    for (size_t b = 0; b < M; b++)
+        for (size_t a = b + 1; a < M; a++) A[a + b * M] = A[b + a * M];
+    V.assign(M * M, 0.0);
+    for (size_t a = 0; a < M; a++) V[a + a * M] = 1.0;
+
+    for (int sweep = 0; sweep < MAX_SWEEP; sweep++)
+    {
+        double off = 0, diag = 0;
+        for (size_t b = 0; b < M; b++)
+        {
+            diag += A[b + b * M] * A[b + b * M];
+            for (size_t a = 0; a < b; a++) off += A[a + b * M] * A[a + b * M];
+        }
+        if (off <= 1e-30 * diag || off == 0) break;
+
+        for (size_t p = 0; p + 1 < M; p++)
+        {
+            for (size_t q = p + 1; q < M; q++)
+            {
+                double apq = A[p + q * M];
+                if (apq == 0) continue;
+                double app = A[p + p * M], aqq = A[q + q * M];
+                double theta = (aqq - app) / (2 * apq);
+                double t = ((theta >= 0) ? 1.0 : -1.0) /
+                           (fabs(theta) + sqrt(theta * theta + 1));
+                double c = 1 / sqrt(t * t + 1), s = t * c;
+                for (size_t k = 0; k < M; k++)
+                {
+                    double akp = A[k + p * M], akq = A[k + q * M];
+                    A[k + p * M] = c * akp - s * akq;
+                    A[k + q * M] = s * akp + c * akq;
+                }
+                for (size_t k = 0; k < M; k++)
+                {
+                    double apk = A[p + k * M], aqk = A[q + k * M];
+                    A[p + k * M] = c * apk - s * aqk;
+                    A[q + k * M] = s * apk + c * aqk;
+                }
+                for (size_t k = 0; k < M; k++)
+                {
+                    double vkp = V[k + p * M], vkq = V[k + q * M];
+                    V[k + p * M] = c * vkp - s * vkq;
+                    V[k + q * M] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+    d.resize(M);
+    for (size_t a = 0; a < M; a++) d[a] = A[a + a * M];
+}
+
+/* pca of one channel, truncated to nOut components or to explVar */
+template <typename T>
+static void pcaChannel(const T *x, size_t N, size_t M, double nOut,
+                       double explVar, unsigned nThreads, PcaResult &r)
+{
+    r.K = 0;
+    if (N < 2 || M == 0) return;
+
+    /* Centered copy (column means summed in a fixed order) */
+    std::vector<double> xc(N * M);
+    nigel::parallelFor(M, [&](size_t a) {
+        const T *col = x + a * N;
+        double mu = 0;
+        for (size_t i = 0; i < N; i++) mu += (double)col[i];
+        mu /= (double)N;
+        for (size_t i = 0; i < N; i++) xc[i + a * N] = (double)col[i] - mu;
+    }, nThreads);
+
+    /* Covariance: one partial sum per slab, reduced in slab order */
+    size_t nSlab = (N + SLAB - 1) / SLAB;
+    std::vector< std::vector<double> > part(nSlab);
+    nigel::parallelFor(nSlab, [&](size_t s) {
+        part[s].assign(M * M, 0.0);
+        size_t r1 = ((s + 1) * SLAB < N) ? (s + 1) * SLAB : N;
+        gramSlab(xc.data(), N, M, s * SLAB, r1, part[s].data());
+    }, nThreads);
+    std::vector<double> C(M * M, 0.0);
+    for (size_t s = 0; s < nSlab; s++)
+    {
+        for (size_t k = 0; k < M * M; k++) C[k] += part[s][k];
+        std::vector<double>().swap(part[s]);
+    }
+    for (size_t k = 0; k < M * M; k++) C[k] /= (double)(N - 1);
+
+    /* Components by decreasing variance */
+    std::vector<double> d, V;
+    jacobiEig(C, M, d, V);
+    std::vector<size_t> order(M);
+    for (size_t a = 0; a < M; a++) order[a] = a;
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return d[a] > d[b]; });
+    size_t nComp = (N - 1 < M) ? N - 1 : M;
+    r.latent.resize(nComp);
+    double total = 0;
+    for (size_t j = 0; j < nComp; j++)
+    {
+        r.latent[j] = (d[order[j]] > 0) ? d[order[j]] : 0.0;
+        total += r.latent[j];
+    }
+
+    /* Number of components kept */
+    size_t K;
+    if (isinf(explVar))
+    {
+        K = (nOut < 0) ? 0 : (size_t)nOut;
+    }
+    else
+    {
+        K = nComp;
+        double cum = 0;
+        for (size_t j = 0; j < nComp; j++)
+        {
+            cum += r.latent[j];
+            if (cum / total > explVar) { K = j + 1; break; }
+        }
+    }
+    if (K > nComp) K = nComp;
+    r.K = K;
+
+    /* Coefficients, with the largest-magnitude element positive */
+    r.coeff.resize(M * K);
+    for (size_t j = 0; j < K; j++)
+    {
+        const double *v = &V[order[j] * M];
+        size_t iMax = 0;
+        for (size_t a = 1; a < M; a++)
+            if (fabs(v[a]) > fabs(v[iMax])) iMax = a;
+        double sgn = (v[iMax] < 0) ? -1.0 : 1.0;
+        for (size_t a = 0; a < M; a++) r.coeff[a + j * M] = sgn * v[a];
+    }
+
+    /* score = xc * coeff */
+    r.score.assign(N * K, 0.0);
+    size_t nTile = (N + TILE - 1) / TILE;
+    nigel::parallelFor(nTile, [&](size_t t) {
+        size_t i0 = t * TILE, i1 = (i0 + TILE < N) ? i0 + TILE : N;
+        for (size_t j = 0; j < K; j++)
+        {
+            double *sc = &r.score[j * N];
+            for (size_t a = 0; a < M; a++)
+            {
+                double w = r.coeff[a + j * M];
+                const double *ca = &xc[a * N];
+                for (size_t i = i0; i < i1; i++) sc[i] += w * ca[i];
+            }
+        }
+    }, nThreads);
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+static void checkSpikes(const mxArray *A)
+{
+    if (mxIsComplex(A) || mxIsSparse(A) || !(mxIsDouble(A) || mxIsSingle(A)) ||
+        mxGetNumberOfDimensions(A) > 2)
+        mexErrMsgIdAndTxt("nigeLab:PcaFeatures:BadClass",
+            "spikes must be a real, full double or single matrix.");
+}
+
+static mxArray *toMatrix(const std::vector<double> &v, size_t m, size_t n)
+{
+    mxArray *a = mxCreateDoubleMatrix(m, n, mxREAL);
+    if (m * n > 0) memcpy(mxGetPr(a), v.data(), m * n * sizeof(double));
+    return a;
+}
+
+void mexFunction( int nlhs, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    if (nrhs != 3)
+        mexErrMsgIdAndTxt("nigeLab:PcaFeatures:BadInput",
+            "Requires (spikes, nOut, explVar).");
+    double nOut = mxGetScalar(NOUT);
+    double explVar = mxGetScalar(EXPLVAR);
+    if (isnan(explVar)) explVar = INFINITY;
+    if (isinf(explVar) && !(nOut >= 1))
+        mexErrMsgIdAndTxt("nigeLab:PcaFeatures:BadNOut",
+            "nOut must be >= 1 when explVar is Inf.");
+
+    bool isCell = mxIsCell(SPIKES);
+    size_t nCh = isCell ? mxGetNumberOfElements(SPIKES) : 1;
+    std::vector<const mxArray *> X(nCh);
+    std::vector<size_t> N(nCh), M(nCh);
+    for (size_t ch = 0; ch < nCh; ch++)
+    {
+        X[ch] = isCell ? mxGetCell(SPIKES, ch) : SPIKES;
+        if (X[ch] == NULL)
+            mexErrMsgIdAndTxt("nigeLab:PcaFeatures:BadClass",
+                "Every cell must contain a spikes matrix.");
+        checkSpikes(X[ch]);
+        N[ch] = mxGetM(X[ch]);
+        M[ch] = mxGetN(X[ch]);
+    }
+
+    /* One channel: all threads on its tiles; several: one per channel */
+    std::vector<const void *> data(nCh);
+    std::vector<char> isDouble(nCh);
+    for (size_t ch = 0; ch < nCh; ch++)
+    {
+        data[ch] = mxGetData(X[ch]);
+        isDouble[ch] = mxIsDouble(X[ch]) ? 1 : 0;
+    }
+    std::vector<PcaResult> res(nCh);
+    unsigned inner = (nCh > 1) ? 1 : 0;
+    nigel::parallelFor(nCh, [&](size_t ch) {
+        if (isDouble[ch])
+            pcaChannel((const double *)data[ch], N[ch], M[ch], nOut, explVar,
+                       inner, res[ch]);
+        else
+            pcaChannel((const float *)data[ch], N[ch], M[ch], nOut, explVar,
+                       inner, res[ch]);
+    });
+
+    int nOutArg = (nlhs < 1) ? 1 : ((nlhs > 3) ? 3 : nlhs);
+    for (int k = 0; k < nOutArg; k++)
+    {
+        if (isCell)
+            plhs[k] = mxCreateCellArray(mxGetNumberOfDimensions(SPIKES),
+                                        mxGetDimensions(SPIKES));
+        for (size_t ch = 0; ch < nCh; ch++)
+        {
+            const PcaResult &r = res[ch];
+            mxArray *a;
+            if (k == 0) a = toMatrix(r.score, N[ch], r.K);
+            else if (k == 1) a = toMatrix(r.latent, r.latent.size(), 1);
+            else a = toMatrix(r.coeff, M[ch], r.K);
+            if (isCell) mxSetCell(plhs[k], ch, a);
+            else plhs[k] = a;
+        }
+    }
+}
@@ -57,22 +57,19 @@ if isempty(endSample)
 end
 
 %% FIND AVERAGE POWER WITHIN EACH WINDOW
-thThis = ones(1,pars.NWIN) * pars.INIT_THRESH;
-for iW = 1:pars.NWIN
 % Here we exclude windows containing 0'S due to artifact rejection
 % Since not all artifact may have been removed
 % These artifacts would increase threshold greatly
-    
-    endSample(iW)   =   min(endSample(iW),nSamples)     ;
-    curr_W          =   data_Mc(startSample(iW):endSample(iW)) ;
-
-    if any(curr_W   ==  0) % Ignore windows with artifact
-         continue;
-    end
-     
-%     thThis(iW) = std(curr_W); 
-    thThis(iW) = median(abs(curr_W))/0.6475; % From Quiroga et al (2004)
+thThis = ones(1,pars.NWIN) * pars.INIT_THRESH;
+startSample = startSample(1:pars.NWIN);
+endSample = min(endSample(1:pars.NWIN),nSamples);
+nZero = cumsum([0, reshape(data_Mc==0,1,[])]);
+iKeep = find((nZero(endSample+1) - nZero(startSample)) == 0);
 
+if ~isempty(iKeep)
+%     thThis(iKeep) = std(curr_W); 
+    thThis(iKeep) = nigeLab.utils.robustStats(data_Mc,'medianabs',...
+       'Windows',[startSample(iKeep).', endSample(iKeep).'])/0.6475; % From Quiroga et al (2004)
 end
 
 %% FIND MEDIAN WINDOW POWER AND SCALE FOR USE AS THRESHOLD
@@ -81,7 +78,7 @@ if exist('thThis','var')==0
     thThis = pars.INIT_THRESH;
 end
 
-thMedian=median(thThis); % Use median to exclude outlier windows
+thMedian=nigeLab.utils.robustStats(thThis,'median'); % Use median to exclude outlier windows
 thresh = thMedian.*pars.MULTCOEFF;
 
 end
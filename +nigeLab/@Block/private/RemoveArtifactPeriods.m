@@ -18,7 +18,9 @@ function [data_ART,art_idx] = RemoveArtifactPeriods(data,t_art)
 %   data_ART    :       data, with the pre-specified epochs in
 %                       pars.ARTIFACT blanked (set to zero).
 %
-%    art_idx    :       Indices that have been blanked from data.
+%    art_idx    :       nArt x 2 sorted, disjoint [start stop] sample
+%                       indices that have been blanked from data (see
+%                       BlankIntervals).
 %
 % By: Max Murphy    v1.0    08/01/2017  Original version (R2017a)
 %                   v1.1    07/27/2018  Added "art_idx" output so that the
@@ -29,14 +31,7 @@ function [data_ART,art_idx] = RemoveArtifactPeriods(data,t_art)
 %                                       the true threshold to be
 %                                       underestimated).
 
-%% LOOP AND CREATE BLANKING INDEX
-art_idx = [];
-for k = 1:size(t_art,2)
-    art_idx = [art_idx, t_art(1,k):t_art(2,k)]; %#ok<AGROW>
-end
-
 %% SET ARTIFACT PERIODS TO ZERO
-data_ART = data;
-data_ART(art_idx) = 0;
+[data_ART,art_idx] = BlankIntervals(data,t_art.');
 
-end
\ No newline at end of file
+end
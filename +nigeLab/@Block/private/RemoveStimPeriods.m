@@ -1,7 +1,11 @@
-function data_ART = RemoveStimPeriods(data,pars)
+function [data_ART,stim_idx] = RemoveStimPeriods(data,pars)
 %% REMOVESTIMPERIODS  Blanks data around stimulation time stamps
 %
 %   data_ART = REMOVESTIMPERIODS(data,pars)
+%   [data_ART,stim_idx] = REMOVESTIMPERIODS(data,pars)
+%
+%   stim_idx is the nK x 2 sorted, disjoint [start stop] sample indices
+%   of the blanked periods (see BlankIntervals).
 %
 % By: Max Murphy    v1.1    08/03/2017  Fixed bug due to single-precision
 %                                       in lb and ub where indexing was
@@ -18,15 +22,7 @@ post_stim = (pars.POST_STIM_BLANKING*1e-3)*pars.FS;
 lb = double(max(round(stim_index - pre_stim),1));
 ub = double(min(numel(data),round(stim_index + post_stim)));
 
-iblank = []; % Accumulate indices
+% Blank those periods
+[data_ART,stim_idx] = BlankIntervals(data,[lb(:), ub(:)]);
 
-for iS = 1:numel(stim_index)
-    iblank = [iblank, lb(iS):ub(iS)];
 end
-
-% Blank those indices
-data_ART = data;
-data_ART(iblank) = 0;
-
-
-end
\ No newline at end of file
@@ -8,7 +8,10 @@ function [ts,p2pamp,pmin,pW,E] = SD_SNEO(data,pars)
 %   --------
 %     data      :       1 x N double of bandpass filtered data, preferrably
 %                       with artifact excluded already, on which to perform
-%                       monopolar spike detection.
+%                       monopolar spike detection. If data is an
+%                       nChannels x N matrix, each row is detected as
+%                       one channel and each output is an nChannels x 1
+%                       cell array.
 %
 %     pars      :       Parameters structure from SPIKEDETECTCLUSTER with
 %                       the following fields:
@@ -38,6 +41,23 @@ function [ts,p2pamp,pmin,pW,E] = SD_SNEO(data,pars)
 %
 % By: Max Murphy    1.0   01/04/2018   Original version (R2017a)
 
+%% USE COMPILED DETECTOR IF AVAILABLE (SAME OUTPUT)
+% See SpikeDetection_SNEO_core.cpp; channels of a matrix run in parallel
+if exist('SpikeDetection_SNEO_core','file')==3
+   [ts,p2pamp,pmin,pW,E] = SpikeDetection_SNEO_core(data,pars.SmoothN,...
+      pars.MultCoeff,pars.NSaround,pars.Polarity,...
+      1e-3*pars.RefrTime*pars.fs,pars.PeakDur*1e-3*pars.fs);
+   return;
+elseif ~isvector(data)
+   nCh = size(data,1);
+   [ts,p2pamp,pmin,pW,E] = deal(cell(nCh,1));
+   for iCh = 1:nCh
+      [ts{iCh},p2pamp{iCh},pmin{iCh},pW{iCh},E{iCh}] = ...
+         SD_SNEO(data(iCh,:),pars);
+   end
+   return;
+end
+
 %% GET NONLINEAR ENERGY OPERATOR SIGNAL AND SMOOTH IT
 Y = data - mean(data);
 Yb = Y(1:(end-2));
@@ -53,8 +73,8 @@ tmpdata = data;
 tmpZ = Zs;
 % tmpZ(art_idx) = [];
 
-th = pars.MultCoeff * median(abs(tmpZ));
-data_th = pars.MultCoeff * median(abs(tmpdata));
+th = pars.MultCoeff * nigeLab.utils.robustStats(tmpZ,'medianabs');
+data_th = pars.MultCoeff * nigeLab.utils.robustStats(tmpdata,'medianabs');
 clear('tmpZ','tmpdata');
 %% PERFORM THRESHOLDING
 pk = Zs > th;
@@ -63,7 +83,7 @@ if sum(pk) <= 1
    p2pamp = [];
    ts = [];
    pmin = [];
-   dt = [];
+   pW = [];
    E = [];
    return
 end
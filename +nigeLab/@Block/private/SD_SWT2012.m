@@ -76,7 +76,7 @@ spd = swtd;
 %estimate noise for each level
 %tmp = swdec(1:level,:)';
 tmp = spd';
-thr = thfactor*sqrt(2*log(Lok)).*mad(tmp,1)/0.6745;
+thr = thfactor*sqrt(2*log(Lok)).*nigeLab.utils.robustStats(tmp,'mad')/0.6745;
 
 % Denoise.
 %swdec2 = zeros(size(swdec));
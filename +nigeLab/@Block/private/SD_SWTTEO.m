@@ -9,6 +9,8 @@ function [ts,p2pamp,pmin,pW,E] = SD_SWTTEO(data,pars)
 %                       SaRa:   Sampling frequency
 %       optional input parameters:
 %                       none
+%       (data may also be an nChannels x N matrix; each row is then
+%        detected as one channel and the outputs are nChannels x 1 cells)
 %   Output parameters:
 %       spikepos:   Timestamps of the detected spikes stored columnwise
 %
@@ -35,6 +37,37 @@ function [ts,p2pamp,pmin,pW,E] = SD_SWTTEO(data,pars)
 
 %parse inputs
 fs = pars.fs;
+
+%use compiled detector if available (same output); see
+%SpikeDetection_SWTTEO_core.cpp. Channels of a matrix run in parallel.
+if exist('SpikeDetection_SWTTEO_core','file')==3
+    if pars.smoothN
+        %conv2 of the (column) TEO with the row wind' below is 'same'
+        %along a singleton dimension, so it scales by the centre tap
+        wind = window(pars.winType,pars.smoothN,pars.winPars{:});
+        gain = wind(floor(numel(wind)/2)+1);
+    else
+        gain = 1;
+    end
+    [ts,p2pamp,pmin,pW,E] = SpikeDetection_SWTTEO_core(data,...
+        wfilters(pars.waveName),pars.wavLevel,gain,pars.MultCoeff,...
+        pars.Polarity,1e-3*pars.RefrTime*fs,pars.PeakDur*1e-3*fs);
+    if iscell(E)
+        E = cellfun(@(e)reshape(e,[],1),E,'UniformOutput',false);
+    else
+        E = reshape(E,[],1); % out_(ts) is a column below
+    end
+    return;
+elseif ~isvector(data) % one channel per row
+    nCh = size(data,1);
+    [ts,p2pamp,pmin,pW,E] = deal(cell(nCh,1));
+    for iCh = 1:nCh
+        [ts{iCh},p2pamp{iCh},pmin{iCh},pW{iCh},E{iCh}] = ...
+            SD_SWTTEO(data(iCh,:),pars);
+    end
+    return;
+end
+
 TEO = @(x,k) (x.^2 - myTEOcircshift(x,[-k, 0]).*myTEOcircshift(x,[k, 0]));
 L = length(data);
 data = data(:);     % ensure in is column
@@ -88,8 +121,8 @@ clear('ss');
 
 % Standard detection
 
-lambda_swtteo   = prctile(out_,99);
-lambda_data      =  pars.MultCoeff*median(abs(data));
+lambda_swtteo   = nigeLab.utils.robustStats(out_,'prctile',99);
+lambda_data      =  pars.MultCoeff*nigeLab.utils.robustStats(data,'medianabs');
 data_th = zeros(size(data));
 data_th(out_>lambda_swtteo) = pars.Polarity .* data(out_>lambda_swtteo);
 
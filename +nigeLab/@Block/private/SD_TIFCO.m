@@ -8,6 +8,8 @@ function [ts,p2pamp,pmin,pW,E] = SD_TIFCO(data,pars)
 %                       SaRa:   Sampling frequency
 %       optional input parameters:
 %                       sx: 
+%       (data may also be an nChannels x N matrix; each row is then
+%        detected as one channel and the outputs are nChannels x 1 cells)
 %   Output parameters:
 %       spikepos:   Timestamps of the detected spikes stored columnwise
 %       
@@ -31,6 +33,40 @@ W = window(pars.winType, pars.winL*fs ,pars.winPars{:});
 a = 1;
 M = 100;
 
+%use compiled detector if available (streams the Gabor coefficients in
+%blocks); see SpikeDetection_TIFCO_core.cpp. Channels of a matrix run in
+%parallel.
+if exist('SpikeDetection_TIFCO_core','file')==3
+    if ~isvector(data)
+        L = size(data,2);
+    end
+    [M,~,dfindx] = findFreqIndx(L,fs,pars.fMin,pars.fMax,M);
+    [~,offset] = max(W);
+    s0 = floor(pars.fMin/(fs/L)) - offset; % win_range(1)-1 in dgtsf
+    if M > 1
+        df = dfindx(2) - dfindx(1);
+    else
+        df = 1;
+    end
+    [ts,p2pamp,pmin,pW,E] = SpikeDetection_TIFCO_core(data,W,s0,df,M,...
+        pars.MultCoeff,pars.Polarity,1e-3*pars.RefrTime*fs,...
+        pars.PeakDur*1e-3*fs);
+    if iscell(E)
+        E = cellfun(@(e)reshape(e,[],1),E,'UniformOutput',false);
+    else
+        E = reshape(E,[],1); % sx1(ts) is a column below
+    end
+    return;
+elseif ~isvector(data) % one channel per row
+    nCh = size(data,1);
+    [ts,p2pamp,pmin,pW,E] = deal(cell(nCh,1));
+    for iCh = 1:nCh
+        [ts{iCh},p2pamp{iCh},pmin{iCh},pW{iCh},E{iCh}] = ...
+            SD_TIFCO(data(iCh,:),pars);
+    end
+    return;
+end
+
 [c,freq] = dgtsf(data,W,a,pars.fMin,pars.fMax,M,fs);
 
 numt = 1;
@@ -45,8 +81,8 @@ sx1 = sum(W,2);
 
 % Standard detection
 
-lambda_tifco  = prctile(sx1,99);
-lambda_data      =  pars.MultCoeff*median(abs(data));
+lambda_tifco  = nigeLab.utils.robustStats(sx1,'prctile',99);
+lambda_data      =  pars.MultCoeff*nigeLab.utils.robustStats(data,'medianabs');
 data_th = zeros(size(data));
 data_th(sx1>lambda_tifco) = pars.Polarity .* data(sx1>lambda_tifco);
 
@@ -0,0 +1,173 @@
+/*=================================================================
+ *
+ * SPIKEDETECTION_SNEO_CORE.CPP	.MEX file for SD_SNEO spike detection
+ *
+ * The calling syntax is:
+ *
+ *		[ts, p2pamp, pmin, pW, E] = SpikeDetection_SNEO_core(data, smoothN, multCoeff, nsAround, polarity, minDist, plp)
+ *
+ *      data:       1 x N filtered data (double or single). For a matrix,
+ *                  each row is one channel and every output is an
+ *                  nChannels x 1 cell of the per-channel outputs.
+ *      smoothN:    samples of the moving-average (SNEO) window
+ *      multCoeff:  factor to multiply the median-based thresholds by
+ *      nsAround:   samples around each SNEO crossing that are kept
+ *      polarity:   1 or -1; sign of the spike peaks to detect
+ *      minDist:    refractory period (samples), as in peakseek
+ *      plp:        samples on each side of a peak searched for pmax
+ *
+ *      ts, p2pamp, pmin, pW, E:  as in SD_SNEO ([] if <= 1 crossing)
+ *
+ * Reproduces SD_SNEO: the nonlinear energy operator is computed on the
+ * fly, smoothed by the same two 'same'-size moving averages (as running
+ * sums), both thresholds use a linear-time median, and the NSaround
+ * dilation, thresholded signal and peakseek are fused into one pass over
+ * the channel (nigel::pickSpikes). Only two channel-length buffers are
+ * used instead of the ~10 temporaries of the MATLAB version. Channels of
+ * a matrix are processed in parallel.
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <math.h>
+#include <stddef.h>
+#include <vector>
+#include "mex.h"
+#include "nigel_spikes.h"
+
+/* Input Arguments */
+
+#define	DATA	    prhs[0]
+#define	SMOOTHN	    prhs[1]
+#define	MULTCOEFF   prhs[2]
+#define	NSAROUND    prhs[3]
+#define	POLARITY    prhs[4]
+#define	MINDIST	    prhs[5]
+#define	PLP	    prhs[6]
+
+/* Constants */
+
+static const size_t RESUM = 8192; /* Running sums are re-summed this often */
+
+struct SneoPars {
+    ptrdiff_t nSmooth;   /* Length of moving-average window */
+    double    wSmooth;   /* Weight of each sample in the window */
+    ptrdiff_t nAround;   /* Length of dilation window (2*NSaround+1) */
+    double    multCoeff;
+    double    polarity;
+    double    minDist;
+    ptrdiff_t plp;
+};
+
+///////////////////////////////////////////////////////////////////////////
+/* Helpers */
+///////////////////////////////////////////////////////////////////////////
+
+/* out[k] = w * sum(src(j)), j = k-left .. k+right (clipped to 0..N-1);
+ * the sliding sum is re-summed every RESUM samples to limit drift */
+template <class Src>
+static void boxSum(Src src, size_t N, ptrdiff_t left, ptrdiff_t right,
+                   double w, double *out)
+{
+    ptrdiff_t n = (ptrdiff_t)N;
+    double s = 0;
+    for (ptrdiff_t k = 0; k < n; k++)
+    {
+        if (k % (ptrdiff_t)RESUM == 0)
+        {
+            s = 0;
+            ptrdiff_t j0 = (k - left < 0) ? 0 : k - left;
+            ptrdiff_t j1 = (k + right > n - 1) ? n - 1 : k + right;
+            for (ptrdiff_t j = j0; j <= j1; j++) s += src(j);
+        }
+        else
+        {
+            if (k + right <= n - 1) s += src(k + right);
+            if (k - left - 1 >= 0) s -= src(k - left - 1);
+        }
+        out[k] = w * s;
+    }
+}
+
+/* SD_SNEO for one channel; returns false if there is <= 1 crossing */
+static bool sneoChannel(const double *x, size_t N, const SneoPars &p,
+                        nigel::SpikeSet &out)
+{
+    if (N == 0) return false;
+
+    /* Y = data - mean(data); Z = [0, Y(2:end-1).^2 - Yb.*Yf, 0] */
+    double mu = 0;
+    for (size_t i = 0; i < N; i++) mu += x[i];
+    mu /= (double)N;
+    ptrdiff_t n = (ptrdiff_t)N;
+    auto Z = [&](ptrdiff_t j) -> double {
+        if (j <= 0 || j >= n - 1) return 0.0;
+        double y = x[j] - mu;
+        return y * y - (x[j-1] - mu) * (x[j+1] - mu);
+    };
+
+    /* Zs = fliplr(conv(fliplr(conv(Z,kern,'same')),kern,'same')) */
+    ptrdiff_t s = p.nSmooth / 2;
+    ptrdiff_t r = p.nSmooth - 1 - s;
+    std::vector<double> c(N), Zs(N);
+    boxSum(Z, N, r, s, p.wSmooth, c.data());
+    boxSum([&](ptrdiff_t j) { return c[j]; }, N, s, r, p.wSmooth, Zs.data());
+
+    /* Thresholds (c is reused as the median buffer) */
+    for (size_t i = 0; i < N; i++) c[i] = fabs(Zs[i]);
+    double th = p.multCoeff * nigel::medianInPlace(c);
+    for (size_t i = 0; i < N; i++) c[i] = fabs(x[i]);
+    double dataTh = p.multCoeff * nigel::medianInPlace(c);
+    std::vector<double>().swap(c);
+
+    size_t nCross = 0;
+    for (size_t i = 0; i < N; i++) nCross += (Zs[i] > th);
+    if (nCross <= 1) return false;
+
+    /* z(pkloc) = Polarity .* data(pkloc), with pkloc the crossings
+     * dilated by conv(pk,ones(1,2*NSaround+1),'same') > 0 */
+    ptrdiff_t sA = p.nAround / 2;
+    ptrdiff_t rA = p.nAround - 1 - sA;
+    ptrdiff_t cnt = 0;
+    for (ptrdiff_t j = 0; j <= sA && j < n; j++) cnt += (Zs[j] > th);
+    auto z = [&](size_t i) -> double {
+        ptrdiff_t k = (ptrdiff_t)i;
+        double v = (cnt > 0) ? p.polarity * x[k] : 0.0;
+        if (k + 1 + sA < n) cnt += (Zs[k + 1 + sA] > th);
+        if (k - rA >= 0) cnt -= (Zs[k - rA] > th);
+        return v;
+    };
+    nigel::pickSpikes(x, N, z, Zs.data(), dataTh, p.minDist, p.polarity,
+                      p.plp, out);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+void mexFunction( int nlhs, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    if (nrhs != 7)
+        mexErrMsgIdAndTxt("nigeLab:SNEO:BadInput",
+            "Requires (data, smoothN, multCoeff, nsAround, polarity, minDist, plp).");
+
+    SneoPars p;
+    double smoothN = mxGetScalar(SMOOTHN);
+    p.nSmooth = (ptrdiff_t)floor(smoothN);
+    p.wSmooth = 1.0 / smoothN;
+    p.nAround = (ptrdiff_t)floor(2 * mxGetScalar(NSAROUND) + 1);
+    p.multCoeff = mxGetScalar(MULTCOEFF);
+    p.polarity = mxGetScalar(POLARITY);
+    p.minDist = mxGetScalar(MINDIST);
+    p.plp = (ptrdiff_t)floor(mxGetScalar(PLP) + 0.5);
+    if (p.nSmooth < 1 || p.nAround < 1)
+        mexErrMsgIdAndTxt("nigeLab:SNEO:BadWindow",
+            "smoothN must be >= 1 and nsAround must be >= 0.");
+
+    nigel::runDetector(nlhs, plhs, DATA,
+        [&](const std::vector<double> &x, nigel::SpikeSet &out) {
+            return sneoChannel(x.data(), x.size(), p, out);
+        });
+}
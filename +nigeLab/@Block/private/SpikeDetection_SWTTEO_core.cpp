@@ -0,0 +1,202 @@
+/*=================================================================
+ *
+ * SPIKEDETECTION_SWTTEO_CORE.CPP	.MEX file for SD_SWTTEO spike detection
+ *
+ * The calling syntax is:
+ *
+ *		[ts, p2pamp, pmin, pW, E] = SpikeDetection_SWTTEO_core(data, lo_D, wavLevel, gain, multCoeff, polarity, minDist, plp)
+ *
+ *      data:       1 x N filtered data (double or single). For a matrix,
+ *                  each row is one channel and every output is an
+ *                  nChannels x 1 cell of the per-channel outputs.
+ *      lo_D:       wavelet decomposition low-pass filter (wfilters)
+ *      wavLevel:   number of stationary wavelet levels
+ *      gain:       factor applied to the TEO of each level (the centre
+ *                  tap of the smoothing window, see SD_SWTTEO)
+ *      multCoeff:  factor to multiply the median(abs(data)) threshold by
+ *      polarity:   1 or -1; sign of the spike peaks to detect
+ *      minDist:    refractory period (samples), as in peakseek
+ *      plp:        samples on each side of a peak searched for pmax
+ *
+ *      ts, p2pamp, pmin, pW, E:  as in SD_SWTTEO (all 1 x nSpikes)
+ *
+ * Reproduces SD_SWTTEO. The signal is (virtually) zero-padded to a
+ * multiple of 2^wavLevel and periodically extended, as by extendswt.
+ * Each level is evaluated "a trous": the taps of lo_D are applied at a
+ * spacing of 2^(level-1) samples instead of convolving with the
+ * zero-stuffed (dyadup) filter. The recording is processed in chunks of
+ * CHUNK samples; each chunk computes every level only over the chunk and
+ * the halo that the following levels need, and accumulates abs(TEO) of
+ * each level into the energy signal in place. The 99th percentile and
+ * median thresholds use linear-time selection. Channels of a matrix are
+ * processed in parallel.
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <math.h>
+#include <stddef.h>
+#include <vector>
+#include "mex.h"
+#include "nigel_spikes.h"
+
+/* Input Arguments */
+
+#define	DATA	    prhs[0]
+#define	LO_D	    prhs[1]
+#define	WAVLEVEL    prhs[2]
+#define	GAIN	    prhs[3]
+#define	MULTCOEFF   prhs[4]
+#define	POLARITY    prhs[5]
+#define	MINDIST	    prhs[6]
+#define	PLP	    prhs[7]
+
+/* Constants */
+
+static const ptrdiff_t CHUNK = 65536;   /* Samples of energy per chunk */
+static const double    PRCTILE = 99;    /* Percentile of SWTTEO threshold */
+
+struct SwtPars {
+    std::vector<double> lo;  /* Decomposition low-pass taps */
+    int       nLevel;
+    double    gain;
+    double    multCoeff;
+    double    polarity;
+    double    minDist;
+    ptrdiff_t plp;
+};
+
+/* Channel zero-padded to N samples (without copying it) */
+struct PaddedSignal {
+    const double *x;
+    ptrdiff_t L;
+    double operator[](ptrdiff_t j) const { return (j < L) ? x[j] : 0.0; }
+};
+
+///////////////////////////////////////////////////////////////////////////
+/* Stationary wavelet TEO energy */
+///////////////////////////////////////////////////////////////////////////
+
+/* Adds gain*abs(TEO) of every level to energy[a..b-1]. Level k has
+ * swa[i] = sum(lo[m] * s[i + h - m*D]), D = 2^(k-1), h = F*D/2, with s
+ * the previous level (or the data) taken modulo N. */
+static void swtChunk(const PaddedSignal &d, ptrdiff_t N, const SwtPars &p,
+                     ptrdiff_t a, ptrdiff_t b, double *energy,
+                     std::vector<double> &cur, std::vector<double> &nxt)
+{
+    ptrdiff_t F = (ptrdiff_t)p.lo.size();
+    int K = p.nLevel;
+
+    /* Range [lo[k], hi[k]) of level k needed by the levels above it */
+    std::vector<ptrdiff_t> lo(K + 1), hi(K + 1);
+    lo[K] = a - 1;
+    hi[K] = b + 1;
+    for (int k = K; k >= 1; k--)
+    {
+        ptrdiff_t D = (ptrdiff_t)1 << (k - 1);
+        lo[k-1] = lo[k] - D * (F/2 - 1);
+        hi[k-1] = hi[k] + D * (F/2);
+    }
+
+    /* Level 0 is the (padded, periodic) data */
+    cur.resize(hi[0] - lo[0]);
+    for (ptrdiff_t j = lo[0]; j < hi[0]; j++)
+    {
+        ptrdiff_t jj = j % N;
+        if (jj < 0) jj += N;
+        cur[j - lo[0]] = d[jj];
+    }
+
+    for (int k = 1; k <= K; k++)
+    {
+        ptrdiff_t D = (ptrdiff_t)1 << (k - 1);
+        ptrdiff_t h = F * D / 2;
+        nxt.resize(hi[k] - lo[k]);
+        for (ptrdiff_t i = lo[k]; i < hi[k]; i++)
+        {
+            const double *s = &cur[i + h - lo[k-1]];
+            double v = 0;
+            for (ptrdiff_t m = 0; m < F; m++) v += p.lo[m] * s[-m * D];
+            nxt[i - lo[k]] = v;
+        }
+
+        /* TEO with the ends replicated (myTEOcircshift) */
+        for (ptrdiff_t i = a; i < b; i++)
+        {
+            double s0 = nxt[i - lo[k]];
+            double sm = (i == 0) ? s0 : nxt[i - 1 - lo[k]];
+            double sp = (i == N - 1) ? s0 : nxt[i + 1 - lo[k]];
+            energy[i] += p.gain * fabs(s0 * s0 - sm * sp);
+        }
+        cur.swap(nxt);
+    }
+}
+
+/* SD_SWTTEO for one channel */
+static bool swtteoChannel(const std::vector<double> &x, const SwtPars &p,
+                          nigel::SpikeSet &out)
+{
+    ptrdiff_t L = (ptrdiff_t)x.size();
+    ptrdiff_t pw = (ptrdiff_t)1 << p.nLevel;
+    ptrdiff_t N = ((L + pw - 1) / pw) * pw;
+    PaddedSignal d = {x.data(), L};
+
+    std::vector<double> energy(N, 0.0), cur, nxt;
+    for (ptrdiff_t a = 0; a < N; a += CHUNK)
+    {
+        ptrdiff_t b = (a + CHUNK < N) ? a + CHUNK : N;
+        swtChunk(d, N, p, a, b, energy.data(), cur, nxt);
+    }
+    std::vector<double>().swap(nxt);
+
+    /* lambda_swtteo = prctile(out_,99); lambda_data from padded data */
+    cur.assign(energy.begin(), energy.end());
+    double lambda = nigel::prctileInPlace(cur, PRCTILE);
+    cur.resize(N);
+    for (ptrdiff_t i = 0; i < N; i++) cur[i] = fabs(d[i]);
+    double dataTh = p.multCoeff * nigel::medianInPlace(cur);
+    std::vector<double>().swap(cur);
+
+    auto z = [&](size_t i) -> double {
+        return (energy[i] > lambda) ? p.polarity * d[(ptrdiff_t)i] : 0.0;
+    };
+    nigel::pickSpikes(d, (size_t)N, z, energy.data(), dataTh, p.minDist,
+                      p.polarity, p.plp, out);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+void mexFunction( int nlhs, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    if (nrhs != 8)
+        mexErrMsgIdAndTxt("nigeLab:SWTTEO:BadInput",
+            "Requires (data, lo_D, wavLevel, gain, multCoeff, polarity, minDist, plp).");
+    if (!mxIsDouble(LO_D) || mxIsComplex(LO_D))
+        mexErrMsgIdAndTxt("nigeLab:SWTTEO:BadFilter",
+            "lo_D must be a real double vector.");
+
+    SwtPars p;
+    size_t F = mxGetNumberOfElements(LO_D);
+    p.lo.assign(mxGetPr(LO_D), mxGetPr(LO_D) + F);
+    p.nLevel = (int)mxGetScalar(WAVLEVEL);
+    p.gain = mxGetScalar(GAIN);
+    p.multCoeff = mxGetScalar(MULTCOEFF);
+    p.polarity = mxGetScalar(POLARITY);
+    p.minDist = mxGetScalar(MINDIST);
+    p.plp = (ptrdiff_t)floor(mxGetScalar(PLP) + 0.5);
+    if (F < 2 || (F % 2) != 0)
+        mexErrMsgIdAndTxt("nigeLab:SWTTEO:BadFilter",
+            "lo_D must have an even number of taps.");
+    if (p.nLevel < 1 || p.nLevel > 20)
+        mexErrMsgIdAndTxt("nigeLab:SWTTEO:BadLevel",
+            "wavLevel must be between 1 and 20.");
+
+    nigel::runDetector(nlhs, plhs, DATA,
+        [&](const std::vector<double> &x, nigel::SpikeSet &out) {
+            return swtteoChannel(x, p, out);
+        });
+}
@@ -0,0 +1,302 @@
+/*=================================================================
+ *
+ * SPIKEDETECTION_TIFCO_CORE.CPP	.MEX file for SD_TIFCO spike detection
+ *
+ * The calling syntax is:
+ *
+ *		[ts, p2pamp, pmin, pW, E] = SpikeDetection_TIFCO_core(data, g, s0, df, M, multCoeff, polarity, minDist, plp)
+ *
+ *      data:       1 x L filtered data (double or single). For a matrix,
+ *                  each row is one channel and every output is an
+ *                  nChannels x 1 cell of the per-channel outputs.
+ *      g:          frequency-domain window of dgtsf (winL*fs samples)
+ *      s0:         0-based FFT bin where the window of band 1 starts
+ *                  (fminidx - offset, as in dgtsf)
+ *      df:         bins between the windows of neighbouring bands
+ *      M:          number of frequency bands (findFreqIndx)
+ *      multCoeff:  factor to multiply the median(abs(data)) threshold by
+ *      polarity:   1 or -1; sign of the spike peaks to detect
+ *      minDist:    refractory period (samples), as in peakseek
+ *      plp:        samples on each side of a peak searched for pmax
+ *
+ *      ts, p2pamp, pmin, pW, E:  as in SD_TIFCO (all 1 x nSpikes)
+ *
+ * dgtsf multiplies the L-point FFT of the channel by g, shifted to each
+ * of the M bands, and takes the L-point inverse FFT of each band; that
+ * is a circular convolution of the channel with the band-pass kernel
+ * exp(2*pi*i*s_k*t/L) * gt(t), where gt is the inverse transform of g.
+ * Here gt is computed once (chirp-z transform), trimmed to the samples
+ * where it is above TAIL of its peak (at most +/- MAX_HALF samples; the
+ * whole period for short channels, which is then exact), and applied to
+ * each band by overlap-save with the built-in radix-2 FFT (nigel_fft.h).
+ * Each block of time samples is reduced to the convFreqWeights score
+ * (sum over bands of the root mean square of abs(c).^2 over a mirrored
+ * window of M bands) as soon as all bands are done, so only one block
+ * of coefficients is kept instead of the L x M matrix.
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "mex.h"
+#include "nigel_fft.h"
+#include "nigel_spikes.h"
+
+/* Input Arguments */
+
+#define	DATA	    prhs[0]
+#define	WIN	    prhs[1]
+#define	S0	    prhs[2]
+#define	DF	    prhs[3]
+#define	NBAND	    prhs[4]
+#define	MULTCOEFF   prhs[5]
+#define	POLARITY    prhs[6]
+#define	MINDIST	    prhs[7]
+#define	PLP	    prhs[8]
+
+/* Constants */
+
+static const double    TAIL = 1e-6;          /* Kernel is trimmed below this (relative) */
+static const ptrdiff_t MAX_HALF = 65536;     /* Max. kernel half-length (samples) */
+static const size_t    MIN_BLOCK = 4096;     /* Min. overlap-save FFT length */
+static const ptrdiff_t ANCHOR = 1024;        /* Demodulation phase re-computed this often */
+static const double    PRCTILE = 99;         /* Percentile of TIFCO threshold */
+static const double    PI = 3.14159265358979323846;
+
+using nigel::cplx;
+using nigel::cmul;
+
+struct TifcoPars {
+    int64_t   L;         /* Channel length (= FFT length of dgtsf) */
+    int64_t   s0, df;
+    int       M;
+    double    multCoeff;
+    double    polarity;
+    double    minDist;
+    ptrdiff_t plp;
+    ptrdiff_t Tl, Tr;    /* Kernel covers gt(-Tl .. Tr) */
+    size_t    B;         /* Overlap-save FFT length */
+    std::vector<cplx> KB; /* B-point FFT of the kernel, over B */
+    unsigned  nThreads;  /* Workers for the bands (0: all) */
+};
+
+///////////////////////////////////////////////////////////////////////////
+/* Kernel */
+///////////////////////////////////////////////////////////////////////////
+
+/* exp(i*pi*n^2/L), with n^2 reduced modulo 2L first */
+static cplx chirp(int64_t n, int64_t L)
+{
+    int64_t m = n < 0 ? -n : n;
+    int64_t r = (int64_t)(((uint64_t)m * (uint64_t)m) % (uint64_t)(2 * L));
+    double a = PI * (double)r / (double)L;
+    return cplx(cos(a), sin(a));
+}
+
+/* gt(t) = sum(g(q) * exp(2*pi*i*q*t/L))/L for t = -Tl..Tr (Bluestein) */
+static void kernelSamples(const std::vector<double> &g, int64_t L,
+                          ptrdiff_t Tl, ptrdiff_t Tr, std::vector<cplx> &gt)
+{
+    ptrdiff_t ws = (ptrdiff_t)g.size();
+    ptrdiff_t nK = Tl + Tr + 1;
+    nigel::FFT plan(nigel::FFT::nextPow2((size_t)(nK + 2 * ws - 1)));
+    size_t P = plan.size();
+
+    std::vector<cplx> a(P, cplx(0, 0)), b(P, cplx(0, 0));
+    for (ptrdiff_t q = 0; q < ws; q++) a[q] = g[q] * chirp(q, L);
+    for (ptrdiff_t j = 0; j < nK + ws - 1; j++)
+        b[j] = std::conj(chirp(j - Tl - ws + 1, L));
+    plan.forward(a.data());
+    plan.forward(b.data());
+    for (size_t i = 0; i < P; i++) a[i] = cmul(a[i], b[i]);
+    plan.inverse(a.data());
+
+    gt.resize(nK);
+    for (ptrdiff_t m = 0; m < nK; m++)
+        gt[m] = cmul(chirp(m - Tl, L), a[m + ws - 1]) / (double)L;
+}
+
+/* Chooses the kernel support and its overlap-save spectrum */
+static void makeKernel(const std::vector<double> &g, TifcoPars &p)
+{
+    std::vector<cplx> gt;
+    if (p.L <= 2 * MAX_HALF + 1)
+    {
+        /* One whole period: same as the L-point circular convolution */
+        p.Tl = (ptrdiff_t)(p.L / 2);
+        p.Tr = (ptrdiff_t)(p.L - 1 - p.L / 2);
+        kernelSamples(g, p.L, p.Tl, p.Tr, gt);
+    }
+    else
+    {
+        kernelSamples(g, p.L, MAX_HALF, MAX_HALF, gt);
+        double peak = 0;
+        for (size_t m = 0; m < gt.size(); m++)
+            if (std::abs(gt[m]) > peak) peak = std::abs(gt[m]);
+        ptrdiff_t T = 0;
+        for (ptrdiff_t t = 1; t <= MAX_HALF; t++)
+        {
+            if (std::abs(gt[MAX_HALF - t]) > TAIL * peak ||
+                std::abs(gt[MAX_HALF + t]) > TAIL * peak) T = t;
+        }
+        gt.erase(gt.begin() + MAX_HALF + T + 1, gt.end());
+        gt.erase(gt.begin(), gt.begin() + (MAX_HALF - T));
+        p.Tl = T;
+        p.Tr = T;
+    }
+
+    size_t nK = gt.size();
+    p.B = nigel::FFT::nextPow2(2 * nK > MIN_BLOCK ? 2 * nK : MIN_BLOCK);
+    p.KB.assign(p.B, cplx(0, 0));
+    for (size_t m = 0; m < nK; m++) p.KB[m] = gt[m] / (double)p.B; /* 1/B of ifft */
+    nigel::FFT(p.B).forward(p.KB.data());
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* Detection */
+///////////////////////////////////////////////////////////////////////////
+
+/* convFreqWeights(c,M,1) summed over bands, for one time sample:
+ * P = abs(c).^2 of the M bands; ext = P mirrored by ceil(M/2)-1 bands
+ * on the left and M-ceil(M/2) on the right (edge band repeated) */
+static double freqScore(const double *P, int M, std::vector<double> &ext)
+{
+    int wc = (M + 1) / 2;
+    int nExt = 2 * M - 1;
+    ext.resize(nExt);
+    for (int e = 0; e < nExt; e++)
+    {
+        int k;
+        if (e < wc - 1) k = wc - 2 - e;
+        else if (e <= M + wc - 2) k = e - wc + 1;
+        else k = 2 * M + wc - 2 - e;
+        ext[e] = P[k];
+    }
+    double w = 1.0 / (double)M;
+    double s = 0;
+    for (int e = 0; e < M; e++) s += ext[e] * w;
+    double sx = sqrt(s);
+    for (int j = 1; j < M; j++)
+    {
+        s += ext[j + M - 1] * w - ext[j - 1] * w;
+        sx += sqrt(s > 0 ? s : 0);
+    }
+    return sx;
+}
+
+/* SD_TIFCO for one channel */
+static bool tifcoChannel(const std::vector<double> &x, const TifcoPars &p,
+                         const nigel::FFT &plan, nigel::SpikeSet &out)
+{
+    ptrdiff_t L = (ptrdiff_t)x.size();
+    ptrdiff_t nK = p.Tl + p.Tr + 1;
+    ptrdiff_t V = (ptrdiff_t)p.B - nK + 1; /* Valid outputs per block */
+    int M = p.M;
+
+    std::vector<double> energy(L), P((size_t)V * M);
+    for (ptrdiff_t t0 = 0; t0 < L; t0 += V)
+    {
+        ptrdiff_t nV = (t0 + V < L) ? V : L - t0;
+
+        /* |c(t,k)|^2 for t = t0..t0+nV-1, one band per work item */
+        nigel::parallelFor((size_t)M, [&](size_t k) {
+            int64_t sk = (p.s0 + (int64_t)k * p.df) % p.L;
+            if (sk < 0) sk += p.L;
+            std::vector<cplx> buf(p.B, cplx(0, 0));
+            ptrdiff_t u0 = t0 - p.Tr;
+            ptrdiff_t nIn = nV + nK - 1;
+            cplx rot(cos(-2 * PI * (double)sk / (double)p.L),
+                     sin(-2 * PI * (double)sk / (double)p.L));
+            cplx ph;
+            for (ptrdiff_t j = 0; j < nIn; j++)
+            {
+                int64_t u = (int64_t)(u0 + j) % p.L;
+                if (u < 0) u += p.L;
+                if (j % ANCHOR == 0)
+                {
+                    int64_t r = (int64_t)(((uint64_t)sk * (uint64_t)u) % (uint64_t)p.L);
+                    double a = -2 * PI * (double)r / (double)p.L;
+                    ph = cplx(cos(a), sin(a));
+                }
+                buf[j] = x[u] * ph;
+                ph = cmul(ph, rot);
+            }
+            plan.forward(buf.data());
+            for (size_t i = 0; i < p.B; i++) buf[i] = cmul(buf[i], p.KB[i]);
+            plan.backward(buf.data());
+            double *Pk = &P[(size_t)k * V];
+            for (ptrdiff_t n = 0; n < nV; n++) Pk[n] = std::norm(buf[n + nK - 1]);
+        }, p.nThreads);
+
+        /* Reduce each time sample over bands */
+        std::vector<double> Pt(M), ext;
+        for (ptrdiff_t n = 0; n < nV; n++)
+        {
+            for (int k = 0; k < M; k++) Pt[k] = P[(size_t)k * V + n];
+            energy[t0 + n] = freqScore(Pt.data(), M, ext);
+        }
+    }
+    std::vector<double>().swap(P);
+
+    /* lambda_tifco = prctile(sx1,99); lambda_data = median(abs(data)) */
+    std::vector<double> tmp(energy);
+    double lambda = nigel::prctileInPlace(tmp, PRCTILE);
+    tmp.resize(L);
+    for (ptrdiff_t i = 0; i < L; i++) tmp[i] = fabs(x[i]);
+    double dataTh = p.multCoeff * nigel::medianInPlace(tmp);
+    std::vector<double>().swap(tmp);
+
+    auto z = [&](size_t i) -> double {
+        return (energy[i] > lambda) ? p.polarity * x[i] : 0.0;
+    };
+    nigel::pickSpikes(x.data(), (size_t)L, z, energy.data(), dataTh,
+                      p.minDist, p.polarity, p.plp, out);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+void mexFunction( int nlhs, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    if (nrhs != 9)
+        mexErrMsgIdAndTxt("nigeLab:TIFCO:BadInput",
+            "Requires (data, g, s0, df, M, multCoeff, polarity, minDist, plp).");
+    if (!mxIsDouble(WIN) || mxIsComplex(WIN) || mxIsEmpty(WIN))
+        mexErrMsgIdAndTxt("nigeLab:TIFCO:BadWindow",
+            "g must be a real double vector.");
+
+    TifcoPars p;
+    size_t nRow = mxGetM(DATA), nCol = mxGetN(DATA);
+    bool isVec = (nRow == 1 || nCol == 1);
+    p.L = (int64_t)(isVec ? nRow * nCol : nCol);
+    p.s0 = (int64_t)mxGetScalar(S0);
+    p.df = (int64_t)mxGetScalar(DF);
+    p.M = (int)mxGetScalar(NBAND);
+    p.multCoeff = mxGetScalar(MULTCOEFF);
+    p.polarity = mxGetScalar(POLARITY);
+    p.minDist = mxGetScalar(MINDIST);
+    p.plp = (ptrdiff_t)floor(mxGetScalar(PLP) + 0.5);
+    p.nThreads = isVec ? 0 : 1; /* Channels of a matrix already run in parallel */
+    std::vector<double> g(mxGetPr(WIN), mxGetPr(WIN) + mxGetNumberOfElements(WIN));
+    if (p.M < 1)
+        mexErrMsgIdAndTxt("nigeLab:TIFCO:BadBands",
+            "M must be at least 1.");
+    if (p.L < 2 || (int64_t)g.size() > p.L)
+        mexErrMsgIdAndTxt("nigeLab:TIFCO:TooShort",
+            "Channels must be longer than the window g (%d samples).",
+            (int)g.size());
+
+    makeKernel(g, p);
+    nigel::FFT plan(p.B);
+
+    nigel::runDetector(nlhs, plhs, DATA,
+        [&](const std::vector<double> &x, nigel::SpikeSet &out) {
+            return tifcoChannel(x, p, plan, out);
+        });
+}
@@ -0,0 +1,253 @@
+/*=================================================================
+ *
+ * STIMSUPPRESS_CORE.CPP	.MEX file for stimulus artifact suppression
+ *
+ * The calling syntax is:
+ *
+ *		Y = StimSuppress_core(X, onsets, pre, post, nTemplate, order)
+ *
+ *      X:          nSamples x nChannel raw data (double or single)
+ *      onsets:     stimulus onset sample indices (1-based; any order)
+ *      pre, post:  samples before and after each onset in its artifact
+ *                  window (W = pre + post + 1 samples)
+ *      nTemplate:  number of neighbouring pulses (nTemplate/2 on each
+ *                  side, fewer at the ends) averaged into the artifact
+ *                  template of a pulse; 0 for no template
+ *      order:      order of the local polynomial fit to the residual of
+ *                  each window (-1 for none)
+ *
+ *      Y:          X (same class and size), with the artifact of every
+ *                  pulse whose window lies in the record suppressed
+ *
+ * Each window is referenced to the mean of its first W/10 samples. The
+ * template of a pulse is the mean referenced window of the other pulses
+ * in its neighbourhood, kept as a running sum as the neighbourhood
+ * slides, so each pulse costs O(W) whatever nTemplate is. The template,
+ * scaled to the pulse (least-squares gain), plus (optionally) a
+ * least-squares polynomial fit to what remains, is the artifact
+ * estimate; it is tapered to zero over the first and last W/10 samples
+ * and subtracted, so the corrected window joins the untouched data
+ * smoothly (post should cover the artifact decay). A window is corrected
+ * up to the start of the next pulse's window. Pulses run in parallel
+ * blocks (channels too, for a matrix).
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "mex.h"
+#include "nigel_threads.h"
+
+/* Input Arguments */
+
+#define	X_IN	prhs[0]
+#define	ONSETS	prhs[1]
+#define	PRE	prhs[2]
+#define	POST	prhs[3]
+#define	NTEMPL	prhs[4]
+#define	ORDER	prhs[5]
+
+/* Constants */
+
+static const size_t BLOCK = 1024;       /* Pulses per parallel work item */
+static const double PI = 3.14159265358979323846;
+
+///////////////////////////////////////////////////////////////////////////
+/* Helpers */
+///////////////////////////////////////////////////////////////////////////
+
+static size_t getCount(const mxArray *A, const char *name)
+{
+    double v = mxGetScalar(A);
+    if (!(v >= 0) || v != floor(v))
+        mexErrMsgIdAndTxt("nigeLab:StimSuppress:BadInput",
+            "%s must be a non-negative integer.", name);
+    return (size_t)v;
+}
+
+/* Window geometry shared by every pulse */
+struct Window
+{
+    size_t W, E;                    /* Length; baseline (and taper) edge */
+    std::vector<double> taper;      /* 0 at the edges, 1 in the middle */
+    std::vector<double> Q;          /* W x nQ orthonormal polynomials */
+    size_t nQ;
+
+    Window(size_t pre, size_t post, int order)
+    {
+        W = pre + post + 1;
+        E = std::max<size_t>(1, W / 10);
+        taper.assign(W, 1.0);
+        for (size_t j = 0; j < E && 2 * j < W; j++)
+        {
+            double t = 0.5 * (1.0 - cos(PI * ((double)j + 0.5) / (double)E));
+            taper[j] = t;
+            taper[W - 1 - j] = t;
+        }
+
+        /* Gram-Schmidt on 1, t, t^2, ... (t in [-1, 1]) */
+        nQ = (order >= 0) ? std::min((size_t)order + 1, W) : 0;
+        Q.assign(W * nQ, 0.0);
+        for (size_t q = 0; q < nQ; q++)
+        {
+            double *v = &Q[q * W];
+            for (size_t j = 0; j < W; j++)
+            {
+                double t = (W > 1) ? 2.0 * (double)j / (double)(W - 1) - 1.0 : 0.0;
+                v[j] = pow(t, (double)q);
+            }
+            for (int pass = 0; pass < 2; pass++)
+            {
+                for (size_t r = 0; r < q; r++)
+                {
+                    const double *u = &Q[r * W];
+                    double d = 0;
+                    for (size_t j = 0; j < W; j++) d += u[j] * v[j];
+                    for (size_t j = 0; j < W; j++) v[j] -= d * u[j];
+                }
+            }
+            double n = 0;
+            for (size_t j = 0; j < W; j++) n += v[j] * v[j];
+            n = sqrt(n);
+            for (size_t j = 0; j < W; j++) v[j] = (n > 0) ? v[j] / n : 0.0;
+        }
+    }
+
+    /* Window d of x[s .. s+W-1] referenced to its leading-edge mean */
+    template <typename T>
+    void extract(const T *x, size_t s, double *d) const
+    {
+        double m0 = 0;
+        for (size_t j = 0; j < E; j++) m0 += (double)x[s + j];
+        m0 /= (double)E;
+        for (size_t j = 0; j < W; j++) d[j] = (double)x[s + j] - m0;
+    }
+};
+
+/* Suppress pulses [k0, k1) of one channel (window starts s, sorted) */
+template <typename T>
+static void suppressBlock(const T *x, T *y, const std::vector<size_t> &s,
+                          size_t k0, size_t k1, size_t h, const Window &win)
+{
+    size_t W = win.W, nV = s.size();
+    std::vector<double> sum(W, 0.0), d(W), tmp(W), a(W);
+
+    /* Running sum over pulses [lo, hi] = [k - h, k + h] within [0, nV) */
+    size_t lo = (k0 > h) ? k0 - h : 0;
+    size_t hi = std::min(k0 + h, nV - 1);
+    for (size_t m = lo; m <= hi; m++)
+    {
+        win.extract(x, s[m], tmp.data());
+        for (size_t j = 0; j < W; j++) sum[j] += tmp[j];
+    }
+
+    for (size_t k = k0; k < k1; k++)
+    {
+        if (k > k0)
+        {
+            if (k + h < nV)
+            {
+                win.extract(x, s[k + h], tmp.data());
+                for (size_t j = 0; j < W; j++) sum[j] += tmp[j];
+                hi = k + h;
+            }
+            if (k > h)
+            {
+                win.extract(x, s[k - h - 1], tmp.data());
+                for (size_t j = 0; j < W; j++) sum[j] -= tmp[j];
+                lo = k - h;
+            }
+        }
+        win.extract(x, s[k], d.data());
+
+        /* Template of the other pulses in the neighbourhood, scaled by
+         * its least-squares gain (pulse-to-pulse amplitude jitter) */
+        double nOther = (double)(hi - lo), tt = 0, td = 0;
+        for (size_t j = 0; j < W; j++)
+        {
+            tmp[j] = (nOther > 0) ? (sum[j] - d[j]) / nOther : 0.0;
+            tt += tmp[j] * tmp[j];
+            td += tmp[j] * d[j];
+        }
+        double gain = (tt > 0) ? td / tt : 0.0;
+        for (size_t j = 0; j < W; j++) a[j] = gain * tmp[j];
+
+        /* Local polynomial fit to the remainder */
+        for (size_t q = 0; q < win.nQ; q++)
+        {
+            const double *u = &win.Q[q * W];
+            double c = 0;
+            for (size_t j = 0; j < W; j++) c += u[j] * (d[j] - gain * tmp[j]);
+            for (size_t j = 0; j < W; j++) a[j] += c * u[j];
+        }
+
+        /* Subtract the tapered estimate, up to the next window */
+        size_t len = (k + 1 < nV) ? std::min(W, s[k + 1] - s[k]) : W;
+        for (size_t j = 0; j < len; j++)
+            y[s[k] + j] = (T)((double)x[s[k] + j] - win.taper[j] * a[j]);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+void mexFunction( int /* nlhs */, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    if (nrhs != 6)
+        mexErrMsgIdAndTxt("nigeLab:StimSuppress:BadInput",
+            "Requires (X, onsets, pre, post, nTemplate, order).");
+    if (mxIsComplex(X_IN) || mxIsSparse(X_IN) || !(mxIsDouble(X_IN) || mxIsSingle(X_IN)))
+        mexErrMsgIdAndTxt("nigeLab:StimSuppress:BadClass",
+            "X must be a real, full double or single matrix.");
+    if (!mxIsDouble(ONSETS) || mxIsComplex(ONSETS))
+        mexErrMsgIdAndTxt("nigeLab:StimSuppress:BadOnsets",
+            "onsets must be a real double vector.");
+
+    /* A vector is one channel */
+    size_t nSamp = mxGetM(X_IN), nCh = mxGetN(X_IN);
+    if (nSamp == 1)
+    {
+        nSamp = nCh;
+        nCh = 1;
+    }
+    size_t pre = getCount(PRE, "pre");
+    size_t post = getCount(POST, "post");
+    size_t h = getCount(NTEMPL, "nTemplate") / 2;
+    int order = (int)mxGetScalar(ORDER);
+    Window win(pre, post, order);
+
+    /* Starts of the windows that lie in the record, sorted and unique */
+    std::vector<size_t> s;
+    const double *on = mxGetPr(ONSETS);
+    for (size_t i = 0; i < mxGetNumberOfElements(ONSETS); i++)
+    {
+        double v = round(on[i]) - 1.0 - (double)pre;
+        if (v >= 0 && v + (double)win.W <= (double)nSamp) s.push_back((size_t)v);
+    }
+    std::sort(s.begin(), s.end());
+    s.erase(std::unique(s.begin(), s.end()), s.end());
+
+    plhs[0] = mxDuplicateArray(X_IN);
+    if (s.empty()) return;
+    size_t nBlk = (s.size() + BLOCK - 1) / BLOCK;
+    const double *xd = mxIsDouble(X_IN) ? mxGetPr(X_IN) : 0;
+    const float *xf = mxIsSingle(X_IN) ? (const float *)mxGetData(X_IN) : 0;
+    double *yd = mxIsDouble(X_IN) ? mxGetPr(plhs[0]) : 0;
+    float *yf = mxIsSingle(X_IN) ? (float *)mxGetData(plhs[0]) : 0;
+
+    /* Blocks write disjoint ranges: each pulse stops at the next window */
+    nigel::parallelFor(nCh * nBlk, [&](size_t i) {
+        size_t c = i / nBlk, k0 = (i % nBlk) * BLOCK;
+        size_t k1 = std::min(k0 + BLOCK, s.size());
+        if (xd)
+            suppressBlock(xd + c * nSamp, yd + c * nSamp, s, k0, k1, h, win);
+        else
+            suppressBlock(xf + c * nSamp, yf + c * nSamp, s, k0, k1, h, win);
+    });
+}
@@ -0,0 +1,92 @@
+function data = SuppressStimArtifact(data,onsets,pars,fs)
+%% SUPPRESSSTIMARTIFACT  Subtract stimulus artifact templates from data
+%
+%   data = SUPPRESSSTIMARTIFACT(data,onsets,pars,fs)
+%
+%   --------
+%    INPUTS
+%   --------
+%     data      :       Raw data vector of one channel (or nSamples x
+%                       nChannels matrix).
+%
+%    onsets     :       Stimulus onset sample indices (1-based).
+%
+%     pars      :       Parameters struct (see nigeLab.defaults.Filt):
+%       -> STIM_BLANK    \\ [pre post] (ms) artifact window around each
+%                           onset (post should cover the artifact decay)
+%       -> STIM_TEMPLATE \\ Number of neighbouring pulses averaged into
+%                           the template of each pulse (0: none)
+%       -> STIM_DETREND  \\ Order of the local polynomial fit to the
+%                           remainder of each window (-1: none)
+%
+%      fs       :       Sample rate (Hz).
+%
+%   --------
+%    OUTPUT
+%   --------
+%     data      :       Same as input, with the artifact of each pulse
+%                       (window referenced to its first tenth) replaced by
+%                       its residual after subtracting the amplitude-scaled
+%                       template of the neighbouring pulses and the
+%                       polynomial fit, tapered at the window edges.
+%
+%   Unlike blanking (RemoveStimPeriods), the data within a millisecond or
+%   so of each pulse stays usable. If the compiled StimSuppress_core
+%   kernel is available (see nigeLab.utils.compileNativeKernels), the
+%   templates are kept as running sums (O(window) per pulse) and pulses
+%   run in parallel; the output is the same.
+
+pre = round(pars.STIM_BLANK(1)*1e-3*fs);
+post = round(pars.STIM_BLANK(end)*1e-3*fs);
+K = pars.STIM_TEMPLATE;
+order = pars.STIM_DETREND;
+
+if exist('StimSuppress_core','file')==3
+   data = StimSuppress_core(data,double(onsets),pre,post,K,order);
+   return;
+elseif ~isvector(data)
+   for iCh = 1:size(data,2)
+      data(:,iCh) = SuppressStimArtifact(data(:,iCh),onsets,pars,fs);
+   end
+   return;
+end
+
+%% ARTIFACT WINDOWS (W x nPulse) THAT LIE IN THE RECORD
+W = pre + post + 1;
+E = max(1,floor(W/10));
+s = unique(round(onsets(:)) - 1 - pre); % 0-based window starts
+s = s((s >= 0) & (s + W <= numel(data)));
+if isempty(s)
+   return;
+end
+idx = s.' + (1:W).';
+x = double(data(:));
+D = x(idx);
+D = D - mean(D(1:E,:),1);
+
+%% TEMPLATE OF THE OTHER PULSES IN EACH NEIGHBOURHOOD, SCALED TO THE PULSE
+h = floor(K/2);
+nOther = movsum(ones(1,numel(s)),[h h]) - 1;
+T = (movsum(D,[h h],2) - D) ./ max(nOther,1);
+gain = sum(T.*D,1) ./ sum(T.^2,1);
+gain(~isfinite(gain)) = 0;
+A = T .* gain;
+
+%% LOCAL POLYNOMIAL FIT TO THE REMAINDER
+if order >= 0
+   t = 2*(0:(W-1)).'/max(W-1,1) - 1;
+   [Q,~] = qr(t.^(0:min(order,W-1)),0);
+   A = A + Q * (Q.' * (D - A));
+end
+
+%% SUBTRACT THE TAPERED ESTIMATE, UP TO THE NEXT WINDOW
+taper = ones(W,1);
+ramp = 0.5 * (1 - cos(pi*((0:(E-1)).' + 0.5)/E));
+taper(1:E) = ramp;
+taper(W:-1:(W-E+1)) = ramp;
+len = min(W,[diff(s.'), W]);
+keep = (1:W).' <= len;
+Y = x(idx) - taper .* A;
+data(idx(keep)) = Y(keep);
+
+end
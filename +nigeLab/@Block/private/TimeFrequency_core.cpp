@@ -0,0 +1,277 @@
+/*=================================================================
+ *
+ * TIMEFREQUENCY_CORE.CPP	.MEX file for analyzeERS
+ *
+ * The calling syntax is:
+ *
+ *		[tf, pow] = TimeFrequency_core(X, fs, freqs, nWin, frameStart, baseFrames, nTapers)
+ *
+ *      X:          nSamples x nTrial x nChannel epochs (double or single)
+ *      fs:         sample rate (Hz)
+ *      freqs:      nFreq frequencies (Hz) at which power is computed
+ *      nWin:       window length (samples)
+ *      frameStart: nFrame 0-based first sample of each frame in the epoch
+ *      baseFrames: (1-based) frames of the baseline; empty for none
+ *      nTapers:    1 for a Hann window, K > 1 for a multitaper estimate
+ *                  with the first K sine tapers
+ *
+ *      tf:         nFreq x nFrame x nChannel mean over trials of the
+ *                  event-related (de)synchronization 100 * (P - B) ./ B,
+ *                  where P is the power of the trial and B its mean over
+ *                  the baseline frames (the mean power if there is no
+ *                  baseline)
+ *      pow:        nFreq x nFrame x nChannel mean power over trials
+ *                  (one-sided power spectral density, as spectrogram)
+ *
+ * Only the samples of the epochs are transformed, and only at the
+ * requested frequencies: equally spaced frequencies (a band) use a
+ * chirp-z transform (nigel_fft.h), two FFTs of length
+ * nextPow2(nWin + nFreq - 1) per frame and taper, instead of a full-length
+ * FFT or a DFT per frequency; other frequency lists use the direct DFT.
+ * The baseline of each trial and the trial average are accumulated as
+ * the frames are computed, so no trial x frequency x time array is
+ * kept. Channels (and blocks of trials of each channel) run in parallel.
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <math.h>
+#include <stddef.h>
+#include <vector>
+#include "mex.h"
+#include "nigel_fft.h"
+#include "nigel_threads.h"
+
+/* Input Arguments */
+
+#define	X_IN	prhs[0]
+#define	FS	prhs[1]
+#define	FREQS	prhs[2]
+#define	NWIN	prhs[3]
+#define	FRAMES	prhs[4]
+#define	BASE	prhs[5]
+#define	NTAPER	prhs[6]
+
+/* Constants */
+
+static const size_t TRIAL_BLOCK = 16;     /* Trials per parallel work item */
+static const double UNIFORM_TOL = 1e-9;   /* Relative tolerance of "equally spaced" */
+static const double PI = 3.14159265358979323846;
+
+using nigel::cplx;
+
+///////////////////////////////////////////////////////////////////////////
+/* Helpers */
+///////////////////////////////////////////////////////////////////////////
+
+/* Power of one windowed frame at every frequency */
+class FramePower {
+public:
+    FramePower(const std::vector<double> &f, double fs, size_t nWin,
+               size_t nTaper)
+        : f_(f), fs_(fs), nWin_(nWin), cz_(0)
+    {
+        /* Tapers, each with its PSD scale 1 / (fs * sum(w.^2)) */
+        if (nTaper <= 1)
+        {
+            taper_.assign(1, std::vector<double>(nWin));
+            for (size_t j = 0; j < nWin; j++)
+                taper_[0][j] = (nWin > 1)
+                    ? 0.5 * (1.0 - cos(2.0 * PI * (double)j / (double)(nWin - 1)))
+                    : 1.0;
+        }
+        else
+        {
+            taper_.assign(nTaper, std::vector<double>(nWin));
+            for (size_t k = 0; k < nTaper; k++)
+                for (size_t j = 0; j < nWin; j++)
+                    taper_[k][j] = sin(PI * (double)(k + 1) * (double)(j + 1) /
+                                       (double)(nWin + 1));
+        }
+        for (size_t k = 0; k < taper_.size(); k++)
+        {
+            double u = 0;
+            for (size_t j = 0; j < nWin; j++) u += taper_[k][j] * taper_[k][j];
+            scale_.push_back(1.0 / (fs * u * (double)taper_.size()));
+        }
+        /* One-sided: double all but DC and Nyquist */
+        for (size_t m = 0; m < f.size(); m++)
+        {
+            double a = fabs(f[m]);
+            side_.push_back((a == 0 || a == fs / 2) ? 1.0 : 2.0);
+        }
+
+        bool uniform = (f.size() > 1);
+        double df = uniform ? (f[f.size() - 1] - f[0]) / (double)(f.size() - 1) : 0;
+        for (size_t m = 1; m < f.size() && uniform; m++)
+            uniform = fabs(f[m] - f[0] - df * (double)m) <=
+                      UNIFORM_TOL * (fabs(f[0]) + fabs(df) * (double)m + 1);
+        if (uniform) cz_ = new nigel::ChirpZ(nWin, f.size(), f[0] / fs, df / fs);
+    }
+
+    ~FramePower() { delete cz_; }
+
+    size_t workSize() const { return cz_ ? cz_->workSize() : 0; }
+
+    /* P(m) = power of x(0 .. nWin-1) at f(m) */
+    void compute(const double *x, double *P, std::vector<double> &buf,
+                 std::vector<cplx> &X, std::vector<cplx> &work) const
+    {
+        size_t nF = f_.size();
+        for (size_t m = 0; m < nF; m++) P[m] = 0;
+        for (size_t k = 0; k < taper_.size(); k++)
+        {
+            for (size_t j = 0; j < nWin_; j++) buf[j] = x[j] * taper_[k][j];
+            if (cz_)
+            {
+                cz_->transform(buf.data(), X.data(), work.data());
+            }
+            else
+            {
+                for (size_t m = 0; m < nF; m++)
+                {
+                    double re = 0, im = 0, w = 2.0 * PI * f_[m] / fs_;
+                    for (size_t j = 0; j < nWin_; j++)
+                    {
+                        re += buf[j] * cos(w * (double)j);
+                        im -= buf[j] * sin(w * (double)j);
+                    }
+                    X[m] = cplx(re, im);
+                }
+            }
+            for (size_t m = 0; m < nF; m++) P[m] += scale_[k] * std::norm(X[m]);
+        }
+        for (size_t m = 0; m < nF; m++) P[m] *= side_[m];
+    }
+
+private:
+    std::vector<double> f_;
+    double fs_;
+    size_t nWin_;
+    std::vector< std::vector<double> > taper_;
+    std::vector<double> scale_, side_;
+    nigel::ChirpZ *cz_;
+
+    FramePower(const FramePower &);
+    FramePower &operator=(const FramePower &);
+};
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+void mexFunction( int nlhs, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    if (nrhs != 7)
+        mexErrMsgIdAndTxt("nigeLab:TimeFrequency:BadInput",
+            "Requires (X, fs, freqs, nWin, frameStart, baseFrames, nTapers).");
+    if (mxIsComplex(X_IN) || mxIsSparse(X_IN) || !(mxIsDouble(X_IN) || mxIsSingle(X_IN)))
+        mexErrMsgIdAndTxt("nigeLab:TimeFrequency:BadClass",
+            "X must be a real, full double or single array.");
+    if (!mxIsDouble(FREQS) || !mxIsDouble(FRAMES) ||
+        (!mxIsEmpty(BASE) && !mxIsDouble(BASE)))
+        mexErrMsgIdAndTxt("nigeLab:TimeFrequency:BadClass",
+            "freqs, frameStart and baseFrames must be double.");
+
+    const mwSize *dims = mxGetDimensions(X_IN);
+    size_t nDim = mxGetNumberOfDimensions(X_IN);
+    size_t nSamp = dims[0];
+    size_t nTrial = (nDim > 1) ? dims[1] : 1;
+    size_t nCh = 1;
+    for (size_t d = 2; d < nDim; d++) nCh *= dims[d];
+
+    double fs = mxGetScalar(FS);
+    double w = mxGetScalar(NWIN);
+    double t = mxGetScalar(NTAPER);
+    if (!(fs > 0))
+        mexErrMsgIdAndTxt("nigeLab:TimeFrequency:BadRate",
+            "fs must be positive.");
+    if (!(w >= 1) || w != floor(w) || !(t >= 1) || t != floor(t))
+        mexErrMsgIdAndTxt("nigeLab:TimeFrequency:BadWindow",
+            "nWin and nTapers must be positive integers.");
+    size_t nWin = (size_t)w;
+
+    std::vector<double> f(mxGetPr(FREQS), mxGetPr(FREQS) + mxGetNumberOfElements(FREQS));
+    size_t nF = f.size();
+    size_t nFrame = mxGetNumberOfElements(FRAMES);
+    std::vector<size_t> start(nFrame);
+    for (size_t m = 0; m < nFrame; m++)
+    {
+        double s = mxGetPr(FRAMES)[m];
+        if (!(s >= 0) || s != floor(s) || s + (double)nWin > (double)nSamp)
+            mexErrMsgIdAndTxt("nigeLab:TimeFrequency:BadFrames",
+                "Frames must lie within the epochs.");
+        start[m] = (size_t)s;
+    }
+    std::vector<size_t> base;
+    for (size_t m = 0; m < mxGetNumberOfElements(BASE); m++)
+    {
+        double b = mxGetPr(BASE)[m];
+        if (!(b >= 1) || b > (double)nFrame || b != floor(b))
+            mexErrMsgIdAndTxt("nigeLab:TimeFrequency:BadBaseline",
+                "baseFrames must be indices of frames.");
+        base.push_back((size_t)b - 1);
+    }
+
+    mwSize outDims[3] = { (mwSize)nF, (mwSize)nFrame, (mwSize)nCh };
+    plhs[0] = mxCreateNumericArray(3, outDims, mxDOUBLE_CLASS, mxREAL);
+    double *tf = mxGetPr(plhs[0]);
+    mxArray *POW = (nlhs > 1) ? mxCreateNumericArray(3, outDims, mxDOUBLE_CLASS, mxREAL) : 0;
+    double *pow = POW ? mxGetPr(POW) : 0;
+
+    const double *xd = mxIsDouble(X_IN) ? mxGetPr(X_IN) : 0;
+    const float *xf = mxIsSingle(X_IN) ? (const float *)mxGetData(X_IN) : 0;
+    FramePower fp(f, fs, nWin, (size_t)t);
+
+    /* Partial sums of each (channel, trial block) */
+    size_t nTB = (nTrial + TRIAL_BLOCK - 1) / TRIAL_BLOCK;
+    size_t nOut = nF * nFrame;
+    std::vector< std::vector<double> > sumTf(nCh * nTB), sumPow(nCh * nTB);
+    nigel::parallelFor(nCh * nTB, [&](size_t job) {
+        size_t c = job / nTB, b = job % nTB;
+        size_t t0 = b * TRIAL_BLOCK;
+        size_t t1 = (t0 + TRIAL_BLOCK < nTrial) ? t0 + TRIAL_BLOCK : nTrial;
+        std::vector<double> &st = sumTf[job], &sp = sumPow[job];
+        st.assign(nOut, 0.0);
+        sp.assign(nOut, 0.0);
+        std::vector<double> x(nSamp), buf(nWin), P(nOut), B(nF);
+        std::vector<cplx> X(nF), work(fp.workSize());
+        for (size_t tr = t0; tr < t1; tr++)
+        {
+            size_t off = (c * nTrial + tr) * nSamp;
+            for (size_t j = 0; j < nSamp; j++)
+                x[j] = xd ? xd[off + j] : (double)xf[off + j];
+            for (size_t m = 0; m < nFrame; m++)
+                fp.compute(&x[start[m]], &P[m * nF], buf, X, work);
+            for (size_t k = 0; k < nOut; k++) sp[k] += P[k];
+            if (base.empty()) continue;
+            for (size_t k = 0; k < nF; k++) B[k] = 0;
+            for (size_t m = 0; m < base.size(); m++)
+                for (size_t k = 0; k < nF; k++) B[k] += P[base[m] * nF + k];
+            for (size_t k = 0; k < nF; k++) B[k] /= (double)base.size();
+            for (size_t m = 0; m < nFrame; m++)
+                for (size_t k = 0; k < nF; k++)
+                    st[m * nF + k] += 100.0 * (P[m * nF + k] - B[k]) / B[k];
+        }
+    });
+
+    for (size_t c = 0; c < nCh; c++)
+    {
+        for (size_t b = 0; b < nTB; b++)
+        {
+            const std::vector<double> &st = sumTf[c * nTB + b], &sp = sumPow[c * nTB + b];
+            for (size_t k = 0; k < nOut; k++)
+            {
+                tf[c * nOut + k] += base.empty() ? sp[k] : st[k];
+                if (pow) pow[c * nOut + k] += sp[k];
+            }
+        }
+        for (size_t k = 0; k < nOut; k++)
+        {
+            tf[c * nOut + k] /= (double)nTrial;
+            if (pow) pow[c * nOut + k] /= (double)nTrial;
+        }
+    }
+    if (POW) plhs[1] = POW;
+}
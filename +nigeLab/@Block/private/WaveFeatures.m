@@ -58,10 +58,7 @@ end
 
 %% INTERPOLATE SPIKES
 pars.N_INTERP_SAMPLES = max(size(spikes,2),pars.N_INTERP_SAMPLES);
-spikes = interp1(1:size(spikes,2),...
-   spikes.',...
-   linspace(1,size(spikes,2),pars.N_INTERP_SAMPLES),...
-   'spline').';
+spikes = nigeLab.utils.upsampleSnippets(spikes,pars.N_INTERP_SAMPLES,'spline');
 M =size(spikes,2);   % # samples per spike
 
 %% CALCULATES FEATURES
@@ -174,12 +171,8 @@ switch pars.FEAT
       
    case 'mix' % Combine peak-width, p2pamp, ICAs
       K = 4;
-      spikes_interp = interp1((0:(size(spikes,2)-1))/pars.FS, ...
-         spikes.', ...
-         linspace(0,(size(spikes,2)-1)/pars.FS, ...
-         pars.N_INTERP_SAMPLES));
-      
-      spikes_interp = spikes_interp.';
+      spikes_interp = nigeLab.utils.upsampleSnippets(spikes, ...
+         pars.N_INTERP_SAMPLES,'linear');
       
       [amax,imax] = max(spikes_interp,[],2);
       [amin,imin] = min(spikes_interp,[],2);
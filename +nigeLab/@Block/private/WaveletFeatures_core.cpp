@@ -0,0 +1,183 @@
+/*=================================================================
+ *
+ * WAVELETFEATURES_CORE.CPP	.MEX file for FEAT_wavelet coefficients
+ *
+ * The calling syntax is:
+ *
+ *		[cc, kurt, skew] = WaveletFeatures_core(spikes, hiD)
+ *
+ *      spikes:     N x M spike snippets (double or single)
+ *      hiD:        wavelet decomposition high-pass filter (wfilters)
+ *
+ *      cc:         N x nC normalized level-1 detail coefficients
+ *                  (zero mean, unit std over spikes), nC =
+ *                  floor((M + numel(hiD) - 1)/2) - 2
+ *      kurt:       1 x nC kurtosis(cc)
+ *      skew:       1 x nC skewness(cc)
+ *
+ * FEAT_wavelet keeps C((sum(L(1:NScales))+2):(end-1)) of wavedec, which
+ * is the level-1 detail (cD1) without its first and last coefficient,
+ * whatever the number of scales. Here cD1 is computed directly, with the
+ * half-point symmetric extension of dwtmode('sym'), for all spikes at
+ * once: the snippets are column-major, so each filter tap is applied to
+ * a contiguous column of spikes (a loop the compiler vectorizes), and
+ * blocks of spikes are processed in parallel. Normalization, kurtosis
+ * and skewness of each coefficient are fused into one pass per column.
+ *
+ * Created on 10/18/2026
+ *=================================================================*/
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include <vector>
+#include "mex.h"
+#include "nigel_threads.h"
+
+/* Input Arguments */
+
+#define	SPIKES	prhs[0]
+#define	HID	prhs[1]
+
+/* Constants */
+
+static const size_t SPIKE_BLOCK = 2048;  /* Spikes per parallel work item */
+
+///////////////////////////////////////////////////////////////////////////
+/* Helpers */
+///////////////////////////////////////////////////////////////////////////
+
+/* Sample of x used at (0-based) position e of the 'sym' extension */
+static size_t symIndex(ptrdiff_t e, ptrdiff_t M)
+{
+    ptrdiff_t r = e % (2 * M);
+    if (r < 0) r += 2 * M;
+    return (size_t)((r < M) ? r : 2 * M - 1 - r);
+}
+
+/* cc(:,j) = cD1(j+2) for rows r0..r1-1 (cD1(j) = sum(f(k) * x(2j-k)),
+ * 1-based, x extended symmetrically) */
+template <typename T>
+static void detailBlock(const T *x, size_t N,
+                        const std::vector<double> &f,
+                        const std::vector<size_t> &tapCol, size_t nC,
+                        size_t r0, size_t r1, double *cc)
+{
+    size_t F = f.size();
+    for (size_t j = 0; j < nC; j++)
+    {
+        double *out = cc + j * N;
+        for (size_t i = r0; i < r1; i++) out[i] = 0;
+        for (size_t k = 0; k < F; k++)
+        {
+            const T *col = x + tapCol[j * F + k] * N;
+            double w = f[k];
+            for (size_t i = r0; i < r1; i++) out[i] += w * (double)col[i];
+        }
+    }
+}
+
+/* Normalizes cc(:,j) and returns its kurtosis and skewness */
+static void columnStats(double *c, size_t N, double &kurt, double &skew)
+{
+    double mu = 0;
+    for (size_t i = 0; i < N; i++) mu += c[i];
+    mu /= (double)N;
+    double ss = 0;
+    for (size_t i = 0; i < N; i++)
+    {
+        c[i] -= mu;
+        ss += c[i] * c[i];
+    }
+    double sd = sqrt(ss / (double)(N - 1));
+
+    /* kurtosis/skewness (biased) of the normalized column */
+    double mu2 = 0;
+    for (size_t i = 0; i < N; i++)
+    {
+        c[i] /= sd;
+        mu2 += c[i];
+    }
+    mu2 /= (double)N;
+    double m2 = 0, m3 = 0, m4 = 0;
+    for (size_t i = 0; i < N; i++)
+    {
+        double d = c[i] - mu2, d2 = d * d;
+        m2 += d2;
+        m3 += d2 * d;
+        m4 += d2 * d2;
+    }
+    m2 /= (double)N;
+    m3 /= (double)N;
+    m4 /= (double)N;
+    kurt = m4 / (m2 * m2);
+    skew = m3 / pow(m2, 1.5);
+}
+
+template <typename T>
+static void waveletFeatures(const T *x, size_t N, size_t M,
+                            const std::vector<double> &f, size_t nC,
+                            double *cc, double *kurt, double *skew)
+{
+    /* Column of x used by each tap of each kept coefficient */
+    size_t F = f.size();
+    std::vector<size_t> tapCol(nC * F);
+    for (size_t j = 0; j < nC; j++)
+    {
+        ptrdiff_t jj = (ptrdiff_t)j + 2; /* 1-based index into cD1 */
+        for (size_t k = 0; k < F; k++)
+            tapCol[j * F + k] = symIndex(2 * jj - 1 - (ptrdiff_t)k, (ptrdiff_t)M);
+    }
+
+    size_t nBlock = (N + SPIKE_BLOCK - 1) / SPIKE_BLOCK;
+    nigel::parallelFor(nBlock, [&](size_t b) {
+        size_t r0 = b * SPIKE_BLOCK;
+        size_t r1 = (r0 + SPIKE_BLOCK < N) ? r0 + SPIKE_BLOCK : N;
+        detailBlock(x, N, f, tapCol, nC, r0, r1, cc);
+    });
+    nigel::parallelFor(nC, [&](size_t j) {
+        columnStats(cc + j * N, N, kurt[j], skew[j]);
+    });
+}
+
+///////////////////////////////////////////////////////////////////////////
+/* MEX Gateway Routine */
+///////////////////////////////////////////////////////////////////////////
+
+void mexFunction( int nlhs, mxArray *plhs[],
+		  int nrhs, const mxArray *prhs[] )
+{
+    if (nrhs != 2)
+        mexErrMsgIdAndTxt("nigeLab:WaveletFeatures:BadInput",
+            "Requires (spikes, hiD).");
+    if (mxIsComplex(SPIKES) || mxIsSparse(SPIKES) ||
+        !(mxIsDouble(SPIKES) || mxIsSingle(SPIKES)))
+        mexErrMsgIdAndTxt("nigeLab:WaveletFeatures:BadClass",
+            "spikes must be real, full double or single.");
+    if (!mxIsDouble(HID) || mxIsComplex(HID) || mxGetNumberOfElements(HID) < 2)
+        mexErrMsgIdAndTxt("nigeLab:WaveletFeatures:BadFilter",
+            "hiD must be a real double vector.");
+
+    size_t N = mxGetM(SPIKES), M = mxGetN(SPIKES);
+    std::vector<double> f(mxGetPr(HID), mxGetPr(HID) + mxGetNumberOfElements(HID));
+    size_t nD = (M + f.size() - 1) / 2;
+    if (M < 1 || nD < 3)
+        mexErrMsgIdAndTxt("nigeLab:WaveletFeatures:TooShort",
+            "Snippets are too short for this wavelet.");
+    size_t nC = nD - 2;
+
+    plhs[0] = mxCreateDoubleMatrix(N, nC, mxREAL);
+    mxArray *K = mxCreateDoubleMatrix(1, nC, mxREAL);
+    mxArray *S = mxCreateDoubleMatrix(1, nC, mxREAL);
+    if (N > 0)
+    {
+        if (mxIsDouble(SPIKES))
+            waveletFeatures(mxGetPr(SPIKES), N, M, f, nC, mxGetPr(plhs[0]),
+                            mxGetPr(K), mxGetPr(S));
+        else
+            waveletFeatures((const float *)mxGetData(SPIKES), N, M, f, nC,
+                            mxGetPr(plhs[0]), mxGetPr(K), mxGetPr(S));
+    }
+    if (nlhs > 1) plhs[1] = K; else mxDestroyArray(K);
+    if (nlhs > 2) plhs[2] = S; else mxDestroyArray(S);
+}
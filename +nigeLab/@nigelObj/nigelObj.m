@@ -2256,6 +2256,9 @@ classdef nigelObj < handle & ...
          %
          %  flag returns true if the save did not throw an error.
          
+         % Make sure queued (write-behind) DiskData writes are on disk
+         nigeLab.libs.DiskWriter.barrier();
+         
          % Make sure array isn't saved to same file
          if numel(obj) > 1
             flag = true(size(obj));